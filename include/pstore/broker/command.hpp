@@ -135,7 +135,7 @@ namespace pstore {
                 return std::strcmp (std::get<0> (a), std::get<0> (b)) < 0;
             }
 
-            static std::array<command_entry, 6> const commands_;
+            static std::array<command_entry, 9> const commands_;
 
             ///@{
             /// Functions responsible for processing each of the commands to which the broker will
@@ -155,6 +155,13 @@ namespace pstore {
             /// Starts the garbage collection for a path (specified in the command path) if not
             /// already running.
             virtual void gc (brokerface::fifo_path const & fifo, broker_command const & c);
+            /// Cancels the garbage collection for a path (specified in the command path).
+            virtual void gc_cancel (brokerface::fifo_path const & fifo, broker_command const & c);
+            /// Changes the settings of the vacuum service. The command path is a space-separated
+            /// list of "key=value" pairs.
+            virtual void gc_config (brokerface::fifo_path const & fifo, broker_command const & c);
+            /// Logs the state of the vacuum service.
+            virtual void gc_status (brokerface::fifo_path const & fifo, broker_command const & c);
 
             /// Echoes the command path text to stdout.
             virtual void echo (brokerface::fifo_path const & fifo, broker_command const & c);
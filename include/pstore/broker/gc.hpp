@@ -1,10 +1,9 @@
 //===- include/pstore/broker/gc.hpp -----------------------*- mode: C++ -*-===//
-//*              *
-//*   __ _  ___  *
-//*  / _` |/ __| *
-//* | (_| | (__  *
-//*  \__, |\___| *
-//*  |___/       *
+//*                                                _         *
+//* __ ____ _ __ _  _ _  _ _ __    ___ ___ _ ___ _(_)__ ___  *
+//* \ V / _` / _| || | || | '  \  (_-</ -_) '_\ V / / _/ -_) *
+//*  \_/\__,_\__|\_,_|\_,_|_|_|_| /__/\___|_|  \_/|_\__\___| *
+//*                                                          *
 //===----------------------------------------------------------------------===//
 //
 // Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
@@ -18,11 +17,15 @@
 #ifndef PSTORE_BROKER_GC_HPP
 #define PSTORE_BROKER_GC_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "pstore/broker/bimap.hpp"
 #include "pstore/broker/pointer_compare.hpp"
 #include "pstore/broker/spawn.hpp"
+#include "pstore/brokerface/pubsub.hpp"
 #include "pstore/config/config.hpp"
 #include "pstore/os/signal_cv.hpp"
 #include "pstore/support/maybe.hpp"
@@ -93,7 +96,60 @@ namespace pstore {
 
         gc_watch_thread & getgc ();
 
+        /// An in-process vacuum service. Once a service has been installed with
+        /// set_vacuum_service(), requests to vacuum a store are passed to it rather than being
+        /// handled by spawning an instance of the vacuum tool.
+        class vacuum_service {
+        public:
+            struct store {
+                std::string path;
+                /// The logical size of the store in bytes.
+                std::uint64_t size;
+                /// The estimated number of bytes that would be recovered by vacuuming the store.
+                std::uint64_t garbage;
+                double priority;
+                bool pending;
+                bool running;
+                unsigned vacuums;
+            };
+
+            virtual ~vacuum_service () noexcept;
+
+            /// Asks for the store at \p path to be vacuumed.
+            virtual void request (std::string const & path) = 0;
+            /// Cancels any outstanding or running collection of the store at \p path.
+            ///
+            /// \returns True if the store was known to the service.
+            virtual bool cancel (std::string const & path) = 0;
+            /// Changes one of the service's settings.
+            ///
+            /// \param key  The name of the setting.
+            /// \param value  The new value of the setting.
+            /// \returns False if \p key or \p value was not recognized.
+            virtual bool configure (std::string const & key, std::string const & value) = 0;
+            /// Returns the service's settings as a space-separated list of key=value pairs in the
+            /// form accepted by configure().
+            virtual std::string settings () const = 0;
+            /// Returns the state of each of the stores known to the service.
+            virtual std::vector<store> stores () const = 0;
+            /// Cancels all work and waits for it to complete.
+            virtual void stop () = 0;
+        };
+
+        /// Installs the service to which vacuum requests are passed. A null pointer restores the
+        /// default behavior of spawning an instance of the vacuum tool for each request.
+        void set_vacuum_service (std::shared_ptr<vacuum_service> const & service);
+        std::shared_ptr<vacuum_service> get_vacuum_service ();
+
+        extern descriptor_condition_variable vacuum_cv;
+        extern brokerface::channel<descriptor_condition_variable> vacuum_channel;
+
+        /// Publishes the state of the vacuum service (as JSON) on vacuum_channel.
+        void publish_vacuum_status ();
+
         void start_vacuum (std::string const & path);
+        /// Cancels any vacuum of the store at \p path which is waiting or in progress.
+        void cancel_vacuum (std::string const & path);
         void gc_sigint (int sig);
 
         void gc_process_watch_thread ();
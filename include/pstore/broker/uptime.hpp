@@ -28,6 +28,14 @@ namespace pstore {
         extern descriptor_condition_variable uptime_cv;
         extern brokerface::channel<descriptor_condition_variable> uptime_channel;
 
+        /// If pstore was configured with PSTORE_INSTRUMENTATION enabled (see counters::enabled()),
+        /// on each uptime tick the totals of the broker's hot-path counters (see
+        /// pstore/support/counters.hpp) are published as JSON on this channel. The counters are
+        /// per-process so they reflect only the work done by the broker process itself, not that
+        /// of the other processes which use the store.
+        extern descriptor_condition_variable counters_cv;
+        extern brokerface::channel<descriptor_condition_variable> counters_channel;
+
         void uptime (gsl::not_null<std::atomic<bool> *> done);
 
     } // end namespace broker
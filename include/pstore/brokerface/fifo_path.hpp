@@ -31,6 +31,16 @@
 namespace pstore {
     namespace brokerface {
 
+        /// The means by which messages are carried from clients to the broker.
+        enum class transport {
+            /// A named pipe (FIFO). Each write carries a single fixed-size message.
+            fifo,
+            /// A SOCK_SEQPACKET Unix-domain socket. Connections are reliable and preserve record
+            /// boundaries, so a single record may carry a batch of messages. Not available on
+            /// Windows.
+            socket,
+        };
+
         class fifo_path {
         public:
             using duration_type = std::chrono::milliseconds;
@@ -75,6 +85,12 @@ namespace pstore {
             /// path (as defined at configure time) is used.
             fifo_path (gsl::czstring pipe_path, duration_type retry_timeout, unsigned max_retries,
                        update_callback cb = default_update_cb);
+
+            /// \param pipe_path  The path of the pipe or socket. If nullptr, the default path for
+            /// the transport \p kind (as defined at configure time) is used.
+            /// \param kind  The transport used to carry messages to the broker.
+            fifo_path (gsl::czstring pipe_path, transport kind, duration_type retry_timeout,
+                       unsigned max_retries, update_callback cb = default_update_cb);
             // No copying or assignment.
             fifo_path (fifo_path const & rhs) = delete;
             fifo_path (fifo_path && rhs) noexcept = delete;
@@ -85,18 +101,22 @@ namespace pstore {
             fifo_path & operator= (fifo_path && rhs) noexcept = delete;
 
 #ifndef _WIN32
-            /// Create the pipe and open a read descriptor. (Used by the pipe server.)
+            /// Create the pipe and open a read descriptor. (Used by the pipe server.) If the
+            /// transport is a socket, the result is a non-blocking descriptor for the listening
+            /// socket from which client connections are accepted.
             server_pipe open_server_pipe ();
 #endif
             /// Open the pipe for writing. (Used by clients to write commands to the pipe.)
             client_pipe open_client_pipe () const;
 
             std::string const & get () const { return path_; }
+            transport get_transport () const noexcept { return transport_; }
 
         private:
             static char const * const default_pipe_name;
+            static char const * const default_socket_name;
 
-            static std::string get_default_path ();
+            static std::string get_default_path (transport kind);
             client_pipe open_impl () const;
             void wait_until_impl (std::chrono::milliseconds timeout) const;
 
@@ -104,8 +124,12 @@ namespace pstore {
             /// A mutex to prevent more than one thread trying to create/open the server pipe at the
             /// same time.
             std::mutex open_server_pipe_mut_;
+            /// The listening socket. Each server thread receives its own duplicate of this
+            /// descriptor. Guarded by open_server_pipe_mut_.
+            pipe_descriptor listener_;
 #endif
             std::atomic<bool> needs_delete_{false};
+            transport const transport_;
             std::string const path_;
 
             duration_type const retry_timeout_;
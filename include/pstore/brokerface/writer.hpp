@@ -15,6 +15,11 @@
 //===----------------------------------------------------------------------===//
 /// \file writer.hpp
 /// \brief Provides a simple interface to enable a client to send messages to the pstore broker.
+///
+/// Messages are carried by the transport chosen when the fifo_path is constructed. When the
+/// transport is a FIFO, each message is written individually. When it is a SOCK_SEQPACKET socket,
+/// a batch of up to #max_batch messages is sent as a single record. Such a batch is delivered
+/// whole or not at all so, for example, all of the parts of a long command arrive together.
 
 #ifndef PSTORE_BROKERFACE_WRITER_HPP
 #define PSTORE_BROKERFACE_WRITER_HPP
@@ -23,6 +28,7 @@
 
 // pstore broker-interface
 #include "pstore/brokerface/fifo_path.hpp"
+#include "pstore/support/gsl.hpp"
 
 namespace pstore {
     namespace brokerface {
@@ -33,6 +39,8 @@ namespace pstore {
         public:
             using duration_type = std::chrono::milliseconds;
             static constexpr unsigned infinite_retries = std::numeric_limits<unsigned>::max ();
+            /// The maximum number of messages carried by a single socket record.
+            static constexpr std::size_t max_batch = 64;
 
             using update_callback = std::function<void ()>;
             /// The default function called by write() to as the write() function retries the
@@ -55,13 +63,29 @@ namespace pstore {
             writer & operator= (writer && rhs) noexcept = default;
 
             void write (message_type const & msg, bool error_on_timeout);
+            /// Writes a sequence of messages. If the transport permits, several messages are
+            /// sent by each operation.
+            void write (gsl::span<message_type const> msgs, bool error_on_timeout);
 
         private:
             // (virtual for unit testing)
             virtual bool write_impl (message_type const & msg);
+            /// Attempts to write one or more of the messages at the start of \p msgs and returns
+            /// the number written. Returns 0 if the transport could not accept a message without
+            /// blocking.
+            virtual std::size_t write_batch_impl (gsl::span<message_type const> msgs);
+            /// Waits for up to the retry timeout before write() makes its next attempt.
+            void wait_impl () const;
+
+            /// Calls the update callback and write_batch_impl() until at least one message has
+            /// been written or the retry limit is reached. Returns the number of messages written.
+            std::size_t write_with_retries (gsl::span<message_type const> msgs,
+                                            bool error_on_timeout);
 
             /// The pipe to which the write() function will write data.
             fifo_path::client_pipe fd_;
+            /// The transport used by fd_.
+            transport transport_;
             /// The time delay between retries.
             duration_type retry_timeout_;
             /// The number of retries that will be attempted before write() will give up.
@@ -0,0 +1,658 @@
+//===- include/pstore/core/btree_map.hpp ------------------*- mode: C++ -*-===//
+//*  _     _                                          *
+//* | |__ | |_ _ __ ___  ___   _ __ ___   __ _ _ __   *
+//* | '_ \| __| '__/ _ \/ _ \ | '_ ` _ \ / _` | '_ \  *
+//* | |_) | |_| | |  __/  __/ | | | | | | (_| | |_) | *
+//* |_.__/ \__|_|  \___|\___| |_| |_| |_|\__,_| .__/  *
+//*                                           |_|     *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file btree_map.hpp
+/// \brief A persistent, ordered associative container implemented as a copy-on-write B+-tree.
+
+#ifndef PSTORE_CORE_BTREE_MAP_HPP
+#define PSTORE_CORE_BTREE_MAP_HPP
+
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "pstore/core/btree_map_types.hpp"
+#include "pstore/core/hamt_map.hpp"
+
+namespace pstore {
+    class transaction_base;
+
+    namespace index {
+
+        /// \brief A persistent, ordered associative container implemented as a copy-on-write
+        /// B+-tree.
+        ///
+        /// Unlike hamt_map, whose iteration order is determined by the hash of each key, the
+        /// elements of a btree_map are visited in key order. This enables lower_bound(),
+        /// upper_bound(), and the iteration of a range of keys such as all of the names which
+        /// share a common prefix. Modified nodes are copied to the heap and written back to the
+        /// store by flush() so that earlier revisions of the index remain intact.
+        ///
+        /// \tparam KeyType  The map key type.
+        /// \tparam ValueType  The map value type.
+        /// \tparam Compare  A function used to order keys. The signature must be equivalent to
+        /// bool(KeyType const &, KeyType const &).
+        template <typename KeyType, typename ValueType, typename Compare = std::less<KeyType>>
+        class btree_map final : public index_base {
+            using node = btree_details::node;
+            using node_ref = btree_details::node_ref;
+
+            template <typename K, typename V>
+            struct pair_types_compatible
+                    : std::integral_constant<bool,
+                                             serialize::is_compatible<KeyType, K>::value &&
+                                                 serialize::is_compatible<ValueType, V>::value> {};
+
+        public:
+            using key_compare = Compare;
+            using key_type = KeyType;
+            using mapped_type = ValueType;
+            using value_type = std::pair<KeyType const, ValueType>;
+
+            //*                 _     _ _                _            *
+            //*  __ ___ _ _  __| |_  (_) |_ ___ _ _ __ _| |_ ___ _ _  *
+            //* / _/ _ \ ' \(_-<  _| | |  _/ -_) '_/ _` |  _/ _ \ '_| *
+            //* \__\___/_||_/__/\__| |_|\__\___|_| \__,_|\__\___/_|   *
+            //*                                                       *
+            /// A forward iterator which visits the elements of the map in key order. The iterator
+            /// records the path from the root to the current leaf entry.
+            class const_iterator {
+                friend class btree_map;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename btree_map::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = value_type const *;
+                using reference = value_type const &;
+
+                /// Constructs the past-the-end iterator.
+                const_iterator (database const & db, btree_map const & index) noexcept
+                        : db_{&db}
+                        , index_{&index} {}
+
+                bool operator== (const_iterator const & other) const noexcept;
+                bool operator!= (const_iterator const & other) const noexcept {
+                    return !operator== (other);
+                }
+
+                /// Dereference operator
+                /// \return The value of the element to which this iterator is currently pointing.
+                reference operator* () const {
+                    if (value_ == nullptr) {
+                        value_ = std::make_shared<value_type const> (
+                            index_->load_leaf_node (*db_, this->get_address ()));
+                    }
+                    return *value_;
+                }
+                pointer operator-> () const { return &operator* (); }
+
+                /// Prefix increment
+                const_iterator & operator++ ();
+                /// Postfix increment operator (e.g., it++)
+                const_iterator operator++ (int) {
+                    const_iterator const old = *this;
+                    ++(*this);
+                    return old;
+                }
+
+                /// Returns the pstore address of the serialized value_type instance to which the
+                /// iterator is currently pointing.
+                address get_address () const noexcept {
+                    PSTORE_ASSERT (!path_.empty () && path_.back ().n->is_leaf ());
+                    return path_.back ().n->key (path_.back ().position);
+                }
+
+            private:
+                struct cursor {
+                    node_ref ref;
+                    /// Keeps an in-store node alive; null for a heap node.
+                    std::shared_ptr<node const> owner;
+                    node const * n;
+                    std::size_t position;
+                };
+
+                /// Appends the node \p ref to the path with the given \p position.
+                void push (node_ref ref, std::size_t position);
+                /// Descends from the current entry to the left-most entry of the leaf beneath it.
+                void move_to_left_most_leaf ();
+
+                database const * db_;
+                btree_map const * index_;
+                std::vector<cursor> path_;
+                mutable std::shared_ptr<value_type const> value_;
+            };
+            using iterator = const_iterator;
+
+            /// \param db  The database instance.
+            /// \param pos  The address of the index header block or null for an empty map.
+            /// \param compare  The key comparison function.
+            explicit btree_map (
+                database const & db,
+                typed_address<header_block> pos = typed_address<header_block>::null (),
+                Compare const & compare = Compare ());
+
+            /// \name Iterators
+            ///@{
+
+            range<database const, btree_map const, const_iterator>
+            make_range (database const & db) const {
+                return {db, *this};
+            }
+
+            const_iterator begin (database const & db) const;
+            const_iterator end (database const & db) const { return const_iterator{db, *this}; }
+            const_iterator cbegin (database const & db) const { return this->begin (db); }
+            const_iterator cend (database const & db) const { return this->end (db); }
+            ///@}
+
+            /// \name Capacity
+            ///@{
+
+            /// Checks whether the container is empty.
+            bool empty () const noexcept { return size_ == 0U; }
+            /// Returns the number of elements
+            std::size_t size () const noexcept { return size_; }
+            ///@}
+
+            /// \name Modifiers
+            ///@{
+
+            /// Inserts an element into the map if the map doesn't already contain an element with
+            /// an equivalent key. If insertion occurs, all iterators are invalidated.
+            ///
+            /// \param transaction The transaction to which the new key-value pair will be appended.
+            /// \param value  The key-value pair to be inserted.
+            /// \result The bool component is true if the insertion took place. The iterator
+            /// component points at the existing or new element.
+            template <typename OtherKeyType, typename OtherValueType,
+                      typename = typename std::enable_if<
+                          pair_types_compatible<OtherKeyType, OtherValueType>::value>::type>
+            std::pair<iterator, bool>
+            insert (transaction_base & transaction,
+                    std::pair<OtherKeyType, OtherValueType> const & value) {
+                return this->insert_or_upsert (transaction, value, false /*is_upsert*/);
+            }
+
+            /// If a key equivalent to \p value first already exists in the container, assigns
+            /// \p value second to the mapped type. If the key does not exist, inserts the new value
+            /// as if by insert(). All iterators are invalidated.
+            ///
+            /// \param transaction  The transaction to which new data will be appended.
+            /// \param value  The key-value pair to be inserted or updated.
+            /// \result The bool component is true if the insertion took place and false if the
+            /// assignment took place. The iterator component points at the element inserted or
+            /// updated.
+            template <typename OtherKeyType, typename OtherValueType,
+                      typename = typename std::enable_if<
+                          pair_types_compatible<OtherKeyType, OtherValueType>::value>::type>
+            std::pair<iterator, bool>
+            insert_or_assign (transaction_base & transaction,
+                              std::pair<OtherKeyType, OtherValueType> const & value) {
+                return this->insert_or_upsert (transaction, value, true /*is_upsert*/);
+            }
+
+            /// If a key equivalent to \p key already exists in the container, assigns \p value to
+            /// the mapped type. If the key does not exist, inserts the new value as if by
+            /// insert(). All iterators are invalidated.
+            template <typename OtherKeyType, typename OtherValueType,
+                      typename = typename std::enable_if<
+                          pair_types_compatible<OtherKeyType, OtherValueType>::value>::type>
+            std::pair<iterator, bool> insert_or_assign (transaction_base & transaction,
+                                                        OtherKeyType const & key,
+                                                        OtherValueType const & value) {
+                return this->insert_or_assign (transaction, std::make_pair (key, value));
+            }
+            ///@}
+
+            /// \name Lookup
+            ///@{
+
+            /// Finds the element with key equivalent to \p key.
+            ///
+            /// \return An iterator to the element with key equivalent to \p key. If no such
+            /// element is found, the past-the-end iterator is returned.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            const_iterator find (database const & db, OtherKeyType const & key) const;
+
+            /// Returns an iterator to the first element whose key is not less than \p key or the
+            /// past-the-end iterator if there is no such element.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            const_iterator lower_bound (database const & db, OtherKeyType const & key) const {
+                return this->bound (db, key, false /*upper*/);
+            }
+
+            /// Returns an iterator to the first element whose key is greater than \p key or the
+            /// past-the-end iterator if there is no such element.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            const_iterator upper_bound (database const & db, OtherKeyType const & key) const {
+                return this->bound (db, key, true /*upper*/);
+            }
+            ///@}
+
+            /// Flush any modified index nodes to the store.
+            ///
+            /// \param transaction  The transaction to which the map will be written.
+            /// \param generation The generation number to which the map will be written.
+            /// \returns The address of the index header block.
+            typed_address<header_block> flush (transaction_base & transaction, unsigned generation);
+
+            /// \name Accessors
+            /// Provide access to index internals.
+            ///@{
+
+            /// Read a leaf node from a store.
+            value_type load_leaf_node (database const & db, address addr) const {
+                return serialize::read<std::pair<KeyType, ValueType>> (
+                    serialize::archive::database_reader{db, addr});
+            }
+
+            /// Returns the index root node.
+            node_ref root () const noexcept { return root_; }
+            ///@}
+
+        private:
+            static constexpr std::array<std::uint8_t, 8> index_signature{
+                {'B', 'T', 'r', 'e', 'H', 'e', 'd', 'r'}};
+
+            /// The result of inserting into a subtree.
+            struct insert_result {
+                /// The (possibly new) root of the subtree.
+                node_ref ref;
+                /// The address of the smallest record in the subtree.
+                address first;
+                /// If not null, a node which was split from the subtree root and which must be
+                /// added to its parent.
+                node * split;
+                /// True if a new element was added.
+                bool inserted;
+            };
+
+            key_type get_key (database const & db, address const addr) const {
+                return serialize::read<KeyType> (serialize::archive::database_reader{db, addr});
+            }
+
+            /// Returns the index of the first entry of \p n whose key is not less than \p key or,
+            /// if \p upper is true, is greater than \p key.
+            template <typename OtherKeyType>
+            std::size_t search (database const & db, node const & n, OtherKeyType const & key,
+                                bool upper) const;
+            /// Returns the index of the child of branch \p n whose subtree could contain \p key.
+            template <typename OtherKeyType>
+            std::size_t child_index (database const & db, node const & n,
+                                     OtherKeyType const & key) const {
+                std::size_t const pos = this->search (db, n, key, true /*upper*/);
+                return pos == 0U ? 0U : pos - 1U;
+            }
+
+            template <typename OtherKeyType>
+            const_iterator bound (database const & db, OtherKeyType const & key, bool upper) const;
+
+            template <typename OtherValueType>
+            std::pair<iterator, bool> insert_or_upsert (transaction_base & transaction,
+                                                        OtherValueType const & value,
+                                                        bool is_upsert);
+            template <typename OtherValueType>
+            insert_result insert_node (transaction_base & transaction, node_ref ref,
+                                       OtherValueType const & value, bool is_upsert);
+
+            /// Returns a heap node to which changes to the node \p n at \p ref may be made. If
+            /// \p ref is in-store, a heap copy is made and the original recorded as garbage.
+            node * make_writable (transaction_base & transaction, node_ref ref, node const & n);
+            /// Splits \p w if it has overflowed.
+            insert_result finish_node (node * w, bool inserted);
+
+            /// Stores a key/value data pair.
+            template <typename OtherValueType>
+            address store_leaf_node (transaction_base & transaction, OtherValueType const & v) {
+                return serialize::write (serialize::archive::make_writer (transaction), v);
+            }
+
+            /// Records the leaf node at \p addr, together with any data to which its value
+            /// refers, as garbage in \p transaction. Called when the leaf is replaced.
+            void supersede_leaf (transaction_base & transaction, address addr) const;
+
+            /// The storage for the in-heap nodes.
+            btree_details::heap_nodes heap_nodes_;
+            unsigned revision_;
+            node_ref root_;
+            std::size_t size_ = 0;
+            Compare compare_;
+        };
+
+        //*  _    _                                  *
+        //* | |__| |_ _ _ ___ ___   _ __  __ _ _ __  *
+        //* | '_ \  _| '_/ -_) -_) | '  \/ _` | '_ \ *
+        //* |_.__/\__|_| \___\___| |_|_|_\__,_| .__/ *
+        //*                                   |_|    *
+        template <typename KeyType, typename ValueType, typename Compare>
+        constexpr std::array<std::uint8_t, 8>
+            btree_map<KeyType, ValueType, Compare>::index_signature;
+
+        // (ctor)
+        // ~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        btree_map<KeyType, ValueType, Compare>::btree_map (database const & db,
+                                                           typed_address<header_block> const pos,
+                                                           Compare const & compare)
+                : revision_{db.get_current_revision ()}
+                , compare_{compare} {
+            if (pos != typed_address<header_block>::null ()) {
+                std::shared_ptr<header_block const> const hb = db.getro (pos);
+#if PSTORE_SIGNATURE_CHECKS_ENABLED
+                if (hb->signature != index_signature) {
+                    raise (pstore::error_code::index_corrupt);
+                }
+#endif
+                auto const root = node_ref{hb->root};
+                if ((hb->size == 0U) != root.is_empty ()) {
+                    raise (pstore::error_code::index_corrupt);
+                }
+                size_ = hb->size;
+                root_ = root;
+            }
+        }
+
+        // begin
+        // ~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        auto btree_map<KeyType, ValueType, Compare>::begin (database const & db) const
+            -> const_iterator {
+            const_iterator result{db, *this};
+            if (!root_.is_empty ()) {
+                result.push (root_, 0U);
+                result.move_to_left_most_leaf ();
+            }
+            return result;
+        }
+
+        // search
+        // ~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        template <typename OtherKeyType>
+        std::size_t btree_map<KeyType, ValueType, Compare>::search (database const & db,
+                                                                    node const & n,
+                                                                    OtherKeyType const & key,
+                                                                    bool const upper) const {
+            auto first = std::size_t{0};
+            auto count = n.size ();
+            while (count > 0U) {
+                std::size_t const step = count / 2U;
+                std::size_t const mid = first + step;
+                key_type const k = this->get_key (db, n.key (mid));
+                if (upper ? !compare_ (key, k) : compare_ (k, key)) {
+                    first = mid + 1U;
+                    count -= step + 1U;
+                } else {
+                    count = step;
+                }
+            }
+            return first;
+        }
+
+        // bound
+        // ~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        template <typename OtherKeyType>
+        auto btree_map<KeyType, ValueType, Compare>::bound (database const & db,
+                                                            OtherKeyType const & key,
+                                                            bool const upper) const
+            -> const_iterator {
+            const_iterator result{db, *this};
+            if (root_.is_empty ()) {
+                return result;
+            }
+            result.push (root_, 0U);
+            for (;;) {
+                typename const_iterator::cursor & c = result.path_.back ();
+                if (c.n->is_leaf ()) {
+                    c.position = this->search (db, *c.n, key, upper);
+                    if (c.position == c.n->size ()) {
+                        // All of the keys in this leaf precede 'key': the result is the first
+                        // entry of the next leaf (if any).
+                        --c.position;
+                        ++result;
+                    }
+                    return result;
+                }
+                c.position = this->child_index (db, *c.n, key);
+                result.push (c.n->child (c.position), 0U);
+            }
+        }
+
+        // find
+        // ~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        template <typename OtherKeyType, typename>
+        auto btree_map<KeyType, ValueType, Compare>::find (database const & db,
+                                                           OtherKeyType const & key) const
+            -> const_iterator {
+            const_iterator it = this->lower_bound (db, key);
+            if (it != this->cend (db) && compare_ (key, this->get_key (db, it.get_address ()))) {
+                return this->cend (db);
+            }
+            return it;
+        }
+
+        // supersede leaf
+        // ~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        void btree_map<KeyType, ValueType, Compare>::supersede_leaf (transaction_base & transaction,
+                                                                     address const addr) const {
+            serialize::archive::database_reader reader{transaction.db (), addr};
+            auto const leaf = serialize::read<std::pair<KeyType, ValueType>> (reader);
+            transaction.supersede ((reader.get_address ().absolute () - addr.absolute ()) +
+                                   details::referenced_bytes (leaf.second));
+        }
+
+        // make writable
+        // ~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        auto btree_map<KeyType, ValueType, Compare>::make_writable (transaction_base & transaction,
+                                                                    node_ref const ref,
+                                                                    node const & n) -> node * {
+            if (ref.is_heap ()) {
+                return ref.to_node ();
+            }
+            transaction.supersede (n.size_bytes ());
+            return node::allocate (&heap_nodes_, n);
+        }
+
+        // finish node
+        // ~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        auto btree_map<KeyType, ValueType, Compare>::finish_node (node * const w,
+                                                                  bool const inserted)
+            -> insert_result {
+            node * const split = w->size () > node::max_entries ? w->split (&heap_nodes_) : nullptr;
+            return {node_ref{w}, w->key (0U), split, inserted};
+        }
+
+        // insert node
+        // ~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        template <typename OtherValueType>
+        auto btree_map<KeyType, ValueType, Compare>::insert_node (transaction_base & transaction,
+                                                                  node_ref const ref,
+                                                                  OtherValueType const & value,
+                                                                  bool const is_upsert)
+            -> insert_result {
+            database const & db = transaction.db ();
+            std::pair<std::shared_ptr<node const>, node const *> const p =
+                node::get_node (db, ref);
+            node const & n = *p.second;
+
+            if (n.is_leaf ()) {
+                std::size_t const pos = this->search (db, n, value.first, false /*upper*/);
+                bool const exists =
+                    pos < n.size () && !compare_ (value.first, this->get_key (db, n.key (pos)));
+                if (exists && !is_upsert) {
+                    return {ref, n.key (0U), nullptr, false};
+                }
+                node * const w = this->make_writable (transaction, ref, n);
+                if (exists) {
+                    this->supersede_leaf (transaction, w->key (pos));
+                    w->set_key (pos, this->store_leaf_node (transaction, value));
+                } else {
+                    w->insert (pos, this->store_leaf_node (transaction, value));
+                }
+                return this->finish_node (w, !exists);
+            }
+
+            std::size_t const pos = this->child_index (db, n, value.first);
+            node_ref const child = n.child (pos);
+            insert_result const r = this->insert_node (transaction, child, value, is_upsert);
+            if (r.ref == child && r.first == n.key (pos) && r.split == nullptr) {
+                return {ref, n.key (0U), nullptr, r.inserted};
+            }
+            node * const w = this->make_writable (transaction, ref, n);
+            w->set_child (pos, r.ref);
+            w->set_key (pos, r.first);
+            if (r.split != nullptr) {
+                w->insert (pos + 1U, r.split->key (0U), node_ref{r.split});
+            }
+            return this->finish_node (w, r.inserted);
+        }
+
+        // insert or upsert
+        // ~~~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        template <typename OtherValueType>
+        auto btree_map<KeyType, ValueType, Compare>::insert_or_upsert (
+            transaction_base & transaction, OtherValueType const & value, bool const is_upsert)
+            -> std::pair<iterator, bool> {
+            database const & db = transaction.db ();
+            if (revision_ != db.get_current_revision ()) {
+                raise (error_code::index_not_latest_revision);
+            }
+
+            bool inserted = true;
+            if (root_.is_empty ()) {
+                node * const leaf = node::allocate (&heap_nodes_, node::kind::leaf);
+                leaf->insert (0U, this->store_leaf_node (transaction, value));
+                root_ = node_ref{leaf};
+            } else {
+                insert_result const r = this->insert_node (transaction, root_, value, is_upsert);
+                root_ = r.ref;
+                inserted = r.inserted;
+                if (r.split != nullptr) {
+                    // The root was split: the tree grows by one level.
+                    node * const branch = node::allocate (&heap_nodes_, node::kind::branch);
+                    branch->insert (0U, r.first, r.ref);
+                    branch->insert (1U, r.split->key (0U), node_ref{r.split});
+                    root_ = node_ref{branch};
+                }
+            }
+            if (inserted) {
+                ++size_;
+            }
+            return {this->find (db, value.first), inserted};
+        }
+
+        // flush
+        // ~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        typed_address<header_block>
+        btree_map<KeyType, ValueType, Compare>::flush (transaction_base & transaction,
+                                                       unsigned const generation) {
+            if (revision_ != transaction.db ().get_current_revision ()) {
+                raise (error_code::index_not_latest_revision);
+            }
+            if (root_.is_heap ()) {
+                root_ = root_.to_node ()->flush (transaction);
+            }
+
+            auto header_addr = typed_address<header_block>::null ();
+            if (size_ > 0U) {
+                auto const pos = transaction.alloc_rw<header_block> ();
+                pos.first->signature = index_signature;
+                pos.first->size = size_;
+                pos.first->root = root_.to_address ();
+                header_addr = pos.second;
+            }
+
+            // Release all of the in-heap nodes that we have now flushed.
+            heap_nodes_.clear ();
+            // Update the revision number into which the index will be flushed.
+            revision_ = generation;
+            return header_addr;
+        }
+
+        //*                 _     _ _                _            *
+        //*  __ ___ _ _  __| |_  (_) |_ ___ _ _ __ _| |_ ___ _ _  *
+        //* / _/ _ \ ' \(_-<  _| | |  _/ -_) '_/ _` |  _/ _ \ '_| *
+        //* \__\___/_||_/__/\__| |_|\__\___|_| \__,_|\__\___/_|   *
+        //*                                                       *
+        // operator==
+        // ~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        bool btree_map<KeyType, ValueType, Compare>::const_iterator::operator== (
+            const_iterator const & other) const noexcept {
+            PSTORE_ASSERT (index_ == other.index_);
+            if (path_.empty () || other.path_.empty ()) {
+                return path_.empty () == other.path_.empty ();
+            }
+            return path_.back ().ref == other.path_.back ().ref &&
+                   path_.back ().position == other.path_.back ().position;
+        }
+
+        // operator++
+        // ~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        auto btree_map<KeyType, ValueType, Compare>::const_iterator::operator++ ()
+            -> const_iterator & {
+            PSTORE_ASSERT (!path_.empty ());
+            value_.reset ();
+            ++path_.back ().position;
+            while (path_.back ().position >= path_.back ().n->size ()) {
+                path_.pop_back ();
+                if (path_.empty ()) {
+                    return *this; // We've reached the end.
+                }
+                ++path_.back ().position;
+            }
+            this->move_to_left_most_leaf ();
+            return *this;
+        }
+
+        // push
+        // ~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        void btree_map<KeyType, ValueType, Compare>::const_iterator::push (
+            node_ref const ref, std::size_t const position) {
+            std::pair<std::shared_ptr<node const>, node const *> p = node::get_node (*db_, ref);
+            path_.push_back (cursor{ref, std::move (p.first), p.second, position});
+        }
+
+        // move to left most leaf
+        // ~~~~~~~~~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Compare>
+        void btree_map<KeyType, ValueType, Compare>::const_iterator::move_to_left_most_leaf () {
+            while (!path_.back ().n->is_leaf ()) {
+                cursor const & c = path_.back ();
+                this->push (c.n->child (c.position), 0U);
+            }
+        }
+
+    } // end namespace index
+} // end namespace pstore
+
+#endif // PSTORE_CORE_BTREE_MAP_HPP
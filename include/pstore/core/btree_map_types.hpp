@@ -0,0 +1,211 @@
+//===- include/pstore/core/btree_map_types.hpp ------------*- mode: C++ -*-===//
+//*  _     _                                           _                          *
+//* | |__ | |_ _ __ ___  ___   _ __ ___   __ _ _ __   | |_ _   _ _ __   ___  ___  *
+//* | '_ \| __| '__/ _ \/ _ \ | '_ ` _ \ / _` | '_ \  | __| | | | '_ \ / _ \/ __| *
+//* | |_) | |_| | |  __/  __/ | | | | | | (_| | |_) | | |_| |_| | |_) |  __/\__ \ *
+//* |_.__/ \__|_|  \___|\___| |_| |_| |_|\__,_| .__/   \__|\__, | .__/ \___||___/ *
+//*                                           |_|          |___/|_|               *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file btree_map_types.hpp
+/// \brief Types used by the B+-tree index.
+
+#ifndef PSTORE_CORE_BTREE_MAP_TYPES_HPP
+#define PSTORE_CORE_BTREE_MAP_TYPES_HPP
+
+#include <memory>
+#include <vector>
+
+#include "pstore/core/database.hpp"
+
+namespace pstore {
+    class transaction_base;
+
+    namespace index {
+        namespace btree_details {
+
+            class node;
+
+            /// The storage for in-heap nodes. Each node is placement-constructed in one of these
+            /// buffers; the nodes are trivially destructible so releasing a buffer is sufficient
+            /// to release the node.
+            using heap_nodes = std::vector<std::unique_ptr<std::uint64_t[]>>;
+
+            //*               _                __  *
+            //*  _ _  ___  __| |___   _ _ ___ / _| *
+            //* | ' \/ _ \/ _` / -_) | '_/ -_)  _| *
+            //* |_||_\___/\__,_\___| |_| \___|_|   *
+            //*                                    *
+            /// A reference to a B+-tree node which may be either in the store or on the heap.
+            /// Nodes are 8-byte aligned so the least significant bit distinguishes the two.
+            class node_ref {
+            public:
+                constexpr node_ref () noexcept = default;
+                constexpr explicit node_ref (address const a) noexcept
+                        : v_{a.absolute ()} {}
+                explicit node_ref (node * const n) noexcept
+                        : v_{reinterpret_cast<std::uintptr_t> (n) | heap_bit} {}
+
+                /// Constructs a reference from its in-store representation.
+                static constexpr node_ref from_raw (std::uint64_t const v) noexcept {
+                    return node_ref{v, 0};
+                }
+                constexpr std::uint64_t raw () const noexcept { return v_; }
+
+                constexpr bool is_empty () const noexcept { return v_ == 0U; }
+                constexpr bool is_heap () const noexcept { return (v_ & heap_bit) != 0U; }
+                constexpr bool is_address () const noexcept { return !this->is_heap (); }
+                constexpr explicit operator bool () const noexcept { return !this->is_empty (); }
+
+                address to_address () const noexcept {
+                    PSTORE_ASSERT (this->is_address ());
+                    return address{v_};
+                }
+                node * to_node () const noexcept {
+                    PSTORE_ASSERT (this->is_heap ());
+                    return reinterpret_cast<node *> (static_cast<std::uintptr_t> (v_ & ~heap_bit));
+                }
+
+                constexpr bool operator== (node_ref const & other) const noexcept {
+                    return v_ == other.v_;
+                }
+                constexpr bool operator!= (node_ref const & other) const noexcept {
+                    return !operator== (other);
+                }
+
+            private:
+                static constexpr std::uint64_t heap_bit = 1U;
+                constexpr node_ref (std::uint64_t const v, int) noexcept
+                        : v_{v} {}
+                std::uint64_t v_ = 0U;
+            };
+
+            //*               _      *
+            //*  _ _  ___  __| |___  *
+            //* | ' \/ _ \/ _` / -_) *
+            //* |_||_\___/\__,_\___| *
+            //*                      *
+            /// A B+-tree node. A leaf holds the addresses of its key/value records in key order.
+            /// A branch holds (key, child) pairs in key order where the key is the address of the
+            /// smallest record in the child's subtree. Keys are compared by loading the records to
+            /// which these addresses refer so that variable-length keys need not be copied into
+            /// the nodes.
+            class node {
+            public:
+                enum class kind : std::uint32_t { leaf = 0, branch = 1 };
+
+                /// The maximum number of entries in a node. A node which grows beyond this size is
+                /// split in two.
+                static constexpr std::size_t max_entries = 64;
+
+                node (node const &) = delete;
+                node (node &&) = delete;
+                ~node () noexcept = default;
+                node & operator= (node const &) = delete;
+                node & operator= (node &&) = delete;
+
+                /// \name Construction
+                ///@{
+
+                /// Allocates an empty heap node which is owned by \p container. The node has room
+                /// for max_entries + 1 entries so that it may overflow before it is split.
+                static node * allocate (gsl::not_null<heap_nodes *> container, kind k);
+                /// Allocates a heap node which is owned by \p container and holds a copy of the
+                /// entries of \p other.
+                static node * allocate (gsl::not_null<heap_nodes *> container, node const & other);
+
+                /// Loads a node from the store. Raises error_code::index_corrupt if the node
+                /// appears to be invalid.
+                static std::shared_ptr<node const> read_node (database const & db, address addr);
+
+                /// Returns a pointer to a node which may be in-heap or in-store. The first member
+                /// of the result keeps an in-store node alive and is null for a heap node. The
+                /// second member is the raw node pointer.
+                static auto get_node (database const & db, node_ref ref)
+                    -> std::pair<std::shared_ptr<node const>, node const *>;
+                ///@}
+
+                bool is_leaf () const noexcept { return kind_ == kind::leaf; }
+                /// Returns the number of entries in the node.
+                std::size_t size () const noexcept { return size_; }
+
+                /// Returns the number of bytes occupied by an in-store node of kind \p k with
+                /// \p size entries.
+                static constexpr std::size_t size_bytes (kind const k,
+                                                         std::size_t const size) noexcept {
+                    return sizeof (node) - sizeof (node::entries_) +
+                           sizeof (std::uint64_t) * words_per_entry (k) * size;
+                }
+                /// Returns the number of bytes occupied by this node in the store.
+                std::size_t size_bytes () const noexcept {
+                    return node::size_bytes (kind_, size_);
+                }
+
+                /// \name Element access
+                ///@{
+
+                /// Returns the address of the record at position \p i of a leaf or the address of
+                /// the smallest record in the subtree of child \p i of a branch.
+                address key (std::size_t const i) const noexcept {
+                    PSTORE_ASSERT (i < size_);
+                    return address{entries_[i * words_per_entry (kind_)]};
+                }
+                /// Returns the child at position \p i of a branch.
+                node_ref child (std::size_t const i) const noexcept {
+                    PSTORE_ASSERT (kind_ == kind::branch && i < size_);
+                    return node_ref::from_raw (entries_[i * 2U + 1U]);
+                }
+
+                void set_key (std::size_t const i, address const a) noexcept {
+                    PSTORE_ASSERT (i < size_);
+                    entries_[i * words_per_entry (kind_)] = a.absolute ();
+                }
+                void set_child (std::size_t const i, node_ref const c) noexcept {
+                    PSTORE_ASSERT (kind_ == kind::branch && i < size_);
+                    entries_[i * 2U + 1U] = c.raw ();
+                }
+                ///@}
+
+                /// Inserts an entry at position \p pos of a heap node. The \p child argument is
+                /// ignored by a leaf.
+                void insert (std::size_t pos, address key, node_ref child = node_ref{}) noexcept;
+
+                /// Moves the upper half of the entries of this (heap) node to a new heap node
+                /// which is owned by \p container.
+                /// \returns The new node.
+                node * split (gsl::not_null<heap_nodes *> container);
+
+                /// Writes this node and any heap nodes beneath it to the store.
+                /// \returns A reference to the in-store copy of this node.
+                node_ref flush (transaction_base & transaction);
+
+            private:
+                explicit node (kind k) noexcept
+                        : kind_{k} {}
+
+                static constexpr std::size_t words_per_entry (kind const k) noexcept {
+                    return k == kind::leaf ? 1U : 2U;
+                }
+
+                using signature_type = std::array<std::uint8_t, 8>;
+                static signature_type const node_signature_;
+
+                signature_type signature_ = node_signature_;
+                kind kind_;
+                std::uint32_t size_ = 0;
+                /// For a leaf, one record address per entry. For a branch, the key address
+                /// followed by the child reference for each entry.
+                std::uint64_t entries_[1];
+            };
+
+        } // end namespace btree_details
+    }     // end namespace index
+} // end namespace pstore
+
+#endif // PSTORE_CORE_BTREE_MAP_TYPES_HPP
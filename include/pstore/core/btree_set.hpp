@@ -0,0 +1,186 @@
+//===- include/pstore/core/btree_set.hpp ------------------*- mode: C++ -*-===//
+//*  _     _                            _    *
+//* | |__ | |_ _ __ ___  ___   ___  ___| |_  *
+//* | '_ \| __| '__/ _ \/ _ \ / __|/ _ \ __| *
+//* | |_) | |_| | |  __/  __/ \__ \  __/ |_  *
+//* |_.__/ \__|_|  \___|\___| |___/\___|\__| *
+//*                                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file btree_set.hpp
+/// \brief A persistent, ordered set implemented as a copy-on-write B+-tree.
+
+#ifndef PSTORE_CORE_BTREE_SET_HPP
+#define PSTORE_CORE_BTREE_SET_HPP
+
+#include "pstore/core/btree_map.hpp"
+#include "pstore/core/hamt_set.hpp"
+
+namespace pstore {
+    namespace index {
+
+        //*  _    _                         _    *
+        //* | |__| |_ _ _ ___ ___   ___ ___| |_  *
+        //* | '_ \  _| '_/ -_) -_) (_-</ -_)  _| *
+        //* |_.__/\__|_| \___\___| /__/\___|\__| *
+        //*                                      *
+        /// An ordered set of keys. See btree_map.
+        template <typename KeyType, typename Compare = std::less<KeyType>>
+        class btree_set final : public index_base {
+            using map_type = btree_map<KeyType, details::empty_class, Compare>;
+
+            class set_iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename std::add_const<KeyType>::type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = value_type *;
+                using reference = value_type &;
+
+                explicit set_iterator (typename map_type::const_iterator const & it)
+                        : it_ (it) {}
+
+                bool operator== (set_iterator const & other) const { return it_ == other.it_; }
+                bool operator!= (set_iterator const & other) const { return it_ != other.it_; }
+
+                reference operator* () const { return it_->first; }
+                pointer operator-> () const { return &it_->first; }
+
+                /// Prefix increment
+                set_iterator & operator++ () {
+                    ++it_;
+                    return *this;
+                }
+                /// Postfix increment operator (e.g., it++)
+                set_iterator operator++ (int) {
+                    auto const old (*this);
+                    ++it_;
+                    return old;
+                }
+
+                address get_address () const { return it_.get_address (); }
+
+            private:
+                typename map_type::const_iterator it_;
+            };
+
+        public:
+            using key_type = KeyType;
+            using value_type = key_type;
+            using key_compare = Compare;
+            using const_iterator = set_iterator;
+            using iterator = const_iterator;
+
+            explicit btree_set (
+                database const & db,
+                typed_address<header_block> ip = typed_address<header_block>::null (),
+                Compare const & compare = Compare ())
+                    : map_ (db, ip, compare) {}
+
+            /// \name Iterators
+            ///@{
+
+            range<database const, btree_set const, const_iterator>
+            make_range (database const & db) const {
+                return {db, *this};
+            }
+
+            const_iterator begin (database const & db) const {
+                return const_iterator{map_.cbegin (db)};
+            }
+            const_iterator cbegin (database const & db) const { return this->begin (db); }
+            const_iterator end (database const & db) const {
+                return const_iterator{map_.cend (db)};
+            }
+            const_iterator cend (database const & db) const { return this->end (db); }
+            ///@}
+
+            /// \name Capacity
+            ///@{
+
+            /// \brief Checks whether the container is empty.
+            bool empty () const { return map_.empty (); }
+            /// \brief Returns the number of elements in the container.
+            std::size_t size () const { return map_.size (); }
+            ///@}
+
+            /// \brief Inserts an element into the container, if the container doesn't already
+            /// contain an element with an equivalent key.
+            ///
+            /// \param transaction  The transaction into which the new value element will be
+            /// inserted.
+            /// \param key  Element value to insert.
+            /// \returns A pair consisting of an iterator to the inserted element (or to the element
+            /// that prevented the insertion) and a bool value set to true if the insertion took
+            /// place.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            std::pair<iterator, bool> insert (transaction_base & transaction,
+                                              OtherKeyType const & key) {
+                auto it = map_.insert (transaction, std::make_pair (key, details::empty_class ()));
+                return {iterator{it.first}, it.second};
+            }
+
+            /// \name Lookup
+            ///@{
+
+            /// Finds an element with key equivalent to \p key.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            const_iterator find (database const & db, OtherKeyType const & key) const {
+                return const_iterator{map_.find (db, key)};
+            }
+            /// Returns an iterator to the first element which is not less than \p key.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            const_iterator lower_bound (database const & db, OtherKeyType const & key) const {
+                return const_iterator{map_.lower_bound (db, key)};
+            }
+            /// Returns an iterator to the first element which is greater than \p key.
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            const_iterator upper_bound (database const & db, OtherKeyType const & key) const {
+                return const_iterator{map_.upper_bound (db, key)};
+            }
+            ///@}
+
+            /// Flush any modified index nodes to the store.
+            ///
+            /// \param transaction  The transaction to which the set will be written.
+            /// \param generation The generation number to which the set will be written.
+            /// \returns The address of the index header block.
+            typed_address<header_block> flush (transaction_base & transaction,
+                                               unsigned generation) {
+                return map_.flush (transaction, generation);
+            }
+
+            /// \name Accessors
+            /// Provide access to index internals.
+            ///@{
+
+            /// Read a leaf node from a store.
+            value_type load_leaf_node (database const & db, address const addr) const {
+                return map_.load_leaf_node (db, addr).first;
+            }
+
+            btree_details::node_ref root () const noexcept { return map_.root (); }
+            ///@}
+
+        private:
+            map_type map_;
+        };
+
+    } // end namespace index
+} // end namespace pstore
+
+#endif // PSTORE_CORE_BTREE_SET_HPP
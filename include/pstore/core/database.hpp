@@ -18,7 +18,9 @@
 #ifndef PSTORE_CORE_DATABASE_HPP
 #define PSTORE_CORE_DATABASE_HPP
 
+#include <atomic>
 #include <mutex>
+#include <vector>
 
 #include "pstore/adt/sstring_view.hpp"
 #include "pstore/core/file_header.hpp"
@@ -141,6 +143,9 @@ namespace pstore {
         ///
         /// \note This is a const member function and therefore cannot "see" revisions later than
         /// the old currently synced because to do so may require additional space to be mapped.
+        /// \note The first call after the database has been synced to a new head walks the list
+        /// of generations to build a table of their footers. Later calls (from any thread) look
+        /// up the table.
         typed_address<trailer> older_revision_footer_pos (unsigned revision) const;
 
         static constexpr bool small_files_enabled () noexcept {
@@ -151,6 +156,14 @@ namespace pstore {
         std::time_t latest_time () const { return this->file ()->latest_time (); }
         bool is_writable () const noexcept { return storage_.file ()->is_writable (); }
 
+        /// Hints that the data at \p addr will shortly be read. This performs no I/O and never
+        /// fails: addresses beyond the end of the store are ignored.
+        void prefetch (address const addr) const noexcept {
+            if (addr.absolute () < this->size ()) {
+                PSTORE_PREFETCH (storage_.address_to_raw_pointer (addr));
+            }
+        }
+
         ///@{
         /// Load a block of data starting at address \p addr and of \p size bytes.
         ///
@@ -329,6 +342,11 @@ namespace pstore {
         /// \note This generation number doesn't count an open transaction.
         unsigned get_current_revision () const { return get_footer ()->a.generation.load (); }
 
+        /// Returns an estimate of the number of bytes in the store which are not reachable from
+        /// the indices of the generation to which the database is synced. This is the space that
+        /// would be recovered by vacuuming the store. See trailer::body::garbage.
+        std::uint64_t garbage () const { return get_footer ()->a.garbage.load (); }
+
         /// \brief Returns the name of the store's synchronisation object.
         ///
         /// This is set of 20 letters (`sync_name_length`) from a 32 character alphabet whose value
@@ -411,29 +429,36 @@ namespace pstore {
                     , logical_{footer_pos_.absolute () + sizeof (trailer)} {}
 
             typed_address<trailer> footer_pos () const noexcept { return footer_pos_; }
-            std::uint64_t logical_size () const noexcept { return logical_; }
+            std::uint64_t logical_size () const noexcept {
+                return logical_.load (std::memory_order_relaxed);
+            }
 
             void update_footer_pos (typed_address<trailer> const new_footer_pos) noexcept {
                 PSTORE_ASSERT (new_footer_pos.absolute () >= leader_size);
                 footer_pos_ = new_footer_pos;
-                logical_ = std::max (logical_, footer_pos_.absolute () + sizeof (trailer));
+                logical_.store (std::max (this->logical_size (),
+                                          footer_pos_.absolute () + sizeof (trailer)),
+                                std::memory_order_relaxed);
             }
 
             void update_logical_size (std::uint64_t const new_logical_size) noexcept {
                 PSTORE_ASSERT (new_logical_size >= footer_pos_.absolute () + sizeof (trailer));
-                logical_ = std::max (logical_, new_logical_size);
+                logical_.store (std::max (this->logical_size (), new_logical_size),
+                                std::memory_order_relaxed);
             }
 
             void truncate_logical_size (std::uint64_t const new_logical_size) noexcept {
                 PSTORE_ASSERT (new_logical_size >= footer_pos_.absolute () + sizeof (trailer));
-                logical_ = new_logical_size;
+                logical_.store (new_logical_size, std::memory_order_relaxed);
             }
 
         private:
             typed_address<trailer> footer_pos_ = typed_address<trailer>::null ();
 
-            /// This value tracks space as it's appended to the file.
-            std::uint64_t logical_ = 0;
+            /// This value tracks space as it's appended to the file. It is read by every access to
+            /// the store and may be updated by another thread of the same transaction (see
+            /// transaction_base::allocate()).
+            std::atomic<std::uint64_t> logical_{0};
         };
         sizes size_;
 
@@ -443,6 +468,17 @@ namespace pstore {
         std::string sync_name_;
         static constexpr auto const sync_name_length = std::size_t{20};
 
+        /// The address of the footer of each revision up to the one to which the database was
+        /// synced when the table was built. A null entry is a revision which could not be found.
+        /// See older_revision_footer_pos().
+        mutable std::vector<typed_address<trailer>> revision_footers_;
+        mutable std::mutex revision_footers_mut_;
+
+        /// Walks the list of generations back from \p footer_pos, the footer of revision
+        /// \p revision, and returns the address of the footer of each.
+        std::vector<typed_address<trailer>>
+        build_revision_footers (typed_address<trailer> footer_pos, unsigned revision) const;
+
         /// Clears the index cache: the next time that an index is requested it will be read from
         /// the disk. Used after a sync() operation has changed the current database view.
         void clear_index_cache ();
@@ -132,6 +132,125 @@ namespace pstore {
             return out;
         }
 
+
+        /// Returns the key from a leaf of a set-like index such as pstore::hamt_set.
+        template <typename KeyType>
+        KeyType const & leaf_key (KeyType const & v) noexcept {
+            return v;
+        }
+        /// Returns the key from a leaf of an associative index such as pstore::hamt_map.
+        template <typename KeyType, typename ValueType>
+        KeyType const & leaf_key (std::pair<KeyType, ValueType> const & kvp) noexcept {
+            return kvp.first;
+        }
+
+        /// Finds the leaves of an old revision of an index whose keys are absent from a newer
+        /// revision of the same index. The two trees are walked together so that subtrees which
+        /// are shared by both revisions need not be visited.
+        template <typename Index>
+        class removal_traverser {
+            using index_pointer = index::details::index_pointer;
+            using internal_node = index::details::internal_node;
+            using linear_node = index::details::linear_node;
+
+        public:
+            /// \param db  The owning database instance.
+            /// \param index  The newer revision of the index.
+            /// \param old_index  The older revision of the index.
+            constexpr removal_traverser (database const & db, Index const & index,
+                                         Index const & old_index) noexcept
+                    : db_{db}
+                    , index_{index}
+                    , old_index_{old_index} {}
+
+            /// \tparam OutputIterator An Output-Iterator type.
+            /// \param out  The output iterator to which the address of leaves may be added.
+            /// \result The output iterator to which results were written.
+            template <typename OutputIterator>
+            OutputIterator operator() (OutputIterator out) const {
+                if (auto const old_root = old_index_.root ()) {
+                    out = this->visit_node (old_root, index_.root (), 0U, out);
+                }
+                return out;
+            }
+
+        private:
+            /// \tparam OutputIterator An Output-Iterator type.
+            /// \param old_node  A node from the old index.
+            /// \param node  The node which occupies the same position in the new index. May be
+            ///   empty.
+            /// \param shifts  The depth of the nodes in the tree structure.
+            /// \param out  The output iterator to which the address of leaves may be added.
+            /// \result The output iterator to which results were written.
+            template <typename OutputIterator>
+            OutputIterator visit_node (index_pointer old_node, index_pointer node, unsigned shifts,
+                                       OutputIterator out) const;
+
+            database const & db_;
+            Index const & index_;
+            Index const & old_index_;
+        };
+
+        // visit node
+        // ~~~~~~~~~~
+        template <typename Index>
+        template <typename OutputIterator>
+        OutputIterator removal_traverser<Index>::visit_node (index_pointer const old_node,
+                                                             index_pointer const node,
+                                                             unsigned const shifts,
+                                                             OutputIterator out) const {
+            if (old_node == node) {
+                // This subtree is shared by both revisions.
+                return out;
+            }
+            if (old_node.is_leaf ()) {
+                auto const value = old_index_.load_leaf_node (db_, old_node.to_address ());
+                if (index_.find (db_, leaf_key (value)) == index_.cend (db_)) {
+                    *out = old_node.to_address ();
+                    ++out;
+                }
+                return out;
+            }
+
+            auto const child_shifts = shifts + index::details::hash_index_bits;
+            if (!index::details::depth_is_internal_node (shifts)) {
+                std::pair<std::shared_ptr<void const>, linear_node const *> const p =
+                    linear_node::get_node (db_, old_node);
+                for (address const child : *p.second) {
+                    out = this->visit_node (index_pointer{child}, index_pointer{}, child_shifts,
+                                            out);
+                }
+                return out;
+            }
+
+            std::pair<std::shared_ptr<void const>, internal_node const *> const old_internal =
+                internal_node::get_node (db_, old_node);
+            // If the new index has an internal node at the same position then its children are
+            // matched to those of the old node by their hash. If not, each of the old leaves is
+            // looked up individually.
+            std::pair<std::shared_ptr<void const>, internal_node const *> new_internal{nullptr,
+                                                                                      nullptr};
+            if (!node.is_empty () && !node.is_leaf ()) {
+                new_internal = internal_node::get_node (db_, node);
+            }
+
+            auto bitmap = old_internal.second->get_bitmap ();
+            auto child_index = std::size_t{0};
+            for (auto hash_index = index::details::hash_type{0}; bitmap != 0U;
+                 ++hash_index, bitmap >>= 1U) {
+                if ((bitmap & 1U) != 0U) { //! OCLINT(PH - bitwise in conditional is ok)
+                    index_pointer const new_child =
+                        new_internal.second != nullptr
+                            ? new_internal.second->lookup (hash_index).first
+                            : index_pointer{};
+                    out = this->visit_node ((*old_internal.second)[child_index], new_child,
+                                            child_shifts, out);
+                    ++child_index;
+                }
+            }
+            return out;
+        }
+
     } // end namespace diff_details
 
 
@@ -155,6 +274,22 @@ namespace pstore {
         return t (out);
     }
 
+    /// Write a series of addresses to an output iterator of the objects in \p old_index whose keys
+    /// are not present in \p index. That is, the objects that were erased from an index between
+    /// two revisions. The addresses may be passed to old_index.load_leaf_node().
+    ///
+    /// \param db  The owning database instance.
+    /// \param index  The index to be searched.
+    /// \param old_index  An earlier revision of \p index.
+    /// \param out  The output iterator to which the address of objects removed from the index
+    ///   are written.
+    /// \result The output iterator to which results were written.
+    template <typename Index, typename OutputIterator>
+    OutputIterator diff_removed (database const & db, Index const & index, Index const & old_index,
+                                 OutputIterator out) {
+        return diff_details::removal_traverser<Index>{db, index, old_index}(out);
+    }
+
 } // end namespace pstore
 
 #endif // PSTORE_CORE_DIFF_HPP
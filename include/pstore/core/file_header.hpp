@@ -94,7 +94,7 @@ namespace pstore {
         std::array<std::uint16_t, 2> const & version () const noexcept { return a.version; }
 
         static constexpr std::uint16_t major_version = 1;
-        static constexpr std::uint16_t minor_version = 13;
+        static constexpr std::uint16_t minor_version = 19;
 
         static std::array<std::uint8_t, 4> const file_signature1;
         static std::uint32_t const file_signature2 = 0x0507FFFF;
@@ -192,7 +192,9 @@ namespace pstore {
     X (debug_line_header)                                                                          \
     X (fragment)                                                                                   \
     X (name)                                                                                       \
+    X (ordered_name)                                                                               \
     X (path)                                                                                       \
+    X (payload)                                                                                    \
     X (write)
 
         struct header_block;
@@ -247,8 +249,13 @@ namespace pstore {
             typed_address<trailer> prev_generation = typed_address<trailer>::null ();
 
             index_records_array index_records;
-            std::uint32_t unused2{0};
-            std::uint32_t unused3{0};
+
+            /// An estimate of the number of bytes in this and all earlier generations which are no
+            /// longer reachable from this generation's indices: replaced index records and the
+            /// data to which they referred, index nodes which have been rewritten, and earlier
+            /// transaction trailers. This is the space that would be recovered by vacuuming the
+            /// store.
+            std::atomic<std::uint64_t> garbage{0};
         };
 
 
@@ -273,16 +280,15 @@ namespace pstore {
     PSTORE_STATIC_ASSERT (offsetof (trailer::body, time) == 24);
     PSTORE_STATIC_ASSERT (offsetof (trailer::body, prev_generation) == 32);
     PSTORE_STATIC_ASSERT (offsetof (trailer::body, index_records) == 40);
-    PSTORE_STATIC_ASSERT (offsetof (trailer::body, unused2) == 88);
-    PSTORE_STATIC_ASSERT (offsetof (trailer::body, unused3) == 92);
+    PSTORE_STATIC_ASSERT (offsetof (trailer::body, garbage) == 104);
     PSTORE_STATIC_ASSERT (alignof (trailer::body) == 8);
-    PSTORE_STATIC_ASSERT (sizeof (trailer::body) == 96);
+    PSTORE_STATIC_ASSERT (sizeof (trailer::body) == 112);
 
     PSTORE_STATIC_ASSERT (offsetof (trailer, a) == 0);
-    PSTORE_STATIC_ASSERT (offsetof (trailer, crc) == 96);
-    PSTORE_STATIC_ASSERT (offsetof (trailer, signature2) == 104);
+    PSTORE_STATIC_ASSERT (offsetof (trailer, crc) == 112);
+    PSTORE_STATIC_ASSERT (offsetof (trailer, signature2) == 120);
     PSTORE_STATIC_ASSERT (alignof (trailer) == 8);
-    PSTORE_STATIC_ASSERT (sizeof (trailer) == 112);
+    PSTORE_STATIC_ASSERT (sizeof (trailer) == 128);
 
 } // namespace pstore
 #endif // PSTORE_CORE_FILE_HEADER_HPP
@@ -19,8 +19,15 @@
 #ifndef PSTORE_CORE_HAMT_MAP_HPP
 #define PSTORE_CORE_HAMT_MAP_HPP
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "pstore/core/hamt_map_types.hpp"
 #include "pstore/serialize/standard_types.hpp"
+#include "pstore/support/counters.hpp"
+#include "pstore/support/parallel_for_each.hpp"
 
 namespace pstore {
 
@@ -30,6 +37,21 @@ namespace pstore {
 
         inline index_base::~index_base () = default;
 
+        namespace details {
+
+            /// Returns the number of bytes of data to which an index value refers. This data
+            /// becomes garbage when the value is replaced.
+            template <typename T>
+            constexpr std::uint64_t referenced_bytes (T const &) noexcept {
+                return 0U;
+            }
+            template <typename T>
+            constexpr std::uint64_t referenced_bytes (extent<T> const & ex) noexcept {
+                return ex.size;
+            }
+
+        } // end namespace details
+
 #ifdef _WIN32
 #    pragma warning(push)
 #    pragma warning(disable : 4521)
@@ -225,7 +247,7 @@ namespace pstore {
             hamt_map (hamt_map const &) = delete;
             hamt_map (hamt_map &&) noexcept = delete;
 
-            ~hamt_map () override { this->clear (); }
+            ~hamt_map () override = default;
 
             hamt_map & operator= (hamt_map const &) = delete;
             hamt_map & operator= (hamt_map &&) noexcept = delete;
@@ -255,6 +277,19 @@ namespace pstore {
                 return make_end_iterator (db, *this);
             }
 
+            /// Divides the elements of the container into no more than \p max_parts disjoint
+            /// ranges which, taken in order, cover the entire container in iteration order. The
+            /// ranges are split at tree node boundaries so that each can be traversed
+            /// independently of (and concurrently with) the others. Since keys are distributed by
+            /// their hash, the ranges hold similar numbers of elements.
+            ///
+            /// \param db  The database to which the index belongs.
+            /// \param max_parts  The maximum number of ranges to be produced. There may be fewer
+            ///   if the tree does not have enough nodes near its root. The result is empty if the
+            ///   container is empty.
+            /// \return The ranges in iteration order.
+            std::vector<subrange<const_iterator>> partition (database const & db,
+                                                             std::size_t max_parts) const;
             ///@}
 
             /// \name Capacity
@@ -330,6 +365,23 @@ namespace pstore {
                           pair_types_compatible<OtherKeyType, OtherValueType>::value>::type>
             auto insert_or_assign (transaction_base & transaction, OtherKeyType const & key,
                                    OtherValueType const & value) -> std::pair<iterator, bool>;
+
+            /// Removes the element (if one exists) with a key equivalent to \p key. The nodes on
+            /// the path to the element are copied to the heap; an internal node which is left with
+            /// a single leaf child is replaced by that leaf. The element remains visible in
+            /// earlier revisions of the store. The space that it occupied together with that of
+            /// any replaced in-store nodes is recorded as garbage in \p transaction so that the
+            /// vacuum can reclaim it. All iterators are invalidated.
+            ///
+            /// \tparam OtherKeyType  A type whose serialized representation is compatible with
+            /// KeyType.
+            /// \param transaction  The transaction to which the modified index will be written.
+            /// \param key  The key of the element to be removed.
+            /// \result The number of elements removed (0 or 1).
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<OtherKeyType, KeyType>::value>::type>
+            std::size_t erase (transaction_base & transaction, OtherKeyType const & key);
             ///@}
 
             /// \name Lookup
@@ -361,6 +413,35 @@ namespace pstore {
             bool contains (database const & db, OtherKeyType const & key) const {
                 return this->find (db, key) != this->end (db);
             }
+
+            /// Finds the elements with keys equivalent to each of the keys in the range [\p first,
+            /// \p last). The result is the same as calling find() for each key in turn, but the
+            /// lookups proceed through the trie together, one level at a time. Every node at the
+            /// next level is prefetched before any of them is read so that the cost of cache and
+            /// page misses is shared between the members of the batch.
+            ///
+            /// \tparam RandomAccessIterator  A random-access iterator whose value type is
+            /// compatible with KeyType.
+            /// \tparam OutputIterator  An output iterator to which const_iterator instances may be
+            /// written.
+            /// \param db  The database to which the index belongs.
+            /// \param first  The start of the range of keys to be found.
+            /// \param last  The end of the range of keys to be found.
+            /// \param out  An output iterator to which an iterator is written for each key, in the
+            ///   order of the input range. A past-the-end iterator is written for a key that is
+            ///   not found.
+            /// \return The output iterator.
+            template <typename RandomAccessIterator, typename OutputIterator>
+            OutputIterator find_many (database const & db, RandomAccessIterator first,
+                                      RandomAccessIterator last, OutputIterator out) const;
+
+            /// Finds the elements with keys equivalent to each of the members of \p keys.
+            /// Equivalent to find_many (db, std::begin (keys), std::end (keys), out).
+            template <typename KeyRange, typename OutputIterator>
+            OutputIterator find_many (database const & db, KeyRange const & keys,
+                                      OutputIterator out) const {
+                return this->find_many (db, std::begin (keys), std::end (keys), out);
+            }
             ///@}
 
             /// Flush any modified index nodes to the store.
@@ -390,20 +471,21 @@ namespace pstore {
             address store_leaf_node (transaction_base & transaction, OtherValueType const & v,
                                      gsl::not_null<parent_stack *> parents);
 
-            /// If the \p node is a heap internal node, clear its children and itself.
-            void clear (index_pointer node, unsigned shifts);
-
-            /// Clear the hamt_map when transaction::rollback() function is called.
-            void clear () {
-                if (root_.is_heap ()) {
-                    this->clear (root_, 0 /*shifts*/);
-                    root_.clear ();
-                }
-            }
+            /// Records the leaf node at \p addr, together with any data to which its value
+            /// refers, as garbage in \p transaction. Called when the leaf is replaced.
+            void supersede_leaf (transaction_base & transaction, address addr) const;
 
             /// Read a key from a store.
             key_type get_key (database const & db, address addr) const;
 
+            /// The maximum number of lookups that find_many() advances together. Larger groups
+            /// give more time for each prefetch to complete but, once the nodes of a group no
+            /// longer fit in the data cache, prefetched lines are evicted before they are used.
+            static constexpr std::size_t find_many_group_size = 64;
+
+            /// Issues a prefetch for the tree node referenced by \p node.
+            static void prefetch_node (database const & db, index_pointer node) noexcept;
+
             /// Called when the trie's top-level loop has descended as far as a leaf node. We need
             /// to convert that to an internal node.
             template <typename OtherValueType>
@@ -450,6 +532,32 @@ namespace pstore {
                               gsl::not_null<parent_stack *> parents, bool is_upsert)
                 -> std::pair<index_pointer, bool>;
 
+            /// Removes the element with a key equivalent to \p key from the subtree rooted at
+            /// \p node, which could be a leaf node, an internal node, or a linear node.
+            ///
+            /// \param transaction  The transaction to which the modified index will be written.
+            /// \param node  A heap or in-store reference to the root of the subtree.
+            /// \param key  The key of the element to be removed.
+            /// \param hash  The key hash.
+            /// \param shifts  The number of bits by which the hash value is shifted to reach the
+            /// current tree level.
+            /// \result  A pair consisting of the node which replaces \p node and a bool denoting
+            /// whether the key was found. The first member is equal to \p node if nothing was
+            /// modified and is empty if the subtree no longer contains any elements.
+            template <typename OtherKeyType>
+            auto erase_node (transaction_base & transaction, index_pointer node,
+                             OtherKeyType const & key, hash_type hash, unsigned shifts)
+                -> std::pair<index_pointer, bool>;
+
+            template <typename OtherKeyType>
+            auto erase_from_internal (transaction_base & transaction, index_pointer node,
+                                      OtherKeyType const & key, hash_type hash, unsigned shifts)
+                -> std::pair<index_pointer, bool>;
+
+            template <typename OtherKeyType>
+            auto erase_from_linear (transaction_base & transaction, index_pointer node,
+                                    OtherKeyType const & key) -> std::pair<index_pointer, bool>;
+
             template <typename Database, typename HamtMap,
                       typename Iterator =
                           typename inherit_const<Database, iterator, const_iterator>::type>
@@ -466,14 +574,6 @@ namespace pstore {
                                                         OtherValueType const & value,
                                                         bool is_upsert);
 
-            /// Frees memory consumed by a heap-allocated tree node.
-            ///
-            /// \param node  The tree node to be deleted.
-            /// \param shifts  The number of bits by which the hash value is shifted to reach the
-            /// current tree level. This is used to determine whether the reference is to an
-            /// internal or linear node.
-            void delete_node (index_pointer node, unsigned shifts);
-
             /// \brief Write the index header.
             /// The index header simply holds a check signature, the tree root, and remembers the
             /// tree size for us on restore.
@@ -502,6 +602,23 @@ namespace pstore {
                                  internal_node::size_bytes (details::hash_size)>;
             std::unique_ptr<internal_nodes_container> internals_container_;
 
+            /// In-heap linear nodes vary in size so are allocated from a bump arena rather than a
+            /// chunked-sequence. Like the internal nodes, they are never freed individually: the
+            /// arena is released in one go once the index has been flushed.
+            details::node_arena linear_arena_;
+
+            /// An index must hold at least this many keys before find() builds a top_levels
+            /// cache. Below this size, the root and second-level nodes are likely to be sparse.
+            static constexpr std::size_t top_levels_min_size = details::top_levels::num_entries;
+            /// Returns the top-levels cache for the current root, building it if necessary. Returns
+            /// null if the root is not an in-store internal node or the index is too small to
+            /// benefit.
+            std::shared_ptr<details::top_levels const> get_top_levels (database const & db) const;
+            /// A cache of the top levels of the trie. It is built lazily by find() and is replaced
+            /// when the root changes. Accessed atomically because find() may be called from
+            /// several threads at once.
+            mutable std::shared_ptr<details::top_levels const> top_levels_;
+
             unsigned revision_;
             index_pointer root_;
             std::size_t size_ = 0;
@@ -629,6 +746,10 @@ namespace pstore {
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
         constexpr std::array<std::uint8_t, 8>
             hamt_map<KeyType, ValueType, Hash, KeyEqual>::index_signature;
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        constexpr std::size_t hamt_map<KeyType, ValueType, Hash, KeyEqual>::find_many_group_size;
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        constexpr std::size_t hamt_map<KeyType, ValueType, Hash, KeyEqual>::top_levels_min_size;
 
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
         hamt_map<KeyType, ValueType, Hash, KeyEqual>::hamt_map (
@@ -664,25 +785,6 @@ namespace pstore {
             }
         }
 
-        // clear
-        // ~~~~~
-        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
-        void hamt_map<KeyType, ValueType, Hash, KeyEqual>::clear (index_pointer node,
-                                                                  unsigned shifts) {
-            PSTORE_ASSERT (node.is_heap () && !node.is_leaf ());
-            if (details::depth_is_internal_node (shifts)) {
-                auto * const internal = node.untag<internal_node *> ();
-                // Recursively release the children of this internal node.
-                for (auto p : *internal) {
-                    if (p.is_heap ()) {
-                        this->clear (p, shifts + details::hash_index_bits);
-                    }
-                }
-            }
-
-            this->delete_node (node, shifts);
-        }
-
         // load leaf node
         // ~~~~~~~~~~~~~~
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
@@ -694,6 +796,17 @@ namespace pstore {
                 serialize::archive::database_reader{db, addr});
         }
 
+        // supersede leaf
+        // ~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        void hamt_map<KeyType, ValueType, Hash, KeyEqual>::supersede_leaf (
+            transaction_base & transaction, address const addr) const {
+            serialize::archive::database_reader reader{transaction.db (), addr};
+            auto const leaf = serialize::read<std::pair<KeyType, ValueType>> (reader);
+            transaction.supersede ((reader.get_address ().absolute () - addr.absolute ()) +
+                                   details::referenced_bytes (leaf.second));
+        }
+
         // get key
         // ~~~~~~~
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
@@ -773,30 +886,12 @@ namespace pstore {
 
             // We ran out of hash bits: create a new linear node.
             auto const linear_ptr = index_pointer{
-                linear_node::allocate (existing_leaf.to_address (),
-                                       this->store_leaf_node (transaction, new_leaf, parents))
-                    .release ()};
+                linear_node::allocate (&linear_arena_, existing_leaf.to_address (),
+                                       this->store_leaf_node (transaction, new_leaf, parents))};
             parents->push (details::parent_type{linear_ptr, 1U});
             return linear_ptr;
         }
 
-        // delete node
-        // ~~~~~~~~~~~
-        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
-        void hamt_map<KeyType, ValueType, Hash, KeyEqual>::delete_node (index_pointer const node,
-                                                                        unsigned const shifts) {
-            if (node.is_heap ()) {
-                PSTORE_ASSERT (!node.is_leaf ());
-                if (details::depth_is_internal_node (shifts)) {
-                    // Internal nodes are owned by internals_container_. Don't delete them here. If
-                    // this ever changes, then add something like: delete
-                    // node.untag<internal_node *> ();
-                } else {
-                    delete node.untag<linear_node *> ();
-                }
-            }
-        }
-
         // insert into internal
         // ~~~~~~~~~~~~~~~~~~~~
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
@@ -819,6 +914,9 @@ namespace pstore {
             // If this slot isn't used, then ensure the node is on the heap, write the new leaf node
             // and point to it.
             if (index == details::not_found) {
+                if (!node.is_heap ()) {
+                    transaction.supersede (internal_node::size_bytes (internal->size ()));
+                }
                 internal_node * const inode =
                     internal_node::make_writable (internals_container_.get (), node, *internal);
                 inode->insert_child (
@@ -837,16 +935,15 @@ namespace pstore {
                                                                   hash, shifts, parents, is_upsert);
 
             // If the insertion resulted in our child node being reallocated, then this node needs
-            // to be heap-allocated and the child reference updated. The original child pointer may
-            // also need to be freed.
+            // to be heap-allocated and the child reference updated.
             if (new_child != child_slot) {
+                if (!node.is_heap ()) {
+                    transaction.supersede (internal_node::size_bytes (internal->size ()));
+                }
                 internal_node * const inode =
                     internal_node::make_writable (internals_container_.get (), node, *internal);
 
-                // Release a previous heap-allocated instance.
-                index_pointer & child = (*inode)[index];
-                this->delete_node (child, shifts);
-                child = new_child;
+                (*inode)[index] = new_child;
                 node = inode;
             }
 
@@ -880,15 +977,18 @@ namespace pstore {
                 // The key wasn't present in the node so we simply append it.
                 // TODO: keep these entries sorted?
 
+                if (!node.is_heap ()) {
+                    transaction.supersede (orig_node->size_bytes ());
+                }
                 // Load into memory with space for 1 new child node.
-                std::unique_ptr<linear_node> new_node = linear_node::allocate_from (*orig_node, 1U);
+                linear_node * const new_node =
+                    linear_node::allocate_from (&linear_arena_, *orig_node, 1U);
                 index = orig_node->size ();
                 (*new_node)[index] = this->store_leaf_node (transaction, value, parents);
-                result = new_node.release ();
+                result = new_node;
             } else {
                 key_exists = true;
                 if (is_upsert) {
-                    std::unique_ptr<linear_node> new_node;
                     linear_node * lnode = nullptr;
 
                     if (node.is_heap ()) {
@@ -896,13 +996,13 @@ namespace pstore {
                         lnode = node.untag<linear_node *> ();
                         result = node;
                     } else {
+                        transaction.supersede (orig_node->size_bytes ());
                         // Load into memory but no extra space.
-                        new_node = linear_node::allocate_from (*orig_node, 0U);
-                        lnode = new_node.get ();
+                        lnode = linear_node::allocate_from (&linear_arena_, *orig_node, 0U);
                         result = lnode;
                     }
+                    this->supersede_leaf (transaction, (*lnode)[index]);
                     (*lnode)[index] = this->store_leaf_node (transaction, value, parents);
-                    new_node.release ();
                 } else {
                     parents->push (details::parent_type{index_pointer{(*orig_node)[index]}});
 
@@ -932,6 +1032,7 @@ namespace pstore {
                     get_key (transaction.db (), node.to_address ()); // Read key.
                 if (equal_ (value.first, existing_key)) {
                     if (is_upsert) {
+                        this->supersede_leaf (transaction, node.to_address ());
                         result = this->store_leaf_node (transaction, value, parents);
                     } else {
                         parents->push (details::parent_type{node});
@@ -1026,6 +1127,165 @@ namespace pstore {
             return this->insert_or_assign (transaction, std::make_pair (key, value));
         }
 
+        // erase from internal
+        // ~~~~~~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        template <typename OtherKeyType>
+        auto hamt_map<KeyType, ValueType, Hash, KeyEqual>::erase_from_internal (
+            transaction_base & transaction, index_pointer const node, OtherKeyType const & key,
+            hash_type const hash, unsigned const shifts) -> std::pair<index_pointer, bool> {
+
+            std::shared_ptr<internal_node const> iptr;
+            internal_node const * internal = nullptr;
+            std::tie (iptr, internal) = internal_node::get_node (transaction.db (), node);
+            PSTORE_ASSERT (internal != nullptr);
+
+            auto const hash_index = hash & details::hash_index_mask;
+            index_pointer child_slot;
+            auto index = std::size_t{0};
+            std::tie (child_slot, index) = internal->lookup (hash_index);
+            if (index == details::not_found) {
+                return {node, false};
+            }
+
+            auto const child_shifts = shifts + details::hash_index_bits;
+            bool found;
+            index_pointer new_child;
+            std::tie (new_child, found) = this->erase_node (
+                transaction, child_slot, key, hash >> details::hash_index_bits, child_shifts);
+            if (!found || new_child == child_slot) {
+                // Either the key wasn't present or the child (and therefore this node) was
+                // modified in place on the heap.
+                return {node, found};
+            }
+
+            if (!node.is_heap ()) {
+                transaction.supersede (internal_node::size_bytes (internal->size ()));
+            }
+            // If this node is about to be left without children or with a lone leaf, then it is
+            // no longer needed: the leaf can be moved up a level (its position is still consistent
+            // with its hash) or the node removed altogether.
+            auto const size = internal->size ();
+            if (new_child.is_empty ()) {
+                if (size == 1U) {
+                    return {index_pointer{}, true};
+                }
+                if (size == 2U) {
+                    index_pointer const & other = (*internal)[index == 0U ? 1U : 0U];
+                    if (other.is_leaf ()) {
+                        return {other, true};
+                    }
+                }
+            } else if (size == 1U && new_child.is_leaf ()) {
+                return {new_child, true};
+            }
+
+            internal_node * const inode =
+                internal_node::make_writable (internals_container_.get (), node, *internal);
+            if (new_child.is_empty ()) {
+                inode->remove_child (hash_index);
+            } else {
+                (*inode)[index] = new_child;
+            }
+            return {index_pointer{inode}, true};
+        }
+
+        // erase from linear
+        // ~~~~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        template <typename OtherKeyType>
+        auto hamt_map<KeyType, ValueType, Hash, KeyEqual>::erase_from_linear (
+            transaction_base & transaction, index_pointer const node, OtherKeyType const & key)
+            -> std::pair<index_pointer, bool> {
+
+            std::shared_ptr<linear_node const> lptr;
+            linear_node const * orig_node = nullptr;
+            std::tie (lptr, orig_node) = linear_node::get_node (transaction.db (), node);
+            PSTORE_ASSERT (orig_node != nullptr);
+
+            index_pointer child_slot;
+            auto index = std::size_t{0};
+            std::tie (child_slot, index) =
+                orig_node->lookup<KeyType> (transaction.db (), key, equal_);
+            if (index == details::not_found) {
+                return {node, false};
+            }
+            this->supersede_leaf (transaction, (*orig_node)[index]);
+
+            auto const size = orig_node->size ();
+            if (size <= 2U) {
+                // A linear node is replaced by its last remaining member.
+                if (!node.is_heap ()) {
+                    transaction.supersede (orig_node->size_bytes ());
+                }
+                return {size == 2U ? index_pointer{(*orig_node)[index == 0U ? 1U : 0U]}
+                                   : index_pointer{},
+                        true};
+            }
+            if (node.is_heap ()) {
+                node.untag<linear_node *> ()->remove (index);
+                return {node, true};
+            }
+            transaction.supersede (orig_node->size_bytes ());
+            linear_node * const new_node =
+                linear_node::allocate_from (&linear_arena_, *orig_node, 0U);
+            new_node->remove (index);
+            return {index_pointer{new_node}, true};
+        }
+
+        // erase node
+        // ~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        template <typename OtherKeyType>
+        auto hamt_map<KeyType, ValueType, Hash, KeyEqual>::erase_node (
+            transaction_base & transaction, index_pointer const node, OtherKeyType const & key,
+            hash_type const hash, unsigned const shifts) -> std::pair<index_pointer, bool> {
+
+            if (node.is_leaf ()) {
+                key_type const existing_key = get_key (transaction.db (), node.to_address ());
+                if (!equal_ (existing_key, key)) {
+                    return {node, false};
+                }
+                this->supersede_leaf (transaction, node.to_address ());
+                return {index_pointer{}, true};
+            }
+            if (details::depth_is_internal_node (shifts)) {
+                return this->erase_from_internal (transaction, node, key, hash, shifts);
+            }
+            return this->erase_from_linear (transaction, node, key);
+        }
+
+        // erase
+        // ~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        template <typename OtherKeyType, typename>
+        std::size_t
+        hamt_map<KeyType, ValueType, Hash, KeyEqual>::erase (transaction_base & transaction,
+                                                             OtherKeyType const & key) {
+            if (revision_ != transaction.db ().get_current_revision ()) {
+                raise (error_code::index_not_latest_revision);
+            }
+            if (this->empty ()) {
+                return 0U;
+            }
+
+            bool found;
+            index_pointer new_root;
+            std::tie (new_root, found) =
+                this->erase_node (transaction, root_, key, static_cast<hash_type> (hash_ (key)),
+                                  0 /* shifts */);
+            if (!found) {
+                return 0U;
+            }
+            root_ = new_root;
+            PSTORE_ASSERT (size_ > 0U);
+            --size_;
+            // Ensure that the transaction will be committed (and the index flushed) even if this
+            // is its only modification.
+            transaction.open ();
+            return 1U;
+        }
+
         // flush
         // ~~~~~
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
@@ -1049,8 +1309,9 @@ namespace pstore {
             auto const header_addr = this->size () > 0U ? this->write_header_block (transaction)
                                                         : typed_address<header_block>::null ();
 
-            // Release all of the in-heap internal nodes that we have now flushed.
+            // Release all of the in-heap internal and linear nodes that we have now flushed.
             internals_container_->clear ();
+            linear_arena_.clear ();
 
             // Update the revision number into which the index will be flushed.
             revision_ = generation;
@@ -1082,11 +1343,19 @@ namespace pstore {
             if (empty ()) {
                 return this->cend (db);
             }
+            PSTORE_COUNT (hamt_find);
 
             auto hash = static_cast<hash_type> (hash_ (key));
             unsigned bit_shifts = 0;
             index_pointer node = root_;
             parent_stack parents;
+            if (std::shared_ptr<details::top_levels const> const top = this->get_top_levels (db)) {
+                std::tie (node, bit_shifts) = top->descend (hash, &parents);
+                if (node.is_empty ()) {
+                    return this->cend (db);
+                }
+                hash >>= bit_shifts;
+            }
 
             std::shared_ptr<void const> store_node;
             while (!node.is_leaf ()) {
@@ -1101,6 +1370,7 @@ namespace pstore {
                         internal->lookup (hash & details::hash_index_mask);
                 } else {
                     // It's a linear node.
+                    PSTORE_COUNT (hamt_find_linear);
                     linear_node const * linear = nullptr;
                     std::tie (store_node, linear) = linear_node::get_node (db, node);
                     std::tie (child_node, index) = linear->lookup<KeyType> (db, key, equal_);
@@ -1126,6 +1396,251 @@ namespace pstore {
             return this->cend (db);
         }
 
+        // find many
+        // ~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        template <typename RandomAccessIterator, typename OutputIterator>
+        OutputIterator hamt_map<KeyType, ValueType, Hash, KeyEqual>::find_many (
+            database const & db, RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator out) const {
+
+            using key_reference = typename std::iterator_traits<RandomAccessIterator>::reference;
+            static_assert (
+                serialize::is_compatible<typename std::decay<key_reference>::type, KeyType>::value,
+                "find_many() key type is not compatible with the map's KeyType");
+
+            // The state of an individual lookup as it descends the tree.
+            struct lookup {
+                hash_type hash = 0;
+                index_pointer node;
+                parent_stack parents;
+                bool found = false;
+            };
+            std::array<lookup, find_many_group_size> group;
+            // The indices (within 'group') of the lookups which have yet to reach a leaf.
+            std::array<std::size_t, find_many_group_size> active;
+
+            while (first != last) {
+                auto const group_size = std::min (static_cast<std::size_t> (last - first),
+                                                  find_many_group_size);
+                auto num_active = std::size_t{0};
+                for (auto ctr = std::size_t{0}; ctr < group_size; ++ctr) {
+                    lookup & l = group[ctr];
+                    l.hash = static_cast<hash_type> (hash_ (first[ctr]));
+                    l.node = root_;
+                    l.parents = parent_stack{};
+                    l.found = false;
+                    if (!root_.is_empty ()) {
+                        active[num_active++] = ctr;
+                    }
+                }
+
+                unsigned bit_shifts = 0;
+                if (num_active > 0U) {
+                    if (std::shared_ptr<details::top_levels const> const top =
+                            this->get_top_levels (db)) {
+                        // Every lookup starts at the same depth: those which end within the
+                        // cached levels are advanced to a leaf (or dropped if the key is absent)
+                        // so that the loop below need only consider the deeper levels.
+                        bit_shifts = details::top_levels::levels * details::hash_index_bits;
+                        auto num_remaining = std::size_t{0};
+                        for (auto ctr = std::size_t{0}; ctr < num_active; ++ctr) {
+                            lookup & l = group[active[ctr]];
+                            unsigned shifts = 0;
+                            std::tie (l.node, shifts) = top->descend (l.hash, &l.parents);
+                            if (l.node.is_empty ()) {
+                                continue;
+                            }
+                            if (shifts < bit_shifts) {
+                                PSTORE_ASSERT (l.node.is_leaf ());
+                                l.found = equal_ (get_key (db, l.node.to_address ()),
+                                                  first[active[ctr]]);
+                                if (l.found) {
+                                    l.parents.push (details::parent_type{l.node});
+                                }
+                                continue;
+                            }
+                            l.hash >>= shifts;
+                            active[num_remaining++] = active[ctr];
+                        }
+                        num_active = num_remaining;
+                    }
+                }
+                while (num_active > 0U) {
+                    // Issue a prefetch for every node at this level before reading any of them.
+                    for (auto ctr = std::size_t{0}; ctr < num_active; ++ctr) {
+                        prefetch_node (db, group[active[ctr]].node);
+                    }
+
+                    // Advance each of the active lookups by one level, removing those that are
+                    // complete.
+                    auto num_remaining = std::size_t{0};
+                    for (auto ctr = std::size_t{0}; ctr < num_active; ++ctr) {
+                        std::size_t const member = active[ctr];
+                        lookup & l = group[member];
+                        key_reference key = first[member];
+                        if (l.node.is_leaf ()) {
+                            l.found = equal_ (get_key (db, l.node.to_address ()), key);
+                            if (l.found) {
+                                l.parents.push (details::parent_type{l.node});
+                            }
+                            continue;
+                        }
+
+                        index_pointer child_node;
+                        auto index = std::size_t{0};
+                        std::shared_ptr<void const> store_node;
+                        if (details::depth_is_internal_node (bit_shifts)) {
+                            internal_node const * internal = nullptr;
+                            std::tie (store_node, internal) = internal_node::get_node (db, l.node);
+                            std::tie (child_node, index) =
+                                internal->lookup (l.hash & details::hash_index_mask);
+                        } else {
+                            PSTORE_COUNT (hamt_find_linear);
+                            linear_node const * linear = nullptr;
+                            std::tie (store_node, linear) = linear_node::get_node (db, l.node);
+                            std::tie (child_node, index) =
+                                linear->lookup<KeyType> (db, key, equal_);
+                        }
+                        if (index == details::not_found) {
+                            continue;
+                        }
+                        l.parents.push (details::parent_type{l.node, index});
+                        l.node = child_node;
+                        l.hash >>= details::hash_index_bits;
+                        active[num_remaining++] = member;
+                    }
+                    num_active = num_remaining;
+                    bit_shifts += details::hash_index_bits;
+                }
+
+                for (auto ctr = std::size_t{0}; ctr < group_size; ++ctr) {
+                    lookup & l = group[ctr];
+                    *out = l.found ? const_iterator (db, std::move (l.parents), this)
+                                   : this->cend (db);
+                    ++out;
+                }
+                first += static_cast<
+                    typename std::iterator_traits<RandomAccessIterator>::difference_type> (
+                    group_size);
+            }
+            return out;
+        }
+
+        // get top levels
+        // ~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        auto hamt_map<KeyType, ValueType, Hash, KeyEqual>::get_top_levels (
+            database const & db) const -> std::shared_ptr<details::top_levels const> {
+            if (size_ < top_levels_min_size || root_.is_heap () || !root_.is_internal ()) {
+                return nullptr;
+            }
+            std::shared_ptr<details::top_levels const> top = std::atomic_load (&top_levels_);
+            if (top == nullptr || top->root () != root_) {
+                // Two threads may race to build the cache: both results are equivalent.
+                top = std::make_shared<details::top_levels const> (db, root_);
+                std::atomic_store (&top_levels_, top);
+            }
+            return top;
+        }
+
+        // prefetch node [static]
+        // ~~~~~~~~~~~~~~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        void hamt_map<KeyType, ValueType, Hash, KeyEqual>::prefetch_node (
+            database const & db, index_pointer const node) noexcept {
+            if (node.is_heap ()) {
+                PSTORE_PREFETCH (node.untag<internal_node const *> ());
+            } else if (node.is_internal ()) {
+                // Internal and linear nodes in the store have the same tag.
+                db.prefetch (node.untag_address<internal_node> ().to_address ());
+            } else {
+                db.prefetch (node.to_address ());
+            }
+        }
+
+        // partition
+        // ~~~~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+        auto hamt_map<KeyType, ValueType, Hash, KeyEqual>::partition (
+            database const & db, std::size_t const max_parts) const
+            -> std::vector<subrange<const_iterator>> {
+
+            std::vector<subrange<const_iterator>> result;
+            if (this->empty () || max_parts == 0U) {
+                return result;
+            }
+
+            // A subtree together with the path by which it is reached from the root.
+            struct subtree {
+                parent_stack parents;
+                index_pointer node;
+            };
+
+            // Replace each of the subtrees with its children until there are enough of them to
+            // fill the requested number of partitions or there are no more nodes to split.
+            std::vector<subtree> frontier{subtree{parent_stack{}, root_}};
+            for (bool split = true; split && frontier.size () < max_parts;) {
+                split = false;
+                std::vector<subtree> next;
+                for (subtree const & s : frontier) {
+                    if (s.node.is_leaf ()) {
+                        next.push_back (s);
+                        continue;
+                    }
+                    split = true;
+                    std::shared_ptr<void const> store_node;
+                    auto const shifts =
+                        static_cast<unsigned> (s.parents.size () * details::hash_index_bits);
+                    auto const visit = [&s, &next] (std::size_t const position,
+                                                    index_pointer const child) {
+                        next.push_back (subtree{s.parents, child});
+                        next.back ().parents.push (details::parent_type{s.node, position});
+                    };
+                    if (details::depth_is_internal_node (shifts)) {
+                        internal_node const * internal = nullptr;
+                        std::tie (store_node, internal) = internal_node::get_node (db, s.node);
+                        for (auto position = std::size_t{0}; position < internal->size ();
+                             ++position) {
+                            visit (position, (*internal)[position]);
+                        }
+                    } else {
+                        linear_node const * linear = nullptr;
+                        std::tie (store_node, linear) = linear_node::get_node (db, s.node);
+                        for (auto position = std::size_t{0}; position < linear->size ();
+                             ++position) {
+                            visit (position, index_pointer{(*linear)[position]});
+                        }
+                    }
+                }
+                frontier = std::move (next);
+            }
+
+            // Share the subtrees as evenly as possible between the partitions. Each range begins
+            // at the left-most leaf of its first subtree and ends where the next range begins.
+            auto const num_subtrees = frontier.size ();
+            auto const num_parts = std::min (max_parts, num_subtrees);
+            auto const range_begin = [&] (std::size_t const part) {
+                subtree & s = frontier[part * num_subtrees / num_parts];
+                const_iterator it{db, std::move (s.parents), this};
+                if (s.node.is_leaf ()) {
+                    it.visited_parents_.push (details::parent_type{s.node});
+                } else {
+                    it.move_to_left_most_child (s.node);
+                }
+                return it;
+            };
+
+            result.reserve (num_parts);
+            const_iterator first = range_begin (0U);
+            for (auto part = std::size_t{1}; part <= num_parts; ++part) {
+                const_iterator last = part < num_parts ? range_begin (part) : this->cend (db);
+                result.emplace_back (first, last);
+                first = std::move (last);
+            }
+            return result;
+        }
+
         // make begin iterator
         // ~~~~~~~~~~~~~~~~~~~
         template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
@@ -1148,6 +1663,31 @@ namespace pstore {
             return {db, parent_stack (), &m};
         }
 
+        /// Calls \p fn for each of the elements of \p index using all of the available cores. The
+        /// index is divided using its partition() method and the resulting ranges are processed
+        /// concurrently. The order in which elements are visited is unspecified.
+        ///
+        /// \tparam Index  A hamt_map or hamt_set.
+        /// \tparam UnaryFunction  A function compatible with void(Index::value_type const &). It
+        ///   may be called concurrently from multiple threads.
+        /// \param db  The database to which the index belongs.
+        /// \param index  The index whose elements are to be visited.
+        /// \param fn  The function to be called for each element.
+        template <typename Index, typename UnaryFunction>
+        void parallel_for_each (database const & db, Index const & index, UnaryFunction fn) {
+            // Produce several ranges per thread so that a thread which finishes early has
+            // something else to do.
+            auto const parts = index.partition (
+                db, std::size_t{4} * std::max (std::thread::hardware_concurrency (), 1U));
+            using range_type = typename decltype (parts)::value_type;
+            pstore::parallel_for_each (std::begin (parts), std::end (parts),
+                                       [&fn] (range_type const & r) {
+                                           for (auto const & v : r) {
+                                               fn (v);
+                                           }
+                                       });
+        }
+
     } // namespace index
 } // namespace pstore
 #endif // PSTORE_CORE_HAMT_MAP_HPP
@@ -19,6 +19,7 @@
 #define PSTORE_CORE_HAMT_MAP_FWD_HPP
 
 #include <functional>
+#include <utility>
 
 namespace pstore {
     namespace index {
@@ -52,6 +53,24 @@ namespace pstore {
             Container & c_;
         };
 
+        /// A pair of iterators which delimit a contiguous sub-range of the elements of a hamt_map
+        /// or hamt_set. Instances are produced by the partition() method of those containers.
+        template <typename Iterator>
+        class subrange {
+        public:
+            subrange (Iterator first, Iterator last)
+                    : first_{std::move (first)}
+                    , last_{std::move (last)} {}
+            /// Returns an iterator to the first element of the range.
+            Iterator begin () const { return first_; }
+            /// Returns an iterator to the element following the last element of the range.
+            Iterator end () const { return last_; }
+
+        private:
+            Iterator first_;
+            Iterator last_;
+        };
+
         template <typename KeyType, typename ValueType, typename Hash = std::hash<KeyType>,
                   typename KeyEqual = std::equal_to<KeyType>>
         class hamt_map;
@@ -62,6 +62,10 @@ namespace pstore {
             constexpr unsigned hash_index_mask = (1U << hash_index_bits) - 1U;
             constexpr unsigned max_internal_depth = max_hash_bits / hash_index_bits;
 
+            /// The size of a processor cache line. Internal nodes are placed in the store so that
+            /// they span as few lines as possible.
+            constexpr std::size_t cache_line_size = 64;
+
             /// The max depth of the hash trees include several levels internal nodes
             /// (max_internal_depth), one linear node and one leaf node.
             constexpr unsigned max_tree_depth = max_internal_depth + 2U;
@@ -117,10 +121,6 @@ namespace pstore {
                 return shift < details::max_hash_bits;
             }
 
-            struct nchildren {
-                std::size_t n;
-            };
-
             //*  _         _                     _     _            *
             //* (_)_ _  __| |_____ __  _ __  ___(_)_ _| |_ ___ _ _  *
             //* | | ' \/ _` / -_) \ / | '_ \/ _ \ | ' \  _/ -_) '_| *
@@ -286,6 +286,49 @@ namespace pstore {
 
             using parent_stack = array_stack<parent_type, max_tree_depth>;
 
+            //*               _                               *
+            //*  _ _  ___  __| |___   __ _ _ _ ___ _ _  __ _  *
+            //* | ' \/ _ \/ _` / -_) / _` | '_/ -_) ' \/ _` | *
+            //* |_||_\___/\__,_\___| \__,_|_| \___|_||_\__,_| *
+            //*                                               *
+            /// \brief A bump allocator for the in-heap linear nodes of an index.
+            ///
+            /// Memory is carved from large chunks and is never freed piecemeal: the whole arena is
+            /// released at once when the index is flushed or cleared. Objects placed in the arena
+            /// must therefore be trivially destructible.
+            class node_arena {
+            public:
+                /// The number of bytes obtained from the system allocator for each chunk. A
+                /// request for more than a quarter of this is given a chunk of its own.
+                static constexpr std::size_t chunk_size = std::size_t{64} * 1024;
+
+                node_arena () = default;
+                node_arena (node_arena const &) = delete;
+                node_arena (node_arena &&) noexcept = default;
+                ~node_arena () noexcept = default;
+
+                node_arena & operator= (node_arena const &) = delete;
+                node_arena & operator= (node_arena &&) noexcept = default;
+
+                /// Allocates \p size bytes aligned to \p align, which must be a power of two no
+                /// greater than alignof (std::max_align_t).
+                void * allocate (std::size_t size, std::size_t align);
+
+                /// Releases all of the memory owned by the arena.
+                void clear () noexcept;
+
+                /// Returns the number of chunks obtained from the system allocator since the arena
+                /// was last cleared.
+                std::size_t chunks () const noexcept { return chunks_.size (); }
+
+            private:
+                std::vector<std::unique_ptr<std::uint8_t[]>> chunks_;
+                /// The next free byte in the chunk from which allocations are currently made.
+                std::uint8_t * ptr_ = nullptr;
+                /// The number of bytes remaining in the current chunk.
+                std::size_t remaining_ = 0U;
+            };
+
 
             //*  _ _                                  _      *
             //* | (_)_ _  ___ __ _ _ _   _ _  ___  __| |___  *
@@ -301,7 +344,6 @@ namespace pstore {
                 using const_iterator = address const *;
 
                 void * operator new (std::size_t) = delete;
-                void operator delete (void * p);
 
                 linear_node (linear_node && rhs) noexcept = delete;
 
@@ -317,35 +359,39 @@ namespace pstore {
                 /// child of the supplied node plus the number passed in the 'extra_children'
                 /// parameter.
                 ///
+                /// \param arena  The arena from which the new node's storage is allocated.
                 /// \param orig_node  A node whose contents will be copied into the newly allocated
                 /// linear node.
                 /// \param extra_children  The number of extra child for which space will be
                 /// allocated. This number is added to the number of children in 'orig_node' in
                 /// calculating the amount of storage to be allocated.
                 /// \result  A pointer to the newly allocated linear node.
-                static std::unique_ptr<linear_node> allocate_from (linear_node const & orig_node,
-                                                                   std::size_t extra_children);
+                static linear_node * allocate_from (node_arena * arena,
+                                                    linear_node const & orig_node,
+                                                    std::size_t extra_children);
 
                 /// \brief Allocates a new in-memory linear node based on the contents of an
                 /// existing store node.
                 ///
+                /// \param arena  The arena from which the new node's storage is allocated.
                 /// \param db The database from which the source node should be loaded.
                 /// \param node A reference to the source node which may be either in-heap or
                 /// in-store.
                 /// \param extra_children The number of additional child nodes for which storage
                 /// should be allocated.
                 /// \result  A pointer to the newly allocated linear node.
-                static std::unique_ptr<linear_node> allocate_from (database const & db,
-                                                                   index_pointer const node,
-                                                                   std::size_t extra_children);
+                static linear_node * allocate_from (node_arena * arena, database const & db,
+                                                    index_pointer const node,
+                                                    std::size_t extra_children);
 
                 /// \brief Allocates a new linear node in memory with sufficient space for two leaf
                 /// addresses.
                 ///
+                /// \param arena  The arena from which the new node's storage is allocated.
                 /// \param a  The first leaf address for the new linear node.
                 /// \param b  The second leaf address for the new linear node.
                 /// \result  A pointer to the newly allocated linear node.
-                static std::unique_ptr<linear_node> allocate (address a, address b);
+                static linear_node * allocate (node_arena * arena, address a, address b);
 
                 /// \brief Returns a pointer to a linear node which may be in-heap or in-store.
                 ///
@@ -399,6 +445,10 @@ namespace pstore {
                 std::size_t size () const { return size_; }
                 ///@}
 
+                /// Removes the child at position \p index. The following children are moved down
+                /// to fill the gap. Must only be called on a heap-allocated node.
+                void remove (std::size_t index) noexcept;
+
                 /// \name Storage
                 ///@{
 
@@ -443,15 +493,11 @@ namespace pstore {
                 using signature_type = std::array<std::uint8_t, 8>;
                 static signature_type const node_signature_;
 
-                /// A placement-new implementation which allocates sufficient storage for a linear
-                /// node with the number of children given by the size parameter.
-                void * operator new (std::size_t s, nchildren size);
                 // Non-allocating placement allocation functions.
                 void * operator new (std::size_t const size, void * const ptr) noexcept {
                     return ::operator new (size, ptr);
                 }
 
-                void operator delete (void * p, nchildren size);
                 void operator delete (void * const p, void * const ptr) noexcept {
                     ::operator delete (p, ptr);
                 }
@@ -462,6 +508,7 @@ namespace pstore {
 
                 /// Allocates a new linear node in memory.
                 ///
+                /// \param arena  The arena from which the new node's storage is allocated.
                 /// \param num_children Sufficient space is allocated for the number of child nodes
                 /// specified in this parameter.
                 /// \param from_node A node whose contents will be copied into the new node. If the
@@ -469,8 +516,8 @@ namespace pstore {
                 /// from_node, the remaining entries are zeroed; if less then the child node
                 /// collection is truncated after the specified number of entries.
                 /// \result A pointer to the newly allocated linear node.
-                static std::unique_ptr<linear_node> allocate (std::size_t num_children,
-                                                              linear_node const & from_node);
+                static linear_node * allocate (node_arena * arena, std::size_t num_children,
+                                               linear_node const & from_node);
 
                 signature_type signature_ = node_signature_;
                 std::uint64_t size_;
@@ -622,9 +669,7 @@ namespace pstore {
                                                       index_pointer const node,
                                                       internal_node const & internal) {
                     if (node.is_heap ()) {
-                        auto * const inode = node.untag<internal_node *> ();
-                        PSTORE_ASSERT (inode->signature_ == node_signature_);
-                        return inode;
+                        return node.untag<internal_node *> ();
                     }
 
                     return allocate (container, internal);
@@ -662,6 +707,10 @@ namespace pstore {
                 void insert_child (hash_type const hash, index_pointer const leaf,
                                    gsl::not_null<parent_stack *> parents);
 
+                /// Removes the child associated with \p hash from the internal node (this). The
+                /// node must have at least two children.
+                void remove_child (hash_type const hash);
+
                 /// Write an internal node and its children into a store.
                 address flush (transaction_base & transaction, unsigned shifts);
 
@@ -701,12 +750,16 @@ namespace pstore {
                 /// store. Returns a new (in-store) internal store address.
                 address store_node (transaction_base & transaction) const;
 
-                using signature_type = std::array<std::uint8_t, 8>;
-                static signature_type const node_signature_;
+                /// Returns the alignment with which a node of \p num_bytes should be allocated if
+                /// the next free byte in the store is at \p pos. A node is moved to the start of
+                /// the next cache line only if doing so reduces the number of lines that it spans.
+                static unsigned store_alignment (address pos, std::size_t num_bytes) noexcept;
 
-                /// A magic number for internal nodes in the store. Acts as a quick integrity test
-                /// for the index structures.
-                signature_type signature_ = node_signature_;
+                // Unlike the other index nodes, an internal node carries no signature: it is
+                // visited by every lookup and dropping the signature allows a node with up to 7
+                // children to fit in a single cache line. validate_after_load() still checks its
+                // structure and "pstore-index-structure --verify" checks that the key of every
+                // leaf hashes to its position in the trie.
 
                 /// For each index in the children array, the corresponding bit is set in this field
                 /// if it is a reference to an internal node or an leaf node. In a linear node, the
@@ -731,6 +784,82 @@ namespace pstore {
                 return {index_pointer{}, not_found};
             }
 
+            //*  _              _             _     *
+            //* | |_ ___ _ __  | |_____ _____| |___ *
+            //* |  _/ _ \ '_ \ | / -_) V / -_) (_-< *
+            //*  \__\___/ .__/ |_\___|\_/\___|_/__/ *
+            //*         |_|                         *
+            /// A decoded copy of the top two levels of an in-store trie. For each of the 4096
+            /// values of the low 12 bits of a hash it records the node reached after descending
+            /// two levels together with the child positions that are needed to build an iterator.
+            /// A lookup may then start at the third level of the trie without loading the root or
+            /// the second-level internal nodes.
+            ///
+            /// Store nodes are immutable so an instance remains valid for as long as the trie's
+            /// root is the node from which it was built.
+            class top_levels {
+            public:
+                /// The number of trie levels which are cached.
+                static constexpr unsigned levels = 2U;
+                /// The number of distinct hash prefixes resolved by the cache.
+                static constexpr std::size_t num_entries = std::size_t{1}
+                                                           << (levels * hash_index_bits);
+
+                /// \param db  The database containing the trie.
+                /// \param root  The trie's root. Must be an in-store internal node.
+                top_levels (database const & db, index_pointer root);
+
+                /// Returns the root of the trie from which the cache was built.
+                index_pointer root () const noexcept { return root_; }
+
+                /// Descends the cached levels of the trie for a key with the given hash. The nodes
+                /// which are traversed are pushed onto \p parents.
+                ///
+                /// \param hash  The hash of the key being sought.
+                /// \param parents  The stack to which the visited nodes and child positions are
+                ///   pushed.
+                /// \returns A pair whose first member is the node from which the search should
+                ///   continue, or an empty pointer if the key is not present in the trie. The
+                ///   second member is the number of hash bits consumed.
+                std::pair<index_pointer, unsigned>
+                descend (hash_type hash, gsl::not_null<parent_stack *> parents) const;
+
+            private:
+                /// A child reference and its position within the parent node.
+                struct slot {
+                    index_pointer node;
+                    std::uint8_t position = 0;
+                };
+
+                index_pointer root_;
+                /// The children of the root indexed by the first-level hash index.
+                std::array<slot, hash_size> first_;
+                /// The children of the second-level internal nodes indexed by the low 12 bits
+                /// of the hash. Entries beneath a first-level child which is not an internal node
+                /// are unused.
+                std::vector<slot> second_;
+            };
+
+            // descend
+            // ~~~~~~~
+            inline std::pair<index_pointer, unsigned>
+            top_levels::descend (hash_type const hash,
+                                 gsl::not_null<parent_stack *> const parents) const {
+                slot const & first = first_[hash & hash_index_mask];
+                if (first.node.is_empty ()) {
+                    return {index_pointer{}, 0U};
+                }
+                parents->push (parent_type{root_, first.position});
+                if (!first.node.is_internal ()) {
+                    return {first.node, hash_index_bits};
+                }
+                slot const & second = second_[hash & (num_entries - 1U)];
+                if (second.node.is_empty ()) {
+                    return {index_pointer{}, 0U};
+                }
+                parents->push (parent_type{first.node, second.position});
+                return {second.node, levels * hash_index_bits};
+            }
 
         } // namespace details
     }     // namespace index
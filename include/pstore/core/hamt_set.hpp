@@ -121,6 +121,17 @@ namespace pstore {
             const_iterator cend (database const & db) const {
                 return const_iterator{map_.cend (db)};
             }
+
+            /// Divides the elements of the container into no more than \p max_parts disjoint
+            /// ranges. See hamt_map::partition().
+            std::vector<subrange<const_iterator>> partition (database const & db,
+                                                             std::size_t const max_parts) const {
+                std::vector<subrange<const_iterator>> result;
+                for (auto const & r : map_.partition (db, max_parts)) {
+                    result.emplace_back (const_iterator{r.begin ()}, const_iterator{r.end ()});
+                }
+                return result;
+            }
             ///@}
 
             /// \name Capacity
@@ -153,6 +164,21 @@ namespace pstore {
                 return {iterator{it.first}, it.second};
             }
 
+            /// \brief Removes the element (if one exists) with a key equivalent to \p key. See
+            /// hamt_map::erase().
+            ///
+            /// \tparam OtherKeyType  A type whose serialized representation is compatible with
+            /// KeyType.
+            /// \param transaction  The transaction to which the modified index will be written.
+            /// \param key  The key of the element to be removed.
+            /// \returns The number of elements removed (0 or 1).
+            template <typename OtherKeyType,
+                      typename = typename std::enable_if<
+                          serialize::is_compatible<KeyType, OtherKeyType>::value>::type>
+            std::size_t erase (transaction_base & transaction, OtherKeyType const & key) {
+                return map_.erase (transaction, key);
+            }
+
             /// \brief Find the element with a specific key.
             /// Finds an element with key equivalent to \p key.
             ///
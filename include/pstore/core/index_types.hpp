@@ -17,6 +17,7 @@
 #ifndef PSTORE_CORE_INDEX_TYPES_HPP
 #define PSTORE_CORE_INDEX_TYPES_HPP
 
+#include "pstore/core/btree_set.hpp"
 #include "pstore/core/indirect_string.hpp"
 
 namespace pstore {
@@ -93,6 +94,8 @@ namespace pstore {
         using compilation_index = hamt_map<digest, extent<repo::compilation>, u128_hash>;
         using debug_line_header_index = hamt_map<digest, extent<std::uint8_t>, u128_hash>;
         using fragment_index = hamt_map<digest, extent<repo::fragment>, u128_hash>;
+        /// Maps from the hash of a section payload to the shared copy of those bytes.
+        using payload_index = hamt_map<digest, extent<std::uint8_t>, u128_hash>;
         using write_index = hamt_map<std::string, extent<char>>;
 
         struct fnv_64a_hash_indirect_string {
@@ -104,6 +107,10 @@ namespace pstore {
 
         using name_index = hamt_set<indirect_string, fnv_64a_hash_indirect_string>;
         using path_index = hamt_set<indirect_string, fnv_64a_hash_indirect_string>;
+        /// The names held in key order. Unlike name_index, this index supports lower_bound() and
+        /// the iteration of a range of names such as those sharing a prefix. Names are added to
+        /// both indices by indirect_string_adder and share their bodies.
+        using ordered_name_index = btree_set<indirect_string>;
 
         // clang-format off
         /// Maps from the indices kind enumeration to the type that is used to represent a database index of that kind.
@@ -114,7 +121,9 @@ namespace pstore {
         template <> struct enum_to_index<trailer::indices::debug_line_header> { using type = debug_line_header_index; };
         template <> struct enum_to_index<trailer::indices::fragment         > { using type = fragment_index;          };
         template <> struct enum_to_index<trailer::indices::name             > { using type = name_index;              };
+        template <> struct enum_to_index<trailer::indices::ordered_name     > { using type = ordered_name_index;      };
         template <> struct enum_to_index<trailer::indices::path             > { using type = path_index;              };
+        template <> struct enum_to_index<trailer::indices::payload          > { using type = payload_index;           };
         template <> struct enum_to_index<trailer::indices::write            > { using type = write_index;             };
         // clang-format on
 
@@ -44,6 +44,7 @@ namespace pstore {
     /// addresses means that the in-store string bodies must be 2-byte aligned.
     class indirect_string {
         friend struct serialize::serializer<indirect_string>;
+        friend class indirect_string_adder;
 
     public:
         constexpr indirect_string (database const & db, address const addr) noexcept
@@ -245,11 +246,46 @@ namespace pstore {
         std::pair<typename Index::iterator, bool> add (transaction_base & transaction,
                                                        std::shared_ptr<Index> const & index,
                                                        gsl::not_null<raw_sstring_view const *> str);
-
+        /// Adds \p str to \p index and, if it was not already present there, to \p ordered. The
+        /// entries in the two indices share a single copy of the string body.
+        ///
+        /// \param transaction  The transaction to which the index records are appended.
+        /// \param index  The index to which the string is added.
+        /// \param ordered  An ordered index of the same strings (normally the ordered_name index).
+        /// \param str  The string to be added.
+        /// \returns The result of inserting the string into \p index.
+        template <typename Index, typename OrderedIndex>
+        std::pair<typename Index::iterator, bool>
+        add (transaction_base & transaction, std::shared_ptr<Index> const & index,
+             std::shared_ptr<OrderedIndex> const & ordered,
+             gsl::not_null<raw_sstring_view const *> str);
+
+        /// Writes the bodies of all of the strings added since the last call to flush(). The
+        /// bodies are written contiguously using a single allocation and each of the in-store
+        /// indirect_string records is patched to point at its body.
+        ///
+        /// \param transaction  The transaction to which the string bodies are appended.
         void flush (transaction_base & transaction);
 
     private:
-        std::vector<std::pair<raw_sstring_view const *, typed_address<address>>> views_;
+        /// \returns The number of bytes occupied by the serialized form of a string of \p length
+        /// characters.
+        static std::size_t body_size (std::size_t length) noexcept;
+        /// Writes the serialized form of \p str to memory starting at \p out.
+        /// \returns The address of the byte following the string body.
+        static std::uint8_t * write_body (std::uint8_t * out, raw_sstring_view const & str);
+
+        struct pending_body {
+            pending_body (raw_sstring_view const * s, typed_address<address> a) noexcept
+                    : str{s}
+                    , addr{a} {}
+            raw_sstring_view const * str;
+            /// The in-store indirect_string instance which will point to the body of str.
+            typed_address<address> addr;
+            /// A second indirect_string instance which will point to the same body, or null.
+            typed_address<address> alias = typed_address<address>::null ();
+        };
+        std::vector<pending_body> views_;
     };
 
     // add
@@ -272,6 +308,23 @@ namespace pstore {
         return res;
     }
 
+    template <typename Index, typename OrderedIndex>
+    std::pair<typename Index::iterator, bool>
+    indirect_string_adder::add (transaction_base & transaction,
+                                std::shared_ptr<Index> const & index,
+                                std::shared_ptr<OrderedIndex> const & ordered,
+                                gsl::not_null<raw_sstring_view const *> str) {
+        auto res = this->add (transaction, index, str);
+        if (res.second && ordered != nullptr) {
+            auto const ores =
+                ordered->insert (transaction, pstore::indirect_string{transaction.db (), str});
+            if (ores.second) {
+                views_.back ().alias = typed_address<address>::make (ores.first.get_address ());
+            }
+        }
+        return res;
+    }
+
     //*  _        _                  __              _   _           *
     //* | |_  ___| |_ __  ___ _ _   / _|_  _ _ _  __| |_(_)___ _ _   *
     //* | ' \/ -_) | '_ \/ -_) '_| |  _| || | ' \/ _|  _| / _ \ ' \  *
@@ -0,0 +1,422 @@
+//===- include/pstore/core/sharded_hamt_map.hpp -----------*- mode: C++ -*-===//
+//*      _                   _          _   _                     _                            *
+//*  ___| |__   __ _ _ __ __| | ___  __| | | |__   __ _ _ __ ___ | |_   _ __ ___   __ _ _ __   *
+//* / __| '_ \ / _` | '__/ _` |/ _ \/ _` | | '_ \ / _` | '_ ` _ \| __| | '_ ` _ \ / _` | '_ \  *
+//* \__ \ | | | (_| | | | (_| |  __/ (_| | | | | | (_| | | | | | | |_  | | | | | | (_| | |_) | *
+//* |___/_| |_|\__,_|_|  \__,_|\___|\__,_| |_| |_|\__,_|_| |_| |_|\__| |_| |_| |_|\__,_| .__/  *
+//*                                                                                    |_|     *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file sharded_hamt_map.hpp
+/// \brief A hamt_map whose keys are divided between independent sub-tries so that the threads of
+/// a single transaction may insert into it concurrently.
+
+#ifndef PSTORE_CORE_SHARDED_HAMT_MAP_HPP
+#define PSTORE_CORE_SHARDED_HAMT_MAP_HPP
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+
+#include "pstore/core/hamt_map.hpp"
+
+namespace pstore {
+    namespace index {
+
+        //*     _                _        _   _              _                      *
+        //*  __| |_  __ _ _ _ __| |___ __| | | |_  __ _ _ __| |_   _ __  __ _ _ __  *
+        //* (_-< ' \/ _` | '_/ _` / -_) _` | | ' \/ _` | '  \  _| | '  \/ _` | '_ \ *
+        //* /__/_||_\__,_|_| \__,_\___\__,_| |_||_\__,_|_|_|_\__| |_|_|_\__,_| .__/ *
+        //*                                                                  |_|    *
+        /// An associative container whose keys are divided between 2^ShardBits independent
+        /// hamt_map instances ("shards") by the top bits of their hash. Each shard has its own
+        /// in-heap root and its own latch, so the threads of a transaction may insert, assign or
+        /// erase keys concurrently provided that the keys fall in different shards. The shards
+        /// are written together when the map is flushed.
+        ///
+        /// The map serializes its own use of the transaction's allocator: transaction_base is not
+        /// itself thread-safe and single-writer indices don't pay for locking.
+        ///
+        /// Lookup and iteration may run concurrently with one another but not with modifications.
+        ///
+        /// \tparam KeyType  The map key type.
+        /// \tparam ValueType  The map value type.
+        /// \tparam Hash  A function which produces the hash of a supplied key.
+        /// \tparam KeyEqual  A function used to compare keys for equality.
+        /// \tparam ShardBits  The number of hash bits used to select a shard.
+        template <typename KeyType, typename ValueType, typename Hash = std::hash<KeyType>,
+                  typename KeyEqual = std::equal_to<KeyType>, unsigned ShardBits = 4U>
+        class sharded_hamt_map final : public index_base {
+            static_assert (ShardBits > 0U && ShardBits < 10U, "ShardBits must be in [1,9]");
+            using shard_map = hamt_map<KeyType, ValueType, Hash, KeyEqual>;
+
+        public:
+            using key_equal = KeyEqual;
+            using key_type = KeyType;
+            using mapped_type = ValueType;
+            using value_type = typename shard_map::value_type;
+
+            /// The number of independent sub-tries.
+            static constexpr std::size_t num_shards = std::size_t{1} << ShardBits;
+
+            //*                 _     _ _                _            *
+            //*  __ ___ _ _  __| |_  (_) |_ ___ _ _ __ _| |_ ___ _ _  *
+            //* / _/ _ \ ' \(_-<  _| | |  _/ -_) '_/ _` |  _/ _ \ '_| *
+            //* \__\___/_||_/__/\__| |_|\__\___|_| \__,_|\__\___/_|   *
+            //*                                                       *
+            /// Visits the members of each shard in turn.
+            class const_iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename shard_map::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = value_type const *;
+                using reference = value_type const &;
+
+                const_iterator (database const & db, sharded_hamt_map const * const map,
+                                std::size_t const shard, typename shard_map::const_iterator it)
+                        : db_{&db}
+                        , map_{map}
+                        , shard_{shard}
+                        , it_{std::move (it)} {
+                    this->skip_empty_shards ();
+                }
+
+                bool operator== (const_iterator const & other) const {
+                    return map_ == other.map_ && shard_ == other.shard_ && it_ == other.it_;
+                }
+                bool operator!= (const_iterator const & other) const { return !operator== (other); }
+
+                reference operator* () const { return *it_; }
+                pointer operator-> () const { return &operator* (); }
+
+                const_iterator & operator++ () {
+                    ++it_;
+                    this->skip_empty_shards ();
+                    return *this;
+                }
+                const_iterator operator++ (int) {
+                    const_iterator const old = *this;
+                    ++(*this);
+                    return old;
+                }
+
+                /// Returns the pstore address of the serialized value_type instance to which the
+                /// iterator is currently pointing.
+                address get_address () const { return it_.get_address (); }
+
+            private:
+                /// If the iterator is at the end of a shard other than the last, moves it to the
+                /// first member of the next non-empty shard (or the end of the last shard).
+                void skip_empty_shards () {
+                    while (shard_ + 1U < num_shards && it_ == map_->shard (shard_).cend (*db_)) {
+                        ++shard_;
+                        it_ = map_->shard (shard_).cbegin (*db_);
+                    }
+                }
+
+                database const * db_;
+                sharded_hamt_map const * map_;
+                std::size_t shard_;
+                typename shard_map::const_iterator it_;
+            };
+
+            /// \param db  The database instance.
+            /// \param pos  The address of the map's header block. If null, an empty map is
+            /// created.
+            /// \param hash  A function that yields a hash from the key value.
+            /// \param equal  A function used to compare keys for equality.
+            explicit sharded_hamt_map (
+                database const & db,
+                typed_address<header_block> pos = typed_address<header_block>::null (),
+                Hash const & hash = Hash (), KeyEqual const & equal = KeyEqual ());
+            sharded_hamt_map (sharded_hamt_map const &) = delete;
+            sharded_hamt_map (sharded_hamt_map &&) noexcept = delete;
+
+            ~sharded_hamt_map () override = default;
+
+            sharded_hamt_map & operator= (sharded_hamt_map const &) = delete;
+            sharded_hamt_map & operator= (sharded_hamt_map &&) noexcept = delete;
+
+            /// \name Iterators
+            ///@{
+            range<database const, sharded_hamt_map const, const_iterator>
+            make_range (database const & db) const {
+                return {db, *this};
+            }
+            const_iterator begin (database const & db) const { return this->cbegin (db); }
+            const_iterator cbegin (database const & db) const {
+                return {db, this, 0U, this->shard (0U).cbegin (db)};
+            }
+            const_iterator end (database const & db) const { return this->cend (db); }
+            const_iterator cend (database const & db) const {
+                return {db, this, num_shards - 1U, this->shard (num_shards - 1U).cend (db)};
+            }
+            ///@}
+
+            /// \name Capacity
+            ///@{
+            bool empty () const noexcept {
+                return std::all_of (std::begin (shards_), std::end (shards_),
+                                    [] (std::unique_ptr<shard_type> const & s) {
+                                        return s->map.empty ();
+                                    });
+            }
+            std::size_t size () const noexcept {
+                return std::accumulate (
+                    std::begin (shards_), std::end (shards_), std::size_t{0},
+                    [] (std::size_t const acc, std::unique_ptr<shard_type> const & s) {
+                        return acc + s->map.size ();
+                    });
+            }
+            ///@}
+
+            /// \name Modifiers
+            /// These functions may be called concurrently by the threads of a transaction. The
+            /// iterator that they return must not be used once another thread has modified the
+            /// same shard.
+            ///@{
+            template <typename OtherKeyType, typename OtherValueType>
+            auto insert (transaction_base & transaction,
+                         std::pair<OtherKeyType, OtherValueType> const & value)
+                -> std::pair<const_iterator, bool> {
+                return this->modify (transaction, value.first,
+                                     [&value] (shard_map & m, transaction_base & t) {
+                                         return m.insert (t, value);
+                                     });
+            }
+
+            template <typename OtherKeyType, typename OtherValueType>
+            auto insert_or_assign (transaction_base & transaction,
+                                   std::pair<OtherKeyType, OtherValueType> const & value)
+                -> std::pair<const_iterator, bool> {
+                return this->modify (transaction, value.first,
+                                     [&value] (shard_map & m, transaction_base & t) {
+                                         return m.insert_or_assign (t, value);
+                                     });
+            }
+
+            template <typename OtherKeyType, typename OtherValueType>
+            auto insert_or_assign (transaction_base & transaction, OtherKeyType const & key,
+                                   OtherValueType const & value)
+                -> std::pair<const_iterator, bool> {
+                return this->insert_or_assign (transaction, std::make_pair (key, value));
+            }
+
+            template <typename OtherKeyType>
+            std::size_t erase (transaction_base & transaction, OtherKeyType const & key) {
+                shard_type & s = *shards_[this->shard_index (key)];
+                std::lock_guard<std::mutex> const lock{s.latch};
+                shard_transaction t{transaction, allocate_mut_};
+                return s.map.erase (t, key);
+            }
+            ///@}
+
+            /// \name Lookup
+            ///@{
+            template <typename OtherKeyType>
+            const_iterator find (database const & db, OtherKeyType const & key) const {
+                auto const index = this->shard_index (key);
+                shard_type & s = *shards_[index];
+                std::lock_guard<std::mutex> const lock{s.latch};
+                auto pos = s.map.find (db, key);
+                if (pos == s.map.cend (db)) {
+                    return this->cend (db);
+                }
+                return {db, this, index, std::move (pos)};
+            }
+
+            template <typename OtherKeyType>
+            bool contains (database const & db, OtherKeyType const & key) const {
+                return this->find (db, key) != this->end (db);
+            }
+            ///@}
+
+            /// Flushes each of the shards in turn and writes the header block which records them.
+            /// Must not be called concurrently with any other member function.
+            ///
+            /// \param transaction  The transaction to which the map will be written.
+            /// \param generation  The generation number to which the map will be written.
+            /// \returns  The address of the map's header block or null if the map is empty.
+            typed_address<header_block> flush (transaction_base & transaction, unsigned generation);
+
+        private:
+            /// The header block signature. The final character records the number of shard bits.
+            static constexpr std::array<std::uint8_t, 8> index_signature{
+                {'I', 'd', 'x', 'S', 'h', 'r', 'd', '0' + ShardBits}};
+            /// The header block's root member points to the table of shard header block addresses.
+            using shard_table = std::array<typed_address<header_block>, num_shards>;
+
+            //*     _                _   _                             _   _           *
+            //*  __| |_  __ _ _ _ __| | | |_ _ _ __ _ _ _  ___ __ _ __| |_(_)___ _ _   *
+            //* (_-< ' \/ _` | '_/ _` | |  _| '_/ _` | ' \(_-</ _` / _|  _| / _ \ ' \  *
+            //* /__/_||_\__,_|_| \__,_|  \__|_| \__,_|_||_/__/\__,_\__|\__|_\___/_||_| *
+            //*                                                                        *
+            /// The transaction passed to a shard's hamt_map by a modifier. Its allocations are made
+            /// by the parent transaction whilst holding the map's allocation mutex. The mutex is
+            /// taken by the first allocation and kept until the modification is complete so that a
+            /// record written by a series of allocations (such as a leaf) remains contiguous.
+            class shard_transaction final : public transaction_base {
+            public:
+                shard_transaction (transaction_base & parent, std::mutex & mut) noexcept
+                        : transaction_base (parent, forwarding_tag{})
+                        , parent_{parent}
+                        , lock_{mut, std::defer_lock} {}
+                shard_transaction (shard_transaction const &) = delete;
+                shard_transaction (shard_transaction &&) noexcept = delete;
+                ~shard_transaction () noexcept override {
+                    if (this->superseded () > 0U) {
+                        this->lock ();
+                        parent_.supersede (this->superseded ());
+                    }
+                }
+
+                shard_transaction & operator= (shard_transaction const &) = delete;
+                shard_transaction & operator= (shard_transaction &&) noexcept = delete;
+
+                address allocate (std::uint64_t const size, unsigned const align) override {
+                    this->lock ();
+                    return parent_.allocate (size, align);
+                }
+                void open () override {
+                    this->lock ();
+                    parent_.open ();
+                }
+                /// The lock is held from here on so that the result remains accurate until the
+                /// caller's next allocation.
+                address next_address () override {
+                    this->lock ();
+                    return parent_.next_address ();
+                }
+
+            private:
+                void lock () {
+                    if (!lock_.owns_lock ()) {
+                        lock_.lock ();
+                    }
+                }
+
+                transaction_base & parent_;
+                std::unique_lock<std::mutex> lock_;
+            };
+
+            struct shard_type {
+                shard_type (database const & db, typed_address<header_block> const pos,
+                            Hash const & hash, KeyEqual const & equal)
+                        : map{db, pos, hash, equal} {}
+                std::mutex latch;
+                shard_map map;
+            };
+
+            shard_map const & shard (std::size_t const index) const noexcept {
+                PSTORE_ASSERT (index < num_shards);
+                return shards_[index]->map;
+            }
+
+            /// The number of hash bits that the shards' tries may consume. Bits beyond the width
+            /// of hash_type are implicitly zero.
+            static constexpr unsigned hash_bits =
+                std::min (details::max_hash_bits, static_cast<unsigned> (details::hash_size));
+            static_assert (ShardBits < hash_bits, "ShardBits must be less than the hash size");
+
+            /// Returns the shard to which \p key belongs. The top bits of the hash are used because
+            /// the shards' tries consume the hash from the bottom.
+            template <typename OtherKeyType>
+            std::size_t shard_index (OtherKeyType const & key) const {
+                return static_cast<std::size_t> (static_cast<details::hash_type> (hash_ (key)) >>
+                                                 (hash_bits - ShardBits));
+            }
+
+            /// Calls \p op with the shard to which \p key belongs and a transaction which adds to
+            /// \p transaction whilst holding the shard's latch.
+            template <typename OtherKeyType, typename Operation>
+            std::pair<const_iterator, bool> modify (transaction_base & transaction,
+                                                    OtherKeyType const & key, Operation op) {
+                auto const index = this->shard_index (key);
+                shard_type & s = *shards_[index];
+                std::lock_guard<std::mutex> const lock{s.latch};
+                shard_transaction t{transaction, allocate_mut_};
+                auto const result = op (s.map, t);
+                return {const_iterator{transaction.db (), this, index, result.first},
+                        result.second};
+            }
+
+            Hash hash_;
+            /// Serializes the shards' use of the transaction's allocator.
+            std::mutex allocate_mut_;
+            std::array<std::unique_ptr<shard_type>, num_shards> shards_;
+        };
+
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual,
+                  unsigned ShardBits>
+        constexpr std::size_t
+            sharded_hamt_map<KeyType, ValueType, Hash, KeyEqual, ShardBits>::num_shards;
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual,
+                  unsigned ShardBits>
+        constexpr std::array<std::uint8_t, 8>
+            sharded_hamt_map<KeyType, ValueType, Hash, KeyEqual, ShardBits>::index_signature;
+
+        // (ctor)
+        // ~~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual,
+                  unsigned ShardBits>
+        sharded_hamt_map<KeyType, ValueType, Hash, KeyEqual, ShardBits>::sharded_hamt_map (
+            database const & db, typed_address<header_block> const pos, Hash const & hash,
+            KeyEqual const & equal)
+                : hash_{hash} {
+            shard_table roots;
+            roots.fill (typed_address<header_block>::null ());
+            auto expected_size = std::uint64_t{0};
+            if (pos != typed_address<header_block>::null ()) {
+                std::shared_ptr<header_block const> const hb = db.getro (pos);
+#if PSTORE_SIGNATURE_CHECKS_ENABLED
+                if (hb->signature != index_signature) {
+                    raise (pstore::error_code::index_corrupt);
+                }
+#endif
+                roots = *db.getro (typed_address<shard_table>::make (hb->root));
+                expected_size = hb->size;
+            }
+            for (auto ctr = std::size_t{0}; ctr < num_shards; ++ctr) {
+                shards_[ctr] = std::make_unique<shard_type> (db, roots[ctr], hash, equal);
+            }
+            if (this->size () != expected_size) {
+                raise (pstore::error_code::index_corrupt);
+            }
+        }
+
+        // flush
+        // ~~~~~
+        template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual,
+                  unsigned ShardBits>
+        typed_address<header_block>
+        sharded_hamt_map<KeyType, ValueType, Hash, KeyEqual, ShardBits>::flush (
+            transaction_base & transaction, unsigned const generation) {
+            shard_table roots;
+            for (auto ctr = std::size_t{0}; ctr < num_shards; ++ctr) {
+                roots[ctr] = shards_[ctr]->map.flush (transaction, generation);
+            }
+            auto const size = this->size ();
+            if (size == 0U) {
+                return typed_address<header_block>::null ();
+            }
+
+            auto const table = transaction.alloc_rw<shard_table> ();
+            *table.first = roots;
+            auto const hb = transaction.alloc_rw<header_block> ();
+            hb.first->signature = index_signature;
+            hb.first->size = size;
+            hb.first->root = table.second.to_address ();
+            return hb.second;
+        }
+
+    } // end namespace index
+} // end namespace pstore
+
+#endif // PSTORE_CORE_SHARDED_HAMT_MAP_HPP
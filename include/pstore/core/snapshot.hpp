@@ -0,0 +1,125 @@
+//===- include/pstore/core/snapshot.hpp -------------------*- mode: C++ -*-===//
+//*                            _           _    *
+//*  ___ _ __   __ _ _ __  ___| |__   ___ | |_  *
+//* / __| '_ \ / _` | '_ \/ __| '_ \ / _ \| __| *
+//* \__ \ | | | (_| | |_) \__ \ | | | (_) | |_  *
+//* |___/_| |_|\__,_| .__/|___/_| |_|\___/ \__| *
+//*                 |_|                         *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file snapshot.hpp
+/// \brief Lightweight read-only views of individual store generations.
+///
+/// A database instance looks at a single revision of the store at a time: database::sync()
+/// remaps the file and discards the cached indices. A snapshot records the location of one
+/// generation's trailer and its index roots so that many readers can look at different
+/// generations concurrently through a single database instance. Creating a snapshot reads the
+/// trailer and nothing else; the indices are loaded on first use.
+
+#ifndef PSTORE_CORE_SNAPSHOT_HPP
+#define PSTORE_CORE_SNAPSHOT_HPP
+
+#include "pstore/core/index_types.hpp"
+
+namespace pstore {
+
+    //*                       _        _    *
+    //*  ____ _  __ _ _ __ __| |_  ___| |_  *
+    //* (_-< ' \/ _` | '_ (_-< ' \/ _ \  _| *
+    //* /__/_||_\__,_| .__/__/_||_\___/\__| *
+    //*              |_|                    *
+    /// A read-only view of a single generation of a store. The snapshot shares the memory
+    /// mapped by its parent database and does not take any additional locks.
+    ///
+    /// A snapshot may refer to any generation which is visible to its parent at the time that it
+    /// is constructed. The parent must outlive the snapshot and must not be synced whilst other
+    /// threads are reading through it. The snapshot object itself is not thread-safe, but is
+    /// cheap to construct and copy: each thread should use its own instance.
+    class snapshot {
+    public:
+        /// Creates a snapshot of the revision to which \p db is currently synced.
+        explicit snapshot (database const & db);
+        /// Creates a snapshot of the given revision of \p db.
+        ///
+        /// \param db  The parent database.
+        /// \param revision  The revision number. Must not be later than the revision to which
+        ///   \p db is synced; pstore::head_revision selects that revision. An unknown_revision
+        ///   error is raised otherwise.
+        /// \note The revision's footer is found with database::older_revision_footer_pos(). The
+        ///   first such lookup after \p db is synced to a new head is proportional to the number
+        ///   of revisions; the remainder are constant time.
+        snapshot (database const & db, unsigned revision);
+        /// Creates a snapshot of the generation whose trailer lies at \p footer_pos.
+        ///
+        /// \param db  The parent database.
+        /// \param footer_pos  The address of a transaction trailer. Must not lie beyond the
+        ///   footer of the revision to which \p db is synced. A footer_corrupt error is raised if
+        ///   it does not refer to a valid trailer.
+        snapshot (database const & db, typed_address<trailer> footer_pos);
+
+        /// Returns the parent database.
+        database const & db () const noexcept { return *db_; }
+        /// Returns the address of the generation's trailer.
+        typed_address<trailer> footer_pos () const noexcept { return footer_pos_; }
+        /// Returns the generation's revision number.
+        unsigned revision () const noexcept { return revision_; }
+        /// Returns the time at which the generation was committed in milliseconds since the
+        /// epoch.
+        std::uint64_t time () const noexcept { return time_; }
+        /// Returns the location of the header block of index \p which or null if the index was
+        /// empty in this generation.
+        typed_address<index::header_block> index_location (trailer::indices which) const {
+            return roots_[static_cast<std::underlying_type<trailer::indices>::type> (which)];
+        }
+
+        /// Returns a reference to the cached instance of index \p which. Used by
+        /// index::get_index().
+        std::shared_ptr<index::index_base> & get_mutable_index (trailer::indices which) const {
+            return indices_[static_cast<std::underlying_type<trailer::indices>::type> (which)];
+        }
+
+    private:
+        snapshot (database const & db, std::shared_ptr<trailer const> const & footer,
+                  typed_address<trailer> footer_pos);
+
+        database const * db_;
+        typed_address<trailer> footer_pos_;
+        unsigned revision_;
+        std::uint64_t time_;
+        trailer::index_records_array roots_;
+        mutable std::array<std::shared_ptr<index::index_base>,
+                           std::tuple_size<trailer::index_records_array>::value>
+            indices_;
+    };
+
+    namespace index {
+
+        /// Returns a pointer to an index as it was in the generation recorded by \p snap, loading
+        /// it from the store on first access. If 'create' is false and the index was empty in
+        /// that generation then nullptr is returned; otherwise an empty index is returned.
+        template <pstore::trailer::indices Index>
+        std::shared_ptr<typename enum_to_index<Index>::type const>
+        get_index (snapshot const & snap, bool const create = true) {
+            using index_type = typename enum_to_index<Index>::type;
+            std::shared_ptr<index_base> & dx = snap.get_mutable_index (Index);
+            if (dx == nullptr) {
+                typed_address<header_block> const location = snap.index_location (Index);
+                if (location != typed_address<header_block>::null ()) {
+                    dx = std::make_shared<index_type> (snap.db (), location);
+                } else if (create) {
+                    dx = std::make_shared<index_type> (snap.db ());
+                }
+            }
+            return std::static_pointer_cast<index_type const> (dx);
+        }
+
+    } // end namespace index
+} // end namespace pstore
+
+#endif // PSTORE_CORE_SNAPSHOT_HPP
@@ -25,6 +25,7 @@
 #include "pstore/core/address.hpp"
 #include "pstore/core/database.hpp"
 #include "pstore/core/time.hpp"
+#include "pstore/os/trace.hpp"
 
 namespace pstore {
     /// \brief The database transaction class.
@@ -57,6 +58,11 @@ namespace pstore {
         /// other words, if it returns false, calls to commit() or rollback() are noops.
         bool is_open () const noexcept { return first_ != address::null (); }
 
+        /// Opens the transaction without allocating any storage so that commit() writes a new
+        /// revision even if the only modifications are to the indices (for example, by erase()).
+        /// Has no effect if the transaction is already open.
+        virtual void open ();
+
         /// Commits all modifications made to the data store as part of this transaction.
         /// Modifications are visible to other processes when the commit is complete.
         transaction_base & commit ();
@@ -165,13 +171,35 @@ namespace pstore {
         /// Returns the number of bytes allocated in this transaction.
         std::uint64_t size () const noexcept { return size_; }
 
+        /// Returns the address at which the next allocation will begin before any padding is
+        /// added to satisfy its alignment. No storage is allocated. The result is only meaningful
+        /// until the next allocation so a derived class which shares the store with other writers
+        /// may serialize the two.
+        virtual address next_address ();
+
+        /// Records that \p bytes of the store are no longer reachable as a result of a change made
+        /// by this transaction. The total is accumulated in the trailer's garbage field.
+        void supersede (std::uint64_t const bytes) noexcept { superseded_ += bytes; }
+        /// Returns the number of bytes superseded by this transaction.
+        std::uint64_t superseded () const noexcept { return superseded_; }
+
     protected:
         explicit transaction_base (database & db);
 
+        struct forwarding_tag {};
+        /// Constructs an object which adds to the open transaction \p parent rather than starting
+        /// a new one. The derived class must override allocate(), open(), and next_address() to
+        /// pass its requests to \p parent and must hand any superseded bytes on to it.
+        transaction_base (transaction_base & parent, forwarding_tag) noexcept
+                : db_{parent.db ()}
+                , dbsize_{parent.dbsize_} {}
+
     private:
         database & db_;
         /// The number of bytes allocated in this transaction.
         std::uint64_t size_ = 0;
+        /// The number of bytes made unreachable by this transaction.
+        std::uint64_t superseded_ = 0;
 
         /// The size of the db at the creation of this transaction
         std::uint64_t dbsize_ = 0;
@@ -293,8 +321,14 @@ namespace pstore {
         transaction_mutex & operator= (transaction_mutex const & rhs) = delete;
         transaction_mutex & operator= (transaction_mutex && rhs) noexcept = default;
 
-        void lock () { rl_.lock (); }
-        void unlock () { rl_.unlock (); }
+        void lock () {
+            trace::span const s{"lock"};
+            rl_.lock ();
+        }
+        void unlock () {
+            trace::span const s{"unlock"};
+            rl_.unlock ();
+        }
 
     private:
         file::range_lock rl_;
@@ -134,8 +134,25 @@ namespace pstore {
             return dump::make_value (members);
         }
 
+        /// Make a value pointer which contains the keys of \p old_index that are not present in
+        /// \p index.
+        ///
+        /// \param db The database from which the indices are to be read.
+        /// \param index  The index as it appears in the newer revision.
+        /// \param old_index  The index as it appears in the older revision.
+        /// \returns  A value pointer which contains the keys removed from the index.
+        template <typename Index>
+        dump::value_ptr make_removed (database & db, Index const & index,
+                                      Index const & old_index) {
+            dump::array::container members;
+            typename details::diff_out<Index>::params params{&db, &old_index, &members};
+            diff_removed (db, index, old_index, details::diff_out<Index>{&params});
+            return dump::make_value (members);
+        }
+
         /// Make a value pointer which contains all different keys between two revisions for a
-        /// specific index.
+        /// specific index. If keys were removed from the index, they are listed by a "removed"
+        /// member.
         ///
         /// \pre new_revision >= old_revision
         ///
@@ -155,12 +172,25 @@ namespace pstore {
             PSTORE_ASSERT (new_revision >= old_revision);
 
             details::revision_restorer const _{db};
+            std::shared_ptr<Index const> old_index;
+            if (old_revision < new_revision) {
+                db.sync (old_revision);
+                old_index = get_index (db, true /* create */);
+            }
             db.sync (new_revision);
 
-            return dump::make_value (dump::object::container{
+            dump::object::container members{
                 {"name", dump::make_value (name)},
                 {"members", make_diff<Index> (db, old_revision, get_index)},
-            });
+            };
+            if (old_index != nullptr) {
+                std::shared_ptr<Index const> const index = get_index (db, true /* create */);
+                dump::value_ptr removed = make_removed (db, *index, *old_index);
+                if (removed->dynamic_cast_array ()->size () > 0U) {
+                    members.emplace_back ("removed", std::move (removed));
+                }
+            }
+            return dump::make_value (std::move (members));
         }
 
         /// Make a value pointer which contains all different keys between two revisions for all
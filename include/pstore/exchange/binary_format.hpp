@@ -0,0 +1,72 @@
+//===- include/pstore/exchange/binary_format.hpp ----------*- mode: C++ -*-===//
+//*  _     _                           __                            _    *
+//* | |__ (_)_ __   __ _ _ __ _   _   / _| ___  _ __ _ __ ___   __ _| |_  *
+//* | '_ \| | '_ \ / _` | '__| | | | | |_ / _ \| '__| '_ ` _ \ / _` | __| *
+//* | |_) | | | | | (_| | |  | |_| | |  _| (_) | |  | | | | | | (_| | |_  *
+//* |_.__/|_|_| |_|\__,_|_|   \__, | |_|  \___/|_|  |_| |_| |_|\__,_|\__| *
+//*                           |___/                                       *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file binary_format.hpp
+/// \brief Constants which describe the binary exchange format.
+///
+/// The binary format carries exactly the same information as the JSON exchange format but is
+/// considerably more compact and cheaper to produce and consume. A file consists of:
+///
+/// - The eight byte signature (binary::signature).
+/// - The format version number (a varint).
+/// - The sixteen bytes of the database UUID.
+/// - A sequence of records, the last of which must be record_kind::end.
+///
+/// Each record is a single byte record_kind followed by the size of the record payload (a
+/// varint) and the payload itself. Transactions are formed of zero or more names, paths,
+/// debug_line_header, fragment, and compilation records, in that order, followed by a commit
+/// record. Strings are referenced by their index in the names (or paths) arrays accumulated over
+/// all of the preceding transactions.
+///
+/// Within payloads, unsigned integers are varints, signed integers are zig-zag encoded varints,
+/// and digests are written as sixteen bytes, most significant first. Strings and byte arrays are
+/// a varint length followed by the raw bytes.
+
+#ifndef PSTORE_EXCHANGE_BINARY_FORMAT_HPP
+#define PSTORE_EXCHANGE_BINARY_FORMAT_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "pstore/support/varint.hpp"
+
+namespace pstore {
+    namespace exchange {
+        namespace binary {
+
+            /// The signature at the start of each binary exchange file.
+            constexpr std::array<std::uint8_t, 8> signature{
+                {'p', 's', 't', 'X', 'c', 'h', 'g', 0x1A}};
+            /// The version of the binary exchange format written by this code.
+            constexpr std::uint64_t version = 1U;
+
+            enum class record_kind : std::uint8_t {
+                end = 0,
+                names = 1,
+                paths = 2,
+                debug_line_header = 3,
+                fragment = 4,
+                compilation = 5,
+                commit = 6,
+            };
+
+            using varint::zigzag_decode;
+            using varint::zigzag_encode;
+
+        } // end namespace binary
+    }     // end namespace exchange
+} // end namespace pstore
+
+#endif // PSTORE_EXCHANGE_BINARY_FORMAT_HPP
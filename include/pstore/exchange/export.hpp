@@ -28,8 +28,25 @@ namespace pstore {
         // "namespace" to work around this restriction.
         namespace export_ns {
 
+            /// Writes the contents of the database \p db to \p os.
+            ///
+            /// \param db  The database to be exported.
+            /// \param os  The stream to which output is written.
+            /// \param comments  Emit comments to the output.
             void emit_database (database & db, ostream & os, bool comments);
 
+            /// Writes the contents of the database \p db to \p os using up to \p jobs worker
+            /// threads. Each worker opens its own read-only view of the file at db.path() and
+            /// renders a subset of the transactions; the results are written in generation order
+            /// so the output is identical to that of the single-threaded overload.
+            ///
+            /// \param db  The database to be exported.
+            /// \param os  The stream to which output is written.
+            /// \param comments  Emit comments to the output.
+            /// \param jobs  The maximum number of worker threads. If less than 2, the export is
+            ///   performed on the calling thread.
+            void emit_database (database & db, ostream & os, bool comments, unsigned jobs);
+
         } // end namespace export_ns
     }     // end namespace exchange
 } // end namespace pstore
@@ -0,0 +1,42 @@
+//===- include/pstore/exchange/export_binary.hpp ----------*- mode: C++ -*-===//
+//*                             _     _     _                         *
+//*   _____  ___ __   ___  _ __| |_  | |__ (_)_ __   __ _ _ __ _   _  *
+//*  / _ \ \/ / '_ \ / _ \| '__| __| | '_ \| | '_ \ / _` | '__| | | | *
+//* |  __/>  <| |_) | (_) | |  | |_  | |_) | | | | | (_| | |  | |_| | *
+//*  \___/_/\_\ .__/ \___/|_|   \__| |_.__/|_|_| |_|\__,_|_|   \__, | *
+//*           |_|                                              |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file export_binary.hpp
+/// \brief The top level entry point for exporting a pstore database using the binary exchange
+/// format.
+
+#ifndef PSTORE_EXCHANGE_EXPORT_BINARY_HPP
+#define PSTORE_EXCHANGE_EXPORT_BINARY_HPP
+
+#include "pstore/exchange/export_ostream.hpp"
+
+namespace pstore {
+    class database;
+
+    namespace exchange {
+        namespace export_ns {
+
+            /// Writes the contents of the database \p db to \p os using the binary exchange
+            /// format. (See binary_format.hpp for a description.)
+            ///
+            /// \param db  The database to be exported.
+            /// \param os  The stream to which output is written.
+            void emit_binary_database (database & db, ostream_base & os);
+
+        } // end namespace export_ns
+    }     // end namespace exchange
+} // end namespace pstore
+
+#endif // PSTORE_EXCHANGE_EXPORT_BINARY_HPP
@@ -27,7 +27,7 @@ namespace pstore {
                                 std::shared_ptr<repo::fragment const> const & fragment,
                                 bool comments);
 
-            void emit_fragments (ostream & os, indent ind, class database const & db,
+            void emit_fragments (ostream_base & os, indent ind, class database const & db,
                                  unsigned generation, string_mapping const & strings,
                                  bool comments);
 
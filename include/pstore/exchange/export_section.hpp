@@ -19,6 +19,7 @@
 #include "pstore/exchange/export_fixups.hpp"
 #include "pstore/exchange/export_ostream.hpp"
 #include "pstore/mcrepo/fragment.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
 #include "pstore/support/base64.hpp"
 
 namespace pstore {
@@ -76,8 +77,9 @@ namespace pstore {
                                 }
                                 {
                                     os1 << separator << ind1 << R"("data":")";
+                                    std::shared_ptr<std::uint8_t const> owner;
                                     repo::container<std::uint8_t> const payload =
-                                        content1.payload ();
+                                        repo::load_payload (db, content1, &owner);
                                     using output_iterator =
                                         typename details::output_iterator<OStream, char>::type;
                                     to_base64 (std::begin (payload), std::end (payload),
@@ -141,13 +143,12 @@ namespace pstore {
                     using dls = repo::debug_line_section;
 
                     template <typename OStream>
-                    OStream & operator() (OStream & os, indent const ind,
-                                          class database const & /*db*/,
+                    OStream & operator() (OStream & os, indent const ind, class database const & db,
                                           string_mapping const & /*strings*/, dls const & content,
                                           bool const /*comments*/) {
                         return emit_object (
                             os, ind, content,
-                            [] (OStream & os1, indent const ind1, dls const & content1) {
+                            [&db] (OStream & os1, indent const ind1, dls const & content1) {
                                 PSTORE_ASSERT (content1.align () == 1U);
                                 PSTORE_ASSERT (content1.xfixups ().size () == 0U);
                                 os1 << ind1 << R"("header":)";
@@ -155,8 +156,9 @@ namespace pstore {
                                 os1 << ",\n";
                                 {
                                     os1 << ind1 << R"("data":")";
+                                    std::shared_ptr<std::uint8_t const> owner;
                                     repo::container<std::uint8_t> const payload =
-                                        content1.payload ();
+                                        repo::load_payload (db, content1, &owner);
                                     using output_iterator =
                                         typename details::output_iterator<OStream, char>::type;
                                     to_base64 (std::begin (payload), std::end (payload),
@@ -77,6 +77,63 @@ namespace pstore {
                 std::unordered_map<address, std::uint64_t> strings_;
             };
 
+            namespace details {
+
+                /// Calls \p fn for the address of each string added to the index given by \p Index
+                /// in transaction \p generation.
+                template <typename trailer::indices Index, typename Function>
+                void for_each_new_string (database const & db, unsigned const generation,
+                                          Function fn) {
+                    if (generation == 0U) {
+                        return;
+                    }
+                    auto const names_index = index::get_index<Index> (db, false /*create*/);
+                    if (names_index == nullptr) {
+                        return;
+                    }
+                    auto const out_fn = [&] (pstore::address const addr) {
+                        fn (*names_index, addr);
+                    };
+                    diff (db, *names_index, generation - 1U, make_diff_out (&out_fn));
+                }
+
+                /// Writes the array of strings added to the index given by \p Index in
+                /// transaction \p generation to the output stream \p os. The function \p
+                /// index_fn yields the exported-array index of each string.
+                template <typename trailer::indices Index, typename IndexFunction>
+                bool emit_strings (ostream_base & os, indent const ind, database const & db,
+                                   unsigned const generation, std::string const & prefix,
+                                   bool const comments, IndexFunction index_fn) {
+                    bool first = true;
+                    std::string comment;
+                    auto const member_indent = ind.next ();
+                    for_each_new_string<Index> (
+                        db, generation, [&] (auto const & names_index, address const addr) {
+                            if (first) {
+                                os << prefix << '[';
+                                first = false;
+                            } else {
+                                os << ',' << comment;
+                            }
+                            os << '\n' << member_indent;
+
+                            indirect_string const str = names_index.load_leaf_node (db, addr);
+                            shared_sstring_view owner;
+                            raw_sstring_view const view = str.as_db_string_view (&owner);
+                            emit_string (os, view);
+                            std::uint64_t const index = index_fn (addr);
+                            if (comments) {
+                                comment = " // #" + std::to_string (index);
+                            }
+                        });
+                    if (!first) {
+                        os << comment << '\n' << ind << ']';
+                    }
+                    return !first;
+                }
+
+            } // end namespace details
+
             //*            _ _        _       _               *
             //*  ___ _ __ (_) |_   __| |_ _ _(_)_ _  __ _ ___ *
             //* / -_) '  \| |  _| (_-<  _| '_| | ' \/ _` (_-< *
@@ -99,40 +156,51 @@ namespace pstore {
             bool emit_strings (ostream_base & os, indent const ind, database const & db,
                                unsigned const generation, std::string const & prefix,
                                string_mapping * const string_table, bool const comments) {
-                if (generation == 0U) {
-                    return false;
-                }
-                auto const names_index = index::get_index<Index> (db, false /*create*/);
-                if (names_index == nullptr) {
-                    return false;
-                }
+                return details::emit_strings<Index> (
+                    os, ind, db, generation, prefix, comments,
+                    [string_table] (address const addr) { return string_table->add (addr); });
+            }
 
-                bool first = true;
-                std::string comment;
-                auto const member_indent = ind.next ();
-                auto const out_fn = [&] (pstore::address const addr) {
-                    if (first) {
-                        os << prefix << '[';
-                        first = false;
-                    } else {
-                        os << ',' << comment;
-                    }
-                    os << '\n' << member_indent;
-
-                    indirect_string const str = names_index->load_leaf_node (db, addr);
-                    shared_sstring_view owner;
-                    raw_sstring_view const view = str.as_db_string_view (&owner);
-                    emit_string (os, view);
-                    std::uint64_t const index = string_table->add (addr);
-                    if (comments) {
-                        comment = " // #" + std::to_string (index);
-                    }
-                };
-                diff (db, *names_index, generation - 1U, make_diff_out (&out_fn));
-                if (!first) {
-                    os << comment << '\n' << ind << ']';
-                }
-                return !first;
+            /// Writes the array of strings added to the index given by \p Index in transaction \p
+            /// generation to the output stream \p os. Unlike the overload which accepts a mutable
+            /// string table, \p string_table must already contain every string being emitted (see
+            /// add_strings()). This enables many transactions to be emitted concurrently.
+            ///
+            /// \tparam Index  The index in which the strings are defined.
+            /// \p os  The stream to which output is written.
+            /// \p ind  The indentation of the output.
+            /// \p db  The database instance whose strings are to be dumped.
+            /// \p generation  The database generation number whose strings are to be dumped.
+            /// \p prefix  A string prefix emitted before the array.
+            /// \p string_table  A string table containing the address-to-index mapping of each
+            ///   string.
+            /// \p comments  Emit comments to the output.
+            /// \returns True if one or more string were emitted, false otherwise.
+            template <typename trailer::indices Index>
+            bool emit_strings (ostream_base & os, indent const ind, database const & db,
+                               unsigned const generation, std::string const & prefix,
+                               string_mapping const * const string_table, bool const comments) {
+                return details::emit_strings<Index> (
+                    os, ind, db, generation, prefix, comments, [string_table] (address const addr) {
+                        return string_table->index (typed_address<indirect_string>::make (addr));
+                    });
+            }
+
+            /// Records the strings added to the index given by \p Index in transaction \p
+            /// generation in \p string_table without producing any output. The table is
+            /// populated exactly as emit_strings() would have done.
+            ///
+            /// \tparam Index  The index in which the strings are defined.
+            /// \p db  The database instance whose strings are to be recorded.
+            /// \p generation  The database generation number whose strings are to be recorded.
+            /// \p string_table  The string table to which the address-to-index mapping of each
+            ///   string is added.
+            template <typename trailer::indices Index>
+            void add_strings (database const & db, unsigned const generation,
+                              string_mapping * const string_table) {
+                details::for_each_new_string<Index> (
+                    db, generation,
+                    [string_table] (auto const &, address const addr) { string_table->add (addr); });
             }
 
         } // end namespace export_ns
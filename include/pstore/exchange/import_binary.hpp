@@ -0,0 +1,122 @@
+//===- include/pstore/exchange/import_binary.hpp ----------*- mode: C++ -*-===//
+//*  _                            _     _     _                         *
+//* (_)_ __ ___  _ __   ___  _ __| |_  | |__ (_)_ __   __ _ _ __ _   _  *
+//* | | '_ ` _ \| '_ \ / _ \| '__| __| | '_ \| | '_ \ / _` | '__| | | | *
+//* | | | | | | | |_) | (_) | |  | |_  | |_) | | | | | (_| | |  | |_| | *
+//* |_|_| |_| |_| .__/ \___/|_|   \__| |_.__/|_|_| |_|\__,_|_|   \__, | *
+//*             |_|                                              |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file import_binary.hpp
+/// \brief Declares the class which consumes the binary exchange format.
+
+#ifndef PSTORE_EXCHANGE_IMPORT_BINARY_HPP
+#define PSTORE_EXCHANGE_IMPORT_BINARY_HPP
+
+#include "pstore/core/transaction.hpp"
+#include "pstore/exchange/binary_format.hpp"
+#include "pstore/exchange/import_context.hpp"
+#include "pstore/exchange/import_strings.hpp"
+
+namespace pstore {
+    namespace exchange {
+        namespace import_ns {
+
+            //*  _    _                      _                     _            *
+            //* | |__(_)_ _  __ _ _ _ _  _  (_)_ __  _ __  ___ _ _| |_ ___ _ _  *
+            //* | '_ \ | ' \/ _` | '_| || | | | '  \| '_ \/ _ \ '_|  _/ -_) '_| *
+            //* |_.__/_|_||_\__,_|_|  \_, | |_|_|_|_| .__/\___/_|  \__\___|_|   *
+            //*                       |__/          |_|                         *
+            /// Consumes a stream of bytes in the binary exchange format (see binary_format.hpp)
+            /// and writes its contents to a database. Like the JSON parser, input may be supplied
+            /// in chunks of any size: incomplete records are buffered until the remainder of the
+            /// record arrives.
+            class binary_importer {
+            public:
+                /// \param db  The database into which the imported data will be written.
+                /// \param payloads  Controls which section payloads are shared and compressed.
+                explicit binary_importer (gsl::not_null<database *> db,
+                                          repo::payload_options const & payloads = {});
+                binary_importer (binary_importer const &) = delete;
+                binary_importer (binary_importer &&) noexcept = delete;
+
+                ~binary_importer () noexcept = default;
+
+                binary_importer & operator= (binary_importer const &) = delete;
+                binary_importer & operator= (binary_importer &&) noexcept = delete;
+
+                /// Supplies the next chunk of input.
+                ///
+                /// \param first  The start of the range of bytes to be consumed.
+                /// \param last  The end of the range of bytes to be consumed.
+                /// \returns The error (if any) detected in the input so far.
+                std::error_code input (std::uint8_t const * first, std::uint8_t const * last);
+
+                /// Signals the end of the input.
+                ///
+                /// \returns The error (if any) detected in the input.
+                std::error_code eof ();
+
+                bool has_error () const noexcept { return static_cast<bool> (error_); }
+                std::error_code last_error () const noexcept { return error_; }
+
+                /// Returns the offset within the input of the start of the record being processed.
+                /// If an error has been detected, this is the record which contains the error.
+                std::uint64_t offset () const noexcept { return offset_; }
+
+            private:
+                /// Processes as many complete records from the range [first, last) as possible.
+                ///
+                /// \returns The position of the first byte that was not consumed.
+                std::uint8_t const * consume (std::uint8_t const * first,
+                                              std::uint8_t const * last);
+                /// Processes the file header from the range [first, last).
+                ///
+                /// \returns The position of the first byte after the header or nullptr if the
+                ///   header is incomplete.
+                std::uint8_t const * header (std::uint8_t const * first, std::uint8_t const * last);
+                std::error_code record (binary::record_kind kind, std::uint8_t const * first,
+                                        std::uint8_t const * last);
+
+                std::error_code strings (std::uint8_t const * first, std::uint8_t const * last,
+                                         not_null<string_mapping *> strings);
+                std::error_code debug_line_header (std::uint8_t const * first,
+                                                   std::uint8_t const * last);
+                std::error_code fragment (std::uint8_t const * first, std::uint8_t const * last);
+                std::error_code compilation (std::uint8_t const * first,
+                                             std::uint8_t const * last);
+                std::error_code commit ();
+                std::error_code end ();
+
+                /// Returns the current transaction, starting a new one if necessary.
+                transaction_base & get_transaction ();
+
+                context ctxt_;
+                string_mapping names_;
+                string_mapping paths_;
+                std::unique_ptr<transaction<transaction_lock>> transaction_;
+
+                enum class state { header, records, done };
+                state state_ = state::header;
+                /// The kind of the last record in the current transaction. Used to ensure that the
+                /// records in a transaction appear in the correct order.
+                binary::record_kind last_kind_ = binary::record_kind::end;
+                uuid id_;
+
+                /// Holds input which does not yet form a complete record.
+                std::vector<std::uint8_t> buffer_;
+                std::uint64_t offset_ = 0;
+                std::error_code error_;
+            };
+
+        } // end namespace import_ns
+    }     // end namespace exchange
+} // end namespace pstore
+
+#endif // PSTORE_EXCHANGE_IMPORT_BINARY_HPP
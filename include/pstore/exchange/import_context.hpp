@@ -17,8 +17,10 @@
 #define PSTORE_EXCHANGE_IMPORT_CONTEXT_HPP
 
 #include <list>
+#include <memory>
 #include <stack>
 
+#include "pstore/mcrepo/shared_payload.hpp"
 #include "pstore/support/gsl.hpp"
 
 namespace pstore {
@@ -42,6 +44,7 @@ namespace pstore {
                 virtual std::error_code operator() (transaction_base * t) = 0;
             };
 
+            class fragment_pipeline;
             class rule;
 
             struct context {
@@ -69,6 +72,11 @@ namespace pstore {
                 gsl::not_null<database *> const db;
                 std::stack<std::unique_ptr<rule>> stack;
                 std::list<std::unique_ptr<patcher>> patches;
+                /// If not null, fragments are prepared by this pipeline's worker threads rather
+                /// than by the parsing thread.
+                std::shared_ptr<fragment_pipeline> pipeline;
+                /// Controls which section payloads are shared and compressed.
+                repo::payload_options payloads;
             };
 
         } // end namespace import_ns
@@ -72,6 +72,13 @@ namespace pstore {
                 index_out_of_range,
                 debug_line_header_digest_not_found,
                 number_too_large,
+
+                bad_binary_signature,
+                unsupported_binary_version,
+                unknown_binary_record,
+                bad_binary_record,
+                binary_record_out_of_order,
+                unexpected_end_of_binary_input,
             };
 
 
@@ -25,6 +25,7 @@
 #ifndef PSTORE_EXCHANGE_IMPORT_FRAGMENT_HPP
 #define PSTORE_EXCHANGE_IMPORT_FRAGMENT_HPP
 
+#include "pstore/exchange/import_fragment_pipeline.hpp"
 #include "pstore/exchange/import_section_to_importer.hpp"
 #include "pstore/mcrepo/fragment.hpp"
 
@@ -73,16 +74,22 @@ namespace pstore {
                 std::error_code key (std::string const & s) override;
                 std::error_code end_object () override;
 
+                /// Validates the fragment \p f.
+                ///
+                /// \param f  The fragment to be validated.
+                /// \returns No error is the fragment was valid or an opporiate error code if the
+                ///   fragment was not legal.
+                static std::error_code check_fragment (repo::fragment const & f);
+
             private:
                 not_null<transaction_base *> const transaction_;
                 not_null<string_mapping const *> const names_;
                 not_null<index::digest const *> const digest_;
 
-                std::array<repo::section_content, repo::num_section_kinds> contents_;
-                linked_definitions_container linked_definitions_;
-
-                std::vector<std::unique_ptr<repo::section_creation_dispatcher>> dispatchers_;
-                std::back_insert_iterator<decltype (dispatchers_)> oit_;
+                /// The fragment's contents are held on the heap so that they can be handed to a
+                /// pipeline worker without invalidating the pointers held by the dispatchers.
+                std::unique_ptr<fragment_contents> contents_;
+                std::back_insert_iterator<decltype (fragment_contents::dispatchers)> oit_;
 
                 // (For explicit specialization, you need to specialize the outer class before the
                 // inner but I don't want to do that here. A workaround is to rely on partial
@@ -101,7 +108,8 @@ namespace pstore {
                 struct section_importer_creator<repo::section_kind::linked_definitions, Dummy> {
                     std::error_code operator() (fragment_sections * const fs) const {
                         using importer = linked_definitions_section<decltype (oit_)>;
-                        return push_array_rule<importer> (fs, &fs->linked_definitions_, &fs->oit_);
+                        return push_array_rule<importer> (fs, &fs->contents_->linked_definitions,
+                                                          &fs->oit_);
                     }
                 };
 
@@ -111,16 +119,9 @@ namespace pstore {
                 }
 
                 repo::section_content * section_contents (repo::section_kind const kind) noexcept {
-                    return &contents_[static_cast<std::underlying_type<repo::section_kind>::type> (
-                        kind)];
+                    return &contents_->sections[static_cast<
+                        std::underlying_type<repo::section_kind>::type> (kind)];
                 }
-
-                /// Validates the fragment \p f.
-                ///
-                /// \param f  The fragment to be validated.
-                /// \returns No error is the fragment was valid or an opporiate error code if the
-                ///   fragment was not legal.
-                static std::error_code check_fragment (repo::fragment const & f);
             };
 
             //*   __                             _     _         _          *
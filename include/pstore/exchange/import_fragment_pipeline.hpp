@@ -0,0 +1,163 @@
+//===- include/pstore/exchange/import_fragment_pipeline.hpp *- mode: C++ -*-===//
+//*  _                            _    *
+//* (_)_ __ ___  _ __   ___  _ __| |_  *
+//* | | '_ ` _ \| '_ \ / _ \| '__| __| *
+//* | | | | | | | |_) | (_) | |  | |_  *
+//* |_|_| |_| |_| .__/ \___/|_|   \__| *
+//*             |_|                    *
+//*   __                                      _    *
+//*  / _|_ __ __ _  __ _ _ __ ___   ___ _ __ | |_  *
+//* | |_| '__/ _` |/ _` | '_ ` _ \ / _ \ '_ \| __| *
+//* |  _| | | (_| | (_| | | | | | |  __/ | | | |_  *
+//* |_| |_|  \__,_|\__, |_| |_| |_|\___|_| |_|\__| *
+//*                |___/                           *
+//*        _            _ _             *
+//*  _ __ (_)_ __   ___| (_)_ __   ___  *
+//* | '_ \| | '_ \ / _ \ | | '_ \ / _ \ *
+//* | |_) | | |_) |  __/ | | | | |  __/ *
+//* | .__/|_| .__/ \___|_|_|_| |_|\___| *
+//* |_|     |_|                         *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file import_fragment_pipeline.hpp
+/// \brief Prepares imported fragments on a pool of worker threads.
+///
+/// When importing a large export file, most of the time is spent decoding the base64 section
+/// payloads and building the fragment records. Neither step depends on the store, so whilst the
+/// parsing thread continues to tokenize the input, the pipeline hands each fragment to a worker
+/// which decodes its payloads and builds a complete, position-independent image of the record in
+/// memory. The parsing thread then copies the finished images into the transaction in the order
+/// in which they appeared in the input. The resulting store is therefore identical to one produced
+/// by a single-threaded import.
+///
+/// Fragments with a section payload which is to be shared or compressed (see context::payloads)
+/// are an exception: the payload index can only be searched and updated by the thread which owns
+/// the transaction. For these fragments, the worker decodes and compresses the payloads and the
+/// record is built by the parsing thread.
+
+#ifndef PSTORE_EXCHANGE_IMPORT_FRAGMENT_PIPELINE_HPP
+#define PSTORE_EXCHANGE_IMPORT_FRAGMENT_PIPELINE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "pstore/core/index_types.hpp"
+#include "pstore/exchange/import_context.hpp"
+#include "pstore/exchange/import_linked_definitions_section.hpp"
+#include "pstore/mcrepo/generic_section.hpp"
+
+namespace pstore {
+    namespace exchange {
+        namespace import_ns {
+
+            /// The contents of a fragment as they are gathered by the import rules.
+            struct fragment_contents {
+                std::array<repo::section_content, repo::num_section_kinds> sections;
+                linked_definitions_container linked_definitions;
+                /// The section creation dispatchers. These refer to the members of sections and
+                /// linked_definitions so an instance must not be moved once the dispatchers have
+                /// been created.
+                std::vector<std::unique_ptr<repo::section_creation_dispatcher>> dispatchers;
+            };
+
+            //*   __                             _          _           _ _           *
+            //*  / _|_ _ __ _ __ _ _ __  ___ _ _| |_   _ __(_)_ __  ___| (_)_ _  ___  *
+            //* |  _| '_/ _` / _` | '  \/ -_) ' \  _| | '_ \ | '_ \/ -_) | | ' \/ -_) *
+            //* |_| |_| \__,_\__, |_|_|_\___|_||_\__| | .__/_| .__/\___|_|_|_||_\___| *
+            //*              |___/                    |_|    |_|                      *
+            class fragment_pipeline {
+            public:
+                /// \param workers  The number of worker threads used to prepare fragments.
+                explicit fragment_pipeline (unsigned workers);
+                fragment_pipeline (fragment_pipeline const &) = delete;
+                fragment_pipeline (fragment_pipeline &&) noexcept = delete;
+
+                ~fragment_pipeline () noexcept;
+
+                fragment_pipeline & operator= (fragment_pipeline const &) = delete;
+                fragment_pipeline & operator= (fragment_pipeline &&) noexcept = delete;
+
+                /// Records the base64-encoded payload of \p content. The payload is decoded
+                /// by a worker once the fragment to which \p content belongs is submitted.
+                void defer_payload (gsl::not_null<repo::section_content *> content,
+                                    std::string && base64);
+
+                /// Hands a fragment (together with any payloads deferred since the previous call)
+                /// to the workers. Any fragments at the head of the queue which are ready are
+                /// stored; if too many fragments are in flight, blocks until the oldest is ready.
+                ///
+                /// \param ctxt  The import context.
+                /// \param transaction  The transaction to which fragments are added.
+                /// \param digest  The digest of the fragment.
+                /// \param contents  The contents of the fragment.
+                std::error_code submit (gsl::not_null<context *> ctxt,
+                                        gsl::not_null<transaction_base *> transaction,
+                                        index::digest const & digest,
+                                        std::unique_ptr<fragment_contents> && contents);
+
+                /// Waits for all of the submitted fragments to be prepared and stores them in
+                /// \p transaction.
+                std::error_code flush (gsl::not_null<context *> ctxt,
+                                       gsl::not_null<transaction_base *> transaction);
+
+            private:
+                /// A fragment record built in memory by a worker.
+                struct prepared_fragment {
+                    std::error_code error;
+                    index::digest digest;
+                    std::unique_ptr<std::uint8_t[]> storage;
+                    std::uint8_t const * image = nullptr;
+                    std::size_t size = 0U;
+                    bool has_linked_definitions = false;
+                    /// If not null, the fragment has payloads which may be shared or compressed.
+                    /// Its record must be built by the parsing thread and image is null.
+                    std::unique_ptr<fragment_contents> contents;
+                    /// The compressed payloads of the fragment's sections (see
+                    /// repo::compress_payloads()).
+                    std::vector<repo::packed_payload> packed;
+                };
+                using payloads = std::vector<std::pair<repo::section_content *, std::string>>;
+
+                static prepared_fragment prepare (index::digest const & digest,
+                                                  std::unique_ptr<fragment_contents> && contents,
+                                                  payloads & deferred,
+                                                  repo::payload_options const & options);
+
+                /// Stores the prepared fragments at the head of the in-flight queue. Stops at the
+                /// first fragment which is not ready once no more than \p limit fragments remain
+                /// in flight.
+                std::error_code store (gsl::not_null<context *> ctxt,
+                                       gsl::not_null<transaction_base *> transaction,
+                                       std::size_t limit);
+
+                void worker ();
+
+                /// The maximum number of fragments which may be awaiting storage.
+                std::size_t const max_in_flight_;
+
+                // State shared with the workers.
+                std::mutex mut_;
+                std::condition_variable cv_;
+                std::deque<std::packaged_task<prepared_fragment ()>> tasks_;
+                bool done_ = false;
+                std::vector<std::thread> threads_;
+
+                // State belonging to the parsing thread.
+                payloads deferred_;
+                std::deque<std::future<prepared_fragment>> in_flight_;
+            };
+
+        } // end namespace import_ns
+    }     // end namespace exchange
+} // end namespace pstore
+
+#endif // PSTORE_EXCHANGE_IMPORT_FRAGMENT_PIPELINE_HPP
@@ -23,6 +23,7 @@
 #define PSTORE_EXCHANGE_IMPORT_GENERIC_SECTION_HPP
 
 #include "pstore/exchange/import_fixups.hpp"
+#include "pstore/exchange/import_fragment_pipeline.hpp"
 #include "pstore/exchange/import_non_terminals.hpp"
 #include "pstore/support/base64.hpp"
 
@@ -128,6 +129,11 @@ namespace pstore {
                 }
                 content_->kind = kind_;
                 content_->align = static_cast<align_type> (align_);
+                if (fragment_pipeline * const pipeline = this->get_context ()->pipeline.get ()) {
+                    // Leave the payload to be decoded by one of the pipeline's worker threads.
+                    pipeline->defer_payload (content_, std::move (data_));
+                    return return_type{content_};
+                }
                 if (!from_base64 (std::begin (data_), std::end (data_),
                                   std::back_inserter (content_->data))) {
                     return return_type{error::bad_base64_data};
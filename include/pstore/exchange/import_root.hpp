@@ -49,8 +49,12 @@ namespace pstore {
 
             /// Creates a JSON parser instance which will consume pstore exchange input.
             /// \param db  The database into which the imported data will be written.
+            /// \param jobs  The number of worker threads used to prepare fragments. If 1 or less,
+            ///   all of the work is performed by the thread calling the parser.
+            /// \param payloads  Controls which section payloads are shared and compressed.
             /// \returns A JSON parser instance.
-            json::parser<callbacks> create_parser (database & db);
+            json::parser<callbacks> create_parser (database & db, unsigned jobs = 1U,
+                                                   repo::payload_options const & payloads = {});
 
         } // end namespace import_ns
     }     // end namespace exchange
@@ -24,6 +24,7 @@
 #include <tuple>
 
 #include "pstore/json/json_error.hpp"
+#include "pstore/json/scan.hpp"
 #include "pstore/support/max.hpp"
 #include "pstore/support/utf.hpp"
 
@@ -216,6 +217,12 @@ namespace pstore {
 
             /// Resets the column count but does not affect the row number.
             void reset_column () noexcept { coordinate_.column = 0U; }
+
+            /// Advances the column number by \p n. Used when a run of characters, none of which
+            /// is a UTF-8 continuation byte, is consumed in bulk.
+            void advance_columns (std::size_t const n) noexcept {
+                coordinate_.column += static_cast<unsigned> (n);
+            }
             ///@}
 
             /// Records an error for this parse. The parse will stop as soon as a non-zero error
@@ -230,6 +237,16 @@ namespace pstore {
             }
             ///@}
 
+            /// Offers the input [first, last) to \p handler so that it can consume a run of
+            /// characters in bulk. Only possible for contiguous input.
+            ///
+            /// \returns An iterator to the first character which was not consumed.
+            template <typename InputIterator>
+            static InputIterator consume_run (matcher &, InputIterator first, InputIterator) {
+                return first;
+            }
+            char const * consume_run (matcher & handler, char const * first, char const * last);
+
             pointer make_root_matcher (bool object_key = false);
             pointer make_whitespace_matcher ();
 
@@ -258,6 +275,9 @@ namespace pstore {
 
             /// The column and row number of the parse within the input stream.
             coord coordinate_{1U, 1U};
+
+            /// The functions used to find the end of runs of whitespace and string characters.
+            details::scanner const & scanner_ = details::best_scanner ();
         };
 
         template <typename Callbacks>
@@ -311,13 +331,34 @@ namespace pstore {
                 virtual std::pair<pointer, bool> consume (parser<Callbacks> & parser,
                                                           maybe<char> ch) = 0;
 
+                /// Called with the remaining contiguous input if accepts_runs() is true. A matcher
+                /// may consume a run of characters from the start of [first, last) without
+                /// completing or pushing a new matcher. It must update the parser's coordinate to
+                /// account for the characters that it consumes.
+                ///
+                /// \param parser The owning parser instance.
+                /// \param first The first of the remaining input characters.
+                /// \param last The end of the remaining input characters.
+                /// \returns A pointer to the first character which was not consumed.
+                virtual char const * consume_run (parser<Callbacks> & parser, char const * first,
+                                                  char const * last) {
+                    (void) parser;
+                    (void) last;
+                    return first;
+                }
+
                 /// \returns True if this matcher has completed (and reached it's "done" state). The
                 /// parser will pop this instance from the parse stack before continuing.
                 bool is_done () const noexcept { return state_ == done; }
 
+                /// \returns True if this matcher is able to consume runs of characters in bulk.
+                bool accepts_runs () const noexcept { return accepts_runs_; }
+
             protected:
-                explicit constexpr matcher (int const initial_state) noexcept
-                        : state_{initial_state} {}
+                explicit constexpr matcher (int const initial_state,
+                                            bool const accepts_runs = false) noexcept
+                        : state_{initial_state}
+                        , accepts_runs_{accepts_runs} {}
 
                 constexpr int get_state () const noexcept { return state_; }
                 void set_state (int const s) noexcept { state_ = s; }
@@ -335,6 +376,14 @@ namespace pstore {
                 }
                 ///@}
 
+                static scanner const & get_scanner (parser<Callbacks> const & parser) noexcept {
+                    return parser.scanner_;
+                }
+                static void advance_columns (parser<Callbacks> & parser,
+                                             std::size_t const n) noexcept {
+                    parser.advance_columns (n);
+                }
+
                 pointer make_root_matcher (parser<Callbacks> & parser, bool object_key = false) {
                     return parser.make_root_matcher (object_key);
                 }
@@ -355,6 +404,7 @@ namespace pstore {
 
             private:
                 int state_;
+                bool const accepts_runs_;
             };
 
             //*  _       _             *
@@ -850,7 +900,7 @@ namespace pstore {
             public:
                 explicit string_matcher (gsl::not_null<std::string *> const str,
                                          bool object_key) noexcept
-                        : matcher<Callbacks> (start_state)
+                        : matcher<Callbacks> (start_state, true)
                         , object_key_{object_key}
                         , app_{str} {
                     str->clear ();
@@ -858,6 +908,8 @@ namespace pstore {
 
                 std::pair<typename matcher<Callbacks>::pointer, bool>
                 consume (parser<Callbacks> & parser, maybe<char> ch) override;
+                char const * consume_run (parser<Callbacks> & parser, char const * first,
+                                          char const * last) override;
 
             private:
                 enum state {
@@ -991,7 +1043,7 @@ namespace pstore {
             }
 
             // hex value [static]
-            // ~~~~~~~~~
+            // ~~~~~~~~~~~~~~~~~~
             template <typename Callbacks>
             maybe<unsigned> string_matcher<Callbacks>::hex_value (char32_t const c,
                                                                   unsigned const value) {
@@ -1009,7 +1061,7 @@ namespace pstore {
             }
 
             // consume hex state [static]
-            // ~~~~~~~~~~~~~~~~~
+            // ~~~~~~~~~~~~~~~~~~~~~~~~~~
             template <typename Callbacks>
             auto string_matcher<Callbacks>::consume_hex_state (unsigned const hex,
                                                                enum state const state,
@@ -1039,7 +1091,7 @@ namespace pstore {
                 }
 
             // consume escape state [static]
-            // ~~~~~~~~~~~~~~~~~~~~
+            // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
             template <typename Callbacks>
             auto string_matcher<Callbacks>::consume_escape_state (char32_t code_point,
                                                                   appender & app)
@@ -1145,6 +1197,27 @@ namespace pstore {
                 return {nullptr, true};
             }
 
+            // consume run
+            // ~~~~~~~~~~~
+            template <typename Callbacks>
+            char const * string_matcher<Callbacks>::consume_run (parser<Callbacks> & parser,
+                                                                 char const * const first,
+                                                                 char const * const last) {
+                // Plain ASCII characters can be copied verbatim to the output string so long as we
+                // are not part-way through an escape sequence, a surrogate pair, or a multi-byte
+                // UTF-8 sequence.
+                if (this->get_state () != normal_char_state || app_.has_high_surrogate () ||
+                    !decoder_.is_code_point_boundary ()) {
+                    return first;
+                }
+                char const * const end =
+                    matcher<Callbacks>::get_scanner (parser).string_body (first, last);
+                app_.result ()->append (first, end);
+                matcher<Callbacks>::advance_columns (parser,
+                                                     static_cast<std::size_t> (end - first));
+                return end;
+            }
+
             //*                          *
             //*  __ _ _ _ _ _ __ _ _  _  *
             //* / _` | '_| '_/ _` | || | *
@@ -1338,7 +1411,7 @@ namespace pstore {
             }
 
             // end object
-            // ~~~~~~~~~~~
+            // ~~~~~~~~~~
             template <typename Callbacks>
             void object_matcher<Callbacks>::end_object (parser<Callbacks> & parser) {
                 this->set_error (parser, parser.callbacks ().end_object ());
@@ -1358,10 +1431,12 @@ namespace pstore {
             class whitespace_matcher final : public matcher<Callbacks> {
             public:
                 whitespace_matcher () noexcept
-                        : matcher<Callbacks> (body_state) {}
+                        : matcher<Callbacks> (body_state, true) {}
 
                 std::pair<typename matcher<Callbacks>::pointer, bool>
                 consume (parser<Callbacks> & parser, maybe<char> ch) override;
+                char const * consume_run (parser<Callbacks> & parser, char const * first,
+                                          char const * last) override;
 
             private:
                 enum state {
@@ -1465,6 +1540,32 @@ namespace pstore {
                 return {nullptr, true};
             }
 
+            // consume run
+            // ~~~~~~~~~~~
+            template <typename Callbacks>
+            char const * whitespace_matcher<Callbacks>::consume_run (parser<Callbacks> & parser,
+                                                                     char const * first,
+                                                                     char const * const last) {
+                if (this->get_state () != body_state) {
+                    return first;
+                }
+                // Consume runs of spaces and tabs along with any LF characters that separate them.
+                // Anything else (including CR, which needs the crlf_state) is left for consume().
+                scanner const & scan = matcher<Callbacks>::get_scanner (parser);
+                for (;;) {
+                    char const * const end = scan.blanks (first, last);
+                    parser.advance_columns (static_cast<std::size_t> (end - first));
+                    first = end;
+                    if (first == last || *first != details::char_set::lf) {
+                        break;
+                    }
+                    this->lf (parser);
+                    parser.advance_column ();
+                    ++first;
+                }
+                return first;
+            }
+
             // consume body
             // ~~~~~~~~~~~~
             template <typename Callbacks>
@@ -1796,7 +1897,10 @@ namespace pstore {
                 std::is_same<typename std::remove_cv<typename SpanType::element_type>::type,
                              char>::value,
                 "span element type must be char");
-            return this->input (std::begin (span), std::end (span));
+            // Pass the span's contents as a pair of pointers so that the bulk scanning fast paths
+            // can be used.
+            char const * const data = span.data ();
+            return this->input (data, data + span.size ());
         }
 
         template <typename Callbacks>
@@ -1813,6 +1917,12 @@ namespace pstore {
             while (first != last) {
                 PSTORE_ASSERT (!stack_.empty ());
                 auto & handler = stack_.top ();
+                if (handler->accepts_runs ()) {
+                    first = this->consume_run (*handler, first, last);
+                    if (first == last) {
+                        break;
+                    }
+                }
                 auto res = handler->consume (*this, just (*first));
                 if (handler->is_done ()) {
                     if (error_) {
@@ -1845,6 +1955,14 @@ namespace pstore {
             return *this;
         }
 
+        // consume run
+        // ~~~~~~~~~~~
+        template <typename Callbacks>
+        char const * parser<Callbacks>::consume_run (matcher & handler, char const * const first,
+                                                     char const * const last) {
+            return handler.consume_run (*this, first, last);
+        }
+
         // eof
         // ~~~
         template <typename Callbacks>
@@ -0,0 +1,63 @@
+//===- include/pstore/json/scan.hpp -----------------------*- mode: C++ -*-===//
+//*                       *
+//*  ___  ___ __ _ _ __   *
+//* / __|/ __/ _` | '_ \  *
+//* \__ \ (_| (_| | | | | *
+//* |___/\___\__,_|_| |_| *
+//*                       *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file scan.hpp
+/// \brief Bulk scanning of the input text used by the JSON parser's fast paths.
+///
+/// The JSON parser is a character-at-a-time state machine. Two constructs dominate typical
+/// inputs (such as the output of pstore-export): runs of indentation whitespace and the bodies of
+/// strings. The functions declared here find the end of such runs many bytes at a time so that the
+/// parser can consume them in bulk. The implementation is selected at runtime from the best
+/// instruction set supported by the host CPU.
+#ifndef PSTORE_JSON_SCAN_HPP
+#define PSTORE_JSON_SCAN_HPP
+
+namespace pstore {
+    namespace json {
+        namespace details {
+
+            enum class scan_isa {
+                portable, ///< A scalar implementation which runs everywhere.
+                sse2,     ///< 16 bytes at a time using SSE2.
+                avx2,     ///< 32 bytes at a time using AVX2.
+            };
+
+            /// A table of the bulk scanning functions for a single instruction set.
+            struct scanner {
+                /// Returns a pointer to the first character in [first, last) which is neither a
+                /// space nor a horizontal tab, or \p last if there is no such character.
+                char const * (*blanks) (char const * first, char const * last);
+                /// Returns a pointer to the first character in [first, last) which cannot be copied
+                /// verbatim from the body of a JSON string: a quote, a backslash, a control
+                /// character, or any byte which is not 7-bit ASCII. Returns \p last if there is no
+                /// such character.
+                char const * (*string_body) (char const * first, char const * last);
+            };
+
+            /// \returns True if the instruction set \p isa is supported by the host CPU.
+            bool scan_isa_available (scan_isa isa) noexcept;
+
+            /// \returns The scanning functions for instruction set \p isa. If \p isa is not
+            ///   available on the host, the portable implementation is returned.
+            scanner const & get_scanner (scan_isa isa) noexcept;
+
+            /// \returns The scanning functions for the best instruction set supported by the host.
+            scanner const & best_scanner () noexcept;
+
+        } // end namespace details
+    }     // end namespace json
+} // end namespace pstore
+
+#endif // PSTORE_JSON_SCAN_HPP
@@ -168,7 +168,11 @@ namespace pstore {
             std::size_t size () const final { return b_.size (); }
             container<internal_fixup> ifixups () const final { return {}; }
             container<external_fixup> xfixups () const final { return {}; }
-            container<std::uint8_t> payload () const final { return {}; }
+            container<std::uint8_t> payload (database const &,
+                                             std::shared_ptr<std::uint8_t const> *,
+                                             payload_cache *) const final {
+                return {};
+            }
 
         private:
             bss_section const & b_;
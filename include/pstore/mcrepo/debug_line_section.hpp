@@ -46,16 +46,30 @@ namespace pstore {
                     , header_{header_extent}
                     , g_{src.data_range, src.ifixups_range, src.xfixups_range, align} {}
 
+            /// Constructs a section whose payload is held at \p payload rather than by the
+            /// section itself. See the corresponding generic_section constructor.
+            template <typename IFixupRange, typename XFixupRange>
+            debug_line_section (index::digest const & header_digest,
+                                extent<std::uint8_t> const & header_extent,
+                                extent<std::uint8_t> const & payload, std::uint64_t size,
+                                bool compressed, IFixupRange const & i, XFixupRange const & x,
+                                std::uint8_t align)
+                    : header_digest_{header_digest}
+                    , header_{header_extent}
+                    , g_{payload, size, compressed, i, x, align} {}
 
             index::digest const & header_digest () const noexcept { return header_digest_; }
             extent<std::uint8_t> const & header_extent () const noexcept { return header_; }
             generic_section const & generic () const noexcept { return g_; }
 
             unsigned align () const noexcept { return g_.align (); }
-            // \returns The section's data payload.
-            container<std::uint8_t> payload () const { return g_.payload (); }
+            /// Returns the section's data payload, loading it from \p db if it is shared and
+            /// decompressing it if necessary. See repo::load_payload().
+            container<std::uint8_t> payload (database const & db,
+                                             std::shared_ptr<std::uint8_t const> * owner,
+                                             payload_cache * cache = nullptr) const;
             /// \returns The number of bytes in the section's data payload.
-            std::size_t size () const noexcept { return this->payload ().size (); }
+            std::size_t size () const noexcept { return static_cast<std::size_t> (g_.size ()); }
             container<internal_fixup> ifixups () const { return g_.ifixups (); }
             container<external_fixup> xfixups () const { return g_.xfixups (); }
 
@@ -76,6 +90,13 @@ namespace pstore {
                 return size_bytes (src.data_range, src.ifixups_range, src.xfixups_range);
             }
 
+            template <typename IFixupRange, typename XFixupRange>
+            static std::size_t size_bytes (extent<std::uint8_t> const & payload,
+                                           IFixupRange const & i, XFixupRange const & x) {
+                return offsetof (debug_line_section, g_) +
+                       generic_section::size_bytes (payload, i, x);
+            }
+
         private:
             index::digest header_digest_;
             extent<std::uint8_t> header_;
@@ -114,6 +135,19 @@ namespace pstore {
             debug_line_section_creation_dispatcher &
             operator= (debug_line_section_creation_dispatcher const &) = delete;
 
+            section_content const * content () const noexcept { return section_; }
+
+            /// Causes the section to refer to the copy of its payload given by \p payload rather
+            /// than carrying its own copy of the content's data bytes.
+            /// \see generic_section_creation_dispatcher::set_shared_payload().
+            void set_shared_payload (extent<std::uint8_t> const & payload,
+                                     bool const compressed = false) noexcept {
+                PSTORE_ASSERT (section_ != nullptr &&
+                               (compressed || payload.size == section_->data.size ()));
+                shared_payload_ = payload;
+                compressed_payload_ = compressed;
+            }
+
             std::size_t size_bytes () const override;
 
             // Write the section data to the memory pointed to by \p out.
@@ -125,6 +159,9 @@ namespace pstore {
             index::digest header_digest_;
             extent<std::uint8_t> header_;
             section_content const * const section_;
+            /// If not null, the shared payload to which the section will refer.
+            extent<std::uint8_t> shared_payload_;
+            bool compressed_payload_ = false;
         };
 
         template <>
@@ -143,7 +180,11 @@ namespace pstore {
             std::size_t size () const final { return d_.size (); }
             container<internal_fixup> ifixups () const final { return d_.ifixups (); }
             container<external_fixup> xfixups () const final { return d_.xfixups (); }
-            container<std::uint8_t> payload () const final { return d_.payload (); }
+            container<std::uint8_t> payload (database const & db,
+                                             std::shared_ptr<std::uint8_t const> * owner,
+                                             payload_cache * cache) const final {
+                return d_.payload (db, owner, cache);
+            }
 
         private:
             debug_line_section const & d_;
@@ -346,7 +346,7 @@ case section_kind::k: name = #k; break;
         }
 
         // populate [private, static]
-        // ~~~~~~~~
+        // ~~~~~~~~~~~~~~~~~~~~~~~~~~
         template <typename Iterator>
         void fragment::populate (void * const ptr, Iterator const first, Iterator const last) {
             // Construct the basic fragment structure into this memory.
@@ -411,7 +411,7 @@ case section_kind::k: name = #k; break;
         }
 
         // load
-        // ~~~~~
+        // ~~~~
         inline auto fragment::load (transaction_base & transaction,
                                     pstore::extent<fragment> const & location)
             -> std::shared_ptr<fragment> {
@@ -452,7 +452,7 @@ case section_kind::k: name = #k; break;
         }
 
         // size bytes [static]
-        // ~~~~~~~~~~
+        // ~~~~~~~~~~~~~~~~~~~
         template <typename Iterator>
         std::size_t fragment::size_bytes (Iterator first, Iterator last) {
             fragment::check_range_is_sorted (first, last);
@@ -488,8 +488,21 @@ case section_kind::k: name = #k; break;
         /// Returns the xfixups of the given section type in the given fragment.
         container<external_fixup> section_xfixups (fragment const & fragment, section_kind kind);
 
-        /// Returns the section content of the given section type in the given fragment.
-        container<std::uint8_t> section_value (fragment const & fragment, section_kind kind);
+        /// Returns the section content of the given section type in the given fragment. A shared
+        /// payload is loaded from \p db and decompressed if necessary (see load_payload()).
+        ///
+        /// \param db  The database containing the fragment.
+        /// \param fragment  The fragment containing the section.
+        /// \param kind  The kind of the section whose content is to be returned.
+        /// \param owner  If the payload is not held by the section, receives the pointer which
+        ///   keeps it in memory.
+        /// \param cache  If not null, a cache of decompressed payloads.
+        /// \returns The section's payload. The range is valid as long as both \p fragment and
+        ///   \p owner.
+        container<std::uint8_t> section_value (database const & db, fragment const & fragment,
+                                               section_kind kind,
+                                               std::shared_ptr<std::uint8_t const> * owner,
+                                               payload_cache * cache = nullptr);
     } // end namespace repo
 } // end namespace pstore
 
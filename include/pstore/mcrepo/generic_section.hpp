@@ -24,12 +24,14 @@
 #include <cstring>
 
 #include "pstore/adt/small_vector.hpp"
+#include "pstore/config/config.hpp"
 #include "pstore/core/address.hpp"
 #include "pstore/mcrepo/section.hpp"
 #include "pstore/support/aligned.hpp"
 #include "pstore/support/bit_count.hpp"
 #include "pstore/support/bit_field.hpp"
 #include "pstore/support/gsl.hpp"
+#include "pstore/support/varint.hpp"
 
 namespace pstore {
     class indirect_string;
@@ -169,6 +171,307 @@ namespace pstore {
 
         std::ostream & operator<< (std::ostream & os, external_fixup const & xfx);
 
+        namespace details {
+
+            /// Reads a varint from \p *pos and advances \p *pos past it.
+            inline std::uint64_t read_varint (std::uint8_t const ** const pos) noexcept {
+                // Most values fit in a single byte so handle that case inline.
+                std::uint8_t const first = **pos;
+                if ((first & 1U) != 0U) {
+                    ++*pos;
+                    return first >> 1U;
+                }
+                unsigned const size = varint::decode_size (*pos);
+                std::uint64_t const result = varint::decode (*pos, size);
+                *pos += size;
+                return result;
+            }
+
+            /// Reads a varint from \p *pos and advances \p *pos past it. \p last is the end of the
+            /// buffer: if at least eight bytes remain, a multi-byte value is read with a single
+            /// load rather than a byte at a time.
+            inline std::uint64_t read_varint (std::uint8_t const ** const pos,
+                                              std::uint8_t const * const last) noexcept {
+#ifndef PSTORE_IS_BIG_ENDIAN
+                std::uint8_t const first = **pos;
+                if ((first & 1U) == 0U && last - *pos >= 8) {
+                    unsigned const size = varint::decode_size (*pos);
+                    if (size < 9U) {
+                        std::uint64_t v;
+                        std::memcpy (&v, *pos, sizeof (v));
+                        *pos += size;
+                        // Discard the bytes beyond the end of the varint and then the size bits.
+                        unsigned const unused = 64U - 8U * size;
+                        return (v << unused) >> (unused + size);
+                    }
+                }
+#else
+                (void) last;
+#endif
+                return read_varint (pos);
+            }
+
+            /// Fixups are stored as a sequence of variable-length records. Offsets (and, for
+            /// external fixups, names) are delta-encoded against the preceding record so that,
+            /// in the usual case, each varint occupies a single byte. The encoding of an internal
+            /// fixup is:
+            ///
+            /// - One byte holding the target section kind in the low 7 bits. The top bit is set
+            ///   if the addend is non-zero.
+            /// - One byte holding the relocation type.
+            /// - The zig-zag encoded difference between the fixup offset and that of the
+            ///   previous fixup as a varint.
+            /// - If the addend is non-zero, its zig-zag encoded value as a varint.
+            ///
+            /// An external fixup is:
+            ///
+            /// - A flags byte: bit 0 is set for a weak reference, bit 1 if the addend is non-zero.
+            /// - One byte holding the relocation type.
+            /// - The zig-zag encoded difference between the name address and that of the previous
+            ///   fixup as a varint.
+            /// - The zig-zag encoded offset difference as a varint.
+            /// - If the addend is non-zero, its zig-zag encoded value as a varint.
+            template <typename Fixup>
+            struct fixup_codec;
+
+            template <>
+            struct fixup_codec<internal_fixup> {
+                static constexpr auto has_addend = std::uint8_t{0x80};
+                PSTORE_STATIC_ASSERT (num_section_kinds < has_addend);
+
+                /// The state carried from one record to the next.
+                struct state {
+                    std::uint64_t offset = 0;
+                };
+
+                static std::size_t size (internal_fixup const & ifx, state * const st) noexcept {
+                    return 2U + varint::encoded_size (delta (ifx.offset, &st->offset)) +
+                           (ifx.addend != 0
+                                ? varint::encoded_size (varint::zigzag_encode (ifx.addend))
+                                : 0U);
+                }
+
+                static std::uint8_t * encode (internal_fixup const & ifx, state * const st,
+                                              std::uint8_t * out) noexcept {
+                    *(out++) = static_cast<std::uint8_t> (
+                        static_cast<std::uint8_t> (ifx.section) |
+                        (ifx.addend != 0 ? has_addend : std::uint8_t{0}));
+                    *(out++) = ifx.type;
+                    out = varint::encode (delta (ifx.offset, &st->offset), out);
+                    if (ifx.addend != 0) {
+                        out = varint::encode (varint::zigzag_encode (ifx.addend), out);
+                    }
+                    return out;
+                }
+
+                static internal_fixup decode (std::uint8_t const ** const pos,
+                                              std::uint8_t const * const last,
+                                              state * const st) noexcept {
+                    std::uint8_t const lead = *((*pos)++);
+                    relocation_type const type = *((*pos)++);
+                    st->offset += static_cast<std::uint64_t> (
+                        varint::zigzag_decode (read_varint (pos, last)));
+                    std::int64_t const addend =
+                        (lead & has_addend) != 0U
+                            ? varint::zigzag_decode (read_varint (pos, last))
+                            : 0;
+                    return {static_cast<section_kind> (lead & ~has_addend), type, st->offset,
+                            addend};
+                }
+
+                /// Returns the zig-zag encoded difference between \p v and \p *prev and updates
+                /// \p *prev.
+                static std::uint64_t delta (std::uint64_t const v,
+                                            std::uint64_t * const prev) noexcept {
+                    auto const result =
+                        varint::zigzag_encode (static_cast<std::int64_t> (v - *prev));
+                    *prev = v;
+                    return result;
+                }
+            };
+
+            template <>
+            struct fixup_codec<external_fixup> {
+                static constexpr auto is_weak = std::uint8_t{0x01};
+                static constexpr auto has_addend = std::uint8_t{0x02};
+
+                /// The state carried from one record to the next.
+                struct state {
+                    std::uint64_t name = 0;
+                    std::uint64_t offset = 0;
+                };
+
+                static std::size_t size (external_fixup const & xfx, state * const st) noexcept {
+                    return 2U + varint::encoded_size (delta (xfx.name.absolute (), &st->name)) +
+                           varint::encoded_size (delta (xfx.offset, &st->offset)) +
+                           (xfx.addend != 0
+                                ? varint::encoded_size (varint::zigzag_encode (xfx.addend))
+                                : 0U);
+                }
+
+                static std::uint8_t * encode (external_fixup const & xfx, state * const st,
+                                              std::uint8_t * out) noexcept {
+                    *(out++) = static_cast<std::uint8_t> (
+                        (xfx.is_weak ? is_weak : std::uint8_t{0}) |
+                        (xfx.addend != 0 ? has_addend : std::uint8_t{0}));
+                    *(out++) = xfx.type;
+                    out = varint::encode (delta (xfx.name.absolute (), &st->name), out);
+                    out = varint::encode (delta (xfx.offset, &st->offset), out);
+                    if (xfx.addend != 0) {
+                        out = varint::encode (varint::zigzag_encode (xfx.addend), out);
+                    }
+                    return out;
+                }
+
+                static external_fixup decode (std::uint8_t const ** const pos,
+                                              std::uint8_t const * const last,
+                                              state * const st) noexcept {
+                    std::uint8_t const flags = *((*pos)++);
+                    relocation_type const type = *((*pos)++);
+                    st->name += static_cast<std::uint64_t> (
+                        varint::zigzag_decode (read_varint (pos, last)));
+                    st->offset += static_cast<std::uint64_t> (
+                        varint::zigzag_decode (read_varint (pos, last)));
+                    std::int64_t const addend =
+                        (flags & has_addend) != 0U
+                            ? varint::zigzag_decode (read_varint (pos, last))
+                            : 0;
+                    return {typed_address<indirect_string>::make (st->name), type,
+                            (flags & is_weak) != 0U ? binding::weak : binding::strong, st->offset,
+                            addend};
+                }
+
+                static std::uint64_t delta (std::uint64_t const v,
+                                            std::uint64_t * const prev) noexcept {
+                    return fixup_codec<internal_fixup>::delta (v, prev);
+                }
+            };
+
+            //*                _          _              _        _               *
+            //*  _ __  __ _ __| |_____ __| |  __ ___ _ _| |_ __ _(_)_ _  ___ _ _  *
+            //* | '_ \/ _` / _| / / -_) _` | / _/ _ \ ' \  _/ _` | | ' \/ -_) '_| *
+            //* | .__/\__,_\__|_\_\___\__,_| \__\___/_||_\__\__,_|_|_||_\___|_|   *
+            //* |_|                                                               *
+            /// A range of packed fixup records. The records are decoded one at a time as the
+            /// range is iterated so no memory is allocated.
+            template <typename Fixup>
+            class packed_container {
+                using codec = fixup_codec<Fixup>;
+
+            public:
+                class const_iterator {
+                public:
+                    using iterator_category = std::input_iterator_tag;
+                    using value_type = Fixup;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = Fixup const *;
+                    using reference = Fixup;
+
+                    /// Constructs an iterator referring to the record at \p pos.
+                    const_iterator (std::uint8_t const * const pos,
+                                    std::uint8_t const * const last) noexcept
+                            : pos_{pos}
+                            , next_{pos}
+                            , last_{last} {
+                        this->decode ();
+                    }
+
+                    bool operator== (const_iterator const & rhs) const noexcept {
+                        return pos_ == rhs.pos_;
+                    }
+                    bool operator!= (const_iterator const & rhs) const noexcept {
+                        return !operator== (rhs);
+                    }
+
+                    Fixup operator* () const noexcept { return value_; }
+                    Fixup const * operator-> () const noexcept { return &value_; }
+
+                    const_iterator & operator++ () noexcept {
+                        pos_ = next_;
+                        this->decode ();
+                        return *this;
+                    }
+                    const_iterator operator++ (int) noexcept {
+                        auto const prev = *this;
+                        ++(*this);
+                        return prev;
+                    }
+
+                private:
+                    void decode () noexcept {
+                        PSTORE_ASSERT (pos_ <= last_);
+                        if (pos_ != last_) {
+                            value_ = codec::decode (&next_, last_, &state_);
+                        }
+                    }
+
+                    std::uint8_t const * pos_;
+                    std::uint8_t const * next_;
+                    std::uint8_t const * last_;
+                    typename codec::state state_;
+                    Fixup value_ = empty_value ();
+                };
+
+                using value_type = Fixup const;
+                using size_type = std::size_t;
+                using difference_type = std::ptrdiff_t;
+                using reference = Fixup;
+                using const_reference = reference;
+                using iterator = const_iterator;
+
+                packed_container () noexcept = default;
+                packed_container (std::uint8_t const * const first, std::uint8_t const * const last,
+                                  size_type const size) noexcept
+                        : first_{first}
+                        , last_{last}
+                        , size_{size} {
+                    PSTORE_ASSERT (last >= first);
+                }
+
+                iterator begin () const noexcept { return {first_, last_}; }
+                iterator end () const noexcept { return {last_, last_}; }
+                const_iterator cbegin () const noexcept { return begin (); }
+                const_iterator cend () const noexcept { return end (); }
+
+                size_type size () const noexcept { return size_; }
+                bool empty () const noexcept { return size_ == 0U; }
+
+                /// The number of bytes occupied by the packed records.
+                size_type size_bytes () const noexcept {
+                    return static_cast<size_type> (last_ - first_);
+                }
+
+            private:
+                static Fixup empty_value () noexcept;
+
+                std::uint8_t const * first_ = nullptr;
+                std::uint8_t const * last_ = nullptr;
+                size_type size_ = 0;
+            };
+
+            template <>
+            inline internal_fixup packed_container<internal_fixup>::empty_value () noexcept {
+                return {section_kind::text, relocation_type{0}, std::uint64_t{0}, std::int64_t{0}};
+            }
+            template <>
+            inline external_fixup packed_container<external_fixup>::empty_value () noexcept {
+                return {typed_address<indirect_string>::null (), relocation_type{0},
+                        binding::strong, std::uint64_t{0}, std::int64_t{0}};
+            }
+
+        } // end namespace details
+
+        template <>
+        class container<internal_fixup> : public details::packed_container<internal_fixup> {
+        public:
+            using packed_container::packed_container;
+        };
+        template <>
+        class container<external_fixup> : public details::packed_container<external_fixup> {
+        public:
+            using packed_container::packed_container;
+        };
+
         //*                        _                 _   _           *
         //*  __ _ ___ _ _  ___ _ _(_)__   ___ ___ __| |_(_)___ _ _   *
         //* / _` / -_) ' \/ -_) '_| / _| (_-</ -_) _|  _| / _ \ ' \  *
@@ -207,6 +510,20 @@ namespace pstore {
                     : generic_section (src.data_range, src.ifixups_range, src.xfixups_range,
                                        align) {}
 
+            /// Constructs a section whose payload is held at \p payload rather than by the
+            /// section itself.
+            ///
+            /// \param payload  The stored payload bytes.
+            /// \param size  The number of bytes in the payload once decompressed.
+            /// \param compressed  True if \p payload holds an LZ4 block (see support/lz4.hpp).
+            /// \param i  The internal fixups.
+            /// \param x  The external fixups.
+            /// \param align  The section's alignment.
+            template <typename IFixupRange, typename XFixupRange>
+            generic_section (extent<std::uint8_t> const & payload, std::uint64_t size,
+                             bool compressed, IFixupRange const & i, XFixupRange const & x,
+                             std::uint8_t align);
+
             generic_section (generic_section const &) = delete;
             generic_section (generic_section &&) = delete;
 
@@ -217,17 +534,35 @@ namespace pstore {
             /// The number of data bytes contained by this section.
             std::uint64_t size () const noexcept { return data_size_; }
 
-            container<std::uint8_t> payload () const noexcept {
+            /// Returns true if the section's payload is held elsewhere in the store rather than by
+            /// the section itself. The bytes may be shared with other sections through the payload
+            /// index and may be compressed.
+            bool has_shared_payload () const noexcept { return shared_payload_ != 0U; }
+            /// Returns true if the bytes given by shared_payload() are an LZ4 block which
+            /// decompresses to size() bytes.
+            bool has_compressed_payload () const noexcept { return compressed_payload_ != 0U; }
+            /// Returns the extent of a shared payload.
+            /// \note This function must only be called if has_shared_payload() is true.
+            extent<std::uint8_t> const & shared_payload () const noexcept {
+                PSTORE_ASSERT (this->has_shared_payload ());
+                return *reinterpret_cast<extent<std::uint8_t> const *> (this + 1);
+            }
+
+            /// Returns the payload which immediately follows the section.
+            /// \note This function must only be called if has_shared_payload() is false. Use
+            ///   repo::load_payload() to access a payload which may be shared or compressed.
+            container<std::uint8_t> inline_payload () const noexcept {
+                PSTORE_ASSERT (!this->has_shared_payload ());
                 auto const * const begin = aligned_ptr<std::uint8_t> (this + 1);
                 return {begin, begin + data_size_};
             }
             container<internal_fixup> ifixups () const {
-                auto const * const begin = aligned_ptr<internal_fixup> (payload ().end ());
-                return {begin, begin + this->num_ifixups ()};
+                fixup_area const area = fixups (this->fixups_begin (), this->num_ifixups ());
+                return {area.first, area.second, this->num_ifixups ()};
             }
             container<external_fixup> xfixups () const {
-                auto const * const begin = aligned_ptr<external_fixup> (ifixups ().end ());
-                return {begin, begin + num_xfixups_};
+                fixup_area const area = this->xfixup_area ();
+                return {area.first, area.second, num_xfixups_};
             }
 
             ///@{
@@ -237,11 +572,6 @@ namespace pstore {
             /// \returns The number of bytes occupied by this fragment section.
             std::size_t size_bytes () const;
 
-            /// \returns The number of bytes needed to accommodate a fragment section with
-            /// the given number of data bytes and fixups.
-            static std::size_t size_bytes (std::size_t data_size, std::size_t num_ifixups,
-                                           std::size_t num_xfixups);
-
             template <typename DataRange, typename IFixupRange, typename XFixupRange>
             static std::size_t size_bytes (DataRange const & d, IFixupRange const & i,
                                            XFixupRange const & x);
@@ -251,6 +581,10 @@ namespace pstore {
             size_bytes (sources<DataRange, IFixupRange, XFixupRange> const & src) {
                 return size_bytes (src.data_range, src.ifixups_range, src.xfixups_range);
             }
+
+            template <typename IFixupRange, typename XFixupRange>
+            static std::size_t size_bytes (extent<std::uint8_t> const & payload,
+                                           IFixupRange const & i, XFixupRange const & x);
             ///@}
 
         private:
@@ -271,13 +605,18 @@ namespace pstore {
                 std::uint32_t field32_ = 0;
                 /// The alignment of this section expressed as a power of two (i.e. 8 byte
                 /// alignment is expressed as an align_ value of 3).
-                bit_field<std::uint32_t, 0, 8> align_;
+                bit_field<std::uint32_t, 0, 7> align_;
+                /// Set if the section refers to a shared payload (see has_shared_payload()).
+                bit_field<std::uint32_t, 7, 1> shared_payload_;
+                /// Set if the shared payload is compressed (see has_compressed_payload()).
+                bit_field<std::uint32_t, 8, 1> compressed_payload_;
                 /// The number of internal fixups.
-                bit_field<std::uint32_t, 8, 24> num_ifixups_;
+                bit_field<std::uint32_t, 9, 23> num_ifixups_;
             };
             /// The number of external fixups in this section.
             std::uint32_t num_xfixups_ = 0;
-            /// The number of data bytes contained by this section.
+            /// The number of data bytes contained by this section. If the payload is compressed,
+            /// this is its size once decompressed.
             std::uint64_t data_size_ = 0;
 
             std::uint32_t num_ifixups () const noexcept;
@@ -288,18 +627,67 @@ namespace pstore {
                       typename = typename std::enable_if<std::is_unsigned<IntType>::value>::type>
             static IntType set_size (Iterator first, Iterator last);
 
-            /// Calculates the size of a region in the section including any necessary
-            /// preceeding alignment bytes.
-            /// \param pos  The starting offset within the section.
-            /// \param num  The number of instance of type Ty.
-            /// \returns Number of bytes occupied by the elements.
-            template <typename Ty>
-            static inline std::size_t part_size_bytes (std::size_t pos, std::size_t const num) {
-                if (num > 0) {
-                    pos = aligned<Ty> (pos) + num * sizeof (Ty);
+            // Each non-empty fixup array is stored as a varint giving the number of bytes
+            // occupied by its records followed by the packed records themselves (see
+            // details::fixup_codec<>).
+
+            using fixup_area = std::pair<std::uint8_t const *, std::uint8_t const *>;
+
+            /// \param pos  The start of a packed fixup array.
+            /// \param num  The number of fixups in the array.
+            /// \returns The range of bytes occupied by the array's records.
+            static fixup_area fixups (std::uint8_t const * pos, std::size_t const num) noexcept {
+                if (num == 0U) {
+                    return {pos, pos};
+                }
+                auto const bytes = static_cast<std::size_t> (details::read_varint (&pos));
+                return {pos, pos + bytes};
+            }
+            /// Returns the address of the first of the fixup arrays. These follow the section's
+            /// payload or, if the payload is shared, its extent.
+            std::uint8_t const * fixups_begin () const noexcept {
+                if (this->has_shared_payload ()) {
+                    return reinterpret_cast<std::uint8_t const *> (&this->shared_payload () + 1);
                 }
-                return pos;
+                return this->inline_payload ().end ();
+            }
+            fixup_area xfixup_area () const noexcept {
+                return fixups (fixups (this->fixups_begin (), this->num_ifixups ()).second,
+                               num_xfixups_);
             }
+
+            /// Writes the internal and external fixup arrays given by \p i and \p x to \p p.
+            /// \returns The address past the end of the fixup arrays.
+            template <typename IFixupRange, typename XFixupRange>
+            std::uint8_t * write_fixup_arrays (std::uint8_t * p, IFixupRange const & i,
+                                               XFixupRange const & x);
+            /// \returns The number of bytes occupied by the fixup arrays given by \p i and \p x.
+            template <typename IFixupRange, typename XFixupRange>
+            static std::size_t fixup_arrays_size (IFixupRange const & i, XFixupRange const & x) {
+                return packed_size (i.first, set_size<std::uint32_t> (i.first, i.second)) +
+                       packed_size (x.first, set_size<std::uint32_t> (x.first, x.second));
+            }
+
+            /// \returns The number of bytes occupied by the records for the \p num fixups
+            /// starting at \p first.
+            template <typename Iterator>
+            static std::size_t records_size (Iterator first, std::size_t num);
+            /// \returns The number of bytes occupied by a packed array of the \p num fixups
+            /// starting at \p first (including its length prefix).
+            template <typename Iterator>
+            static std::size_t packed_size (Iterator const first, std::size_t const num) {
+                if (num == 0U) {
+                    return 0U;
+                }
+                std::size_t const bytes = records_size (first, num);
+                return varint::encoded_size (bytes) + bytes;
+            }
+
+            /// Writes a packed array of the \p num fixups starting at \p first to \p out.
+            /// \returns The address past the end of the packed data.
+            template <typename Iterator>
+            static std::uint8_t * write_fixups (Iterator first, std::size_t num,
+                                                std::uint8_t * out);
         };
 
         // (ctor)
@@ -333,20 +721,56 @@ namespace pstore {
                 data_size_ = generic_section::set_size<decltype (data_size_)> (d.first, d.second);
                 p = std::uninitialized_copy (d.first, d.second, p);
             }
+            p = this->write_fixup_arrays (p, i, x);
+            PSTORE_ASSERT (p >= start &&
+                           static_cast<std::size_t> (p - start) == size_bytes (d, i, x));
+        }
+
+        template <typename IFixupRange, typename XFixupRange>
+        generic_section::generic_section (extent<std::uint8_t> const & payload,
+                                          std::uint64_t const size, bool const compressed,
+                                          IFixupRange const & i, XFixupRange const & x,
+                                          std::uint8_t const align) {
+            PSTORE_ASSERT (bit_count::pop_count (align) == 1);
+            PSTORE_ASSERT (compressed || payload.size == size);
+            align_ = bit_count::ctz (align);
+            shared_payload_ = 1U;
+            compressed_payload_ = compressed ? 1U : 0U;
+            num_ifixups_ = std::uint32_t{0};
+            data_size_ = size;
+#ifndef NDEBUG
+            auto * const start = reinterpret_cast<std::uint8_t const *> (this);
+#endif
+            // Note that the memory pointed to by 'p' is uninitialized.
+            auto * p = reinterpret_cast<std::uint8_t *> (this + 1);
+            PSTORE_STATIC_ASSERT (sizeof (generic_section) % alignof (extent<std::uint8_t>) == 0);
+            new (p) extent<std::uint8_t> (payload);
+            p += sizeof (extent<std::uint8_t>);
+            p = this->write_fixup_arrays (p, i, x);
+            PSTORE_ASSERT (p >= start &&
+                           static_cast<std::size_t> (p - start) == size_bytes (payload, i, x));
+        }
+
+        // write fixup arrays
+        // ~~~~~~~~~~~~~~~~~~
+        template <typename IFixupRange, typename XFixupRange>
+        std::uint8_t * generic_section::write_fixup_arrays (std::uint8_t * p,
+                                                            IFixupRange const & i,
+                                                            XFixupRange const & x) {
             if (i.first != i.second) {
-                p = reinterpret_cast<std::uint8_t *> (
-                    std::uninitialized_copy (i.first, i.second, aligned_ptr<internal_fixup> (p)));
-                num_ifixups_ = generic_section::set_size<decltype (num_ifixups_)::value_type> (
-                    i.first, i.second);
+                auto const num =
+                    generic_section::set_size<decltype (num_ifixups_)::value_type> (i.first,
+                                                                                    i.second);
+                PSTORE_ASSERT (num <= decltype (num_ifixups_)::max ());
+                num_ifixups_ = num;
+                p = generic_section::write_fixups (i.first, num, p);
             }
             if (x.first != x.second) {
-                p = reinterpret_cast<std::uint8_t *> (
-                    std::uninitialized_copy (x.first, x.second, aligned_ptr<external_fixup> (p)));
                 num_xfixups_ =
                     generic_section::set_size<decltype (num_xfixups_)> (x.first, x.second);
+                p = generic_section::write_fixups (x.first, num_xfixups_, p);
             }
-            PSTORE_ASSERT (p >= start &&
-                           static_cast<std::size_t> (p - start) == size_bytes (d, i, x));
+            return p;
         }
 
         // set_size
@@ -365,18 +789,49 @@ namespace pstore {
                           static_cast<common> (std::numeric_limits<IntType>::max ())));
         }
 
+        // records size
+        // ~~~~~~~~~~~~
+        template <typename Iterator>
+        std::size_t generic_section::records_size (Iterator first, std::size_t num) {
+            using fixup = typename std::iterator_traits<Iterator>::value_type;
+            typename details::fixup_codec<fixup>::state st;
+            auto bytes = std::size_t{0};
+            for (; num > 0U; --num, ++first) {
+                bytes += details::fixup_codec<fixup>::size (*first, &st);
+            }
+            return bytes;
+        }
+
+        // write fixups
+        // ~~~~~~~~~~~~
+        template <typename Iterator>
+        std::uint8_t * generic_section::write_fixups (Iterator first, std::size_t const num,
+                                                      std::uint8_t * out) {
+            using fixup = typename std::iterator_traits<Iterator>::value_type;
+            out = varint::encode (records_size (first, num), out);
+            typename details::fixup_codec<fixup>::state st;
+            for (auto n = num; n > 0U; --n, ++first) {
+                out = details::fixup_codec<fixup>::encode (*first, &st, out);
+            }
+            return out;
+        }
+
         // size_bytes
         // ~~~~~~~~~~
         template <typename DataRange, typename IFixupRange, typename XFixupRange>
         std::size_t generic_section::size_bytes (DataRange const & d, IFixupRange const & i,
                                                  XFixupRange const & x) {
             auto const data_size = std::distance (d.first, d.second);
-            auto const num_ifixups = std::distance (i.first, i.second);
-            auto const num_xfixups = std::distance (x.first, x.second);
-            PSTORE_ASSERT (data_size >= 0 && num_ifixups >= 0 && num_xfixups >= 0);
-            return size_bytes (static_cast<std::size_t> (data_size),
-                               static_cast<std::size_t> (num_ifixups),
-                               static_cast<std::size_t> (num_xfixups));
+            PSTORE_ASSERT (data_size >= 0);
+            return sizeof (generic_section) + static_cast<std::size_t> (data_size) +
+                   fixup_arrays_size (i, x);
+        }
+
+        template <typename IFixupRange, typename XFixupRange>
+        std::size_t generic_section::size_bytes (extent<std::uint8_t> const & /*payload*/,
+                                                 IFixupRange const & i, XFixupRange const & x) {
+            return sizeof (generic_section) + sizeof (extent<std::uint8_t>) +
+                   fixup_arrays_size (i, x);
         }
 
         // num_ifixups
@@ -460,6 +915,20 @@ namespace pstore {
             void set_content (gsl::not_null<section_content const *> const content) {
                 section_ = content;
             }
+            section_content const * content () const noexcept { return section_; }
+
+            /// Causes the section to refer to the copy of its payload given by \p payload rather
+            /// than carrying its own copy of the content's data bytes.
+            ///
+            /// \param payload  The stored payload.
+            /// \param compressed  True if \p payload is the LZ4-compressed form of the data.
+            void set_shared_payload (extent<std::uint8_t> const & payload,
+                                     bool const compressed = false) noexcept {
+                PSTORE_ASSERT (section_ != nullptr &&
+                               (compressed || payload.size == section_->data.size ()));
+                shared_payload_ = payload;
+                compressed_payload_ = compressed;
+            }
 
             std::size_t size_bytes () const final;
 
@@ -469,6 +938,9 @@ namespace pstore {
         private:
             std::uintptr_t aligned_impl (std::uintptr_t in) const final;
             section_content const * section_ = nullptr;
+            /// If not null, the shared payload to which the section will refer.
+            extent<std::uint8_t> shared_payload_;
+            bool compressed_payload_ = false;
         };
 
         template <>
@@ -492,7 +964,9 @@ namespace pstore {
             std::size_t size () const final { return s_.size (); }
             container<internal_fixup> ifixups () const final { return s_.ifixups (); }
             container<external_fixup> xfixups () const final { return s_.xfixups (); }
-            container<std::uint8_t> payload () const final { return s_.payload (); }
+            container<std::uint8_t> payload (database const & db,
+                                             std::shared_ptr<std::uint8_t const> * owner,
+                                             payload_cache * cache) const final;
 
         private:
             generic_section const & s_;
@@ -26,7 +26,7 @@
 #define PSTORE_MCREPO_LINKED_DEFINITIONS_SECTION_HPP
 
 #include "pstore/mcrepo/compilation.hpp"
-#include "pstore/mcrepo/section.hpp"
+#include "pstore/mcrepo/generic_section.hpp"
 #include "pstore/support/inherit_const.hpp"
 
 namespace pstore {
@@ -253,7 +253,11 @@ namespace pstore {
             std::size_t size () const final { error (); }
             container<internal_fixup> ifixups () const final { error (); }
             container<external_fixup> xfixups () const final { error (); }
-            container<std::uint8_t> payload () const final { error (); }
+            container<std::uint8_t> payload (database const &,
+                                             std::shared_ptr<std::uint8_t const> *,
+                                             payload_cache *) const final {
+                error ();
+            }
 
         private:
             PSTORE_NO_RETURN void error () const;
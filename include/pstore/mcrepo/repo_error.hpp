@@ -31,6 +31,7 @@ namespace pstore {
             bad_compilation_record,
             too_many_members_in_compilation,
             bss_section_too_large,
+            bad_compressed_payload,
         };
 
         class error_category final : public std::error_category {
@@ -20,11 +20,14 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iosfwd>
+#include <memory>
 #include <type_traits>
 
 #include "pstore/support/assert.hpp"
 
 namespace pstore {
+    class database;
+
     namespace repo {
 
 #define PSTORE_MCREPO_SECTION_KINDS                                                                \
@@ -188,6 +191,14 @@ namespace pstore {
 
         struct internal_fixup;
         struct external_fixup;
+        class payload_cache;
+
+        // The fixup arrays are stored in a packed form. Their containers are specialized to
+        // decode the records on the fly (see generic_section.hpp).
+        template <>
+        class container<internal_fixup>;
+        template <>
+        class container<external_fixup>;
 
         /// This class is used to add virtual methods to a fragment's section. The section types
         /// themselves cannot be virtual because they're written to disk and wouldn't be portable
@@ -204,7 +215,14 @@ namespace pstore {
             virtual container<external_fixup> xfixups () const = 0;
             /// Return the data section stored in the object file. For example, the bss section has
             /// empty data section.
-            virtual container<std::uint8_t> payload () const = 0;
+            ///
+            /// \param db  The database containing the section.
+            /// \param owner  If the payload is not held by the section, receives the pointer which
+            ///   keeps it in memory.
+            /// \param cache  If not null, a cache of decompressed payloads.
+            virtual container<std::uint8_t> payload (database const & db,
+                                                     std::shared_ptr<std::uint8_t const> * owner,
+                                                     payload_cache * cache) const = 0;
         };
 
 
@@ -0,0 +1,212 @@
+//===- include/pstore/mcrepo/shared_payload.hpp -----------*- mode: C++ -*-===//
+//*      _                        _                     _                 _  *
+//*  ___| |__   __ _ _ __ ___  __| |  _ __   __ _ _   _| | ___   __ _  __| | *
+//* / __| '_ \ / _` | '__/ _ \/ _` | | '_ \ / _` | | | | |/ _ \ / _` |/ _` | *
+//* \__ \ | | | (_| | | |  __/ (_| | | |_) | (_| | |_| | | (_) | (_| | (_| | *
+//* |___/_| |_|\__,_|_|  \___|\__,_| | .__/ \__,_|\__, |_|\___/ \__,_|\__,_| *
+//*                                  |_|          |___/                      *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file shared_payload.hpp
+/// \brief Content-addressed and compressed storage for section payloads.
+///
+/// Identical section payloads often appear in many fragments: for example, template
+/// instantiations whose code is the same but whose debug information differs. Rather than each
+/// fragment carrying its own copy of the bytes, a generic section may refer to a single shared
+/// copy which is recorded in the payload index under a hash of its contents.
+///
+/// Payloads which are held outside of their section may also be compressed using the LZ4 block
+/// format. This is most effective for the debug sections which dominate the size of a typical
+/// repository. A compressed payload is only decoded when it is requested by load_payload(); the
+/// sections of a fragment which are not compressed continue to be read in place.
+
+#ifndef PSTORE_MCREPO_SHARED_PAYLOAD_HPP
+#define PSTORE_MCREPO_SHARED_PAYLOAD_HPP
+
+#include <bitset>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "pstore/mcrepo/debug_line_section.hpp"
+#include "pstore/mcrepo/fragment.hpp"
+
+namespace pstore {
+    namespace repo {
+
+        /// Returns the set of section kinds whose payloads are compressed by default: the debug
+        /// sections.
+        std::bitset<num_section_kinds> default_compressed_kinds () noexcept;
+
+        /// Controls which section payloads are stored outside of their section.
+        struct payload_options {
+            /// Payloads of at least this number of bytes are stored once and shared between
+            /// fragments. Zero disables sharing.
+            std::size_t share_threshold = 0U;
+            /// Payloads of at least this number of bytes whose section kind is a member of
+            /// compress_kinds are compressed. Zero disables compression.
+            std::size_t compress_threshold = 0U;
+            std::bitset<num_section_kinds> compress_kinds = default_compressed_kinds ();
+
+            bool share (std::size_t const size) const noexcept {
+                return share_threshold > 0U && size >= share_threshold;
+            }
+            bool compress (section_kind const kind, std::size_t const size) const noexcept {
+                return compress_threshold > 0U && size >= compress_threshold &&
+                       compress_kinds.test (static_cast<std::size_t> (kind));
+            }
+            /// Returns true if any payload could be stored outside of its section.
+            bool enabled () const noexcept {
+                return share_threshold > 0U || compress_threshold > 0U;
+            }
+        };
+
+        /// Returns the key under which the payload [\p first, \p last) is recorded in the payload
+        /// index.
+        index::digest payload_digest (std::uint8_t const * first,
+                                      std::uint8_t const * last) noexcept;
+
+        /// Returns the shared copy of the payload [\p first, \p last), adding it to the payload
+        /// index if it is not already present.
+        ///
+        /// \param transaction  The transaction to which a new copy of the payload is added.
+        /// \param first  The start of the payload bytes.
+        /// \param last  The end of the payload bytes.
+        /// \returns The extent of the shared payload or a null extent if a different payload is
+        ///   already recorded under the same key. In that case the caller should store the payload
+        ///   inline.
+        extent<std::uint8_t> intern_payload (transaction_base & transaction,
+                                             std::uint8_t const * first,
+                                             std::uint8_t const * last);
+
+        /// If the section built by \p d may hold its payload outside of the section, returns the
+        /// section's content; otherwise nullptr.
+        section_content const * payload_content (section_creation_dispatcher const & d) noexcept;
+
+        /// The compressed form of a section's payload or an empty vector if the payload is not
+        /// to be compressed.
+        using packed_payload = std::vector<std::uint8_t>;
+
+        /// Compresses the payload of the section built by \p d if \p options requires it and
+        /// doing so saves space. This function does not access the store and may be called
+        /// concurrently for different dispatchers.
+        packed_payload compress_payload (section_creation_dispatcher const & d,
+                                         payload_options const & options);
+
+        /// Stores the payload of the section built by \p d outside of the section if \p options
+        /// requires it.
+        ///
+        /// \param transaction  The transaction to which the payload is added.
+        /// \param d  The dispatcher which will build the section.
+        /// \param packed  The result of calling compress_payload() for \p d.
+        /// \param options  Controls which payloads are shared and compressed.
+        void store_payload (transaction_base & transaction, section_creation_dispatcher & d,
+                            packed_payload const & packed, payload_options const & options);
+
+        /// Compresses the payloads of the sections described by the range of section creation
+        /// dispatchers [\p first, \p last).
+        /// \returns One entry for each dispatcher.
+        template <typename Iterator>
+        std::vector<packed_payload> compress_payloads (Iterator first, Iterator last,
+                                                       payload_options const & options) {
+            std::vector<packed_payload> result;
+            for (; first != last; ++first) {
+                result.emplace_back (compress_payload (*first, options));
+            }
+            return result;
+        }
+
+        /// Makes each of the sections described by the range of section creation dispatchers
+        /// [\p first, \p last) refer to a shared and/or compressed copy of its payload if
+        /// \p options requires it. The dispatchers must be passed to fragment::alloc() as part of
+        /// the same transaction.
+        ///
+        /// \param transaction  The transaction to which new payloads are added.
+        /// \param first  The start of a range of section creation dispatchers.
+        /// \param last  The end of a range of section creation dispatchers.
+        /// \param packed  The result of calling compress_payloads() for the same range.
+        /// \param options  Controls which payloads are shared and compressed.
+        template <typename Iterator>
+        void store_payloads (transaction_base & transaction, Iterator first, Iterator const last,
+                             std::vector<packed_payload> const & packed,
+                             payload_options const & options) {
+            auto it = packed.begin ();
+            for (; first != last; ++first, ++it) {
+                PSTORE_ASSERT (it != packed.end ());
+                store_payload (transaction, *first, *it, options);
+            }
+        }
+
+        template <typename Iterator>
+        void store_payloads (transaction_base & transaction, Iterator first, Iterator last,
+                             payload_options const & options) {
+            store_payloads (transaction, first, last, compress_payloads (first, last, options),
+                            options);
+        }
+
+        //*                  _              _              _         *
+        //*  _ __  __ _ _  _| |___  __ _ __| |  __ __ _ __| |_  ___  *
+        //* | '_ \/ _` | || | / _ \/ _` / _` | / _/ _` / _| ' \/ -_) *
+        //* | .__/\__,_|\_, |_\___/\__,_\__,_| \__\__,_\__|_||_\___| *
+        //* |_|         |__/                                         *
+        /// Holds recently decompressed payloads so that a payload shared by many sections is
+        /// decoded once. Instances may be shared between threads.
+        class payload_cache {
+        public:
+            /// \param capacity  The maximum number of decompressed bytes held by the cache.
+            explicit payload_cache (std::size_t capacity) noexcept
+                    : capacity_{capacity} {}
+            payload_cache (payload_cache const &) = delete;
+            payload_cache & operator= (payload_cache const &) = delete;
+
+            /// Returns the decompressed payload stored at \p addr or nullptr if it is not cached.
+            std::shared_ptr<std::uint8_t const> find (address addr);
+            /// Records the decompressed payload stored at \p addr.
+            void insert (address addr, std::shared_ptr<std::uint8_t const> const & data,
+                         std::size_t size);
+
+        private:
+            struct entry {
+                address addr;
+                std::shared_ptr<std::uint8_t const> data;
+                std::size_t size;
+            };
+            using lru_list = std::list<entry>;
+
+            std::size_t const capacity_;
+            std::mutex mut_;
+            std::size_t size_ = 0U;
+            /// The cached payloads, most recently used first.
+            lru_list lru_;
+            std::unordered_map<address, lru_list::iterator> map_;
+        };
+
+        /// Returns the payload of section \p s, loading it from \p db if it is shared and
+        /// decompressing it if necessary.
+        ///
+        /// \param db  The database containing the section.
+        /// \param s  The section whose payload is to be returned.
+        /// \param owner  If the payload is not held by \p s, receives the pointer which keeps it
+        ///   in memory.
+        /// \param cache  If not null, a cache of decompressed payloads.
+        /// \returns The section's payload. The range is valid as long as both \p s and \p owner.
+        container<std::uint8_t> load_payload (database const & db, generic_section const & s,
+                                              std::shared_ptr<std::uint8_t const> * owner,
+                                              payload_cache * cache = nullptr);
+        inline container<std::uint8_t>
+        load_payload (database const & db, debug_line_section const & s,
+                      std::shared_ptr<std::uint8_t const> * const owner,
+                      payload_cache * const cache = nullptr) {
+            return load_payload (db, s.generic (), owner, cache);
+        }
+
+    } // end namespace repo
+} // end namespace pstore
+
+#endif // PSTORE_MCREPO_SHARED_PAYLOAD_HPP
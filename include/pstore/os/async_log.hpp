@@ -0,0 +1,79 @@
+//===- include/pstore/os/async_log.hpp --------------------*- mode: C++ -*-===//
+//*                               _              *
+//*   __ _ ___ _   _ _ __   ___  | | ___   __ _  *
+//*  / _` / __| | | | '_ \ / __| | |/ _ \ / _` | *
+//* | (_| \__ \ |_| | | | | (__  | | (_) | (_| | *
+//*  \__,_|___/\__, |_| |_|\___| |_|\___/ \__, | *
+//*            |___/                      |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file async_log.hpp
+/// \brief A logger which hands messages to a dedicated writer thread.
+///
+/// Each thread which logs through an async_logger owns a fixed-size single-producer,
+/// single-consumer ring of messages. Adding a message to the ring takes no lock; a single
+/// process-wide writer thread drains the rings and passes each message to the wrapped logger's
+/// log_deferred() member function. This means that slow operations such as writing to a file
+/// (and rotating it) happen away from the threads doing the logging.
+///
+/// If a thread logs faster than the writer can keep up, its ring fills and further messages from
+/// that thread are dropped (and counted) until space becomes available. The number of dropped
+/// messages is reported to the logger with the next message which is written.
+
+#ifndef PSTORE_OS_ASYNC_LOG_HPP
+#define PSTORE_OS_ASYNC_LOG_HPP
+
+#include <cstdint>
+#include <memory>
+
+#include "pstore/os/logging.hpp"
+
+namespace pstore {
+
+    /// The number of messages which may be waiting in each thread's ring.
+    constexpr std::size_t async_log_ring_size = 1024;
+
+    //*                         _                         *
+    //*  __ _ ____  _ _ _  __  | |___  __ _ __ _ ___ _ _  *
+    //* / _` (_-< || | ' \/ _| | / _ \/ _` / _` / -_) '_| *
+    //* \__,_/__/\_, |_||_\__| |_\___/\__, \__, \___|_|   *
+    //*          |__/                 |___/|___/          *
+    class async_logger final : public logger {
+    public:
+        /// \param sink  The logger to which messages are written by the writer thread.
+        explicit async_logger (std::unique_ptr<logger> sink);
+        async_logger (async_logger const &) = delete;
+        async_logger (async_logger &&) noexcept = delete;
+
+        /// Waits for the messages which have been sent to this logger to be written.
+        ~async_logger () noexcept override;
+
+        async_logger & operator= (async_logger const &) = delete;
+        async_logger & operator= (async_logger &&) noexcept = delete;
+
+        using logger::log;
+        void log (priority p, std::string const & message) override;
+
+        logger & sink () noexcept { return *sink_; }
+
+    private:
+        std::unique_ptr<logger> sink_;
+    };
+
+    /// Blocks until all of the messages which have been sent to any async_logger have been
+    /// written.
+    void flush_async_log ();
+
+    /// Returns the total number of messages which have been dropped because a thread's ring was
+    /// full.
+    std::uint64_t async_log_dropped () noexcept;
+
+} // end namespace pstore
+
+#endif // PSTORE_OS_ASYNC_LOG_HPP
@@ -18,6 +18,7 @@
 #ifndef PSTORE_OS_LOGGING_HPP
 #define PSTORE_OS_LOGGING_HPP
 
+#include <ctime>
 #include <fstream>
 #include <mutex>
 
@@ -84,6 +85,17 @@ namespace pstore {
                 this->log (p, message, d.c_str ());
             }
 
+            /// Writes a message which was logged earlier, possibly by a different thread. This
+            /// is used by async_logger's writer thread.
+            ///
+            /// \param p  The message priority.
+            /// \param time  The time at which the message was logged.
+            /// \param thread_name  The name of the thread which logged the message.
+            /// \param message  The message text.
+            virtual void log_deferred (priority p, std::time_t time,
+                                       std::string const & thread_name,
+                                       std::string const & message);
+
         private:
             template <typename T>
             static std::string to_string (gsl::czstring const message, T const t) {
@@ -112,9 +124,13 @@ namespace pstore {
 
             using logger::log;
             void log (priority p, std::string const & message) final;
+            void log_deferred (priority p, std::time_t time, std::string const & thread_name,
+                               std::string const & message) final;
 
         private:
             virtual void log_impl (std::string const & message) = 0;
+            void write (priority p, std::time_t time, std::string const & thread_name,
+                        std::string const & message);
 
             static std::mutex mutex_;
             std::string thread_name_ = get_current_thread_name ();
@@ -192,6 +208,11 @@ namespace pstore {
 
         void create_log_stream (std::string const & ident);
 
+        /// Controls whether the loggers subsequently created by create_log_stream() are wrapped in
+        /// an async_logger so that messages are written by a dedicated thread.
+        void set_async_logging (bool enabled) noexcept;
+        bool async_logging () noexcept;
+
 
         namespace details {
 
@@ -0,0 +1,111 @@
+//===- include/pstore/os/trace.hpp ------------------------*- mode: C++ -*-===//
+//*  _                       *
+//* | |_ _ __ __ _  ___ ___  *
+//* | __| '__/ _` |/ __/ _ \ *
+//* | |_| | | (_| | (_|  __/ *
+//*  \__|_|  \__,_|\___\___| *
+//*                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file trace.hpp
+/// \brief Records the timing of the phases of store operations as Chrome trace events.
+///
+/// Tracing is off by default. It is enabled either by calling trace::enable() or by setting the
+/// PSTORE_TRACE environment variable to the path of a file. In the latter case, the events are
+/// written to that file (with any "%p" replaced by the process ID) when the process exits. The
+/// output can be loaded by chrome://tracing or https://ui.perfetto.dev.
+///
+/// Event timestamps are taken from the system-wide monotonic clock (CLOCK_MONOTONIC on Linux)
+/// rather than being measured from the start of the process. The per-process files produced by
+/// "%p" can therefore be merged (by concatenating their "traceEvents" arrays) to show, for
+/// example, the broker and its clients on a single time line.
+///
+/// The events are recorded in a fixed-size, per-process ring buffer so that the cost of tracing is
+/// bounded: once the buffer is full, the oldest events are overwritten. When tracing is disabled,
+/// a span costs a single relaxed atomic load.
+
+#ifndef PSTORE_OS_TRACE_HPP
+#define PSTORE_OS_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+#include "pstore/support/gsl.hpp"
+
+namespace pstore {
+    namespace trace {
+
+        using clock = std::chrono::steady_clock;
+
+        /// The maximum number of events retained by the ring buffer.
+        constexpr auto ring_size = std::size_t{1} << 16U;
+
+        namespace details {
+            extern std::atomic<bool> is_enabled;
+        } // end namespace details
+
+        /// Returns true if events are being recorded.
+        inline bool enabled () noexcept {
+            return details::is_enabled.load (std::memory_order_relaxed);
+        }
+        /// Starts or stops the recording of events.
+        void enable (bool on) noexcept;
+
+        /// Records an event named \p name which started at \p start and ended at \p end.
+        ///
+        /// \param name  The event name. This must be a string literal or a string whose lifetime
+        ///   is at least that of the process.
+        /// \param start  The time at which the event started.
+        /// \param end  The time at which the event ended.
+        void record (gsl::czstring name, clock::time_point start, clock::time_point end) noexcept;
+
+        /// Discards all of the recorded events.
+        void clear () noexcept;
+
+        /// Writes the recorded events to \p os in Chrome trace-event JSON format. The output is
+        /// only guaranteed to be consistent if no events are being recorded concurrently.
+        void write_json (std::ostream & os);
+
+        //*                      *
+        //*  ____ __  __ _ _ _   *
+        //* (_-< '_ \/ _` | ' \  *
+        //* /__/ .__/\__,_|_||_| *
+        //*    |_|               *
+        /// Records an event covering the lifetime of an instance. Nothing is recorded if tracing
+        /// was disabled when the instance was constructed.
+        class span {
+        public:
+            explicit span (gsl::czstring const name) noexcept
+                    : name_{enabled () ? name : nullptr} {
+                if (name_ != nullptr) {
+                    start_ = clock::now ();
+                }
+            }
+            span (span const &) = delete;
+            span (span &&) = delete;
+            ~span () noexcept {
+                if (name_ != nullptr) {
+                    record (name_, start_, clock::now ());
+                }
+            }
+
+            span & operator= (span const &) = delete;
+            span & operator= (span &&) = delete;
+
+        private:
+            gsl::czstring const name_;
+            clock::time_point start_;
+        };
+
+    } // end namespace trace
+} // end namespace pstore
+
+#endif // PSTORE_OS_TRACE_HPP
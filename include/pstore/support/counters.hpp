@@ -0,0 +1,187 @@
+//===- include/pstore/support/counters.hpp ----------------*- mode: C++ -*-===//
+//*                        _                 *
+//*   ___ ___  _   _ _ __ | |_ ___ _ __ ___  *
+//*  / __/ _ \| | | | '_ \| __/ _ \ '__/ __| *
+//* | (_| (_) | |_| | | | | ||  __/ |  \__ \ *
+//*  \___\___/ \__,_|_| |_|\__\___|_|  |___/ *
+//*                                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file counters.hpp
+/// \brief Lightweight counters and histograms for instrumenting hot paths.
+///
+/// Each thread increments its own copy of the counters so that recording an event needs neither
+/// a lock nor an atomic read-modify-write instruction. read() sums the values of all of the
+/// threads (including those which have exited).
+///
+/// The PSTORE_COUNT(), PSTORE_COUNT_N(), PSTORE_RECORD() and PSTORE_TIME_SCOPE() macros are used
+/// by library code to record events. Unless pstore is configured with PSTORE_INSTRUMENTATION
+/// enabled, they expand to nothing and have no cost at all.
+
+#ifndef PSTORE_SUPPORT_COUNTERS_HPP
+#define PSTORE_SUPPORT_COUNTERS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "pstore/config/config.hpp"
+#include "pstore/support/bit_count.hpp"
+
+/// The event counters. Each is named after the component and the event which it counts.
+#define PSTORE_COUNTERS                                                                            \
+    X (database_get)                                                                               \
+    X (database_get_spanning)                                                                      \
+    X (hamt_find)                                                                                  \
+    X (hamt_find_linear)                                                                           \
+    X (indirect_string_store_read)                                                                 \
+    X (storage_regions_mapped)                                                                     \
+    X (transaction_commit)
+
+/// The histograms. Each records values in power-of-two buckets.
+#define PSTORE_HISTOGRAMS X (transaction_commit_ns)
+
+namespace pstore {
+    namespace counters {
+
+#define X(a) a,
+        enum class counter : unsigned { PSTORE_COUNTERS last };
+        enum class histogram : unsigned { PSTORE_HISTOGRAMS last };
+#undef X
+
+        constexpr auto num_counters = static_cast<std::size_t> (counter::last);
+        constexpr auto num_histograms = static_cast<std::size_t> (histogram::last);
+        /// The number of buckets in each histogram. Bucket 0 records the value 0; bucket n
+        /// records values in the range [2^(n-1), 2^n).
+        constexpr auto histogram_buckets = std::size_t{65};
+
+        /// Returns true if the library was configured with the instrumentation macros enabled.
+        constexpr bool enabled () noexcept {
+#ifdef PSTORE_INSTRUMENTATION
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        char const * name (counter c) noexcept;
+        char const * name (histogram h) noexcept;
+
+        /// Returns the histogram bucket in which \p value is recorded.
+        inline std::size_t bucket (std::uint64_t const value) noexcept {
+            return value == 0U ? 0U : std::size_t{64} - bit_count::clz (value);
+        }
+
+        namespace details {
+
+            //*  _   _                    _                   _               *
+            //* | |_| |_  _ _ ___ __ _ __| |  __ ___ _  _ _ _| |_ ___ _ _ ___ *
+            //* |  _| ' \| '_/ -_) _` / _` | / _/ _ \ || | ' \  _/ -_) '_(_-< *
+            //*  \__|_||_|_| \___\__,_\__,_| \__\___/\_,_|_||_\__\___|_| /__/ *
+            //*                                                               *
+            /// The counters belonging to a single thread. They are only written by the owning
+            /// thread: the values are atomic so that they may be safely read by another.
+            struct thread_counters {
+                std::array<std::atomic<std::uint64_t>, num_counters> counters{};
+                std::array<std::array<std::atomic<std::uint64_t>, histogram_buckets>,
+                           num_histograms>
+                    histograms{};
+            };
+
+            /// Returns the calling thread's counters.
+            thread_counters & local ();
+
+            /// Adds \p n to \p v. Only the owning thread writes to \p v, so the increment does
+            /// not need to be atomic.
+            inline void bump (std::atomic<std::uint64_t> & v, std::uint64_t const n) noexcept {
+                v.store (v.load (std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+        } // end namespace details
+
+        /// Adds \p n to counter \p c.
+        inline void add (counter const c, std::uint64_t const n = 1U) {
+            details::bump (details::local ().counters[static_cast<std::size_t> (c)], n);
+        }
+
+        /// Records \p value in histogram \p h.
+        inline void record (histogram const h, std::uint64_t const value) {
+            details::bump (
+                details::local ().histograms[static_cast<std::size_t> (h)][bucket (value)], 1U);
+        }
+
+        /// The totals of all of the counters and histograms at an instant.
+        struct snapshot {
+            std::array<std::uint64_t, num_counters> counters{};
+            std::array<std::array<std::uint64_t, histogram_buckets>, num_histograms> histograms{};
+
+            std::uint64_t operator[] (counter const c) const noexcept {
+                return counters[static_cast<std::size_t> (c)];
+            }
+            std::array<std::uint64_t, histogram_buckets> const &
+            operator[] (histogram const h) const noexcept {
+                return histograms[static_cast<std::size_t> (h)];
+            }
+        };
+
+        /// Returns the totals of the counters of all threads.
+        snapshot read ();
+
+        /// Returns \p s as a JSON object. Each counter is a member whose value is a number; each
+        /// histogram is a member whose value is an object mapping the lower bound of each
+        /// non-empty bucket to its count.
+        std::string to_json (snapshot const & s);
+
+
+        //*                          _   _   _                *
+        //*  ___ __ ___ _ __  ___ __| | | |_(_)_ __  ___ _ _  *
+        //* (_-</ _/ _ \ '_ \/ -_) _` | |  _| | '  \/ -_) '_| *
+        //* /__/\__\___/ .__/\___\__,_|  \__|_|_|_|_\___|_|   *
+        //*            |_|                                    *
+        /// Records the lifetime of an instance (in nanoseconds) in a histogram.
+        class scoped_timer {
+        public:
+            explicit scoped_timer (histogram const h) noexcept
+                    : h_{h} {}
+            scoped_timer (scoped_timer const &) = delete;
+            scoped_timer (scoped_timer &&) = delete;
+            ~scoped_timer () noexcept {
+                record (h_, static_cast<std::uint64_t> (
+                                std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                    std::chrono::steady_clock::now () - start_)
+                                    .count ()));
+            }
+
+            scoped_timer & operator= (scoped_timer const &) = delete;
+            scoped_timer & operator= (scoped_timer &&) = delete;
+
+        private:
+            histogram const h_;
+            std::chrono::steady_clock::time_point const start_ = std::chrono::steady_clock::now ();
+        };
+
+    } // end namespace counters
+} // end namespace pstore
+
+#ifdef PSTORE_INSTRUMENTATION
+#    define PSTORE_COUNT(c) (pstore::counters::add (pstore::counters::counter::c))
+#    define PSTORE_COUNT_N(c, n) (pstore::counters::add (pstore::counters::counter::c, (n)))
+#    define PSTORE_RECORD(h, v) (pstore::counters::record (pstore::counters::histogram::h, (v)))
+#    define PSTORE_TIME_SCOPE(h)                                                                  \
+        pstore::counters::scoped_timer const pstore_timer_##h{pstore::counters::histogram::h}
+#else
+#    define PSTORE_COUNT(c) ((void) 0)
+#    define PSTORE_COUNT_N(c, n) ((void) 0)
+#    define PSTORE_RECORD(h, v) ((void) 0)
+#    define PSTORE_TIME_SCOPE(h) ((void) 0)
+#endif // PSTORE_INSTRUMENTATION
+
+#endif // PSTORE_SUPPORT_COUNTERS_HPP
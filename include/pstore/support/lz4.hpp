@@ -0,0 +1,75 @@
+//===- include/pstore/support/lz4.hpp ---------------------*- mode: C++ -*-===//
+//*  _     _  _    *
+//* | |___| || |   *
+//* | |_  / || |_  *
+//* | |/ /|__   _| *
+//* |_/___|  |_|   *
+//*                *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file lz4.hpp
+/// \brief A compressor and decompressor for the LZ4 block format.
+///
+/// LZ4 trades compression ratio for speed: decompression in particular runs at a large fraction
+/// of memory bandwidth. The data is encoded as a series of sequences, each of which consists of a
+/// run of literal bytes followed by a match: a copy of earlier output given by an offset and
+/// length.
+///
+///     +-------+------------------+----------+--------+-----------------+
+///     | token | [literal length] | literals | offset | [match length]  |
+///     +-------+------------------+----------+--------+-----------------+
+///
+/// The high four bits of the token hold the number of literals and the low four bits the match
+/// length less four (the minimum match length). A value of 15 in either field indicates that
+/// further length bytes follow: each is added to the length until one is less than 255. The
+/// offset is a two-byte little-endian value. The final sequence has only literals.
+///
+/// This implementation only supports the block format: there is no frame header or checksum. The
+/// caller must record both the compressed and original sizes.
+
+#ifndef PSTORE_SUPPORT_LZ4_HPP
+#define PSTORE_SUPPORT_LZ4_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pstore {
+    namespace lz4 {
+
+        /// Returns the maximum number of bytes that compress() will produce for an input of
+        /// \p size bytes.
+        constexpr std::size_t compress_bound (std::size_t const size) noexcept {
+            return size + size / 255U + 16U;
+        }
+
+        /// Compresses the bytes [\p src, \p src + \p size).
+        ///
+        /// \param src  The start of the data to be compressed.
+        /// \param size  The number of bytes to be compressed.
+        /// \param dst  The buffer to which the compressed data is written. Must be at least
+        ///   compress_bound(size) bytes long.
+        /// \returns The number of bytes written to \p dst.
+        std::size_t compress (std::uint8_t const * src, std::size_t size,
+                              std::uint8_t * dst) noexcept;
+
+        /// Decompresses an LZ4 block.
+        ///
+        /// \param src  The start of the compressed data.
+        /// \param src_size  The number of bytes of compressed data.
+        /// \param dst  The buffer to which the original data is written.
+        /// \param dst_size  The size of the original data.
+        /// \returns True if the data was successfully decompressed and exactly filled \p dst. False
+        ///   if the compressed data was malformed.
+        bool decompress (std::uint8_t const * src, std::size_t src_size, std::uint8_t * dst,
+                         std::size_t dst_size) noexcept;
+
+    } // end namespace lz4
+} // end namespace pstore
+
+#endif // PSTORE_SUPPORT_LZ4_HPP
@@ -14,77 +14,143 @@
 //
 //===----------------------------------------------------------------------===//
 
+/// \file parallel_for_each.hpp
+/// \brief A parallel version of std::for_each() which runs on a thread_pool.
+
 #ifndef PSTORE_SUPPORT_PARALLEL_FOR_EACH_HPP
 #define PSTORE_SUPPORT_PARALLEL_FOR_EACH_HPP
 
 #include <algorithm>
-#include <future>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <vector>
 
-#include "pstore/support/assert.hpp"
+#include "pstore/support/portab.hpp"
+#include "pstore/support/thread_pool.hpp"
 
 namespace pstore {
 
+    namespace details {
+
+        /// The state shared by the threads taking part in a call to parallel_for_each().
+        struct parallel_loop {
+            explicit parallel_loop (std::size_t const chunks) noexcept
+                    : num_chunks{chunks} {}
+
+            std::size_t const num_chunks;
+            /// The index of the next chunk to be claimed.
+            std::atomic<std::size_t> next{0};
+            /// The number of chunks that have been processed or skipped.
+            std::atomic<std::size_t> completed{0};
+            /// Set once a chunk has raised an exception. Chunks claimed after this are skipped.
+            std::atomic<bool> failed{false};
+
+            std::mutex mut;
+            std::condition_variable cv;
+            /// The first exception raised by a chunk. Guarded by mut.
+            std::exception_ptr error;
+        };
+
+    } // end namespace details
+
+    /// Calls \p fn for each element in the range [\p first, \p last) using the calling thread
+    /// together with the workers of \p pool. The range is divided into chunks which the threads
+    /// claim one at a time so that a thread which meets a run of expensive elements does not hold
+    /// up the others. If \p fn raises an exception, the remaining chunks are skipped and the first
+    /// exception is rethrown once the threads have finished.
+    ///
+    /// \tparam InputIt  An iterator type. The range is traversed more than once.
+    /// \tparam UnaryFunction  A function compatible with void(value_type const &). It may be
+    ///   called concurrently from multiple threads.
     template <typename InputIt, typename UnaryFunction>
-    void parallel_for_each (InputIt first, InputIt last, UnaryFunction fn) {
-        auto it_distance = std::distance (first, last);
-        if (it_distance <= 0) {
+    void parallel_for_each (thread_pool & pool, InputIt first, InputIt last, UnaryFunction fn) {
+        using difference_type = typename std::iterator_traits<InputIt>::difference_type;
+        using value_type = typename std::iterator_traits<InputIt>::value_type;
+
+        auto const distance = std::distance (first, last);
+        if (distance <= 0) {
             return;
         }
+        auto const num_elements = static_cast<std::size_t> (distance);
+        constexpr auto chunks_per_thread = std::size_t{32};
+
+        // Aim for many chunks per thread: enough to even out skewed per-element costs whilst
+        // keeping the cost of claiming a chunk (a single atomic increment) small in comparison
+        // with the work that it holds.
+        std::size_t const participants = std::size_t{pool.size ()} + 1U;
+        std::size_t const chunk_size =
+            std::max (num_elements / (participants * chunks_per_thread), std::size_t{1});
+
+        // Chunk i is the range [bounds[i], bounds[i + 1]).
+        std::vector<InputIt> bounds;
+        bounds.reserve (num_elements / chunk_size + 2U);
+        for (auto remaining = num_elements;;) {
+            bounds.push_back (first);
+            if (remaining == 0U) {
+                break;
+            }
+            auto const step = std::min (remaining, chunk_size);
+            std::advance (first, static_cast<difference_type> (step));
+            remaining -= step;
+        }
 
-        using difference_type = typename std::iterator_traits<InputIt>::difference_type;
-        using udifference_type = typename std::make_unsigned<difference_type>::type;
-        using wide_type =
-            typename std::conditional<sizeof (udifference_type) >= sizeof (unsigned int),
-                                      udifference_type, unsigned int>::type;
-        auto num_elements = static_cast<wide_type> (it_distance);
-
-        auto const num_threads =
-            std::min (static_cast<wide_type> (std::max (std::thread::hardware_concurrency (), 1U)),
-                      num_elements);
-
-        // The number of work items to be processed by each worker thread.
-        auto const partition_size = (num_elements + num_threads - 1) / num_threads;
-        PSTORE_ASSERT (partition_size * num_threads >= num_elements);
-
-        // TODO: use small_vector<>.
-        std::vector<std::future<void>> futures;
-        futures.reserve (num_threads);
-
-        while (first != last) {
-            wide_type const distance = std::min (partition_size, num_elements);
-            auto next = first;
-            PSTORE_ASSERT (distance >= 0 &&
-                           distance < static_cast<udifference_type> (
-                                          std::numeric_limits<difference_type>::max ()));
-
-            std::advance (next, static_cast<difference_type> (distance));
-            using value_type = typename std::iterator_traits<InputIt>::value_type;
-
-            // Create an asynchronous task which will sequentially process from 'first' to
-            // 'next' invoking f() for each data member.
-            auto per_thread_fn = [&fn] (InputIt fst, InputIt lst) {
-                std::for_each (fst, lst, [&fn] (value_type const & v) { fn (v); });
-            };
-            futures.emplace_back (std::async (std::launch::async, per_thread_fn, first, next));
-
-            first = next;
-            PSTORE_ASSERT (num_elements >= distance);
-            num_elements -= distance;
+        auto const loop = std::make_shared<details::parallel_loop> (bounds.size () - 1U);
+
+        // Processes chunks until none remain. A worker may not start running this function until
+        // after parallel_for_each() has returned, so it must not touch 'bounds' or 'fn' unless it
+        // has successfully claimed a chunk.
+        auto const run = [&bounds, &fn] (details::parallel_loop & l) {
+            for (;;) {
+                std::size_t const chunk = l.next.fetch_add (1U);
+                if (chunk >= l.num_chunks) {
+                    return;
+                }
+                if (!l.failed.load ()) {
+                    PSTORE_TRY {
+                        std::for_each (bounds[chunk], bounds[chunk + 1U],
+                                       [&fn] (value_type const & v) { fn (v); });
+                    }
+                    // clang-format off
+                    PSTORE_CATCH (..., { // clang-format on
+                        std::lock_guard<std::mutex> const lock{l.mut};
+                        if (!l.error) {
+                            l.error = std::current_exception ();
+                        }
+                        l.failed = true;
+                    })
+                }
+                if (l.completed.fetch_add (1U) + 1U == l.num_chunks) {
+                    std::lock_guard<std::mutex> const lock{l.mut};
+                    l.cv.notify_all ();
+                }
+            }
+        };
+
+        auto const helpers = std::min (std::size_t{pool.size ()}, loop->num_chunks - 1U);
+        for (auto ctr = std::size_t{0}; ctr < helpers; ++ctr) {
+            pool.submit ([loop, run] { run (*loop); });
         }
-        PSTORE_ASSERT (num_elements == 0 && futures.size () <= num_threads);
-
-        // Join
-        for (auto & f : futures) {
-            PSTORE_ASSERT (f.valid ());
-            // Note that future::get<> is normally used to retreive the future's result, but
-            // here I'm calling it to ensure that an exception stored in the future's state is
-            // raised.
-            f.get ();
+        run (*loop);
+
+        // Wait for any chunks claimed by the workers to be completed.
+        std::unique_lock<std::mutex> lock{loop->mut};
+        loop->cv.wait (lock, [&loop] { return loop->completed.load () == loop->num_chunks; });
+        if (loop->error) {
+            std::rethrow_exception (loop->error);
         }
     }
 
+    /// Calls \p fn for each element in the range [\p first, \p last) using the process-wide
+    /// thread pool (thread_pool::global()).
+    template <typename InputIt, typename UnaryFunction>
+    void parallel_for_each (InputIt first, InputIt last, UnaryFunction fn) {
+        parallel_for_each (thread_pool::global (), first, last, std::move (fn));
+    }
+
 } // namespace pstore
 
 #endif // PSTORE_SUPPORT_PARALLEL_FOR_EACH_HPP
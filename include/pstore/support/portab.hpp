@@ -85,6 +85,13 @@ namespace pstore {
 #    define PSTORE_UNLIKELY(expr) (expr)
 #endif
 
+/// A macro which is a wrapper around __builtin_prefetch(): a hint that the cache line containing
+/// \p addr will shortly be read. Has no effect if the compiler does not provide the intrinsic.
+#if __has_builtin(__builtin_prefetch) || defined(__GNUC__)
+#    define PSTORE_PREFETCH(addr) __builtin_prefetch ((addr))
+#else
+#    define PSTORE_PREFETCH(addr) static_cast<void> (addr)
+#endif
 
 // Specifies that the function does not return.
 #if __has_cpp_attribute(noreturn)
@@ -0,0 +1,100 @@
+//===- include/pstore/support/thread_pool.hpp -------------*- mode: C++ -*-===//
+//*  _   _                        _                     _  *
+//* | |_| |__  _ __ ___  __ _  __| |  _ __   ___   ___ | | *
+//* | __| '_ \| '__/ _ \/ _` |/ _` | | '_ \ / _ \ / _ \| | *
+//* | |_| | | | | |  __/ (_| | (_| | | |_) | (_) | (_) | | *
+//*  \__|_| |_|_|  \___|\__,_|\__,_| | .__/ \___/ \___/|_| *
+//*                                  |_|                   *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file thread_pool.hpp
+/// \brief A persistent pool of worker threads which share work by stealing.
+///
+/// Each worker owns a queue of tasks. A task submitted by a worker is added to the back of that
+/// worker's own queue and the worker takes its next task from the same end; a worker whose queue
+/// is empty steals from the front of the queue belonging to one of its peers. Tasks submitted by
+/// other threads are shared between the queues in turn.
+
+#ifndef PSTORE_SUPPORT_THREAD_POOL_HPP
+#define PSTORE_SUPPORT_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pstore {
+
+    //*  _   _                    _                  _  *
+    //* | |_| |_  _ _ ___ __ _ __| |  _ __  ___  ___| | *
+    //* |  _| ' \| '_/ -_) _` / _` | | '_ \/ _ \/ _ \ | *
+    //*  \__|_||_|_| \___\__,_\__,_| | .__/\___/\___/_| *
+    //*                              |_|                *
+    class thread_pool {
+    public:
+        using task = std::function<void ()>;
+
+        /// \param workers  The number of worker threads. Must be at least 1.
+        explicit thread_pool (unsigned workers);
+        thread_pool (thread_pool const &) = delete;
+        thread_pool (thread_pool &&) noexcept = delete;
+
+        /// Waits for all of the tasks that have been submitted to complete before stopping the
+        /// worker threads.
+        ~thread_pool () noexcept;
+
+        thread_pool & operator= (thread_pool const &) = delete;
+        thread_pool & operator= (thread_pool &&) noexcept = delete;
+
+        /// Returns a process-wide pool with one fewer worker than the number of hardware threads
+        /// (but at least one). Parallel algorithms use the calling thread alongside the workers
+        /// so that the machine is fully occupied. The pool is created on first use.
+        static thread_pool & global ();
+
+        /// Returns the number of worker threads.
+        unsigned size () const noexcept { return static_cast<unsigned> (threads_.size ()); }
+
+        /// Queues a task to be run by one of the workers. Tasks must not throw: an exception
+        /// which escapes from a task terminates the process.
+        void submit (task && t);
+
+    private:
+        struct queue {
+            std::mutex mut;
+            std::deque<task> tasks;
+        };
+
+        /// Removes a task from the back of queue \p self or, if that is empty, from the front of
+        /// one of the other workers' queues.
+        bool pop (std::size_t self, task * const out);
+
+        void worker (std::size_t self);
+
+        std::vector<std::unique_ptr<queue>> queues_;
+        std::vector<std::thread> threads_;
+
+        /// The number of tasks in the queues. May be briefly negative if a task is taken before
+        /// the increment performed by submit() is visible.
+        std::atomic<std::ptrdiff_t> queued_{0};
+        /// The queue to which the next task submitted by a thread outside the pool is added.
+        std::atomic<std::size_t> next_queue_{0};
+
+        std::mutex mut_;
+        std::condition_variable cv_;
+        bool done_ = false;
+    };
+
+} // end namespace pstore
+
+#endif // PSTORE_SUPPORT_THREAD_POOL_HPP
@@ -130,6 +130,8 @@ namespace pstore {
         public:
             auto get (std::uint8_t byte) noexcept -> maybe<char32_t>;
             auto is_well_formed () const noexcept -> bool { return well_formed_; }
+            /// \returns True if the decoder is not part-way through a multi-byte sequence.
+            auto is_code_point_boundary () const noexcept -> bool { return state_ == accept; }
 
         private:
             enum state { accept, reject };
@@ -160,6 +160,17 @@ namespace pstore {
             return decode (in, decode_size (in));
         }
 
+        /// Maps a signed value to an unsigned value such that numbers with a small magnitude have
+        /// a small varint encoding. (0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, ...)
+        constexpr std::uint64_t zigzag_encode (std::int64_t const v) noexcept {
+            return (static_cast<std::uint64_t> (v) << 1U) ^
+                   (v < 0 ? ~std::uint64_t{0} : std::uint64_t{0});
+        }
+        /// The inverse of zigzag_encode().
+        constexpr std::int64_t zigzag_decode (std::uint64_t const v) noexcept {
+            return static_cast<std::int64_t> ((v >> 1U) ^ (~(v & 1U) + 1U));
+        }
+
     } // end namespace varint
 } // end namespace pstore
 
@@ -20,7 +20,10 @@
 #ifndef VACUUM_COPY_HPP
 #define VACUUM_COPY_HPP (1)
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 
 namespace pstore {
     class database;
@@ -30,6 +33,26 @@ namespace vacuum {
     struct user_options;
     void copy (std::shared_ptr<pstore::database> source, status * const st,
                user_options const & opt);
+
+    enum class copy_result {
+        complete,  ///< The live data was copied to the destination store.
+        abandoned, ///< The copy was abandoned by the caller.
+        no_index,  ///< The source store has no names index.
+    };
+
+    /// Called by copy_live() after each entry is copied with the number of bytes in that entry.
+    /// Returns true if the copy should be abandoned.
+    using copy_progress = std::function<bool (std::uint64_t)>;
+
+    /// Copies the live data in \p source (that is, the data reachable from its names index) to
+    /// a new store at \p destination_path.
+    ///
+    /// \param source  The store to be copied.
+    /// \param destination_path  The path of the store to which the data is copied.
+    /// \param progress  Called after each entry is copied. If it returns true, the copy is
+    ///   abandoned and the destination left empty.
+    copy_result copy_live (pstore::database const & source, std::string const & destination_path,
+                           copy_progress const & progress);
 } // namespace vacuum
 
 #endif // VACUUM_COPY_HPP
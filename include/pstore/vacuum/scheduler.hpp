@@ -0,0 +1,225 @@
+//===- include/pstore/vacuum/scheduler.hpp ----------------*- mode: C++ -*-===//
+//*           _              _       _            *
+//*  ___  ___| |__   ___  __| |_   _| | ___ _ __  *
+//* / __|/ __| '_ \ / _ \/ _` | | | | |/ _ \ '__| *
+//* \__ \ (__| | | |  __/ (_| | |_| | |  __/ |    *
+//* |___/\___|_| |_|\___|\__,_|\__,_|_|\___|_|    *
+//*                                               *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file scheduler.hpp
+/// \brief Vacuums many stores from a single process.
+///
+/// Rather than running a separate vacuumd process for each store, a scheduler keeps a table of
+/// the stores which have asked to be vacuumed together with a bounded pool of worker threads. A
+/// store becomes a candidate for collection once it has been left alone for the "quiet period".
+/// Whenever a worker is free, it collects the candidate with the highest priority: the store's
+/// estimated reclaimable bytes weighted by the time since it was last vacuumed. All of the
+/// workers share a single throttle which limits the rate at which they copy data.
+
+#ifndef PSTORE_VACUUM_SCHEDULER_HPP
+#define PSTORE_VACUUM_SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pstore/vacuum/status.hpp"
+
+namespace vacuum {
+
+    //*  _   _            _   _   _      *
+    //* | |_| |_  _ _ ___| |_| |_| |___  *
+    //* |  _| ' \| '_/ _ \  _|  _| / -_) *
+    //*  \__|_||_|_| \___/\__|\__|_\___| *
+    //*                                  *
+    /// Limits the rate at which a group of threads may consume a resource (such as disk bandwidth).
+    class throttle {
+    public:
+        /// \param bytes_per_second  The maximum rate. Zero means that the rate is unlimited.
+        explicit throttle (std::uint64_t bytes_per_second = 0U) noexcept
+                : rate_{bytes_per_second} {}
+
+        void set_rate (std::uint64_t bytes_per_second) noexcept;
+        std::uint64_t rate () const noexcept;
+
+        /// Blocks the calling thread until \p bytes may be consumed without the total rate
+        /// exceeding the limit.
+        void consume (std::uint64_t bytes);
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        mutable std::mutex mut_;
+        std::uint64_t rate_;
+        /// The time at which the budget consumed so far will have been paid off.
+        clock::time_point next_;
+    };
+
+    enum class collect_result {
+        complete,  ///< The store was vacuumed.
+        busy,      ///< The store is open in another process.
+        modified,  ///< The store was opened or modified during collection.
+        cancelled, ///< Collection was cancelled.
+        failed,    ///< Collection failed (the reason is logged).
+    };
+
+    /// Vacuums the store at \p path in the calling thread. The data copied is paced by \p limit.
+    /// The collection is abandoned if \p cancel becomes true or if the store is opened or modified
+    /// by another process.
+    collect_result collect (std::string const & path, throttle & limit,
+                            std::atomic<bool> const & cancel);
+
+    struct space_usage {
+        /// The logical size of the store in bytes.
+        std::uint64_t size = 0U;
+        /// The number of bytes that would be recovered by vacuuming the store.
+        std::uint64_t garbage = 0U;
+
+        /// Returns the fraction of the store that is garbage.
+        double ratio () const noexcept {
+            return size == 0U ? 0.0 : static_cast<double> (garbage) / static_cast<double> (size);
+        }
+    };
+
+    /// Reads the size and garbage estimate recorded in the latest trailer of the store at \p path.
+    /// Returns zeros if the store could not be opened.
+    space_usage estimate_space (std::string const & path);
+
+    //*         _           _      _          *
+    //*  ___ __| |_  ___ __| |_  _| |___ _ _  *
+    //* (_-</ _| ' \/ -_) _` | || | / -_) '_| *
+    //* /__/\__|_||_\___\__,_|\_,_|_\___|_|   *
+    //*                                       *
+    class scheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        struct options {
+            /// The maximum number of stores that are vacuumed concurrently.
+            unsigned workers = 2U;
+            /// The total rate (in bytes per second) at which data is copied. Zero is unlimited.
+            std::uint64_t bandwidth = 0U;
+            /// The time for which a store must be left alone before it is vacuumed.
+            std::chrono::seconds quiet_period = initial_delay;
+            /// Requests for stores in which garbage makes up less than this fraction of the total
+            /// size are ignored.
+            double min_garbage_ratio = 0.1;
+        };
+
+        /// The function which vacuums a single store.
+        using collector = std::function<collect_result (std::string const &, throttle &,
+                                                        std::atomic<bool> const &)>;
+        /// Estimates the size of the store at the given path and the space that a collection
+        /// would reclaim.
+        using estimator = std::function<space_usage (std::string const &)>;
+        /// Called whenever a collection finishes.
+        using observer = std::function<void ()>;
+
+        struct store_status {
+            std::string path;
+            /// The most recent estimate of the store's size and garbage.
+            space_usage usage;
+            double priority;
+            /// True if the store is waiting to be collected.
+            bool pending;
+            bool running;
+            /// The number of times the store has been vacuumed.
+            unsigned vacuums;
+        };
+
+        explicit scheduler (options const & opt, collector collect = vacuum::collect,
+                            estimator estimate = estimate_space);
+        scheduler (scheduler const &) = delete;
+        scheduler (scheduler &&) noexcept = delete;
+        ~scheduler () noexcept;
+
+        scheduler & operator= (scheduler const &) = delete;
+        scheduler & operator= (scheduler &&) noexcept = delete;
+
+        /// Records a request to vacuum the store at \p path. The store will be considered for
+        /// collection once it has been left alone for the quiet period.
+        ///
+        /// \returns False if the request was ignored because the store's garbage ratio is below
+        ///   the threshold given by options::min_garbage_ratio.
+        bool request (std::string const & path);
+        /// Forgets any outstanding request for \p path and cancels a collection that is in
+        /// progress.
+        ///
+        /// \returns True if there was a request for \p path.
+        bool cancel (std::string const & path);
+
+        void set_workers (unsigned workers);
+        void set_bandwidth (std::uint64_t const bytes_per_second) {
+            throttle_.set_rate (bytes_per_second);
+        }
+        void set_quiet_period (std::chrono::seconds period);
+        void set_min_garbage_ratio (double ratio);
+        void set_observer (observer obs);
+
+        options get_options () const;
+
+        /// Cancels all work and waits for the worker threads to exit.
+        void stop ();
+
+        /// Returns the state of every store known to the scheduler, highest priority first. A
+        /// store is known from its first accepted request until it is cancelled or a
+        /// collection fails.
+        std::vector<store_status> status () const;
+
+    private:
+        struct entry {
+            /// The time of the most recent request to vacuum this store.
+            clock::time_point last_request;
+            /// The time at which the store was last vacuumed (or first requested).
+            clock::time_point last_vacuum;
+            /// The most recent estimate of the store's size and garbage.
+            space_usage usage;
+            /// True if a request has been received since the last collection began.
+            bool pending = false;
+            bool running = false;
+            unsigned vacuums = 0U;
+            std::shared_ptr<std::atomic<bool>> cancel;
+        };
+        using entry_map = std::map<std::string, entry>;
+
+        static double priority (entry const & e, clock::time_point now);
+
+        /// Returns the highest priority store which is ready to be vacuumed. If there is none,
+        /// returns end() and sets \p wake to the time at which one will become ready.
+        entry_map::iterator choose (clock::time_point now, clock::time_point * wake);
+        void worker (unsigned index);
+        void finished (std::string const & path, collect_result result, space_usage const & usage);
+
+        collector const collect_;
+        estimator const estimate_;
+        throttle throttle_;
+
+        mutable std::mutex mut_;
+        std::condition_variable cv_;
+        entry_map entries_;
+        unsigned workers_;
+        std::chrono::seconds quiet_period_;
+        double min_garbage_ratio_;
+        observer observer_;
+        bool done_ = false;
+        std::vector<std::thread> threads_;
+    };
+
+} // end namespace vacuum
+
+#endif // PSTORE_VACUUM_SCHEDULER_HPP
@@ -124,6 +124,52 @@ namespace pstore {
             });
         }
 
+        // gc cancel
+        // ~~~~~~~~~
+        void command_processor::gc_cancel (brokerface::fifo_path const &,
+                                           broker_command const & c) {
+            cancel_vacuum (c.path);
+        }
+
+        // gc config
+        // ~~~~~~~~~
+        void command_processor::gc_config (brokerface::fifo_path const &,
+                                           broker_command const & c) {
+            std::shared_ptr<vacuum_service> const service = get_vacuum_service ();
+            if (service == nullptr) {
+                this->log ("GCCONFIG ignored: the vacuum service is not enabled");
+                return;
+            }
+            std::istringstream is{c.path};
+            std::string setting;
+            while (is >> setting) {
+                auto const equals = setting.find ('=');
+                if (equals == std::string::npos ||
+                    !service->configure (setting.substr (0, equals), setting.substr (equals + 1))) {
+                    pstore::log (priority::error, "bad vacuum setting:", setting);
+                }
+            }
+            publish_vacuum_status ();
+        }
+
+        // gc status
+        // ~~~~~~~~~
+        void command_processor::gc_status (brokerface::fifo_path const &, broker_command const &) {
+            std::shared_ptr<vacuum_service> const service = get_vacuum_service ();
+            if (service == nullptr) {
+                pstore::log (priority::info, "GC processes running: ", getgc ().size ());
+                return;
+            }
+            pstore::log (priority::info, "Vacuum service: ", service->settings ());
+            for (vacuum_service::store const & s : service->stores ()) {
+                std::ostringstream os;
+                os << s.path << ": size=" << s.size << " garbage=" << s.garbage
+                   << " priority=" << s.priority << " vacuums=" << s.vacuums
+                   << (s.running ? " (running)" : s.pending ? " (pending)" : "");
+                this->log (os.str ().c_str ());
+            }
+        }
+
         // echo
         // ~~~~
         void command_processor::echo (brokerface::fifo_path const &, broker_command const & c) {
@@ -167,9 +213,12 @@ namespace pstore {
             pstore::log (priority::info, str);
         }
 
-        std::array<command_processor::command_entry, 6> const command_processor::commands_{{
+        std::array<command_processor::command_entry, 9> const command_processor::commands_{{
             command_processor::command_entry ("ECHO", &command_processor::echo),
             command_processor::command_entry ("GC", &command_processor::gc),
+            command_processor::command_entry ("GCCANCEL", &command_processor::gc_cancel),
+            command_processor::command_entry ("GCCONFIG", &command_processor::gc_config),
+            command_processor::command_entry ("GCSTATUS", &command_processor::gc_status),
             command_processor::command_entry ("NOP", &command_processor::nop),
             command_processor::command_entry (
                 "SUICIDE", &command_processor::suicide), // initiate the broker shutdown.
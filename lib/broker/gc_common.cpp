@@ -17,6 +17,10 @@
 
 #include "pstore/broker/gc.hpp"
 
+#include <iomanip>
+#include <sstream>
+
+#include "pstore/json/utility.hpp"
 #include "pstore/os/logging.hpp"
 #include "pstore/os/path.hpp"
 #include "pstore/os/process_file_name.hpp"
@@ -118,12 +122,120 @@ namespace pstore {
 
         void gc_process_watch_thread () { getgc ().watcher (); }
 
-        void start_vacuum (std::string const & db_path) { getgc ().start_vacuum (db_path); }
+        //*                                                _         *
+        //* __ ____ _ __ _  _ _  _ _ __    ___ ___ _ ___ _(_)__ ___  *
+        //* \ V / _` / _| || | || | '  \  (_-</ -_) '_\ V / / _/ -_) *
+        //*  \_/\__,_\__|\_,_|\_,_|_|_|_| /__/\___|_|  \_/|_\__\___| *
+        //*                                                          *
+        vacuum_service::~vacuum_service () noexcept = default;
+
+        namespace {
+
+            std::mutex service_mut;
+            std::shared_ptr<vacuum_service> service;
+
+            /// Writes \p str to \p os as a JSON string.
+            void write_json_string (std::ostream & os, std::string const & str) {
+                os << '"';
+                for (char const c : str) {
+                    switch (c) {
+                    case '"': os << "\\\""; break;
+                    case '\\': os << "\\\\"; break;
+                    default:
+                        if (static_cast<unsigned char> (c) < 0x20) {
+                            os << "\\u" << std::hex << std::setw (4) << std::setfill ('0')
+                               << static_cast<unsigned> (c) << std::dec;
+                        } else {
+                            os << c;
+                        }
+                        break;
+                    }
+                }
+                os << '"';
+            }
+
+            std::string vacuum_status_json (vacuum_service const & s) {
+                std::ostringstream os;
+                os << "{ \"settings\": ";
+                write_json_string (os, s.settings ());
+                os << ", \"stores\": [";
+                auto separator = "";
+                for (vacuum_service::store const & st : s.stores ()) {
+                    os << separator << "{ \"path\": ";
+                    write_json_string (os, st.path);
+                    os << ", \"size\": " << st.size << ", \"garbage\": " << st.garbage
+                       << ", \"priority\": " << st.priority
+                       << ", \"pending\": " << (st.pending ? "true" : "false")
+                       << ", \"running\": " << (st.running ? "true" : "false")
+                       << ", \"vacuums\": " << st.vacuums << " }";
+                    separator = ", ";
+                }
+                os << "] }";
+                return os.str ();
+            }
+
+        } // end anonymous namespace
+
+        descriptor_condition_variable vacuum_cv;
+        brokerface::channel<descriptor_condition_variable> vacuum_channel{&vacuum_cv};
+
+        // set vacuum service
+        // ~~~~~~~~~~~~~~~~~~
+        void set_vacuum_service (std::shared_ptr<vacuum_service> const & s) {
+            std::lock_guard<std::mutex> const lock{service_mut};
+            service = s;
+        }
+
+        // get vacuum service
+        // ~~~~~~~~~~~~~~~~~~
+        std::shared_ptr<vacuum_service> get_vacuum_service () {
+            std::lock_guard<std::mutex> const lock{service_mut};
+            return service;
+        }
+
+        // publish vacuum status
+        // ~~~~~~~~~~~~~~~~~~~~~
+        void publish_vacuum_status () {
+            if (std::shared_ptr<vacuum_service> const s = get_vacuum_service ()) {
+                vacuum_channel.publish ([&s] () {
+                    std::string const str = vacuum_status_json (*s);
+                    PSTORE_ASSERT (json::is_valid (str));
+                    return str;
+                });
+            }
+        }
+
+        void start_vacuum (std::string const & db_path) {
+            if (std::shared_ptr<vacuum_service> const s = get_vacuum_service ()) {
+                log (priority::info, "Requesting vacuum of ", logger::quoted{db_path.c_str ()});
+                s->request (db_path);
+                publish_vacuum_status ();
+                return;
+            }
+            getgc ().start_vacuum (db_path);
+        }
+
+        void cancel_vacuum (std::string const & db_path) {
+            if (std::shared_ptr<vacuum_service> const s = get_vacuum_service ()) {
+                if (!s->cancel (db_path)) {
+                    log (priority::info, "No vacuum requested for ",
+                         logger::quoted{db_path.c_str ()});
+                }
+                publish_vacuum_status ();
+                return;
+            }
+            getgc ().stop_vacuum (db_path);
+        }
 
         /// Called when a signal has been recieved which should result in the process shutting.
         /// \note This function is called from the quit-thread rather than directly from a signal
         /// handler so it doesn't need to restrict itself to signal-safe functions.
-        void gc_sigint (int const sig = -1) { getgc ().stop (sig); }
+        void gc_sigint (int const sig = -1) {
+            if (std::shared_ptr<vacuum_service> const s = get_vacuum_service ()) {
+                s->stop ();
+            }
+            getgc ().stop (sig);
+        }
 
     } // end namespace broker
 } // end namespace pstore
@@ -19,8 +19,14 @@
 
 #ifndef _WIN32
 
+// Standard includes
+#    include <array>
+#    include <vector>
+
 // Platform includes
+#    include <poll.h>
 #    include <sys/select.h>
+#    include <sys/socket.h>
 #    include <sys/types.h>
 #    include <sys/uio.h>
 
@@ -30,6 +36,7 @@
 #    include "pstore/broker/message_pool.hpp"
 #    include "pstore/broker/quit.hpp"
 #    include "pstore/broker/recorder.hpp"
+#    include "pstore/brokerface/writer.hpp"
 #    include "pstore/os/logging.hpp"
 
 namespace {
@@ -57,6 +64,147 @@ namespace {
         }
     }
 
+    //*              _       _                     _          *
+    //*  ___ ___  __| |_____| |_   _ _ ___ __ _ __| |___ _ _  *
+    //* (_-</ _ \/ _| / / -_)  _| | '_/ -_) _` / _` / -_) '_| *
+    //* /__/\___/\__|_\_\___|\__| |_| \___\__,_\__,_\___|_|   *
+    //*                                                       *
+    /// Reads batches of messages from the client connections accepted on a shared listening
+    /// socket. Each reader thread owns the connections that it accepts.
+    class socket_reader {
+    public:
+        using message_ptr = pstore::brokerface::message_ptr;
+
+        socket_reader ();
+
+        /// Accepts any pending connection on \p listener.
+        void accept (int listener);
+        /// Reads a record from the connection at \p index and pushes its messages to \p cp.
+        /// Returns false if the connection was closed.
+        bool read (std::size_t index, pstore::broker::command_processor & cp,
+                   pstore::broker::recorder * record_file);
+
+        std::vector<pollfd> & poll_fds () noexcept { return fds_; }
+
+    private:
+        static constexpr auto max_batch = pstore::brokerface::writer::max_batch;
+
+        /// The descriptors passed to poll(). The first is the listening socket; each of the rest
+        /// is a client connection and corresponds to the member of connections_ with the same
+        /// index less 1.
+        std::vector<pollfd> fds_;
+        std::vector<pstore::socket_descriptor> connections_;
+
+        /// The buffers into which a record is scattered. Those which are filled are passed to the
+        /// command processor and replaced with fresh buffers from the pool.
+        std::array<message_ptr, max_batch> buffers_;
+        std::array<iovec, max_batch> iov_;
+    };
+
+    // (ctor)
+    // ~~~~~~
+    socket_reader::socket_reader () {
+        for (auto ctr = std::size_t{0}; ctr < max_batch; ++ctr) {
+            buffers_[ctr] = pstore::broker::pool.get_from_pool ();
+            iov_[ctr] = iovec{buffers_[ctr].get (), sizeof (pstore::brokerface::message_type)};
+        }
+    }
+
+    // accept
+    // ~~~~~~
+    void socket_reader::accept (int const listener) {
+        pstore::socket_descriptor fd{::accept (listener, nullptr, nullptr)};
+        if (!fd.valid ()) {
+            int const err = errno;
+            // Another reader thread may have taken the connection.
+            if (err != EAGAIN && err != EWOULDBLOCK && err != ECONNABORTED && err != EINTR) {
+                raise (pstore::errno_erc{err}, "accept");
+            }
+            return;
+        }
+        fds_.push_back (pollfd{fd.native_handle (), POLLIN, 0});
+        connections_.push_back (std::move (fd));
+    }
+
+    // read
+    // ~~~~
+    bool socket_reader::read (std::size_t const index, pstore::broker::command_processor & cp,
+                              pstore::broker::recorder * const record_file) {
+        msghdr msg{};
+        msg.msg_iov = iov_.data ();
+        msg.msg_iovlen = iov_.size ();
+        ssize_t const bytes_read = ::recvmsg (fds_[index].fd, &msg, 0);
+        if (bytes_read < 0) {
+            int const err = errno;
+            if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) {
+                return true;
+            }
+            if (err != ECONNRESET) {
+                raise (pstore::errno_erc{err}, "recvmsg");
+            }
+        }
+        if (bytes_read <= 0) {
+            // The client closed its connection.
+            fds_.erase (fds_.begin () + static_cast<std::ptrdiff_t> (index));
+            connections_.erase (connections_.begin () + static_cast<std::ptrdiff_t> (index - 1U));
+            return false;
+        }
+
+        constexpr auto message_size = sizeof (pstore::brokerface::message_type);
+        auto const size = static_cast<std::size_t> (bytes_read);
+        if ((msg.msg_flags & MSG_TRUNC) != 0 || size % message_size != 0) {
+            log (priority::error, "Partial message received. Length ", bytes_read);
+        }
+        for (auto ctr = std::size_t{0}, count = size / message_size; ctr < count; ++ctr) {
+            cp.push_command (std::move (buffers_[ctr]), record_file);
+            buffers_[ctr] = pstore::broker::pool.get_from_pool ();
+            iov_[ctr].iov_base = buffers_[ctr].get ();
+        }
+        return true;
+    }
+
+    // read socket
+    // ~~~~~~~~~~~
+    void read_socket (int const listener, pstore::broker::command_processor & cp,
+                      pstore::broker::recorder * const record_file) {
+        using pstore::broker::done;
+
+        socket_reader reader;
+        std::vector<pollfd> & fds = reader.poll_fds ();
+        fds.push_back (pollfd{listener, POLLIN, 0});
+        constexpr auto timeout_ms =
+            static_cast<int> (pstore::broker::details::timeout_seconds * 1000U);
+        for (;;) {
+            int const retval = ::poll (fds.data (), fds.size (), timeout_ms);
+            if (retval == -1) {
+                int const err = errno;
+                if (err == EINTR) {
+                    continue;
+                }
+                raise (pstore::errno_erc{err}, "poll");
+            }
+            if (retval == 0) {
+                log (priority::notice, "no data within timeout");
+            }
+            // Visit the connections before the listening socket. This ensures that a thread which
+            // is being asked to quit doesn't first accept the connection intended for another.
+            for (auto index = fds.size () - 1U; index > 0U; --index) {
+                if (fds[index].revents != 0) {
+                    reader.read (index, cp, record_file);
+                    if (done) {
+                        return;
+                    }
+                }
+            }
+            if (done) {
+                return;
+            }
+            if ((fds[0].revents & POLLIN) != 0) {
+                reader.accept (listener);
+            }
+        }
+    }
+
 } // end anonymous namespace
 
 
@@ -68,6 +216,15 @@ namespace pstore {
         void read_loop (brokerface::fifo_path & fifo, std::shared_ptr<recorder> & record_file,
                         std::shared_ptr<command_processor> const cp) {
             try {
+                if (fifo.get_transport () == brokerface::transport::socket) {
+                    log (priority::notice, "listening to socket ",
+                         logger::quoted{fifo.get ().c_str ()});
+                    auto const fd = fifo.open_server_pipe ();
+                    read_socket (fd.native_handle (), *cp, record_file.get ());
+                    log (priority::notice, "exiting read loop");
+                    return;
+                }
+
                 log (priority::notice, "listening to FIFO ", logger::quoted{fifo.get ().c_str ()});
                 auto const fd = fifo.open_server_pipe ();
 
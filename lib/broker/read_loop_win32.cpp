@@ -23,6 +23,7 @@
 // Standard includes
 #    include <algorithm>
 #    include <array>
+#    include <cerrno>
 #    include <cstdio>
 #    include <cstdlib>
 #    include <iterator>
@@ -452,6 +453,9 @@ namespace pstore {
         void read_loop (brokerface::fifo_path & path, std::shared_ptr<recorder> & record_file,
                         std::shared_ptr<command_processor> cp) {
             try {
+                if (path.get_transport () != brokerface::transport::fifo) {
+                    raise (errno_erc{ENOTSUP}, "Unix-domain socket transport");
+                }
                 log (logger::priority::notice, "listening to named pipe ",
                      logger::quoted (path.get ().c_str ()));
                 auto const pipe_name = utf::win32::to16 (path.get ());
@@ -21,12 +21,15 @@
 #include "pstore/json/utility.hpp"
 #include "pstore/os/logging.hpp"
 #include "pstore/os/thread.hpp"
+#include "pstore/support/counters.hpp"
 
 namespace pstore {
     namespace broker {
 
         descriptor_condition_variable uptime_cv;
         brokerface::channel<descriptor_condition_variable> uptime_channel (&uptime_cv);
+        descriptor_condition_variable counters_cv;
+        brokerface::channel<descriptor_condition_variable> counters_channel (&counters_cv);
 
         void uptime (gsl::not_null<std::atomic<bool> *> const done) {
             log (logger::priority::info, "uptime 1 second tick starting");
@@ -45,6 +48,14 @@ namespace pstore {
                     PSTORE_ASSERT (json::is_valid (str));
                     return str;
                 });
+                if /*constexpr*/ (
+                    counters::enabled ()) { //! OCLINT(PH - don't warn that this is a constant)
+                    counters_channel.publish ([] () {
+                        std::string const str = counters::to_json (counters::read ());
+                        PSTORE_ASSERT (json::is_valid (str));
+                        return str;
+                    });
+                }
             }
 
             log (logger::priority::info, "uptime thread exiting");
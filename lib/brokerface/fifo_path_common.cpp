@@ -36,16 +36,24 @@ namespace pstore {
     namespace brokerface {
 
         char const * const fifo_path::default_pipe_name = PSTORE_VENDOR_ID ".pstore_broker.fifo";
+        char const * const fifo_path::default_socket_name = PSTORE_VENDOR_ID ".pstore_broker.sock";
 
         // (ctor)
         // ~~~~~~
-        fifo_path::fifo_path (gsl::czstring const pipe_path, duration_type const retry_timeout,
-                              unsigned const max_retries, update_callback cb)
-                : path_{pipe_path == nullptr ? get_default_path () : pipe_path}
+        fifo_path::fifo_path (gsl::czstring const pipe_path, transport const kind,
+                              duration_type const retry_timeout, unsigned const max_retries,
+                              update_callback cb)
+                : transport_{kind}
+                , path_{pipe_path == nullptr ? get_default_path (kind) : pipe_path}
                 , retry_timeout_{retry_timeout}
                 , max_retries_{max_retries}
                 , update_cb_{std::move (cb)} {}
 
+        fifo_path::fifo_path (gsl::czstring const pipe_path, duration_type const retry_timeout,
+                              unsigned const max_retries, update_callback cb)
+                : fifo_path (pipe_path, transport::fifo, retry_timeout, max_retries,
+                             std::move (cb)) {}
+
         fifo_path::fifo_path (gsl::czstring const pipe_path, update_callback cb)
                 : fifo_path (pipe_path, duration_type{0}, 0, std::move (cb)) {}
 
@@ -25,9 +25,12 @@
 
 #    include <cerrno>
 #    include <cstdlib>
+#    include <cstring>
 
 #    include <fcntl.h>
+#    include <sys/socket.h>
 #    include <sys/stat.h>
+#    include <sys/un.h>
 #    include <unistd.h>
 
 #    include "pstore/support/error.hpp"
@@ -86,6 +89,92 @@ namespace {
         raise (pstore::errno_erc{errcode}, str.str ());
     }
 
+    PSTORE_NO_RETURN void raise_socket_error (pstore::gsl::czstring const what,
+                                              std::string const & path, int const errcode) {
+        std::ostringstream str;
+        str << what << ' ' << pstore::quoted (path);
+        raise (pstore::errno_erc{errcode}, str.str ());
+    }
+
+    // make address
+    // ~~~~~~~~~~~~
+    sockaddr_un make_address (std::string const & path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.length () >= sizeof (addr.sun_path)) {
+            raise_socket_error ("Socket path is too long:", path, ENAMETOOLONG);
+        }
+        std::strncpy (addr.sun_path, path.c_str (), sizeof (addr.sun_path) - 1U);
+        return addr;
+    }
+
+    // set nonblocking
+    // ~~~~~~~~~~~~~~~
+    void set_nonblocking (pstore::pipe_descriptor const & fd) {
+        int const flags = ::fcntl (fd.native_handle (), F_GETFL);
+        if (flags == -1 || ::fcntl (fd.native_handle (), F_SETFL, flags | O_NONBLOCK) == -1) {
+            raise (pstore::errno_erc{errno}, "fcntl");
+        }
+    }
+
+    // open seqpacket socket
+    // ~~~~~~~~~~~~~~~~~~~~~
+    pstore::pipe_descriptor open_seqpacket_socket (std::string const & path) {
+        pstore::pipe_descriptor fd{::socket (AF_UNIX, SOCK_SEQPACKET, 0)};
+        if (!fd.valid ()) {
+            raise_socket_error ("Could not create a socket for", path, errno);
+        }
+        return fd;
+    }
+
+    // connect socket
+    // ~~~~~~~~~~~~~~
+    /// Connects \p fd to the socket at \p addr. Returns 0 on success or an errno value.
+    int connect_socket (pstore::pipe_descriptor const & fd, sockaddr_un const & addr) {
+        return ::connect (fd.native_handle (), reinterpret_cast<sockaddr const *> (&addr),
+                          sizeof (addr)) == 0
+                   ? 0
+                   : errno;
+    }
+
+    // bind socket
+    // ~~~~~~~~~~~
+    int bind_socket (pstore::pipe_descriptor const & fd, sockaddr_un const & addr) {
+        // Temporarily set the umask to 0 so that any user can connect to our socket.
+        umask_raii const umask{0}; //! OCLINT (PH - intentionally unused)
+        return ::bind (fd.native_handle (), reinterpret_cast<sockaddr const *> (&addr),
+                       sizeof (addr)) == 0
+                   ? 0
+                   : errno;
+    }
+
+    // open listener
+    // ~~~~~~~~~~~~~
+    /// Creates the broker's listening socket at \p path. A socket file which was left behind by a
+    /// broker which is no longer running is replaced.
+    pstore::pipe_descriptor open_listener (std::string const & path) {
+        sockaddr_un const addr = make_address (path);
+        pstore::pipe_descriptor fd = open_seqpacket_socket (path);
+        int err = bind_socket (fd, addr);
+        if (err == EADDRINUSE) {
+            // Is there a live server at the other end of this path?
+            if (connect_socket (open_seqpacket_socket (path), addr) == ECONNREFUSED) {
+                ::unlink (path.c_str ());
+                err = bind_socket (fd, addr);
+            }
+        }
+        if (err != 0) {
+            raise_socket_error ("Could not bind socket at", path, err);
+        }
+        if (::listen (fd.native_handle (), SOMAXCONN) != 0) {
+            raise_socket_error ("Could not listen on socket at", path, errno);
+        }
+        // Several threads share the listening socket: accept() must not block if another thread
+        // has already taken the pending connection.
+        set_nonblocking (fd);
+        return fd;
+    }
+
 } // end anonymous namespace
 
 namespace pstore {
@@ -107,6 +196,18 @@ namespace pstore {
             std::lock_guard<decltype (open_server_pipe_mut_)> //! OCLINT
                 const lock{open_server_pipe_mut_};
 
+            if (transport_ == transport::socket) {
+                if (!listener_.valid ()) {
+                    listener_ = open_listener (path_);
+                    needs_delete_ = true;
+                }
+                pipe_descriptor fd{::dup (listener_.native_handle ())};
+                if (!fd.valid ()) {
+                    raise (errno_erc{errno}, "dup");
+                }
+                return {std::move (fd), pipe_descriptor{}};
+            }
+
             // The server opens its well-known FIFO read-only (since it only reads from it) each
             // time the number of clients goes from 1 to 0, the server will read an end of file on
             // the FIFO. To prevent the server from having to handle this case, we use the trick of
@@ -144,6 +245,19 @@ namespace pstore {
         // ~~~~~~~~~
         auto fifo_path::open_impl () const -> client_pipe {
             auto const & path = get ();
+            if (transport_ == transport::socket) {
+                client_pipe fd = open_seqpacket_socket (path);
+                int const err = connect_socket (fd, make_address (path));
+                if (err != 0) {
+                    // As for the FIFO, the caller may retry if the broker is not yet listening.
+                    if (err != ENOENT && err != ECONNREFUSED && err != EAGAIN) {
+                        raise_socket_error ("Could not connect to socket", path, err);
+                    }
+                    return client_pipe{};
+                }
+                set_nonblocking (fd);
+                return fd;
+            }
 
             // select() will return on EOF and for every EOF we handle there will be a new EOF which
             // results in read() calls spinning frantically. To avoid this we open the FIFO for both
@@ -176,9 +290,10 @@ namespace pstore {
 
         // get_default_path
         // ~~~~~~~~~~~~~~~~
-        std::string fifo_path::get_default_path () {
+        std::string fifo_path::get_default_path (transport const kind) {
             // TODO: consider using /run/user/<userid> on Linux?
-            return "/var/tmp/"s + default_pipe_name;
+            return "/var/tmp/"s +
+                   (kind == transport::socket ? default_socket_name : default_pipe_name);
         }
 
     } // end namespace brokerface
@@ -20,6 +20,7 @@
 
 #ifdef _WIN32
 
+#    include <cerrno>
 #    include <sstream>
 #    include <thread>
 
@@ -35,7 +36,7 @@ namespace pstore {
 
         // get_default_path
         // ~~~~~~~~~~~~~~~~
-        std::string fifo_path::get_default_path () {
+        std::string fifo_path::get_default_path (transport const) {
             return std::string{R"(\\.\pipe\)"} + default_pipe_name;
         }
 
@@ -43,6 +44,9 @@ namespace pstore {
         // ~~~~~~~~~
         auto fifo_path::open_impl () const -> client_pipe {
             auto const path = this->get ();
+            if (transport_ != transport::fifo) {
+                raise (errno_erc{ENOTSUP}, "Unix-domain socket transport");
+            }
             auto const path16 = pstore::utf::win32::to16 (path);
             auto fd = client_pipe{::CreateFileW (path16.c_str (), // pipe name
                                                  GENERIC_WRITE,   // write access
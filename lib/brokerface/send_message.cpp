@@ -19,6 +19,7 @@
 
 #include <iterator>
 #include <string>
+#include <vector>
 
 #include "pstore/brokerface/message_type.hpp"
 #include "pstore/brokerface/writer.hpp"
@@ -50,7 +51,7 @@ namespace pstore {
 
             std::uint32_t const mid = message_id++;
 
-            // Build and send each message.
+            // Build each message.
             auto first = std::begin (payload);
 
             using difference_type = std::iterator_traits<decltype (first)>::difference_type;
@@ -60,6 +61,8 @@ namespace pstore {
                            "payload_chars is too large to be represented as "
                            "string::iterator::difference_type");
 
+            std::vector<message_type> parts;
+            parts.reserve (num_parts);
             for (auto part = num_parts_type{0}; part < num_parts; ++part) {
                 auto const remaining = std::distance (first, std::end (payload));
                 PSTORE_ASSERT (remaining > 0);
@@ -68,9 +71,12 @@ namespace pstore {
                 std::advance (last, std::min (remaining, static_cast<difference_type> (
                                                              message_type::payload_chars)));
 
-                wr.write (message_type{mid, part, num_parts, first, last}, error_on_timeout);
+                parts.emplace_back (mid, part, num_parts, first, last);
                 first = last;
             }
+            // Hand all of the parts to the writer together so that a transport which supports
+            // batching can send them in as few operations as possible.
+            wr.write (gsl::make_span (parts), error_on_timeout);
         }
 
         std::uint32_t next_message_id () { return message_id.load (); }
@@ -19,19 +19,22 @@
 
 #include "pstore/brokerface/writer.hpp"
 
-#include <thread>
 #include <utility>
 
+#include "pstore/brokerface/message_type.hpp"
 #include "pstore/support/error.hpp"
 
 namespace pstore {
     namespace brokerface {
 
+        constexpr std::size_t writer::max_batch;
+
         // (ctor)
         // ~~~~~~
         writer::writer (fifo_path::client_pipe && pipe, duration_type const retry_timeout,
                         unsigned const max_retries, update_callback cb)
                 : fd_{std::move (pipe)}
+                , transport_{transport::fifo}
                 , retry_timeout_{retry_timeout}
                 , max_retries_{max_retries}
                 , update_cb_{std::move (cb)} {}
@@ -42,6 +45,7 @@ namespace pstore {
         writer::writer (fifo_path const & fifo, duration_type const retry_timeout,
                         unsigned const max_retries, update_callback cb)
                 : fd_{fifo.open_client_pipe ()}
+                , transport_{fifo.get_transport ()}
                 , retry_timeout_{retry_timeout}
                 , max_retries_{max_retries}
                 , update_cb_{std::move (cb)} {}
@@ -56,19 +60,39 @@ namespace pstore {
         // write
         // ~~~~~
         void writer::write (message_type const & msg, bool const error_on_timeout) {
+            this->write (gsl::make_span (&msg, 1), error_on_timeout);
+        }
+
+        void writer::write (gsl::span<message_type const> msgs, bool const error_on_timeout) {
+            while (!msgs.empty ()) {
+                auto const written = this->write_with_retries (msgs, error_on_timeout);
+                if (written == 0U) {
+                    break;
+                }
+                msgs = msgs.subspan (static_cast<std::ptrdiff_t> (written));
+            }
+        }
+
+        // write with retries
+        // ~~~~~~~~~~~~~~~~~~
+        std::size_t writer::write_with_retries (gsl::span<message_type const> const msgs,
+                                                bool const error_on_timeout) {
+            auto written = std::size_t{0};
             auto tries = 0U;
             bool const infinite_tries = max_retries_ == infinite_retries;
             for (; infinite_tries || tries <= max_retries_; ++tries) {
                 update_cb_ ();
-                if (this->write_impl (msg)) {
+                written = this->write_batch_impl (msgs);
+                if (written > 0U) {
                     break;
                 }
-                std::this_thread::sleep_for (retry_timeout_);
+                this->wait_impl ();
             }
 
             if (error_on_timeout && !infinite_tries && tries > max_retries_) {
                 raise (::pstore::error_code::pipe_write_timeout);
             }
+            return written;
         }
 
     } // end namespace brokerface
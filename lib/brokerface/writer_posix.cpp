@@ -21,24 +21,85 @@
 
 #ifndef _WIN32
 
+#    include <algorithm>
+#    include <thread>
+
+#    include <poll.h>
+#    include <sys/socket.h>
 #    include <unistd.h>
+
 #    include "pstore/brokerface/message_type.hpp"
 #    include "pstore/support/error.hpp"
 
+namespace {
+
+#    ifdef MSG_NOSIGNAL
+    // A broker which has gone away must not kill the client with SIGPIPE.
+    constexpr int send_flags = MSG_NOSIGNAL;
+#    else
+    constexpr int send_flags = 0;
+#    endif
+
+    constexpr bool is_retryable (int const err) noexcept {
+        return err == EAGAIN || err == EWOULDBLOCK || err == EPIPE;
+    }
+
+} // end anonymous namespace
+
 namespace pstore {
     namespace brokerface {
 
+        // write impl
+        // ~~~~~~~~~~
         bool writer::write_impl (message_type const & msg) {
             bool const ok = ::write (fd_.native_handle (), &msg, sizeof (msg)) == sizeof (msg);
             if (!ok) {
                 int const err = errno;
-                if (err != EAGAIN && err != EWOULDBLOCK && err != EPIPE) {
+                if (!is_retryable (err)) {
                     raise (errno_erc{err}, "write to broker pipe");
                 }
             }
             return ok;
         }
 
+        // write batch impl
+        // ~~~~~~~~~~~~~~~~
+        std::size_t writer::write_batch_impl (gsl::span<message_type const> const msgs) {
+            PSTORE_ASSERT (!msgs.empty ());
+            if (transport_ != transport::socket) {
+                return this->write_impl (msgs[0]) ? 1U : 0U;
+            }
+            // A SOCK_SEQPACKET record is sent atomically: either the whole batch is accepted or
+            // none of it is.
+            auto const count = std::min (static_cast<std::size_t> (msgs.size ()), max_batch);
+            auto const size = count * sizeof (message_type);
+            ssize_t const sent = ::send (fd_.native_handle (), msgs.data (), size, send_flags);
+            if (sent < 0) {
+                int const err = errno;
+                if (!is_retryable (err)) {
+                    raise (errno_erc{err}, "send to broker socket");
+                }
+                return 0U;
+            }
+            PSTORE_ASSERT (static_cast<std::size_t> (sent) == size);
+            return count;
+        }
+
+        // wait impl
+        // ~~~~~~~~~
+        void writer::wait_impl () const {
+            if (transport_ == transport::socket && fd_.valid ()) {
+                // Rather than sleeping for the full timeout, wake as soon as the broker has
+                // drained enough of the socket for our next record.
+                pollfd pfd{fd_.native_handle (), POLLOUT, 0};
+                int const res = ::poll (&pfd, 1, static_cast<int> (retry_timeout_.count ()));
+                if (res == 0 || (res > 0 && (pfd.revents & (POLLERR | POLLHUP)) == 0)) {
+                    return;
+                }
+            }
+            std::this_thread::sleep_for (retry_timeout_);
+        }
+
     } // end namespace brokerface
 } // end namespace pstore
 
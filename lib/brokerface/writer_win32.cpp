@@ -21,6 +21,8 @@
 
 #ifdef _WIN32
 
+#    include <thread>
+
 #    include "pstore/brokerface/message_type.hpp"
 #    include "pstore/support/error.hpp"
 
@@ -44,6 +46,17 @@ namespace pstore {
             return true;
         }
 
+        // write batch impl
+        // ~~~~~~~~~~~~~~~~
+        std::size_t writer::write_batch_impl (gsl::span<message_type const> const msgs) {
+            // A named pipe carries a single message per write.
+            return this->write_impl (msgs[0]) ? 1U : 0U;
+        }
+
+        // wait impl
+        // ~~~~~~~~~
+        void writer::wait_impl () const { std::this_thread::sleep_for (retry_timeout_); }
+
     } // end namespace brokerface
 } // end namespace pstore
 
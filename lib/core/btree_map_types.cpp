@@ -0,0 +1,168 @@
+//===- lib/core/btree_map_types.cpp ---------------------------------------===//
+//*  _     _                                           _                          *
+//* | |__ | |_ _ __ ___  ___   _ __ ___   __ _ _ __   | |_ _   _ _ __   ___  ___  *
+//* | '_ \| __| '__/ _ \/ _ \ | '_ ` _ \ / _` | '_ \  | __| | | | '_ \ / _ \/ __| *
+//* | |_) | |_| | |  __/  __/ | | | | | | (_| | |_) | | |_| |_| | |_) |  __/\__ \ *
+//* |_.__/ \__|_|  \___|\___| |_| |_| |_|\__,_| .__/   \__|\__, | .__/ \___||___/ *
+//*                                           |_|          |___/|_|               *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file btree_map_types.cpp
+#include "pstore/core/btree_map_types.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include "pstore/core/transaction.hpp"
+
+namespace pstore {
+    namespace index {
+        namespace btree_details {
+
+            //*               _      *
+            //*  _ _  ___  __| |___  *
+            //* | ' \/ _ \/ _` / -_) *
+            //* |_||_\___/\__,_\___| *
+            //*                      *
+
+            node::signature_type const node::node_signature_ = {
+                {'B', 'T', 'r', 'e', 'N', 'o', 'd', 'e'}};
+            constexpr std::size_t node::max_entries;
+            constexpr std::uint64_t node_ref::heap_bit;
+
+            // allocate [static]
+            // ~~~~~~~~~~~~~~~~~
+            node * node::allocate (gsl::not_null<heap_nodes *> const container, kind const k) {
+                static_assert (std::is_standard_layout<node>::value,
+                               "node must be standard-layout");
+                static_assert (alignof (node) >= 2,
+                               "node must have alignment >= 2 to ensure the bottom bit is 0");
+                static_assert (offsetof (node, signature_) == 0,
+                               "offsetof (node, signature_) must be 0");
+                static_assert (offsetof (node, kind_) == 8, "offsetof (node, kind_) must be 8");
+                static_assert (offsetof (node, size_) == 12, "offsetof (node, size_) must be 12");
+                static_assert (offsetof (node, entries_) == 16,
+                               "offset of the first entry must be 16");
+
+                constexpr std::size_t words =
+                    node::size_bytes (kind::branch, max_entries + 1U) / sizeof (std::uint64_t);
+                container->emplace_back (new std::uint64_t[words]);
+                return new (container->back ().get ()) node (k);
+            }
+
+            node * node::allocate (gsl::not_null<heap_nodes *> const container,
+                                   node const & other) {
+                node * const result = node::allocate (container, other.kind_);
+                result->size_ = other.size_;
+                std::copy (&other.entries_[0],
+                           &other.entries_[0] + other.size_ * words_per_entry (other.kind_),
+                           &result->entries_[0]);
+                return result;
+            }
+
+            // read_node [static]
+            // ~~~~~~~~~~~~~~~~~~
+            std::shared_ptr<node const> node::read_node (database const & db,
+                                                        address const addr) {
+                // Load the fixed-size part of the node to discover its kind and size before
+                // loading the complete structure.
+                auto base = std::static_pointer_cast<node const> (
+                    db.getro (addr, sizeof (node) - sizeof (node::entries_)));
+#if PSTORE_SIGNATURE_CHECKS_ENABLED
+                if (base->signature_ != node_signature_) {
+                    raise (error_code::index_corrupt, db.path ());
+                }
+#endif
+                if ((base->kind_ != kind::leaf && base->kind_ != kind::branch) ||
+                    base->size_ == 0U || base->size_ > max_entries) {
+                    raise (error_code::index_corrupt, db.path ());
+                }
+                std::size_t const actual_size = base->size_bytes ();
+                base.reset ();
+
+                auto resl = std::static_pointer_cast<node const> (db.getro (addr, actual_size));
+                if (!resl->is_leaf ()) {
+                    // Nodes are written depth-first so every child must precede its parent.
+                    for (auto ctr = std::size_t{0}; ctr < resl->size (); ++ctr) {
+                        node_ref const c = resl->child (ctr);
+                        if (c.is_empty () || c.is_heap () || c.to_address () >= addr) {
+                            raise (error_code::index_corrupt, db.path ());
+                        }
+                    }
+                }
+                return resl;
+            }
+
+            // get_node [static]
+            // ~~~~~~~~~~~~~~~~~
+            auto node::get_node (database const & db, node_ref const ref)
+                -> std::pair<std::shared_ptr<node const>, node const *> {
+                PSTORE_ASSERT (!ref.is_empty ());
+                if (ref.is_heap ()) {
+                    node const * const ptr = ref.to_node ();
+                    PSTORE_ASSERT (ptr->signature_ == node_signature_);
+                    return {nullptr, ptr};
+                }
+                std::shared_ptr<node const> store_node = node::read_node (db, ref.to_address ());
+                auto const * const ptr = store_node.get ();
+                return {std::move (store_node), ptr};
+            }
+
+            // insert
+            // ~~~~~~
+            void node::insert (std::size_t const pos, address const key,
+                               node_ref const child) noexcept {
+                PSTORE_ASSERT (pos <= size_ && size_ <= max_entries);
+                std::size_t const wpe = words_per_entry (kind_);
+                std::uint64_t * const first = &entries_[0] + pos * wpe;
+                std::uint64_t * const last = &entries_[0] + size_ * wpe;
+                std::copy_backward (first, last, last + wpe);
+                ++size_;
+                this->set_key (pos, key);
+                if (kind_ == kind::branch) {
+                    this->set_child (pos, child);
+                }
+            }
+
+            // split
+            // ~~~~~
+            node * node::split (gsl::not_null<heap_nodes *> const container) {
+                node * const right = node::allocate (container, kind_);
+                auto const left_size = static_cast<std::uint32_t> (size_ / 2U);
+                std::size_t const wpe = words_per_entry (kind_);
+                std::copy (&entries_[0] + left_size * wpe, &entries_[0] + size_ * wpe,
+                           &right->entries_[0]);
+                right->size_ = size_ - left_size;
+                size_ = left_size;
+                return right;
+            }
+
+            // flush
+            // ~~~~~
+            node_ref node::flush (transaction_base & transaction) {
+                if (kind_ == kind::branch) {
+                    for (auto ctr = std::size_t{0}; ctr < size_; ++ctr) {
+                        node_ref const c = this->child (ctr);
+                        if (c.is_heap ()) {
+                            this->set_child (ctr, c.to_node ()->flush (transaction));
+                        }
+                    }
+                }
+                std::size_t const num_bytes = this->size_bytes ();
+                std::shared_ptr<void> ptr;
+                address result;
+                std::tie (ptr, result) = transaction.alloc_rw (num_bytes, alignof (node));
+                std::memcpy (ptr.get (), static_cast<void const *> (this), num_bytes);
+                return node_ref{result};
+            }
+
+        } // end namespace btree_details
+    }     // end namespace index
+} // end namespace pstore
@@ -19,6 +19,7 @@
 #include "pstore/core/start_vacuum.hpp"
 #include "pstore/core/time.hpp"
 #include "pstore/os/path.hpp"
+#include "pstore/support/counters.hpp"
 
 #include "base32.hpp"
 
@@ -119,29 +120,51 @@ namespace pstore {
     // older revision footer pos
     // ~~~~~~~~~~~~~~~~~~~~~~~~~
     typed_address<trailer> database::older_revision_footer_pos (unsigned const revision) const {
-        if (revision == pstore::head_revision || revision > this->get_current_revision ()) {
+        unsigned const current_revision = this->get_current_revision ();
+        if (revision == pstore::head_revision || revision > current_revision) {
             raise (pstore::error_code::unknown_revision);
         }
 
-        // Walk backwards down the linked list of revisions to find it.
-        typed_address<trailer> footer_pos = size_.footer_pos ();
+        std::lock_guard<std::mutex> const lock{revision_footers_mut_};
+        // The table remains valid after a sync to an older revision. It must be rebuilt once a
+        // later revision becomes visible.
+        typed_address<trailer> const head = size_.footer_pos ();
+        if (current_revision >= revision_footers_.size () ||
+            revision_footers_[current_revision] != head) {
+            revision_footers_ = this->build_revision_footers (head, current_revision);
+        }
+        typed_address<trailer> const result = revision_footers_[revision];
+        if (result == typed_address<trailer>::null ()) {
+            raise (pstore::error_code::unknown_revision);
+        }
+        return result;
+    }
+
+    // build revision footers
+    // ~~~~~~~~~~~~~~~~~~~~~~
+    std::vector<typed_address<trailer>>
+    database::build_revision_footers (typed_address<trailer> footer_pos,
+                                      unsigned const revision) const {
+        std::vector<typed_address<trailer>> result (revision + 1U,
+                                                    typed_address<trailer>::null ());
+        // Walk backwards down the linked list of revisions. Generation numbers must get smaller
+        // as we go.
+        auto limit = revision + 1U;
         for (;;) {
             auto const tail = this->getro (footer_pos);
             unsigned int const tail_revision = tail->a.generation;
-            if (revision > tail_revision) {
-                raise (pstore::error_code::unknown_revision);
+            if (tail_revision >= limit) {
+                raise (pstore::error_code::footer_corrupt, this->path ());
             }
-            if (tail_revision == revision) {
+            result[tail_revision] = footer_pos;
+            if (tail_revision == 0U) {
                 break;
             }
-
-            // TODO: check that footer_pos and generation number are getting smaller; time must
-            // not be getting larger.
+            limit = tail_revision;
             footer_pos = tail->a.prev_generation;
             trailer::validate (*this, footer_pos);
         }
-
-        return footer_pos;
+        return result;
     }
 
     // sync
@@ -389,7 +412,9 @@ namespace pstore {
     auto database::get (address const addr, std::size_t const size, bool const initialized,
                         bool const writable) const -> std::shared_ptr<void const> {
         this->check_get_params (addr, size, writable);
+        PSTORE_COUNT (database_get);
         if (storage_.request_spans_regions (addr, size)) {
+            PSTORE_COUNT (database_get_spanning);
             return this->get_spanning (addr, size, initialized, writable);
         }
         return storage_.address_to_pointer (addr);
@@ -400,7 +425,9 @@ namespace pstore {
     auto database::getu (address addr, std::size_t size, bool initialized) const
         -> unique_pointer<void const> {
         this->check_get_params (addr, size, false);
+        PSTORE_COUNT (database_get);
         if (storage_.request_spans_regions (addr, size)) {
+            PSTORE_COUNT (database_get_spanning);
             return this->get_spanningu (addr, size, initialized);
         }
         return {storage_.address_to_raw_pointer (addr), deleter_nop<void const>};
@@ -16,12 +16,56 @@
 /// \file hamt_map_types.cpp
 #include "pstore/core/hamt_map_types.hpp"
 
+#include <cstddef>
 #include <new>
 
+#include "pstore/support/aligned.hpp"
+
 namespace pstore {
     namespace index {
         namespace details {
 
+            //*               _                               *
+            //*  _ _  ___  __| |___   __ _ _ _ ___ _ _  __ _  *
+            //* | ' \/ _ \/ _` / -_) / _` | '_/ -_) ' \/ _` | *
+            //* |_||_\___/\__,_\___| \__,_|_| \___|_||_\__,_| *
+            //*                                               *
+
+            constexpr std::size_t node_arena::chunk_size;
+
+            // allocate
+            // ~~~~~~~~
+            void * node_arena::allocate (std::size_t const size, std::size_t const align) {
+                PSTORE_ASSERT (is_power_of_two (align) && align <= alignof (std::max_align_t));
+                auto padding = static_cast<std::size_t> (
+                    aligned (reinterpret_cast<std::uintptr_t> (ptr_), align) -
+                    reinterpret_cast<std::uintptr_t> (ptr_));
+                if (ptr_ == nullptr || padding + size > remaining_) {
+                    if (size > chunk_size / 4U) {
+                        // Give a large request a chunk of its own so that the remainder of the
+                        // current chunk is not abandoned.
+                        chunks_.emplace_back (new std::uint8_t[size]);
+                        return chunks_.back ().get ();
+                    }
+                    chunks_.emplace_back (new std::uint8_t[chunk_size]);
+                    ptr_ = chunks_.back ().get ();
+                    remaining_ = chunk_size;
+                    padding = 0U;
+                }
+                std::uint8_t * const result = ptr_ + padding;
+                ptr_ = result + size;
+                remaining_ -= padding + size;
+                return result;
+            }
+
+            // clear
+            // ~~~~~
+            void node_arena::clear () noexcept {
+                chunks_.clear ();
+                ptr_ = nullptr;
+                remaining_ = 0U;
+            }
+
             //*  _ _                                  _      *
             //* | (_)_ _  ___ __ _ _ _   _ _  ___  __| |___  *
             //* | | | ' \/ -_) _` | '_| | ' \/ _ \/ _` / -_) *
@@ -31,22 +75,6 @@ namespace pstore {
             linear_node::signature_type const linear_node::node_signature_ = {
                 {'I', 'n', 'd', 'x', 'L', 'n', 'e', 'r'}};
 
-            // operator new
-            // ~~~~~~~~~~~~
-            void * linear_node::operator new (std::size_t const s, nchildren const size) {
-                (void) s;
-                std::size_t const actual_bytes = linear_node::size_bytes (size.n);
-                PSTORE_ASSERT (actual_bytes >= s);
-                return ::operator new (actual_bytes);
-            }
-
-            // operator delete
-            // ~~~~~~~~~~~~~~~
-            void linear_node::operator delete (void * const p, nchildren const /*size*/) {
-                ::operator delete (p);
-            }
-            void linear_node::operator delete (void * const p) { ::operator delete (p); }
-
             // (ctor)
             // ~~~~~~
             linear_node::linear_node (std::size_t const size)
@@ -54,6 +82,8 @@ namespace pstore {
 
                 static_assert (std::is_standard_layout<linear_node>::value,
                                "linear_node must be standard-layout");
+                static_assert (std::is_trivially_destructible<linear_node>::value,
+                               "linear_node is allocated from an arena and is never destroyed");
                 static_assert (
                     alignof (linear_node) >= 4,
                     "linear_node must have alignment >= 4 to ensure the bottom two bits are 0");
@@ -76,11 +106,13 @@ namespace pstore {
 
             // allocate
             // ~~~~~~~~
-            std::unique_ptr<linear_node> linear_node::allocate (std::size_t const num_children,
-                                                                linear_node const & from_node) {
+            linear_node * linear_node::allocate (node_arena * const arena,
+                                                 std::size_t const num_children,
+                                                 linear_node const & from_node) {
                 // Allocate the new node and fill in the basic fields.
-                auto new_node = std::unique_ptr<linear_node> (new (nchildren{num_children})
-                                                                  linear_node (num_children));
+                auto * const new_node = new (
+                    arena->allocate (linear_node::size_bytes (num_children), alignof (linear_node)))
+                    linear_node (num_children);
 
                 std::size_t const num_to_copy = std::min (num_children, from_node.size ());
                 auto const * const src_begin = from_node.leaves_;
@@ -91,8 +123,11 @@ namespace pstore {
                 return new_node;
             }
 
-            std::unique_ptr<linear_node> linear_node::allocate (address const a, address const b) {
-                auto result = std::unique_ptr<linear_node> (new (nchildren{2U}) linear_node (2U));
+            linear_node * linear_node::allocate (node_arena * const arena, address const a,
+                                                 address const b) {
+                auto * const result =
+                    new (arena->allocate (linear_node::size_bytes (2U), alignof (linear_node)))
+                        linear_node (2U);
                 (*result)[0] = a;
                 (*result)[1] = b;
                 return result;
@@ -100,19 +135,21 @@ namespace pstore {
 
             // allocate_from
             // ~~~~~~~~~~~~~
-            std::unique_ptr<linear_node>
-            linear_node::allocate_from (linear_node const & orig_node,
-                                        std::size_t const extra_children) {
-                return linear_node::allocate (orig_node.size () + extra_children, orig_node);
+            linear_node * linear_node::allocate_from (node_arena * const arena,
+                                                      linear_node const & orig_node,
+                                                      std::size_t const extra_children) {
+                return linear_node::allocate (arena, orig_node.size () + extra_children,
+                                              orig_node);
             }
 
-            std::unique_ptr<linear_node>
-            linear_node::allocate_from (database const & db, index_pointer const node,
-                                        std::size_t const extra_children) {
+            linear_node * linear_node::allocate_from (node_arena * const arena,
+                                                      database const & db,
+                                                      index_pointer const node,
+                                                      std::size_t const extra_children) {
                 std::pair<std::shared_ptr<linear_node const>, linear_node const *> const p =
                     linear_node::get_node (db, node);
                 PSTORE_ASSERT (p.second != nullptr);
-                return linear_node::allocate_from (*p.second, extra_children);
+                return linear_node::allocate_from (arena, *p.second, extra_children);
             }
 
             // get_node
@@ -145,6 +182,14 @@ namespace pstore {
                 return {std::move (ln), p};
             }
 
+            // remove
+            // ~~~~~~
+            void linear_node::remove (std::size_t const index) noexcept {
+                PSTORE_ASSERT (index < size_);
+                std::move (this->begin () + index + 1, this->end (), this->begin () + index);
+                --size_;
+            }
+
             // flush
             // ~~~~~
             address linear_node::flush (transaction_base & transaction) const {
@@ -163,9 +208,6 @@ namespace pstore {
             //* |_|_||_\__\___|_| |_||_\__,_|_| |_||_\___/\__,_\___| *
             //*                                                      *
 
-            internal_node::signature_type const internal_node::node_signature_ = {
-                {'I', 'n', 't', 'e', 'r', 'n', 'a', 'l'}};
-
             // ctor (one child)
             // ~~~~~~~~~~~~~~~~
             internal_node::internal_node (index_pointer const & leaf, hash_type const hash)
@@ -178,12 +220,12 @@ namespace pstore {
                                                            ">= 4 to ensure the bottom two bits "
                                                            "are 0");
 
-                static_assert (offsetof (internal_node, signature_) == 0,
-                               "offsetof (internal_node, signature) must be 0");
-                static_assert (offsetof (internal_node, bitmap_) == 8,
-                               "offsetof (internal_node, bitmap_) must be 8");
-                static_assert (offsetof (internal_node, children_) == 16,
-                               "offset of the first child must be 16.");
+                static_assert (offsetof (internal_node, bitmap_) == 0,
+                               "offsetof (internal_node, bitmap_) must be 0");
+                static_assert (offsetof (internal_node, children_) == 8,
+                               "offset of the first child must be 8.");
+                static_assert (internal_node::size_bytes (7U) == cache_line_size,
+                               "an internal node with 7 children should fill a cache line");
             }
 
             // ctor (two children)
@@ -234,11 +276,6 @@ namespace pstore {
 
             bool internal_node::validate_after_load (internal_node const & internal,
                                                      typed_address<internal_node> const addr) {
-#if PSTORE_SIGNATURE_CHECKS_ENABLED
-                if (internal.signature_ != node_signature_) {
-                    return false;
-                }
-#endif
                 return std::all_of (std::begin (internal), std::end (internal),
                                     [addr] (index_pointer const & child) {
                                         if (child.is_heap () ||
@@ -331,6 +368,47 @@ namespace pstore {
                 parents->push (parent_type{index_pointer{this}, index});
             }
 
+            // remove_child
+            // ~~~~~~~~~~~~
+            void internal_node::remove_child (hash_type const hash) {
+                auto const hash_index = hash & details::hash_index_mask;
+                auto const bit_pos = hash_type{1} << hash_index;
+                // check that this slot is occupied.
+                PSTORE_ASSERT ((this->bitmap_ & bit_pos) !=
+                               0); //! OCLINT(PH - bitwise in conditional)
+
+                unsigned const index = bit_count::pop_count (this->bitmap_ & (bit_pos - 1));
+                unsigned const old_size = bit_count::pop_count (this->bitmap_);
+                PSTORE_ASSERT (old_size > 1U && index < old_size);
+
+                // Move elements from [index+1..old_size) to [index..old_size-1)
+                {
+                    auto const children_span = gsl::make_span (&children_[0], hash_size);
+                    auto const num_to_move = old_size - index - 1U;
+
+                    auto const span = children_span.subspan (index + 1U, num_to_move);
+                    auto const d_span = children_span.subspan (index, num_to_move);
+                    std::move (std::begin (span), std::end (span), std::begin (d_span));
+                }
+
+                this->bitmap_ = this->bitmap_ & ~bit_pos;
+                PSTORE_ASSERT (bit_count::pop_count (this->bitmap_) == old_size - 1U);
+            }
+
+            // store_alignment
+            // ~~~~~~~~~~~~~~~
+            unsigned internal_node::store_alignment (address const pos,
+                                                     std::size_t const num_bytes) noexcept {
+                auto const lines = [num_bytes] (std::uint64_t const offset) {
+                    return (offset + num_bytes + cache_line_size - 1U) / cache_line_size;
+                };
+                // The node will begin at the first suitably aligned address at or after pos.
+                auto const start = aligned<internal_node> (pos.absolute ());
+                return lines (start % cache_line_size) > lines (0U)
+                           ? unsigned{cache_line_size}
+                           : unsigned{alignof (internal_node)};
+            }
+
             // store_node
             // ~~~~~~~~~~
             address internal_node::store_node (transaction_base & transaction) const {
@@ -338,7 +416,9 @@ namespace pstore {
 
                 std::shared_ptr<void> ptr;
                 address result;
-                std::tie (ptr, result) = transaction.alloc_rw (num_bytes, alignof (internal_node));
+                unsigned const align =
+                    internal_node::store_alignment (transaction.next_address (), num_bytes);
+                std::tie (ptr, result) = transaction.alloc_rw (num_bytes, align);
                 new (ptr.get ()) internal_node (*this);
                 return result;
             }
@@ -360,8 +440,8 @@ namespace pstore {
                         } else { // linear node
                             PSTORE_ASSERT (p.is_linear ());
                             auto * const linear = p.untag<linear_node *> ();
+                            // The node is owned by the index's arena. Don't delete it here.
                             p = linear->flush (transaction) | internal_node_bit;
-                            delete linear;
                         }
                     }
                 }
@@ -369,6 +449,50 @@ namespace pstore {
                 return this->store_node (transaction) | internal_node_bit;
             }
 
+            //*  _              _             _     *
+            //* | |_ ___ _ __  | |_____ _____| |___ *
+            //* |  _/ _ \ '_ \ | / -_) V / -_) (_-< *
+            //*  \__\___/ .__/ |_\___|\_/\___|_/__/ *
+            //*         |_|                         *
+
+            constexpr unsigned top_levels::levels;
+            constexpr std::size_t top_levels::num_entries;
+
+            // (ctor)
+            // ~~~~~~
+            top_levels::top_levels (database const & db, index_pointer const root)
+                    : root_{root}
+                    , second_ (num_entries) {
+                PSTORE_ASSERT (root.is_internal () && !root.is_heap ());
+                // Visit the children of 'node' in hash order calling f(hash_index, child,
+                // position) for each.
+                auto const for_each_child = [&db] (index_pointer const node, auto const f) {
+                    std::pair<std::shared_ptr<internal_node const>, internal_node const *> const
+                        p = internal_node::get_node (db, node);
+                    hash_type const bitmap = p.second->get_bitmap ();
+                    auto position = std::uint8_t{0};
+                    for (auto index = hash_type{0}; index < hash_size; ++index) {
+                        if ((bitmap & (hash_type{1} << index)) != 0U) {
+                            f (index, (*p.second)[position], position);
+                            ++position;
+                        }
+                    }
+                };
+
+                for_each_child (root, [&] (hash_type const index1, index_pointer const child,
+                                           std::uint8_t const position1) {
+                    first_[index1] = slot{child, position1};
+                    if (child.is_internal ()) {
+                        for_each_child (child, [&] (hash_type const index2,
+                                                    index_pointer const grandchild,
+                                                    std::uint8_t const position2) {
+                            second_[index2 << hash_index_bits | index1] =
+                                slot{grandchild, position2};
+                        });
+                    }
+                });
+            }
+
         } // namespace details
     }     // namespace index
 } // namespace pstore
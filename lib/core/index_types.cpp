@@ -31,7 +31,14 @@ namespace {
                       unsigned const generation) {
         pstore::database & db = transaction.db ();
         if (auto const index = pstore::index::get_index<Index> (db, false /*create*/)) {
-            (*locations)[index_integral (Index)] = index->flush (transaction, generation);
+            auto & location = (*locations)[index_integral (Index)];
+            auto const previous = location;
+            location = index->flush (transaction, generation);
+            // The index's previous header block is no longer reachable.
+            if (previous != pstore::typed_address<pstore::index::header_block>::null () &&
+                location != previous) {
+                transaction.supersede (sizeof (pstore::index::header_block));
+            }
         }
     }
 
@@ -15,6 +15,11 @@
 //===----------------------------------------------------------------------===//
 #include "pstore/core/indirect_string.hpp"
 
+#include <algorithm>
+
+#include "pstore/support/aligned.hpp"
+#include "pstore/support/counters.hpp"
+
 namespace pstore {
 
     //*  _         _ _            _        _       _            *
@@ -33,6 +38,7 @@ namespace pstore {
         if (address_ & in_heap_mask) {
             return *reinterpret_cast<sstring_view<char const *> const *> (address_ & ~in_heap_mask);
         }
+        PSTORE_COUNT (indirect_string_store_read);
         return get_sstring_view (db_, address{address_}, owner);
     }
 
@@ -154,16 +160,65 @@ namespace pstore {
             serialize::archive::make_reader (db, addr.to_address ()));
     }
 
+    // body size
+    // ~~~~~~~~~
+    std::size_t indirect_string_adder::body_size (std::size_t const length) noexcept {
+        // The string length is varint-encoded but always occupies at least two bytes (see
+        // serialize::string_helper).
+        return std::max (varint::encoded_size (length), 2U) + length;
+    }
+
+    // write body
+    // ~~~~~~~~~~
+    std::uint8_t * indirect_string_adder::write_body (std::uint8_t * out,
+                                                      raw_sstring_view const & str) {
+        auto const length = str.length ();
+        auto * const first = out;
+        out = varint::encode (length, out);
+        if (out - first == 1) {
+            *(out++) = 0;
+        }
+        return std::copy (str.data (), str.data () + length, out);
+    }
+
     // flush
     // ~~~~~
     void indirect_string_adder::flush (transaction_base & transaction) {
-        for (auto const & v : views_) {
-            PSTORE_ASSERT (v.second != typed_address<address>::null ());
-            indirect_string::write_body_and_patch_address (transaction,
-                                                           *std::get<0> (v), // string body
-                                                           std::get<1> (v)   // address to patch
-            );
+        if (views_.empty ()) {
+            return;
+        }
+        // Each string body must be 2-byte aligned to ensure that the LSB of its address is clear.
+        constexpr auto aligned_to = 1U << indirect_string::in_heap_mask;
+
+        // Work out the number of bytes needed for all of the string bodies so that we can make a
+        // single allocation for all of them.
+        std::size_t total = 0;
+        for (pending_body const & v : views_) {
+            total = aligned (total, aligned_to) + body_size (v.str->length ());
+        }
+
+        std::shared_ptr<void> ptr;
+        address base;
+        std::tie (ptr, base) = transaction.alloc_rw (total, aligned_to);
+        auto * const first = static_cast<std::uint8_t *> (ptr.get ());
+
+        // Write the string bodies and patch each of the in-store indirect pointers to refer to
+        // them.
+        auto * out = first;
+        for (pending_body const & v : views_) {
+            PSTORE_ASSERT (v.addr != typed_address<address>::null ());
+            auto const offset = static_cast<std::size_t> (out - first);
+            auto const padding = aligned (offset, aligned_to) - offset;
+            out = std::fill_n (out, padding, std::uint8_t{0});
+
+            address const body = base + static_cast<std::uint64_t> (out - first);
+            *transaction.getrw (v.addr) = body;
+            if (v.alias != typed_address<address>::null ()) {
+                *transaction.getrw (v.alias) = body;
+            }
+            out = write_body (out, *v.str);
         }
+        PSTORE_ASSERT (static_cast<std::size_t> (out - first) == total);
         views_.clear ();
     }
 
@@ -0,0 +1,57 @@
+//===- lib/core/snapshot.cpp ----------------------------------------------===//
+//*                            _           _    *
+//*  ___ _ __   __ _ _ __  ___| |__   ___ | |_  *
+//* / __| '_ \ / _` | '_ \/ __| '_ \ / _ \| __| *
+//* \__ \ | | | (_| | |_) \__ \ | | | (_) | |_  *
+//* |___/_| |_|\__,_| .__/|___/_| |_|\___/ \__| *
+//*                 |_|                         *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/core/snapshot.hpp"
+
+#include "pstore/core/database.hpp"
+
+namespace {
+
+    std::shared_ptr<pstore::trailer const>
+    load_footer (pstore::database const & db, pstore::typed_address<pstore::trailer> const pos) {
+        // A snapshot cannot see beyond the revision to which its parent is synced: the memory
+        // holding later generations may not yet be mapped.
+        if (pos == pstore::typed_address<pstore::trailer>::null () || pos > db.footer_pos ()) {
+            pstore::raise (pstore::error_code::footer_corrupt, db.path ());
+        }
+        pstore::trailer::validate (db, pos);
+        return db.getro (pos);
+    }
+
+} // end anonymous namespace
+
+namespace pstore {
+
+    // (ctor)
+    // ~~~~~~
+    snapshot::snapshot (database const & db)
+            : snapshot (db, db.get_footer (), db.footer_pos ()) {}
+
+    snapshot::snapshot (database const & db, unsigned const revision)
+            : snapshot (db, revision == head_revision ? db.footer_pos ()
+                                                      : db.older_revision_footer_pos (revision)) {}
+
+    snapshot::snapshot (database const & db, typed_address<trailer> const footer_pos)
+            : snapshot (db, load_footer (db, footer_pos), footer_pos) {}
+
+    snapshot::snapshot (database const & db, std::shared_ptr<trailer const> const & footer,
+                        typed_address<trailer> const footer_pos)
+            : db_{&db}
+            , footer_pos_{footer_pos}
+            , revision_{footer->a.generation.load ()}
+            , time_{footer->a.time.load ()}
+            , roots_ (footer->a.index_records) {}
+
+} // end namespace pstore
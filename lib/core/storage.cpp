@@ -17,6 +17,8 @@
 
 #include "pstore/core/storage.hpp"
 #include "pstore/core/file_header.hpp"
+#include "pstore/os/trace.hpp"
+#include "pstore/support/counters.hpp"
 
 namespace {
 
@@ -65,9 +67,11 @@ namespace pstore {
             regions_.empty () ? std::uint64_t{0} : regions_.back ()->end ();
         if (new_logical_size > old_physical_size) {
             // if growing the storage
+            trace::span const s{"map_bytes"};
             auto const old_num_regions = regions_.size ();
             // Allocate new memory region(s) to accommodate the additional bytes requested.
             region_factory_->add (&regions_, old_physical_size, new_logical_size);
+            PSTORE_COUNT_N (storage_regions_mapped, regions_.size () - old_num_regions);
             this->update_master_pointers (old_num_regions);
             return;
         }
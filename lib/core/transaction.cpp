@@ -20,6 +20,7 @@
 #include <utility>
 
 #include "pstore/core/index_types.hpp"
+#include "pstore/support/counters.hpp"
 
 namespace pstore {
 
@@ -40,6 +41,7 @@ namespace pstore {
     transaction_base::transaction_base (transaction_base && rhs) noexcept
             : db_{rhs.db_}
             , size_{rhs.size_}
+            , superseded_{rhs.superseded_}
             , dbsize_{rhs.dbsize_}
             , first_ (rhs.first_) {
         rhs.first_ = address::null ();
@@ -50,6 +52,7 @@ namespace pstore {
     // allocate
     // ~~~~~~~~
     address transaction_base::allocate (std::uint64_t const size, unsigned const align) {
+        trace::span const s{"allocate"};
         database & db = this->db ();
         auto const old_size = db.size ();
         address const result = db.allocate (size, align);
@@ -70,6 +73,22 @@ namespace pstore {
         return result;
     }
 
+    // open
+    // ~~~~
+    void transaction_base::open () {
+        if (first_ == address::null ()) {
+            if (size_ != 0) {
+                // Cannot allocate data after a transaction has been committed
+                raise (error_code::cannot_allocate_after_commit);
+            }
+            first_ = this->next_address ();
+        }
+    }
+
+    // next_address
+    // ~~~~~~~~~~~~
+    address transaction_base::next_address () { return address{db_.size ()}; }
+
     // alloc_rw
     // ~~~~~~~~
     std::pair<std::shared_ptr<void>, address> transaction_base::alloc_rw (std::size_t const size,
@@ -91,6 +110,10 @@ namespace pstore {
             // No data was added to the transaction. Nothing to do.
             return *this;
         }
+        PSTORE_COUNT (transaction_commit);
+        // The transaction lock is held throughout.
+        PSTORE_TIME_SCOPE (transaction_commit_ns);
+        trace::span const commit_span{"commit"};
 
         database & db = this->db ();
 
@@ -110,10 +133,14 @@ namespace pstore {
             // writing data here.
 
             auto locations = prev_footer->a.index_records;
-            index::flush_indices (*this, &locations, generation);
+            {
+                trace::span const s{"flush_indices"};
+                index::flush_indices (*this, &locations, generation);
+            }
 
             // Writing new data is done. Now we begin to build the new file footer.
             {
+                trace::span const s{"write_trailer"};
                 std::shared_ptr<trailer> trailer_ptr;
                 std::tie (trailer_ptr, new_footer_pos) = this->alloc_rw<trailer> ();
                 auto * const t = new (trailer_ptr.get ()) trailer;
@@ -126,6 +153,9 @@ namespace pstore {
                 t->a.size = size_ - sizeof (trailer);
                 t->a.time = pstore::milliseconds_since_epoch ();
                 t->a.prev_generation = head.footer_pos;
+                // The previous trailer is only reachable through the generation list so it
+                // counts as garbage along with anything superseded by this transaction.
+                t->a.garbage = prev_footer->a.garbage + superseded_ + sizeof (trailer);
                 t->crc = t->get_crc ();
             }
         }
@@ -134,10 +164,14 @@ namespace pstore {
         db.set_new_footer (new_footer_pos);
 
         // Mark both this transaction's contents and its trailer as read-only.
-        db.protect (first_, (new_footer_pos + 1).to_address ());
+        {
+            trace::span const s{"protect"};
+            db.protect (first_, (new_footer_pos + 1).to_address ());
+        }
 
         // That's the end of this transaction.
         first_ = address::null ();
+        superseded_ = 0;
         PSTORE_ASSERT (!this->is_open ()); //! OCLINT(PH - don't warn about the assert macro)
         return *this;
     }
@@ -147,6 +181,7 @@ namespace pstore {
     transaction_base & transaction_base::rollback () noexcept {
         if (this->is_open ()) {
             first_ = address::null ();
+            superseded_ = 0;
             PSTORE_ASSERT (!this->is_open ()); //! OCLINT(PH - don't warn about the assert macro)
             // if we grew the db, truncate it back
             if (db_.size () > dbsize_) {
@@ -162,6 +197,7 @@ namespace pstore {
     // * begin *
     // *********
     transaction<transaction_lock> begin (database & db) {
+        trace::span const s{"begin"};
         return begin (db, transaction_lock{transaction_mutex{db}});
     }
 
@@ -80,6 +80,7 @@ namespace pstore {
                 {"prev_generation", make_value (trailer.a.prev_generation)},
                 {"indices", make_value (std::begin (trailer.a.index_records),
                                         std::end (trailer.a.index_records))},
+                {"garbage", make_value (trailer.a.garbage.load ())},
                 {"crc", make_value (trailer.crc)},
                 {"signature2",
                  make_value (std::begin (trailer.signature2), std::end (trailer.signature2))},
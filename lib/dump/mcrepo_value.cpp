@@ -21,6 +21,7 @@
 #include "pstore/dump/mcdebugline_value.hpp"
 #include "pstore/dump/mcdisassembler_value.hpp"
 #include "pstore/dump/value.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
 
 namespace {
 
@@ -90,7 +91,9 @@ namespace pstore {
         value_ptr make_section_value (repo::generic_section const & section,
                                       repo::section_kind const sk, parameters const & parm) {
             (void) sk;
-            auto const & payload = section.payload ();
+            std::shared_ptr<std::uint8_t const> owner;
+            repo::container<std::uint8_t> const payload =
+                repo::load_payload (parm.db, section, &owner);
             value_ptr data_value;
 #ifdef PSTORE_IS_INSIDE_LLVM
             if (sk == repo::section_kind::text) {
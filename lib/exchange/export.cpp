@@ -18,9 +18,16 @@
 
 #include "pstore/exchange/export.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+
 #include "pstore/core/generation_iterator.hpp"
 #include "pstore/exchange/export_compilation.hpp"
 #include "pstore/exchange/export_fragment.hpp"
+#include "pstore/support/maybe.hpp"
+#include "pstore/support/scope_guard.hpp"
 
 namespace {
 
@@ -41,7 +48,7 @@ namespace {
 
     // emit debug line headers
     // ~~~~~~~~~~~~~~~~~~~~~~~
-    bool emit_debug_line_headers (pstore::exchange::export_ns::ostream & os,
+    bool emit_debug_line_headers (pstore::exchange::export_ns::ostream_base & os,
                                   pstore::exchange::export_ns::indent const ind,
                                   pstore::database const & db, unsigned const generation) {
         auto const debug_line_headers =
@@ -83,6 +90,116 @@ namespace {
         return (prev_emitted ? ",\n" : "") + ind.str () + '"' + property + "\":";
     }
 
+    // emit transaction
+    // ~~~~~~~~~~~~~~~~
+    /// Writes the object describing transaction \p generation to \p os. \p db must be synced to
+    /// \p generation.
+    ///
+    /// \tparam StringMapping  Either string_mapping (in which case strings are added to the
+    ///   tables as they are emitted) or string_mapping const (in which case the tables must
+    ///   already contain every string in the transaction).
+    template <typename StringMapping>
+    void emit_transaction (pstore::exchange::export_ns::ostream_base & os,
+                           pstore::exchange::export_ns::indent const ind,
+                           pstore::database const & db, unsigned const generation,
+                           StringMapping * const string_table, StringMapping * const path_table,
+                           bool const comments) {
+        using namespace pstore;
+        using namespace pstore::exchange::export_ns;
+
+        os << ind << "{\n";
+        auto const object_indent = ind.next ();
+        if (comments) {
+            os << object_indent << "// transaction #" << generation << '\n';
+        }
+        bool const names_emitted = emit_strings<trailer::indices::name> (
+            os, object_indent, db, generation, prefix (false, object_indent, "names"),
+            string_table, comments);
+        bool const paths_emitted = emit_strings<trailer::indices::path> (
+            os, object_indent, db, generation, prefix (names_emitted, object_indent, "paths"),
+            path_table, comments);
+        if (paths_emitted || names_emitted) {
+            os << ",\n";
+        }
+        if (emit_debug_line_headers (os, object_indent, db, generation)) {
+            os << ",\n";
+        }
+        os << object_indent << R"("fragments":{)";
+        emit_fragments (os, object_indent.next (), db, generation, *string_table, comments);
+        os << '\n' << object_indent << "},\n";
+        os << object_indent << R"("compilations":{)";
+        emit_compilation_index (os, object_indent.next (), db, generation, *string_table,
+                                comments);
+        os << '\n' << object_indent << "}\n";
+        os << ind << '}';
+    }
+
+    //*  _                             _   _               _                       _  *
+    //* | |_ _ _ __ _ _ _  ___ __ _ __| |_(_)___ _ _    __| |_  __ _ _ _  _ _  ___| | *
+    //* |  _| '_/ _` | ' \(_-</ _` / _|  _| / _ \ ' \  / _| ' \/ _` | ' \| ' \/ -_) | *
+    //*  \__|_| \__,_|_||_/__/\__,_\__|\__|_\___/_||_| \__|_||_\__,_|_||_|_||_\___|_| *
+    //*                                                                               *
+    /// A bounded queue which carries rendered transactions from a single export worker to the
+    /// thread which writes them to the output.
+    class transaction_channel {
+    public:
+        explicit transaction_channel (std::size_t const capacity) noexcept
+                : capacity_{capacity} {}
+
+        /// Called by the worker to append a rendered transaction to the queue. Blocks whilst the
+        /// queue is full.
+        ///
+        /// \returns False if the consumer has abandoned the export, true otherwise.
+        bool push (std::string && str) {
+            std::unique_lock<std::mutex> lock{mut_};
+            cv_.wait (lock, [this] { return cancelled_ || queue_.size () < capacity_; });
+            if (cancelled_) {
+                return false;
+            }
+            queue_.emplace_back (std::move (str));
+            cv_.notify_all ();
+            return true;
+        }
+
+        /// Called by the consumer to remove the next rendered transaction from the queue. Blocks
+        /// whilst the queue is empty.
+        ///
+        /// \returns The rendered transaction or nothing if the worker exited before producing it.
+        pstore::maybe<std::string> pop () {
+            std::unique_lock<std::mutex> lock{mut_};
+            cv_.wait (lock, [this] { return closed_ || !queue_.empty (); });
+            if (queue_.empty ()) {
+                return pstore::nothing<std::string> ();
+            }
+            auto result = pstore::just (std::move (queue_.front ()));
+            queue_.pop_front ();
+            cv_.notify_all ();
+            return result;
+        }
+
+        /// Called by the worker when it will produce no further output.
+        void close () {
+            std::lock_guard<std::mutex> const lock{mut_};
+            closed_ = true;
+            cv_.notify_all ();
+        }
+
+        /// Called by the consumer if it will consume no further output.
+        void cancel () {
+            std::lock_guard<std::mutex> const lock{mut_};
+            cancelled_ = true;
+            cv_.notify_all ();
+        }
+
+    private:
+        std::size_t const capacity_;
+        std::mutex mut_;
+        std::condition_variable cv_;
+        std::deque<std::string> queue_;
+        bool closed_ = false;
+        bool cancelled_ = false;
+    };
+
 } // end anonymous namespace
 
 namespace pstore {
@@ -101,41 +218,122 @@ namespace pstore {
 
                 auto const f = footers (db);
                 PSTORE_ASSERT (std::distance (std::begin (f), std::end (f)) >= 1);
-                emit_array (
-                    os, ind, std::next (std::begin (f)), std::end (f),
-                    [&] (ostream & os1, indent const ind1,
-                         pstore::typed_address<pstore::trailer> const footer_pos) {
-                        auto const footer = db.getro (footer_pos);
-                        unsigned const generation = footer->a.generation;
-                        db.sync (generation);
-                        os1 << ind1 << "{\n";
-                        auto const object_indent = ind1.next ();
-                        if (comments) {
-                            os1 << object_indent << "// transaction #" << generation << '\n';
-                        }
-                        bool const names_emitted = emit_strings<trailer::indices::name> (
-                            os1, object_indent, db, generation,
-                            prefix (false, object_indent, "names"), &string_table, comments);
-                        bool const paths_emitted = emit_strings<trailer::indices::path> (
-                            os1, object_indent, db, generation,
-                            prefix (names_emitted, object_indent, "paths"), &path_table, comments);
-                        if (paths_emitted || names_emitted) {
-                            os1 << ",\n";
+                emit_array (os, ind, std::next (std::begin (f)), std::end (f),
+                            [&] (ostream_base & os1, indent const ind1,
+                                 pstore::typed_address<pstore::trailer> const footer_pos) {
+                                unsigned const generation = db.getro (footer_pos)->a.generation;
+                                db.sync (generation);
+                                emit_transaction (os1, ind1, db, generation, &string_table,
+                                                  &path_table, comments);
+                            });
+                os << "\n}\n";
+            }
+
+            void emit_database (database & db, ostream & os, bool const comments,
+                                unsigned const jobs) {
+                if (jobs <= 1U) {
+                    emit_database (db, os, comments);
+                    return;
+                }
+
+                auto const f = footers (db);
+                PSTORE_ASSERT (std::distance (std::begin (f), std::end (f)) >= 1);
+
+                // The exported string indices are assigned in the order in which the strings
+                // were added to the store. Build the complete string tables up-front so that the
+                // workers can share them (read-only) irrespective of the order in which they
+                // process transactions.
+                string_mapping string_table{db, name_index_tag ()};
+                string_mapping path_table{db, path_index_tag ()};
+                std::for_each (std::next (std::begin (f)), std::end (f),
+                               [&] (typed_address<trailer> const footer_pos) {
+                                   unsigned const generation = db.getro (footer_pos)->a.generation;
+                                   db.sync (generation);
+                                   add_strings<trailer::indices::name> (db, generation,
+                                                                        &string_table);
+                                   add_strings<trailer::indices::path> (db, generation,
+                                                                        &path_table);
+                               });
+
+                auto const ind = indent{}.next ();
+                auto const transaction_indent = ind.next ();
+                auto const num_transactions = f.size ();
+                // Transaction #i (with i in the range [1, num_transactions)) is rendered by
+                // worker (i - 1) % jobs. Each worker has its own database instance so that it can
+                // be synced independently of the others.
+                auto const num_workers =
+                    std::min (static_cast<std::size_t> (jobs),
+                              std::max (num_transactions - 1U, std::size_t{1}));
+                std::vector<std::unique_ptr<transaction_channel>> channels;
+                channels.reserve (num_workers);
+                std::generate_n (std::back_inserter (channels), num_workers, [] {
+                    // Allow each worker to run a few transactions ahead of the writer.
+                    return std::make_unique<transaction_channel> (std::size_t{4});
+                });
+
+                auto const path = db.path ();
+                auto const worker = [&] (std::size_t const w) {
+                    transaction_channel & channel = *channels[w];
+                    auto const close = make_scope_guard ([&channel] { channel.close (); });
+
+                    database wdb{path, database::access_mode::read_only};
+                    for (auto t = w + 1U; t < num_transactions; t += num_workers) {
+                        unsigned const generation = wdb.getro (f[t])->a.generation;
+                        wdb.sync (generation);
+
+                        ostringstream os1;
+                        string_mapping const * const strings = &string_table;
+                        string_mapping const * const paths = &path_table;
+                        emit_transaction (os1, transaction_indent, wdb, generation, strings, paths,
+                                          comments);
+                        if (!channel.push (std::string{os1.str ()})) {
+                            break;
                         }
-                        if (emit_debug_line_headers (os1, object_indent, db, generation)) {
-                            os1 << ",\n";
+                    }
+                };
+
+                std::vector<std::future<void>> futures;
+                futures.reserve (num_workers);
+                for (auto w = std::size_t{0}; w < num_workers; ++w) {
+                    futures.emplace_back (std::async (std::launch::async, worker, w));
+                }
+                {
+                    auto const cancel_all = [&channels] {
+                        for (auto & channel : channels) {
+                            channel->cancel ();
                         }
-                        os1 << object_indent << R"("fragments":{)";
-                        emit_fragments (os1, object_indent.next (), db, generation, string_table,
-                                        comments);
-                        os1 << '\n' << object_indent << "},\n";
-                        os1 << object_indent << R"("compilations":{)";
-                        emit_compilation_index (os1, object_indent.next (), db, generation,
-                                                string_table, comments);
-                        os1 << '\n' << object_indent << "}\n";
-                        os1 << ind1 << '}';
-                    });
-                os << "\n}\n";
+                    };
+                    // If writing the output fails, release any workers waiting for queue space.
+                    auto const cancel = make_scope_guard (cancel_all);
+
+                    os << "{\n";
+                    os << ind << R"("version":1,)" << '\n';
+                    os << ind << R"("id":")" << db.get_header ().id ().str () << "\",\n";
+                    os << ind << R"("transactions":)";
+
+                    auto t = std::size_t{1};
+                    emit_array (os, ind, std::next (std::begin (f)), std::end (f),
+                                [&] (ostream_base & os1, indent, typed_address<trailer> const &) {
+                                    auto const w = (t - 1U) % num_workers;
+                                    maybe<std::string> const str = channels[w]->pop ();
+                                    if (!str) {
+                                        // The worker stopped before producing this transaction.
+                                        // Release the others and raise its exception before any
+                                        // more output is written.
+                                        cancel_all ();
+                                        futures[w].get ();
+                                        raise (std::errc::operation_canceled, "export worker");
+                                    }
+                                    os1 << *str;
+                                    ++t;
+                                });
+                    os << "\n}\n";
+                }
+
+                // Join the workers. future::get() raises any exception stored by a worker.
+                for (auto & fut : futures) {
+                    fut.get ();
+                }
             }
 
         } // end namespace export_ns
@@ -0,0 +1,313 @@
+//===- lib/exchange/export_binary.cpp -------------------------------------===//
+//*                             _     _     _                         *
+//*   _____  ___ __   ___  _ __| |_  | |__ (_)_ __   __ _ _ __ _   _  *
+//*  / _ \ \/ / '_ \ / _ \| '__| __| | '_ \| | '_ \ / _` | '__| | | | *
+//* |  __/>  <| |_) | (_) | |  | |_  | |_) | | | | | (_| | |  | |_| | *
+//*  \___/_/\_\ .__/ \___/|_|   \__| |_.__/|_|_| |_|\__,_|_|   \__, | *
+//*           |_|                                              |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file export_binary.cpp
+/// \brief Implements the top level entry point for exporting a pstore database using the binary
+/// exchange format.
+
+#include "pstore/exchange/export_binary.hpp"
+
+#include "pstore/core/database.hpp"
+#include "pstore/core/index_types.hpp"
+#include "pstore/exchange/binary_format.hpp"
+#include "pstore/exchange/export_strings.hpp"
+#include "pstore/mcrepo/compilation.hpp"
+#include "pstore/mcrepo/fragment.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
+#include "pstore/support/varint.hpp"
+
+namespace {
+
+    using byte_vector = std::vector<std::uint8_t>;
+    using pstore::exchange::binary::record_kind;
+    using pstore::exchange::export_ns::ostream_base;
+    using pstore::exchange::export_ns::string_mapping;
+
+    /// The maximum number of bytes of decompressed section payload held by the exporter.
+    constexpr std::size_t payload_cache_size = std::size_t{64} * 1024U * 1024U;
+
+    // append varint
+    // ~~~~~~~~~~~~~
+    void append_varint (byte_vector * const out, std::uint64_t const v) {
+        pstore::varint::encode (v, std::back_inserter (*out));
+    }
+
+    // append digest
+    // ~~~~~~~~~~~~~
+    void append_digest (byte_vector * const out, pstore::index::digest const & d) {
+        auto const append64 = [out] (std::uint64_t const v) {
+            for (auto shift = 56; shift >= 0; shift -= 8) {
+                out->push_back (static_cast<std::uint8_t> (v >> static_cast<unsigned> (shift)));
+            }
+        };
+        append64 (d.high ());
+        append64 (d.low ());
+    }
+
+    // append bytes
+    // ~~~~~~~~~~~~
+    template <typename Iterator>
+    void append_bytes (byte_vector * const out, Iterator const first, Iterator const last) {
+        append_varint (out, static_cast<std::uint64_t> (std::distance (first, last)));
+        out->insert (out->end (), first, last);
+    }
+
+    // write bytes
+    // ~~~~~~~~~~~
+    void write_bytes (ostream_base & os, std::uint8_t const * const first,
+                      std::uint8_t const * const last) {
+        os.write (reinterpret_cast<char const *> (first), last - first);
+    }
+
+    // write record
+    // ~~~~~~~~~~~~
+    void write_record (ostream_base & os, record_kind const kind, byte_vector const & payload) {
+        std::array<std::uint8_t, 1U + pstore::varint::max_output_length> prefix;
+        prefix[0] = static_cast<std::uint8_t> (kind);
+        auto const * const prefix_end = pstore::varint::encode (payload.size (), &prefix[1]);
+        write_bytes (os, prefix.data (), prefix_end);
+        write_bytes (os, payload.data (), payload.data () + payload.size ());
+    }
+
+    // append ifixups
+    // ~~~~~~~~~~~~~~
+    void append_ifixups (byte_vector * const out,
+                         pstore::repo::container<pstore::repo::internal_fixup> const & ifixups) {
+        append_varint (out, ifixups.size ());
+        for (pstore::repo::internal_fixup const & ifx : ifixups) {
+            out->push_back (static_cast<std::uint8_t> (ifx.section));
+            out->push_back (ifx.type);
+            append_varint (out, ifx.offset);
+            append_varint (out, pstore::exchange::binary::zigzag_encode (ifx.addend));
+        }
+    }
+
+    /// The means by which section payloads are read.
+    struct payload_source {
+        pstore::database const & db;
+        /// Avoids repeatedly decompressing a payload which is shared by many sections.
+        pstore::repo::payload_cache * cache;
+    };
+
+    // append section
+    // ~~~~~~~~~~~~~~
+    void append_section (byte_vector * const out, payload_source const & source,
+                         string_mapping const & strings,
+                         pstore::repo::generic_section const & content) {
+        append_varint (out, content.align ());
+        std::shared_ptr<std::uint8_t const> owner;
+        pstore::repo::container<std::uint8_t> const payload =
+            pstore::repo::load_payload (source.db, content, &owner, source.cache);
+        append_bytes (out, std::begin (payload), std::end (payload));
+        append_ifixups (out, content.ifixups ());
+
+        pstore::repo::container<pstore::repo::external_fixup> const xfixups = content.xfixups ();
+        append_varint (out, xfixups.size ());
+        for (pstore::repo::external_fixup const & xfx : xfixups) {
+            append_varint (out, strings.index (xfx.name));
+            out->push_back (xfx.type);
+            out->push_back (xfx.is_weak ? std::uint8_t{1} : std::uint8_t{0});
+            append_varint (out, xfx.offset);
+            append_varint (out, pstore::exchange::binary::zigzag_encode (xfx.addend));
+        }
+    }
+
+    void append_section (byte_vector * const out, payload_source const & /*source*/,
+                         string_mapping const & /*strings*/,
+                         pstore::repo::bss_section const & content) {
+        PSTORE_ASSERT (content.ifixups ().empty ());
+        PSTORE_ASSERT (content.xfixups ().empty ());
+        append_varint (out, content.align ());
+        append_varint (out, content.size ());
+    }
+
+    void append_section (byte_vector * const out, payload_source const & source,
+                         string_mapping const & /*strings*/,
+                         pstore::repo::debug_line_section const & content) {
+        PSTORE_ASSERT (content.align () == 1U);
+        PSTORE_ASSERT (content.xfixups ().size () == 0U);
+        append_digest (out, content.header_digest ());
+        std::shared_ptr<std::uint8_t const> owner;
+        pstore::repo::container<std::uint8_t> const payload =
+            pstore::repo::load_payload (source.db, content, &owner, source.cache);
+        append_bytes (out, std::begin (payload), std::end (payload));
+        append_ifixups (out, content.ifixups ());
+    }
+
+    void append_section (byte_vector * const out, payload_source const & /*source*/,
+                         string_mapping const & /*strings*/,
+                         pstore::repo::linked_definitions const & content) {
+        append_varint (out, content.size ());
+        for (pstore::repo::linked_definitions::value_type const & l : content) {
+            append_digest (out, l.compilation);
+            append_varint (out, l.index);
+        }
+    }
+
+    // write strings
+    // ~~~~~~~~~~~~~
+    template <pstore::trailer::indices Index>
+    void write_strings (ostream_base & os, record_kind const kind, pstore::database const & db,
+                        unsigned const generation, string_mapping * const string_table,
+                        byte_vector * const payload) {
+        payload->clear ();
+        pstore::exchange::export_ns::details::for_each_new_string<Index> (
+            db, generation, [&] (auto const & index, pstore::address const addr) {
+                pstore::indirect_string const str = index.load_leaf_node (db, addr);
+                pstore::shared_sstring_view owner;
+                pstore::raw_sstring_view const view = str.as_db_string_view (&owner);
+                append_bytes (payload, view.data (), view.data () + view.size ());
+                string_table->add (addr);
+            });
+        if (!payload->empty ()) {
+            write_record (os, kind, *payload);
+        }
+    }
+
+    // write debug line headers
+    // ~~~~~~~~~~~~~~~~~~~~~~~~
+    void write_debug_line_headers (ostream_base & os, pstore::database const & db,
+                                   unsigned const generation, byte_vector * const payload) {
+        auto const debug_line_headers =
+            pstore::index::get_index<pstore::trailer::indices::debug_line_header> (db);
+        if (debug_line_headers->empty ()) {
+            return;
+        }
+        auto const out_fn = [&] (pstore::address const addr) {
+            auto const & kvp = debug_line_headers->load_leaf_node (db, addr);
+            payload->clear ();
+            append_digest (payload, kvp.first);
+            std::shared_ptr<std::uint8_t const> const data = db.getro (kvp.second);
+            auto const * const ptr = data.get ();
+            append_bytes (payload, ptr, ptr + kvp.second.size);
+            write_record (os, record_kind::debug_line_header, *payload);
+        };
+        pstore::diff (db, *debug_line_headers, generation - 1U,
+                      pstore::exchange::export_ns::make_diff_out (&out_fn));
+    }
+
+    // write fragments
+    // ~~~~~~~~~~~~~~~
+    void write_fragments (ostream_base & os, pstore::database const & db,
+                          unsigned const generation, string_mapping const & strings,
+                          pstore::repo::payload_cache * const cache, byte_vector * const payload) {
+        using pstore::repo::section_kind;
+
+        auto const fragments = pstore::index::get_index<pstore::trailer::indices::fragment> (db);
+        if (fragments->empty ()) {
+            return;
+        }
+        payload_source const source{db, cache};
+        auto const out_fn = [&] (pstore::address const addr) {
+            auto const & kvp = fragments->load_leaf_node (db, addr);
+            std::shared_ptr<pstore::repo::fragment const> const fragment = db.getro (kvp.second);
+
+            payload->clear ();
+            append_digest (payload, kvp.first);
+            for (section_kind const kind : *fragment) {
+                payload->push_back (static_cast<std::uint8_t> (kind));
+#define X(a)                                                                                       \
+    case section_kind::a:                                                                          \
+        append_section (payload, source, strings, fragment->at<section_kind::a> ());               \
+        break;
+                switch (kind) {
+                    PSTORE_MCREPO_SECTION_KINDS
+                case section_kind::last:
+                    // unreachable...
+                    PSTORE_ASSERT (false);
+                    break;
+                }
+#undef X
+            }
+            write_record (os, record_kind::fragment, *payload);
+        };
+        pstore::diff (db, *fragments, generation - 1U,
+                      pstore::exchange::export_ns::make_diff_out (&out_fn));
+    }
+
+    // write compilations
+    // ~~~~~~~~~~~~~~~~~~
+    void write_compilations (ostream_base & os, pstore::database const & db,
+                             unsigned const generation, string_mapping const & strings,
+                             byte_vector * const payload) {
+        auto const compilations =
+            pstore::index::get_index<pstore::trailer::indices::compilation> (db);
+        if (!compilations || compilations->empty ()) {
+            return;
+        }
+        auto const out_fn = [&] (pstore::address const addr) {
+            auto const & kvp = compilations->load_leaf_node (db, addr);
+            std::shared_ptr<pstore::repo::compilation const> const compilation =
+                db.getro (kvp.second);
+
+            payload->clear ();
+            append_digest (payload, kvp.first);
+            append_varint (payload, strings.index (compilation->triple ()));
+            for (pstore::repo::definition const & d : *compilation) {
+                append_digest (payload, d.digest);
+                append_varint (payload, strings.index (d.name));
+                payload->push_back (static_cast<std::uint8_t> (d.linkage ()));
+                payload->push_back (static_cast<std::uint8_t> (d.visibility ()));
+            }
+            write_record (os, record_kind::compilation, *payload);
+        };
+        pstore::diff (db, *compilations, generation - 1U,
+                      pstore::exchange::export_ns::make_diff_out (&out_fn));
+    }
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace exchange {
+        namespace export_ns {
+
+            // emit binary database
+            // ~~~~~~~~~~~~~~~~~~~~
+            void emit_binary_database (database & db, ostream_base & os) {
+                string_mapping string_table{db, name_index_tag ()};
+                string_mapping path_table{db, path_index_tag ()};
+
+                repo::payload_cache cache{payload_cache_size};
+                byte_vector payload;
+                payload.reserve (4096);
+                payload.assign (std::begin (binary::signature), std::end (binary::signature));
+                append_varint (&payload, binary::version);
+                uuid const id = db.get_header ().id ();
+                payload.insert (payload.end (), std::begin (id.array ()), std::end (id.array ()));
+                write_bytes (os, payload.data (), payload.data () + payload.size ());
+
+                // The first (zeroth) transaction in the store is, by definition, empty so we
+                // start at 1.
+                unsigned const head = db.get_current_revision ();
+                for (auto generation = 1U; generation <= head; ++generation) {
+                    db.sync (generation);
+                    write_strings<trailer::indices::name> (os, binary::record_kind::names, db,
+                                                           generation, &string_table, &payload);
+                    write_strings<trailer::indices::path> (os, binary::record_kind::paths, db,
+                                                           generation, &path_table, &payload);
+                    write_debug_line_headers (os, db, generation, &payload);
+                    write_fragments (os, db, generation, string_table, &cache, &payload);
+                    write_compilations (os, db, generation, string_table, &payload);
+
+                    payload.clear ();
+                    write_record (os, binary::record_kind::commit, payload);
+                }
+                payload.clear ();
+                write_record (os, binary::record_kind::end, payload);
+            }
+
+        } // end namespace export_ns
+    }     // end namespace exchange
+} // end namespace pstore
@@ -48,7 +48,7 @@ namespace pstore {
                 os << '\n' << ind << '}';
             }
 
-            void emit_fragments (ostream & os, indent const ind, database const & db,
+            void emit_fragments (ostream_base & os, indent const ind, database const & db,
                                  unsigned const generation, string_mapping const & strings,
                                  bool const comments) {
                 auto const fragments = index::get_index<trailer::indices::fragment> (db);
@@ -0,0 +1,709 @@
+//===- lib/exchange/import_binary.cpp -------------------------------------===//
+//*  _                            _     _     _                         *
+//* (_)_ __ ___  _ __   ___  _ __| |_  | |__ (_)_ __   __ _ _ __ _   _  *
+//* | | '_ ` _ \| '_ \ / _ \| '__| __| | '_ \| | '_ \ / _` | '__| | | | *
+//* | | | | | | | |_) | (_) | |  | |_  | |_) | | | | | (_| | |  | |_| | *
+//* |_|_| |_| |_| .__/ \___/|_|   \__| |_.__/|_|_| |_|\__,_|_|   \__, | *
+//*             |_|                                              |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file import_binary.cpp
+/// \brief Implements the class which consumes the binary exchange format.
+
+#include "pstore/exchange/import_binary.hpp"
+
+#include "pstore/exchange/import_fragment.hpp"
+#include "pstore/mcrepo/compilation.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
+#include "pstore/support/aligned.hpp"
+#include "pstore/support/pointee_adaptor.hpp"
+#include "pstore/support/varint.hpp"
+
+namespace {
+
+    using pstore::exchange::import_ns::error;
+
+    //*                        _                   _          *
+    //*  _ _ ___ __ ___ _ _ __| |  _ _ ___ __ _ __| |___ _ _  *
+    //* | '_/ -_) _/ _ \ '_/ _` | | '_/ -_) _` / _` / -_) '_| *
+    //* |_| \___\__\___/_| \__,_| |_| \___\__,_\__,_\___|_|   *
+    //*                                                       *
+    /// Reads the fields of a record payload. Rather than checking for an error after each value,
+    /// the reader remembers whether it ran past the end of the payload: the caller need only check
+    /// ok() before acting on the values it has read.
+    class record_reader {
+    public:
+        using byte_range = std::pair<std::uint8_t const *, std::uint8_t const *>;
+
+        record_reader (std::uint8_t const * const first, std::uint8_t const * const last) noexcept
+                : pos_{first}
+                , last_{last} {}
+
+        /// Returns true if no errors have been encountered.
+        bool ok () const noexcept { return ok_; }
+        /// Returns true if the entire payload has been consumed.
+        bool empty () const noexcept { return pos_ == last_; }
+        /// Returns true if the entire payload was consumed without error.
+        bool complete () const noexcept { return ok_ && this->empty (); }
+
+        std::uint8_t byte () noexcept {
+            if (!this->has (1U)) {
+                return 0U;
+            }
+            return *(pos_++);
+        }
+
+        std::uint64_t varint () noexcept {
+            if (!this->has (1U)) {
+                return 0U;
+            }
+            unsigned const size = pstore::varint::decode_size (pos_);
+            if (!this->has (size)) {
+                return 0U;
+            }
+            std::uint64_t const result = pstore::varint::decode (pos_, size);
+            pos_ += size;
+            return result;
+        }
+
+        std::int64_t signed_varint () noexcept {
+            return pstore::exchange::binary::zigzag_decode (this->varint ());
+        }
+
+        pstore::index::digest digest () noexcept {
+            if (!this->has (16U)) {
+                return {};
+            }
+            pstore::index::digest const result{pos_};
+            pos_ += 16U;
+            return result;
+        }
+
+        /// Reads a length-prefixed sequence of bytes.
+        byte_range bytes () noexcept {
+            std::uint64_t const size = this->varint ();
+            if (!this->has (size)) {
+                return {pos_, pos_};
+            }
+            auto const * const first = pos_;
+            pos_ += size;
+            return {first, pos_};
+        }
+
+    private:
+        bool has (std::uint64_t const size) noexcept {
+            if (ok_ && size > static_cast<std::uint64_t> (last_ - pos_)) {
+                ok_ = false;
+            }
+            return ok_;
+        }
+
+        std::uint8_t const * pos_;
+        std::uint8_t const * const last_;
+        bool ok_ = true;
+    };
+
+    // set alignment
+    // ~~~~~~~~~~~~~
+    std::error_code set_alignment (pstore::repo::section_content * const content,
+                                   std::uint64_t const align) {
+        if (!pstore::is_power_of_two (align)) {
+            return error::alignment_must_be_power_of_2;
+        }
+        using align_type = decltype (content->align);
+        static_assert (std::is_unsigned<align_type>::value, "Expected alignment to be unsigned");
+        if (align > std::numeric_limits<align_type>::max ()) {
+            return error::alignment_is_too_great;
+        }
+        content->align = static_cast<align_type> (align);
+        return {};
+    }
+
+    // read ifixups
+    // ~~~~~~~~~~~~
+    std::error_code read_ifixups (record_reader * const reader,
+                                  std::vector<pstore::repo::internal_fixup> * const ifixups) {
+        using pstore::repo::section_kind;
+
+        std::uint64_t const count = reader->varint ();
+        for (auto ctr = std::uint64_t{0}; ctr < count && reader->ok (); ++ctr) {
+            std::uint8_t const section = reader->byte ();
+            std::uint8_t const type = reader->byte ();
+            std::uint64_t const offset = reader->varint ();
+            std::int64_t const addend = reader->signed_varint ();
+            if (section >= static_cast<std::uint8_t> (section_kind::last)) {
+                return error::unknown_section_name;
+            }
+            ifixups->emplace_back (static_cast<section_kind> (section), type, offset, addend);
+        }
+        return reader->ok () ? std::error_code{} : error::bad_binary_record;
+    }
+
+    //*   __                             _     _         _ _    _          *
+    //*  / _|_ _ __ _ __ _ _ __  ___ _ _| |_  | |__ _  _(_) |__| |___ _ _  *
+    //* |  _| '_/ _` / _` | '  \/ -_) ' \  _| | '_ \ || | | / _` / -_) '_| *
+    //* |_| |_| \__,_\__, |_|_|_\___|_||_\__| |_.__/\_,_|_|_\__,_\___|_|   *
+    //*              |___/                                                 *
+    /// Accumulates the sections of a fragment record and creates the corresponding section
+    /// creation dispatchers.
+    class fragment_builder {
+    public:
+        fragment_builder (pstore::database & db,
+                          pstore::exchange::import_ns::string_mapping const & names) noexcept
+                : db_{db}
+                , names_{names} {}
+
+        std::error_code read_section (pstore::repo::section_kind kind, record_reader * reader);
+
+        std::vector<std::unique_ptr<pstore::repo::section_creation_dispatcher>> const &
+        dispatchers () const noexcept {
+            return dispatchers_;
+        }
+
+    private:
+        std::error_code read (pstore::repo::section_kind kind, record_reader * reader,
+                              pstore::repo::generic_section const *);
+        std::error_code read (pstore::repo::section_kind kind, record_reader * reader,
+                              pstore::repo::bss_section const *);
+        std::error_code read (pstore::repo::section_kind kind, record_reader * reader,
+                              pstore::repo::debug_line_section const *);
+        std::error_code read (pstore::repo::section_kind kind, record_reader * reader,
+                              pstore::repo::linked_definitions const *);
+
+        pstore::repo::section_content * section_contents (pstore::repo::section_kind const kind) {
+            auto * const content = &contents_[static_cast<std::size_t> (kind)];
+            content->kind = kind;
+            return content;
+        }
+
+        pstore::database & db_;
+        pstore::exchange::import_ns::string_mapping const & names_;
+
+        std::array<pstore::repo::section_content, pstore::repo::num_section_kinds> contents_;
+        pstore::exchange::import_ns::linked_definitions_container linked_definitions_;
+        std::vector<std::unique_ptr<pstore::repo::section_creation_dispatcher>> dispatchers_;
+    };
+
+    // read section
+    // ~~~~~~~~~~~~
+    std::error_code fragment_builder::read_section (pstore::repo::section_kind const kind,
+                                                    record_reader * const reader) {
+        using pstore::repo::section_kind;
+#define X(a)                                                                                       \
+    case section_kind::a:                                                                          \
+        return this->read (kind, reader,                                                           \
+                           static_cast<pstore::repo::enum_to_section_t<section_kind::a> const *> ( \
+                               nullptr));
+        switch (kind) {
+            PSTORE_MCREPO_SECTION_KINDS
+        case section_kind::last: break;
+        }
+#undef X
+        return error::unknown_section_name;
+    }
+
+    // read [generic section]
+    // ~~~~~~~~~~~~~~~~~~~~~~
+    std::error_code fragment_builder::read (pstore::repo::section_kind const kind,
+                                            record_reader * const reader,
+                                            pstore::repo::generic_section const *) {
+        pstore::repo::section_content * const content = this->section_contents (kind);
+        std::uint64_t const align = reader->varint ();
+        record_reader::byte_range const data = reader->bytes ();
+        if (std::error_code const erc = read_ifixups (reader, &content->ifixups)) {
+            return erc;
+        }
+        std::uint64_t const count = reader->varint ();
+        for (auto ctr = std::uint64_t{0}; ctr < count && reader->ok (); ++ctr) {
+            std::uint64_t const name_index = reader->varint ();
+            std::uint8_t const type = reader->byte ();
+            std::uint8_t const is_weak = reader->byte ();
+            std::uint64_t const offset = reader->varint ();
+            std::int64_t const addend = reader->signed_varint ();
+            if (!reader->ok ()) {
+                break;
+            }
+            auto const name = names_.lookup (name_index);
+            if (!name) {
+                return name.get_error ();
+            }
+            content->xfixups.emplace_back (*name, type,
+                                           is_weak != 0U ? pstore::repo::binding::weak
+                                                         : pstore::repo::binding::strong,
+                                           offset, addend);
+        }
+        if (!reader->ok ()) {
+            return error::bad_binary_record;
+        }
+        if (std::error_code const erc = set_alignment (content, align)) {
+            return erc;
+        }
+        content->data.assign (data.first, data.second);
+        dispatchers_.emplace_back (
+            std::make_unique<pstore::repo::generic_section_creation_dispatcher> (kind, content));
+        return {};
+    }
+
+    // read [bss section]
+    // ~~~~~~~~~~~~~~~~~~
+    std::error_code fragment_builder::read (pstore::repo::section_kind const kind,
+                                            record_reader * const reader,
+                                            pstore::repo::bss_section const *) {
+        pstore::repo::section_content * const content = this->section_contents (kind);
+        std::uint64_t const align = reader->varint ();
+        std::uint64_t const size = reader->varint ();
+        if (!reader->ok ()) {
+            return error::bad_binary_record;
+        }
+        if (std::error_code const erc = set_alignment (content, align)) {
+            return erc;
+        }
+        content->data.resize (size);
+        dispatchers_.emplace_back (
+            std::make_unique<pstore::repo::bss_section_creation_dispatcher> (content));
+        return {};
+    }
+
+    // read [debug line section]
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~
+    std::error_code fragment_builder::read (pstore::repo::section_kind const kind,
+                                            record_reader * const reader,
+                                            pstore::repo::debug_line_section const *) {
+        pstore::repo::section_content * const content = this->section_contents (kind);
+        pstore::index::digest const header_digest = reader->digest ();
+        record_reader::byte_range const data = reader->bytes ();
+        if (std::error_code const erc = read_ifixups (reader, &content->ifixups)) {
+            return erc;
+        }
+        if (!reader->ok ()) {
+            return error::bad_binary_record;
+        }
+
+        auto const index =
+            pstore::index::get_index<pstore::trailer::indices::debug_line_header> (db_);
+        auto const pos = index->find (db_, header_digest);
+        if (pos == index->end (db_)) {
+            return error::debug_line_header_digest_not_found;
+        }
+        content->data.assign (data.first, data.second);
+        dispatchers_.emplace_back (
+            std::make_unique<pstore::repo::debug_line_section_creation_dispatcher> (
+                header_digest, pos->second, content));
+        return {};
+    }
+
+    // read [linked definitions]
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~
+    std::error_code fragment_builder::read (pstore::repo::section_kind const /*kind*/,
+                                            record_reader * const reader,
+                                            pstore::repo::linked_definitions const *) {
+        std::uint64_t const count = reader->varint ();
+        for (auto ctr = std::uint64_t{0}; ctr < count && reader->ok (); ++ctr) {
+            pstore::index::digest const compilation = reader->digest ();
+            std::uint64_t const index = reader->varint ();
+            if (index > std::numeric_limits<std::uint32_t>::max ()) {
+                return error::index_out_of_range;
+            }
+            linked_definitions_.emplace_back (
+                compilation, static_cast<std::uint32_t> (index),
+                pstore::typed_address<pstore::repo::definition>::make (index));
+        }
+        // A linked-definitions section must hold at least one reference to a definition.
+        if (!reader->ok () || linked_definitions_.empty ()) {
+            return error::bad_binary_record;
+        }
+        auto const * const data = linked_definitions_.data ();
+        dispatchers_.emplace_back (
+            std::make_unique<pstore::repo::linked_definitions_creation_dispatcher> (
+                data, data + linked_definitions_.size ()));
+        return {};
+    }
+
+    // decode linkage
+    // ~~~~~~~~~~~~~~
+    pstore::maybe<pstore::repo::linkage> decode_linkage (std::uint8_t const l) {
+        using pstore::repo::linkage;
+#define X(a)                                                                                       \
+    case linkage::a: return pstore::just (linkage::a);
+        switch (static_cast<linkage> (l)) { PSTORE_REPO_LINKAGES }
+#undef X
+        return pstore::nothing<linkage> ();
+    }
+
+    // decode visibility
+    // ~~~~~~~~~~~~~~~~~
+    pstore::maybe<pstore::repo::visibility> decode_visibility (std::uint8_t const v) {
+        using pstore::repo::visibility;
+        switch (static_cast<visibility> (v)) {
+        case visibility::default_vis: return pstore::just (visibility::default_vis);
+        case visibility::hidden_vis: return pstore::just (visibility::hidden_vis);
+        case visibility::protected_vis: return pstore::just (visibility::protected_vis);
+        }
+        return pstore::nothing<visibility> ();
+    }
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace exchange {
+        namespace import_ns {
+
+            //*  _    _                      _                     _            *
+            //* | |__(_)_ _  __ _ _ _ _  _  (_)_ __  _ __  ___ _ _| |_ ___ _ _  *
+            //* | '_ \ | ' \/ _` | '_| || | | | '  \| '_ \/ _ \ '_|  _/ -_) '_| *
+            //* |_.__/_|_||_\__,_|_|  \_, | |_|_|_|_| .__/\___/_|  \__\___|_|   *
+            //*                       |__/          |_|                         *
+            // (ctor)
+            // ~~~~~~
+            binary_importer::binary_importer (gsl::not_null<database *> const db,
+                                              repo::payload_options const & payloads)
+                    : ctxt_{db} {
+                ctxt_.payloads = payloads;
+            }
+
+            // input
+            // ~~~~~
+            std::error_code binary_importer::input (std::uint8_t const * const first,
+                                                    std::uint8_t const * const last) {
+                if (error_) {
+                    return error_;
+                }
+                if (buffer_.empty ()) {
+                    // The common case: process complete records directly from the input and
+                    // buffer only the trailing partial record (if any).
+                    std::uint8_t const * const pos = this->consume (first, last);
+                    buffer_.assign (pos, last);
+                } else {
+                    buffer_.insert (buffer_.end (), first, last);
+                    std::uint8_t const * const begin = buffer_.data ();
+                    std::uint8_t const * const pos = this->consume (begin, begin + buffer_.size ());
+                    buffer_.erase (buffer_.begin (), buffer_.begin () + (pos - begin));
+                }
+                return error_;
+            }
+
+            // eof
+            // ~~~
+            std::error_code binary_importer::eof () {
+                if (!error_) {
+                    if (state_ != state::done) {
+                        error_ = error::unexpected_end_of_binary_input;
+                    } else if (!buffer_.empty ()) {
+                        // There was data after the end record.
+                        error_ = error::bad_binary_record;
+                    }
+                }
+                return error_;
+            }
+
+            // consume
+            // ~~~~~~~
+            std::uint8_t const * binary_importer::consume (std::uint8_t const * first,
+                                                           std::uint8_t const * const last) {
+                while (!error_ && state_ != state::done) {
+                    if (state_ == state::header) {
+                        std::uint8_t const * const pos = this->header (first, last);
+                        if (pos == nullptr) {
+                            break;
+                        }
+                        offset_ += static_cast<std::uint64_t> (pos - first);
+                        first = pos;
+                        state_ = state::records;
+                        continue;
+                    }
+
+                    // A record is the kind byte followed by a varint payload size and the payload.
+                    auto const available = static_cast<std::uint64_t> (last - first);
+                    if (available < 2U) {
+                        break;
+                    }
+                    unsigned const size_bytes = varint::decode_size (first + 1);
+                    if (available < 1U + size_bytes) {
+                        break;
+                    }
+                    std::uint64_t const size = varint::decode (first + 1, size_bytes);
+                    std::uint8_t const * const payload = first + 1 + size_bytes;
+                    if (size > static_cast<std::uint64_t> (last - payload)) {
+                        break;
+                    }
+                    error_ = this->record (static_cast<binary::record_kind> (*first), payload,
+                                           payload + size);
+                    if (error_) {
+                        break;
+                    }
+                    offset_ += static_cast<std::uint64_t> (payload + size - first);
+                    first = payload + size;
+                }
+                return first;
+            }
+
+            // header
+            // ~~~~~~
+            std::uint8_t const * binary_importer::header (std::uint8_t const * const first,
+                                                          std::uint8_t const * const last) {
+                auto const & signature = binary::signature;
+                auto const available = static_cast<std::size_t> (last - first);
+                // Check as much of the signature as we have so that garbage input is rejected
+                // promptly.
+                if (!std::equal (first, first + std::min (available, signature.size ()),
+                                 std::begin (signature))) {
+                    error_ = error::bad_binary_signature;
+                    return nullptr;
+                }
+                if (available <= signature.size ()) {
+                    return nullptr;
+                }
+                std::uint8_t const * pos = first + signature.size ();
+                unsigned const version_bytes = varint::decode_size (pos);
+                auto constexpr id_bytes = std::tuple_size<uuid::container_type>::value;
+                if (static_cast<std::size_t> (last - pos) < version_bytes + id_bytes) {
+                    return nullptr;
+                }
+                if (varint::decode (pos, version_bytes) != binary::version) {
+                    error_ = error::unsupported_binary_version;
+                    return nullptr;
+                }
+                pos += version_bytes;
+
+                uuid::container_type id;
+                std::copy (pos, pos + id_bytes, std::begin (id));
+                id_ = uuid{id};
+                return pos + id_bytes;
+            }
+
+            // record
+            // ~~~~~~
+            std::error_code binary_importer::record (binary::record_kind const kind,
+                                                     std::uint8_t const * const first,
+                                                     std::uint8_t const * const last) {
+                using binary::record_kind;
+
+                // Records within a transaction must appear in the same order as the members of a
+                // JSON transaction object. Later records rely on earlier ones: fragments may
+                // reference debug line headers, for example.
+                if (kind < last_kind_) {
+                    return error::binary_record_out_of_order;
+                }
+                last_kind_ = kind;
+
+                switch (kind) {
+                case record_kind::names: return this->strings (first, last, &names_);
+                case record_kind::paths: return this->strings (first, last, &paths_);
+                case record_kind::debug_line_header: return this->debug_line_header (first, last);
+                case record_kind::fragment: return this->fragment (first, last);
+                case record_kind::compilation: return this->compilation (first, last);
+                case record_kind::commit:
+                    return first == last ? this->commit () : error::bad_binary_record;
+                case record_kind::end:
+                    return first == last ? this->end () : error::bad_binary_record;
+                }
+                return error::unknown_binary_record;
+            }
+
+            // get transaction
+            // ~~~~~~~~~~~~~~~
+            transaction_base & binary_importer::get_transaction () {
+                if (transaction_ == nullptr) {
+                    transaction_ =
+                        std::make_unique<transaction<transaction_lock>> (begin (*ctxt_.db));
+                }
+                return *transaction_;
+            }
+
+            // strings
+            // ~~~~~~~
+            std::error_code binary_importer::strings (std::uint8_t const * const first,
+                                                      std::uint8_t const * const last,
+                                                      not_null<string_mapping *> const strings) {
+                transaction_base & transaction = this->get_transaction ();
+                record_reader reader{first, last};
+                while (!reader.empty ()) {
+                    record_reader::byte_range const str = reader.bytes ();
+                    if (!reader.ok ()) {
+                        return error::bad_binary_record;
+                    }
+                    if (std::error_code const erc = strings->add_string (
+                            &transaction, std::string{str.first, str.second})) {
+                        return erc;
+                    }
+                }
+                strings->flush (&transaction);
+                return {};
+            }
+
+            // debug line header
+            // ~~~~~~~~~~~~~~~~~
+            std::error_code binary_importer::debug_line_header (std::uint8_t const * const first,
+                                                                std::uint8_t const * const last) {
+                record_reader reader{first, last};
+                index::digest const digest = reader.digest ();
+                record_reader::byte_range const data = reader.bytes ();
+                if (!reader.complete ()) {
+                    return error::bad_binary_record;
+                }
+
+                transaction_base & transaction = this->get_transaction ();
+                auto const size = static_cast<std::size_t> (data.second - data.first);
+                // Create space for this data in the store and copy it there.
+                std::shared_ptr<std::uint8_t> out;
+                typed_address<std::uint8_t> where;
+                std::tie (out, where) = transaction.alloc_rw<std::uint8_t> (size);
+                std::copy (data.first, data.second, out.get ());
+
+                // Add an index entry for this data.
+                auto const index =
+                    index::get_index<trailer::indices::debug_line_header> (transaction.db ());
+                index->insert (transaction,
+                               std::make_pair (digest, extent<std::uint8_t>{where, size}));
+                return {};
+            }
+
+            // fragment
+            // ~~~~~~~~
+            std::error_code binary_importer::fragment (std::uint8_t const * const first,
+                                                       std::uint8_t const * const last) {
+                record_reader reader{first, last};
+                index::digest const digest = reader.digest ();
+
+                fragment_builder builder{*ctxt_.db, names_};
+                auto prev_kind = -1;
+                while (reader.ok () && !reader.empty ()) {
+                    std::uint8_t const kind = reader.byte ();
+                    // Sections must be unique and appear in section_kind order.
+                    if (static_cast<int> (kind) <= prev_kind) {
+                        return error::bad_binary_record;
+                    }
+                    prev_kind = kind;
+                    if (kind >= static_cast<std::uint8_t> (repo::section_kind::last)) {
+                        return error::unknown_section_name;
+                    }
+                    if (std::error_code const erc = builder.read_section (
+                            static_cast<repo::section_kind> (kind), &reader)) {
+                        return erc;
+                    }
+                }
+                if (!reader.complete ()) {
+                    return error::bad_binary_record;
+                }
+
+                transaction_base & transaction = this->get_transaction ();
+                auto const & dispatchers = builder.dispatchers ();
+                auto const dispatchers_begin = make_pointee_adaptor (dispatchers.begin ());
+                auto const dispatchers_end = make_pointee_adaptor (dispatchers.end ());
+                if (ctxt_.payloads.enabled ()) {
+                    repo::store_payloads (transaction, dispatchers_begin, dispatchers_end,
+                                          ctxt_.payloads);
+                }
+                auto const fext =
+                    repo::fragment::alloc (transaction, dispatchers_begin, dispatchers_end);
+
+                // Check that the fragment is legal before we go further.
+                if (std::error_code const erc = fragment_sections::check_fragment (
+                        *repo::fragment::load (*ctxt_.db, fext))) {
+                    return erc;
+                }
+                auto const fragments =
+                    index::get_index<trailer::indices::fragment> (*ctxt_.db, true /* create */);
+                fragments->insert (transaction, std::make_pair (digest, fext));
+
+                // If this fragment has a linked-definitions section then we need to patch the
+                // addresses of the referenced definitions once we've imported everything.
+                if (std::find_if (dispatchers_begin, dispatchers_end,
+                                  [] (repo::section_creation_dispatcher const & d) {
+                                      return d.kind () == repo::section_kind::linked_definitions;
+                                  }) != dispatchers_end) {
+                    ctxt_.patches.emplace_back (new address_patch (ctxt_.db, fext));
+                }
+                return {};
+            }
+
+            // compilation
+            // ~~~~~~~~~~~
+            std::error_code binary_importer::compilation (std::uint8_t const * const first,
+                                                          std::uint8_t const * const last) {
+                record_reader reader{first, last};
+                index::digest const digest = reader.digest ();
+                std::uint64_t const triple_index = reader.varint ();
+                if (!reader.ok ()) {
+                    return error::bad_binary_record;
+                }
+                auto const triple = names_.lookup (triple_index);
+                if (!triple) {
+                    return triple.get_error ();
+                }
+
+                database & db = *ctxt_.db;
+                auto const fragments = index::get_index<trailer::indices::fragment> (db);
+                std::vector<repo::definition> definitions;
+                while (!reader.empty ()) {
+                    index::digest const fragment_digest = reader.digest ();
+                    std::uint64_t const name_index = reader.varint ();
+                    std::uint8_t const linkage = reader.byte ();
+                    std::uint8_t const visibility = reader.byte ();
+                    if (!reader.ok ()) {
+                        return error::bad_binary_record;
+                    }
+
+                    auto const fpos = fragments->find (db, fragment_digest);
+                    if (fpos == fragments->end (db)) {
+                        return error::no_such_fragment;
+                    }
+                    auto const name = names_.lookup (name_index);
+                    if (!name) {
+                        return name.get_error ();
+                    }
+                    maybe<repo::linkage> const l = decode_linkage (linkage);
+                    if (!l) {
+                        return error::bad_linkage;
+                    }
+                    maybe<repo::visibility> const v = decode_visibility (visibility);
+                    if (!v) {
+                        return error::bad_visibility;
+                    }
+                    definitions.emplace_back (fragment_digest, fpos->second, *name, *l, *v);
+                }
+
+                // Create the compilation record in the store and add it to the compilations
+                // index.
+                transaction_base & transaction = this->get_transaction ();
+                extent<repo::compilation> const compilation_extent = repo::compilation::alloc (
+                    transaction, *triple, std::begin (definitions), std::end (definitions));
+                auto const compilations = index::get_index<trailer::indices::compilation> (db);
+                compilations->insert (transaction, std::make_pair (digest, compilation_extent));
+                return {};
+            }
+
+            // commit
+            // ~~~~~~
+            std::error_code binary_importer::commit () {
+                transaction_base & transaction = this->get_transaction ();
+                if (std::error_code const erc = ctxt_.apply_patches (&transaction)) {
+                    return erc;
+                }
+                transaction.commit ();
+                transaction_.reset ();
+                last_kind_ = binary::record_kind::end;
+                return {};
+            }
+
+            // end
+            // ~~~
+            std::error_code binary_importer::end () {
+                // Every transaction must have been committed.
+                if (transaction_ != nullptr) {
+                    return error::unexpected_end_of_binary_input;
+                }
+                ctxt_.db->set_id (id_);
+                state_ = state::done;
+                return {};
+            }
+
+        } // end namespace import_ns
+    }     // end namespace exchange
+} // end namespace pstore
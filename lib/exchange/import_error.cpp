@@ -124,6 +124,21 @@ namespace pstore {
                     break;
 
                 case error::number_too_large: result = "number too large"; break;
+
+                case error::bad_binary_signature:
+                    result = "the input is not a binary exchange file";
+                    break;
+                case error::unsupported_binary_version:
+                    result = "unsupported binary exchange format version";
+                    break;
+                case error::unknown_binary_record: result = "unknown binary record kind"; break;
+                case error::bad_binary_record: result = "binary record was malformed"; break;
+                case error::binary_record_out_of_order:
+                    result = "binary record was out of order";
+                    break;
+                case error::unexpected_end_of_binary_input:
+                    result = "unexpected end of binary input";
+                    break;
                 }
                 return result;
             }
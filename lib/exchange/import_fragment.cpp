@@ -23,6 +23,8 @@
 
 #include <type_traits>
 
+#include "pstore/mcrepo/shared_payload.hpp"
+
 namespace {
 
     template <typename Section>
@@ -104,7 +106,8 @@ namespace pstore {
                     , transaction_{transaction}
                     , names_{names}
                     , digest_{digest}
-                    , oit_{dispatchers_} {
+                    , contents_{std::make_unique<fragment_contents> ()}
+                    , oit_{contents_->dispatchers} {
                 PSTORE_ASSERT (&transaction->db () == ctxt->db);
             }
 
@@ -164,8 +167,22 @@ namespace pstore {
                 context * const ctxt = this->get_context ();
                 PSTORE_ASSERT (ctxt->db == &transaction_->db ());
 
-                auto const dispatchers_begin = make_pointee_adaptor (dispatchers_.begin ());
-                auto const dispatchers_end = make_pointee_adaptor (dispatchers_.end ());
+                if (fragment_pipeline * const pipeline = ctxt->pipeline.get ()) {
+                    if (std::error_code const erc = pipeline->submit (ctxt, transaction_, *digest_,
+                                                                      std::move (contents_))) {
+                        return erc;
+                    }
+                    return pop ();
+                }
+
+                std::vector<std::unique_ptr<repo::section_creation_dispatcher>> const &
+                    dispatchers = contents_->dispatchers;
+                auto const dispatchers_begin = make_pointee_adaptor (dispatchers.begin ());
+                auto const dispatchers_end = make_pointee_adaptor (dispatchers.end ());
+                if (ctxt->payloads.enabled ()) {
+                    repo::store_payloads (*transaction_, dispatchers_begin, dispatchers_end,
+                                          ctxt->payloads);
+                }
                 auto const fext =
                     repo::fragment::alloc (*transaction_, dispatchers_begin, dispatchers_end);
 
@@ -225,7 +242,17 @@ namespace pstore {
 
             // end object
             // ~~~~~~~~~~
-            std::error_code fragment_index::end_object () { return pop (); }
+            std::error_code fragment_index::end_object () {
+                context * const ctxt = this->get_context ();
+                if (fragment_pipeline * const pipeline = ctxt->pipeline.get ()) {
+                    // Ensure that all of the fragments are in the index before we continue: the
+                    // compilations which follow will reference them.
+                    if (std::error_code const erc = pipeline->flush (ctxt, transaction_)) {
+                        return erc;
+                    }
+                }
+                return pop ();
+            }
 
         } // end namespace import_ns
     }     // end namespace exchange
@@ -0,0 +1,251 @@
+//===- lib/exchange/import_fragment_pipeline.cpp --------------------------===//
+//*  _                            _    *
+//* (_)_ __ ___  _ __   ___  _ __| |_  *
+//* | | '_ ` _ \| '_ \ / _ \| '__| __| *
+//* | | | | | | | |_) | (_) | |  | |_  *
+//* |_|_| |_| |_| .__/ \___/|_|   \__| *
+//*             |_|                    *
+//*   __                                      _    *
+//*  / _|_ __ __ _  __ _ _ __ ___   ___ _ __ | |_  *
+//* | |_| '__/ _` |/ _` | '_ ` _ \ / _ \ '_ \| __| *
+//* |  _| | | (_| | (_| | | | | | |  __/ | | | |_  *
+//* |_| |_|  \__,_|\__, |_| |_| |_|\___|_| |_|\__| *
+//*                |___/                           *
+//*        _            _ _             *
+//*  _ __ (_)_ __   ___| (_)_ __   ___  *
+//* | '_ \| | '_ \ / _ \ | | '_ \ / _ \ *
+//* | |_) | | |_) |  __/ | | | | |  __/ *
+//* | .__/|_| .__/ \___|_|_|_| |_|\___| *
+//* |_|     |_|                         *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/exchange/import_fragment_pipeline.hpp"
+
+#include <cstring>
+
+#include "pstore/core/transaction.hpp"
+#include "pstore/exchange/import_error.hpp"
+#include "pstore/exchange/import_fragment.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
+#include "pstore/support/base64.hpp"
+#include "pstore/support/pointee_adaptor.hpp"
+
+namespace {
+
+    /// Satisfies the requirements that repo::fragment::alloc() places on its Transaction type so
+    /// that a fragment can be built in ordinary memory rather than in a store.
+    class image_allocator {
+    public:
+        std::pair<std::shared_ptr<void>, pstore::address> alloc_rw (std::size_t const size,
+                                                                    unsigned const align) {
+            storage_.reset (new std::uint8_t[size + align - 1U]);
+            void * ptr = storage_.get ();
+            auto space = size + align - 1U;
+            ptr = std::align (align, size, ptr, space);
+            PSTORE_ASSERT (ptr != nullptr);
+            image_ = static_cast<std::uint8_t *> (ptr);
+            return {std::shared_ptr<void> (image_, [] (void *) {}), pstore::address::null ()};
+        }
+
+        std::unique_ptr<std::uint8_t[]> release_storage () noexcept { return std::move (storage_); }
+        std::uint8_t const * image () const noexcept { return image_; }
+
+    private:
+        std::unique_ptr<std::uint8_t[]> storage_;
+        std::uint8_t * image_ = nullptr;
+    };
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace exchange {
+        namespace import_ns {
+
+            //*   __                             _          _           _ _           *
+            //*  / _|_ _ __ _ __ _ _ __  ___ _ _| |_   _ __(_)_ __  ___| (_)_ _  ___  *
+            //* |  _| '_/ _` / _` | '  \/ -_) ' \  _| | '_ \ | '_ \/ -_) | | ' \/ -_) *
+            //* |_| |_| \__,_\__, |_|_|_\___|_||_\__| | .__/_| .__/\___|_|_|_||_\___| *
+            //*              |___/                    |_|    |_|                      *
+            // (ctor)
+            // ~~~~~~
+            fragment_pipeline::fragment_pipeline (unsigned const workers)
+                    : max_in_flight_{std::size_t{4} * std::max (workers, 1U)} {
+                threads_.reserve (workers);
+                for (auto ctr = 0U; ctr < workers; ++ctr) {
+                    threads_.emplace_back ([this] { this->worker (); });
+                }
+            }
+
+            // (dtor)
+            // ~~~~~~
+            fragment_pipeline::~fragment_pipeline () noexcept {
+                {
+                    std::lock_guard<std::mutex> const lock{mut_};
+                    // Abandon any work that has not yet been started.
+                    tasks_.clear ();
+                    done_ = true;
+                }
+                cv_.notify_all ();
+                for (std::thread & t : threads_) {
+                    t.join ();
+                }
+            }
+
+            // worker
+            // ~~~~~~
+            void fragment_pipeline::worker () {
+                for (;;) {
+                    std::packaged_task<prepared_fragment ()> task;
+                    {
+                        std::unique_lock<std::mutex> lock{mut_};
+                        cv_.wait (lock, [this] { return done_ || !tasks_.empty (); });
+                        if (tasks_.empty ()) {
+                            return;
+                        }
+                        task = std::move (tasks_.front ());
+                        tasks_.pop_front ();
+                    }
+                    task ();
+                }
+            }
+
+            // defer payload
+            // ~~~~~~~~~~~~~
+            void fragment_pipeline::defer_payload (gsl::not_null<repo::section_content *> content,
+                                                   std::string && base64) {
+                deferred_.emplace_back (content.get (), std::move (base64));
+            }
+
+            // prepare [static]
+            // ~~~~~~~~~~~~~~~~
+            auto fragment_pipeline::prepare (index::digest const & digest,
+                                             std::unique_ptr<fragment_contents> && contents,
+                                             payloads & deferred,
+                                             repo::payload_options const & options)
+                -> prepared_fragment {
+                prepared_fragment result;
+                result.digest = digest;
+                for (auto & payload : deferred) {
+                    std::string const & data = payload.second;
+                    if (!from_base64 (std::begin (data), std::end (data),
+                                      std::back_inserter (payload.first->data))) {
+                        result.error = error::bad_base64_data;
+                        return result;
+                    }
+                }
+
+                auto const first = make_pointee_adaptor (contents->dispatchers.begin ());
+                auto const last = make_pointee_adaptor (contents->dispatchers.end ());
+                result.has_linked_definitions =
+                    std::find_if (first, last, [] (repo::section_creation_dispatcher const & d) {
+                        return d.kind () == repo::section_kind::linked_definitions;
+                    }) != last;
+                if (options.enabled () &&
+                    std::any_of (first, last,
+                                 [&options] (repo::section_creation_dispatcher const & d) {
+                                     repo::section_content const * const content =
+                                         repo::payload_content (d);
+                                     if (content == nullptr) {
+                                         return false;
+                                     }
+                                     std::size_t const size = content->data.size ();
+                                     return options.share (size) ||
+                                            options.compress (d.kind (), size);
+                                 })) {
+                    result.packed = repo::compress_payloads (first, last, options);
+                    result.contents = std::move (contents);
+                    return result;
+                }
+
+                image_allocator allocator;
+                result.size = repo::fragment::alloc (allocator, first, last).size;
+                result.image = allocator.image ();
+                result.storage = allocator.release_storage ();
+                result.error = fragment_sections::check_fragment (
+                    *reinterpret_cast<repo::fragment const *> (result.image));
+                return result;
+            }
+
+            // submit
+            // ~~~~~~
+            std::error_code
+            fragment_pipeline::submit (gsl::not_null<context *> const ctxt,
+                                       gsl::not_null<transaction_base *> const transaction,
+                                       index::digest const & digest,
+                                       std::unique_ptr<fragment_contents> && contents) {
+                std::packaged_task<prepared_fragment ()> task{
+                    [digest, c = std::move (contents), d = std::move (deferred_),
+                     t = ctxt->payloads] () mutable {
+                        return prepare (digest, std::move (c), d, t);
+                    }};
+                deferred_.clear ();
+                in_flight_.emplace_back (task.get_future ());
+                {
+                    std::lock_guard<std::mutex> const lock{mut_};
+                    tasks_.emplace_back (std::move (task));
+                }
+                cv_.notify_one ();
+                return this->store (ctxt, transaction, max_in_flight_);
+            }
+
+            // flush
+            // ~~~~~
+            std::error_code
+            fragment_pipeline::flush (gsl::not_null<context *> const ctxt,
+                                      gsl::not_null<transaction_base *> const transaction) {
+                return this->store (ctxt, transaction, 0U);
+            }
+
+            // store
+            // ~~~~~
+            std::error_code
+            fragment_pipeline::store (gsl::not_null<context *> const ctxt,
+                                      gsl::not_null<transaction_base *> const transaction,
+                                      std::size_t const limit) {
+                auto const fragment_index =
+                    index::get_index<trailer::indices::fragment> (*ctxt->db, true /* create */);
+                while (!in_flight_.empty ()) {
+                    std::future<prepared_fragment> & front = in_flight_.front ();
+                    if (in_flight_.size () <= limit &&
+                        front.wait_for (std::chrono::seconds{0}) != std::future_status::ready) {
+                        break;
+                    }
+                    prepared_fragment const p = front.get ();
+                    in_flight_.pop_front ();
+                    if (p.error) {
+                        return p.error;
+                    }
+                    extent<repo::fragment> fext;
+                    if (p.contents != nullptr) {
+                        auto const first = make_pointee_adaptor (p.contents->dispatchers.begin ());
+                        auto const last = make_pointee_adaptor (p.contents->dispatchers.end ());
+                        repo::store_payloads (*transaction, first, last, p.packed, ctxt->payloads);
+                        fext = repo::fragment::alloc (*transaction, first, last);
+                        if (std::error_code const erc = fragment_sections::check_fragment (
+                                *repo::fragment::load (*ctxt->db, fext))) {
+                            return erc;
+                        }
+                    } else {
+                        std::pair<std::shared_ptr<void>, address> const storage =
+                            transaction->alloc_rw (p.size, alignof (repo::fragment));
+                        std::memcpy (storage.first.get (), p.image, p.size);
+                        fext = extent<repo::fragment>{
+                            typed_address<repo::fragment> (storage.second), p.size};
+                    }
+                    fragment_index->insert (*transaction, std::make_pair (p.digest, fext));
+                    if (p.has_linked_definitions) {
+                        ctxt->patches.emplace_back (new address_patch (ctxt->db, fext));
+                    }
+                }
+                return {};
+            }
+
+        } // end namespace import_ns
+    }     // end namespace exchange
+} // end namespace pstore
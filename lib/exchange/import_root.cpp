@@ -17,6 +17,7 @@
 
 #include <bitset>
 
+#include "pstore/exchange/import_fragment_pipeline.hpp"
 #include "pstore/exchange/import_non_terminals.hpp"
 #include "pstore/exchange/import_transaction.hpp"
 #include "pstore/exchange/import_uuid.hpp"
@@ -118,8 +119,14 @@ namespace pstore {
 
             // create parser
             // ~~~~~~~~~~~~~
-            json::parser<callbacks> create_parser (database & db) {
-                return json::make_parser (callbacks::make<root> (&db), json::extensions::all);
+            json::parser<callbacks> create_parser (database & db, unsigned const jobs,
+                                                   repo::payload_options const & payloads) {
+                auto cb = callbacks::make<root> (&db);
+                cb.get_context ()->payloads = payloads;
+                if (jobs > 1U) {
+                    cb.get_context ()->pipeline = std::make_shared<fragment_pipeline> (jobs);
+                }
+                return json::make_parser (std::move (cb), json::extensions::all);
             }
 
         } // end namespace import_ns
@@ -46,8 +46,10 @@ namespace pstore {
 
                 std::shared_ptr<index::name_index> const names_index =
                     index::get_index<trailer::indices::name> (transaction->db ());
+                std::shared_ptr<index::ordered_name_index> const ordered_index =
+                    index::get_index<trailer::indices::ordered_name> (transaction->db ());
                 std::pair<index::name_index::iterator, bool> const add_res =
-                    adder_.add (*transaction, names_index, &s);
+                    adder_.add (*transaction, names_index, ordered_index, &s);
                 if (!add_res.second) {
                     return error::duplicate_name;
                 }
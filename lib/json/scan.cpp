@@ -0,0 +1,276 @@
+//===- lib/json/scan.cpp --------------------------------------------------===//
+//*                       *
+//*  ___  ___ __ _ _ __   *
+//* / __|/ __/ _` | '_ \  *
+//* \__ \ (_| (_| | | | | *
+//* |___/\___\__,_|_| |_| *
+//*                       *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/json/scan.hpp"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#        define PSTORE_JSON_SCAN_SSE2 1
+#        include <emmintrin.h>
+#    endif
+#    if defined(__GNUC__) || defined(__clang__)
+#        define PSTORE_JSON_SCAN_AVX2 1
+#        define PSTORE_JSON_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#        include <immintrin.h>
+#    elif defined(_MSC_VER)
+#        define PSTORE_JSON_SCAN_AVX2 1
+#        define PSTORE_JSON_TARGET_AVX2
+#        include <immintrin.h>
+#        include <intrin.h>
+#    endif
+#endif
+
+#ifndef PSTORE_JSON_SCAN_SSE2
+#    define PSTORE_JSON_SCAN_SSE2 0
+#endif
+#ifndef PSTORE_JSON_SCAN_AVX2
+#    define PSTORE_JSON_SCAN_AVX2 0
+#endif
+
+namespace {
+
+    constexpr bool is_blank (char const c) noexcept { return c == ' ' || c == '\t'; }
+
+    constexpr bool is_string_body (char const c) noexcept {
+        return static_cast<unsigned char> (c) >= 0x20U && static_cast<unsigned char> (c) < 0x80U &&
+               c != '"' && c != '\\';
+    }
+
+    // count trailing zeros
+    // ~~~~~~~~~~~~~~~~~~~~
+    inline unsigned count_trailing_zeros (std::uint32_t const x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned> (__builtin_ctz (x));
+#elif defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward (&index, x);
+        return static_cast<unsigned> (index);
+#else
+        auto n = 0U;
+        for (auto v = x; (v & 1U) == 0U; v >>= 1U) {
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    //*                _        _    _      *
+    //*  _ __  ___ _ _| |_ __ _| |__| |___  *
+    //* | '_ \/ _ \ '_|  _/ _` | '_ \ / -_) *
+    //* | .__/\___/_|  \__\__,_|_.__/_\___| *
+    //* |_|                                 *
+
+    // portable blanks
+    // ~~~~~~~~~~~~~~~
+    char const * portable_blanks (char const * first, char const * const last) {
+        while (first != last && is_blank (*first)) {
+            ++first;
+        }
+        return first;
+    }
+
+    // portable string body
+    // ~~~~~~~~~~~~~~~~~~~~
+    char const * portable_string_body (char const * first, char const * const last) {
+        while (first != last && is_string_body (*first)) {
+            ++first;
+        }
+        return first;
+    }
+
+#if PSTORE_JSON_SCAN_SSE2
+    //*             ___  *
+    //*  ______ ___|_  ) *
+    //* (_-<_-</ -_)/ /  *
+    //* /__/__/\___/___| *
+    //*                  *
+
+    // sse2 blanks
+    // ~~~~~~~~~~~
+    char const * sse2_blanks (char const * first, char const * const last) {
+        __m128i const space = _mm_set1_epi8 (' ');
+        __m128i const tab = _mm_set1_epi8 ('\t');
+        for (; last - first >= 16; first += 16) {
+            __m128i const v = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (first));
+            __m128i const match = _mm_or_si128 (_mm_cmpeq_epi8 (v, space), _mm_cmpeq_epi8 (v, tab));
+            auto const stop = static_cast<std::uint32_t> (~_mm_movemask_epi8 (match)) & 0xFFFFU;
+            if (stop != 0U) {
+                return first + count_trailing_zeros (stop);
+            }
+        }
+        return portable_blanks (first, last);
+    }
+
+    // sse2 string body
+    // ~~~~~~~~~~~~~~~~
+    char const * sse2_string_body (char const * first, char const * const last) {
+        __m128i const quote = _mm_set1_epi8 ('"');
+        __m128i const backslash = _mm_set1_epi8 ('\\');
+        // Bytes are compared as signed values, so a single comparison with 0x20 catches both the
+        // control characters (0x00-0x1F) and the bytes with the top bit set (0x80-0xFF).
+        __m128i const space = _mm_set1_epi8 (0x20);
+        for (; last - first >= 16; first += 16) {
+            __m128i const v = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (first));
+            __m128i const escape =
+                _mm_or_si128 (_mm_cmpeq_epi8 (v, quote), _mm_cmpeq_epi8 (v, backslash));
+            __m128i const special = _mm_or_si128 (escape, _mm_cmplt_epi8 (v, space));
+            auto const stop = static_cast<std::uint32_t> (_mm_movemask_epi8 (special));
+            if (stop != 0U) {
+                return first + count_trailing_zeros (stop);
+            }
+        }
+        return portable_string_body (first, last);
+    }
+#endif // PSTORE_JSON_SCAN_SSE2
+
+#if PSTORE_JSON_SCAN_AVX2
+    //*                 ___  *
+    //*  __ ___ ____ __|_  ) *
+    //* / _` \ V /\ \ / / /  *
+    //* \__,_|\_/ /_\_\/___| *
+    //*                      *
+
+    // avx2 blanks
+    // ~~~~~~~~~~~
+    PSTORE_JSON_TARGET_AVX2 char const * avx2_blanks (char const * first, char const * const last) {
+        __m256i const space = _mm256_set1_epi8 (' ');
+        __m256i const tab = _mm256_set1_epi8 ('\t');
+        for (; last - first >= 32; first += 32) {
+            __m256i const v = _mm256_loadu_si256 (reinterpret_cast<__m256i const *> (first));
+            __m256i const match =
+                _mm256_or_si256 (_mm256_cmpeq_epi8 (v, space), _mm256_cmpeq_epi8 (v, tab));
+            auto const stop = ~static_cast<std::uint32_t> (_mm256_movemask_epi8 (match));
+            if (stop != 0U) {
+                return first + count_trailing_zeros (stop);
+            }
+        }
+        return portable_blanks (first, last);
+    }
+
+    // avx2 string body
+    // ~~~~~~~~~~~~~~~~
+    PSTORE_JSON_TARGET_AVX2 char const * avx2_string_body (char const * first,
+                                                           char const * const last) {
+        __m256i const quote = _mm256_set1_epi8 ('"');
+        __m256i const backslash = _mm256_set1_epi8 ('\\');
+        // As for SSE2, a signed comparison catches both control characters and non-ASCII bytes.
+        __m256i const space = _mm256_set1_epi8 (0x20);
+        for (; last - first >= 32; first += 32) {
+            __m256i const v = _mm256_loadu_si256 (reinterpret_cast<__m256i const *> (first));
+            __m256i const special = _mm256_or_si256 (
+                _mm256_or_si256 (_mm256_cmpeq_epi8 (v, quote), _mm256_cmpeq_epi8 (v, backslash)),
+                _mm256_cmpgt_epi8 (space, v));
+            auto const stop = static_cast<std::uint32_t> (_mm256_movemask_epi8 (special));
+            if (stop != 0U) {
+                return first + count_trailing_zeros (stop);
+            }
+        }
+        return portable_string_body (first, last);
+    }
+
+    // has avx2
+    // ~~~~~~~~
+    bool has_avx2 () noexcept {
+#    if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid (info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid (info, 1);
+        constexpr auto osxsave = 1 << 27;
+        constexpr auto avx = 1 << 28;
+        if ((info[2] & (osxsave | avx)) != (osxsave | avx)) {
+            return false;
+        }
+        // Check that the OS saves the YMM registers on a context switch.
+        if ((_xgetbv (0) & 0x6U) != 0x6U) {
+            return false;
+        }
+        __cpuidex (info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#    else
+        __builtin_cpu_init ();
+        return __builtin_cpu_supports ("avx2") != 0;
+#    endif
+    }
+#endif // PSTORE_JSON_SCAN_AVX2
+
+    constexpr pstore::json::details::scanner portable_scanner{&portable_blanks,
+                                                              &portable_string_body};
+#if PSTORE_JSON_SCAN_SSE2
+    constexpr pstore::json::details::scanner sse2_scanner{&sse2_blanks, &sse2_string_body};
+#endif
+#if PSTORE_JSON_SCAN_AVX2
+    constexpr pstore::json::details::scanner avx2_scanner{&avx2_blanks, &avx2_string_body};
+#endif
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace json {
+        namespace details {
+
+            // scan isa available
+            // ~~~~~~~~~~~~~~~~~~
+            bool scan_isa_available (scan_isa const isa) noexcept {
+                switch (isa) {
+                case scan_isa::portable: return true;
+                case scan_isa::sse2: return PSTORE_JSON_SCAN_SSE2 != 0;
+                case scan_isa::avx2:
+#if PSTORE_JSON_SCAN_AVX2
+                {
+                    static bool const avx2 = has_avx2 ();
+                    return avx2;
+                }
+#else
+                    return false;
+#endif
+                }
+                return false;
+            }
+
+            // get scanner
+            // ~~~~~~~~~~~
+            scanner const & get_scanner (scan_isa const isa) noexcept {
+                if (scan_isa_available (isa)) {
+                    switch (isa) {
+                    case scan_isa::portable: break;
+#if PSTORE_JSON_SCAN_SSE2
+                    case scan_isa::sse2: return sse2_scanner;
+#endif
+#if PSTORE_JSON_SCAN_AVX2
+                    case scan_isa::avx2: return avx2_scanner;
+#endif
+                    default: break;
+                    }
+                }
+                return portable_scanner;
+            }
+
+            // best scanner
+            // ~~~~~~~~~~~~
+            scanner const & best_scanner () noexcept {
+                static scanner const & best = scan_isa_available (scan_isa::avx2)
+                                                  ? get_scanner (scan_isa::avx2)
+                                                  : get_scanner (scan_isa::sse2);
+                return best;
+            }
+
+        } // end namespace details
+    }     // end namespace json
+} // end namespace pstore
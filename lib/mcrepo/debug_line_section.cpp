@@ -21,18 +21,39 @@
 //===----------------------------------------------------------------------===//
 #include "pstore/mcrepo/debug_line_section.hpp"
 
+#include "pstore/mcrepo/shared_payload.hpp"
+
 namespace pstore {
     namespace repo {
 
+        container<std::uint8_t>
+        debug_line_section::payload (database const & db,
+                                     std::shared_ptr<std::uint8_t const> * const owner,
+                                     payload_cache * const cache) const {
+            return load_payload (db, g_, owner, cache);
+        }
+
         std::size_t debug_line_section_creation_dispatcher::size_bytes () const {
-            return debug_line_section::size_bytes (section_->make_sources ());
+            auto const src = section_->make_sources ();
+            if (shared_payload_.addr != typed_address<std::uint8_t>::null ()) {
+                return debug_line_section::size_bytes (shared_payload_, src.ifixups_range,
+                                                       src.xfixups_range);
+            }
+            return debug_line_section::size_bytes (src);
         }
 
         std::uint8_t *
         debug_line_section_creation_dispatcher::write (std::uint8_t * const out) const {
             PSTORE_ASSERT (this->aligned (out) == out);
-            auto * const scn = new (out) debug_line_section (
-                header_digest_, header_, section_->make_sources (), section_->align);
+            auto const src = section_->make_sources ();
+            debug_line_section * scn = nullptr;
+            if (shared_payload_.addr != typed_address<std::uint8_t>::null ()) {
+                scn = new (out) debug_line_section (
+                    header_digest_, header_, shared_payload_, section_->data.size (),
+                    compressed_payload_, src.ifixups_range, src.xfixups_range, section_->align);
+            } else {
+                scn = new (out) debug_line_section (header_digest_, header_, src, section_->align);
+            }
             return out + scn->size_bytes ();
         }
 
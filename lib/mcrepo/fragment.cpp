@@ -214,7 +214,10 @@ container<external_fixup> pstore::repo::section_xfixups (fragment const & f,
 
 // section data
 // ~~~~~~~~~~~~
-container<std::uint8_t> pstore::repo::section_value (fragment const & f, section_kind const kind) {
+container<std::uint8_t>
+pstore::repo::section_value (database const & db, fragment const & f, section_kind const kind,
+                             std::shared_ptr<std::uint8_t const> * const owner,
+                             payload_cache * const cache) {
     dispatcher_buffer buffer;
-    return make_dispatcher (f, kind, &buffer)->payload ();
+    return make_dispatcher (f, kind, &buffer)->payload (db, owner, cache);
 }
@@ -17,6 +17,8 @@
 /// \brief Defines the generic section that is used for many fragment sections.
 #include "pstore/mcrepo/generic_section.hpp"
 
+#include "pstore/mcrepo/shared_payload.hpp"
+
 namespace pstore {
     namespace repo {
 
@@ -70,19 +72,9 @@ namespace pstore {
         //* |___/                                                    *
         // size_bytes
         // ~~~~~~~~~~
-        std::size_t generic_section::size_bytes (std::size_t const data_size,
-                                                 std::size_t const num_ifixups,
-                                                 std::size_t const num_xfixups) {
-            auto result = sizeof (generic_section);
-            result = generic_section::part_size_bytes<std::uint8_t> (result, data_size);
-            result = generic_section::part_size_bytes<internal_fixup> (result, num_ifixups);
-            result = generic_section::part_size_bytes<external_fixup> (result, num_xfixups);
-            return result;
-        }
-
         std::size_t generic_section::size_bytes () const {
-            return generic_section::size_bytes (payload ().size (), ifixups ().size (),
-                                                xfixups ().size ());
+            return static_cast<std::size_t> (this->xfixup_area ().second -
+                                             reinterpret_cast<std::uint8_t const *> (this));
         }
 
         //*                  _   _               _ _               _      _             *
@@ -92,13 +84,25 @@ namespace pstore {
         //*                                            |_|                              *
 
         std::size_t generic_section_creation_dispatcher::size_bytes () const {
-            return generic_section::size_bytes (section_->make_sources ());
+            auto const src = section_->make_sources ();
+            if (shared_payload_.addr != typed_address<std::uint8_t>::null ()) {
+                return generic_section::size_bytes (shared_payload_, src.ifixups_range,
+                                                    src.xfixups_range);
+            }
+            return generic_section::size_bytes (src);
         }
 
         std::uint8_t * generic_section_creation_dispatcher::write (std::uint8_t * const out) const {
             PSTORE_ASSERT (this->aligned (out) == out);
-            auto * const scn =
-                new (out) generic_section (section_->make_sources (), section_->align);
+            auto const src = section_->make_sources ();
+            generic_section * scn = nullptr;
+            if (shared_payload_.addr != typed_address<std::uint8_t>::null ()) {
+                scn = new (out) generic_section (shared_payload_, section_->data.size (),
+                                                 compressed_payload_, src.ifixups_range,
+                                                 src.xfixups_range, section_->align);
+            } else {
+                scn = new (out) generic_section (src, section_->align);
+            }
             return out + scn->size_bytes ();
         }
 
@@ -115,6 +119,13 @@ namespace pstore {
         //*                                       |_|                              *
         section_dispatcher::~section_dispatcher () noexcept {}
 
+        container<std::uint8_t>
+        section_dispatcher::payload (database const & db,
+                                     std::shared_ptr<std::uint8_t const> * const owner,
+                                     payload_cache * const cache) const {
+            return load_payload (db, s_, owner, cache);
+        }
+
 
     } // end namespace repo
 } // end namespace pstore
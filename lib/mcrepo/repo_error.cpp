@@ -30,6 +30,9 @@ namespace pstore {
                 result = "too many members in a compilation";
                 break;
             case error_code::bss_section_too_large: result = "bss section too large"; break;
+            case error_code::bad_compressed_payload:
+                result = "a compressed section payload could not be decoded";
+                break;
             }
             return result;
         }
@@ -0,0 +1,268 @@
+//===- lib/mcrepo/shared_payload.cpp --------------------------------------===//
+//*      _                        _                     _                 _  *
+//*  ___| |__   __ _ _ __ ___  __| |  _ __   __ _ _   _| | ___   __ _  __| | *
+//* / __| '_ \ / _` | '__/ _ \/ _` | | '_ \ / _` | | | | |/ _ \ / _` |/ _` | *
+//* \__ \ | | | (_| | | |  __/ (_| | | |_) | (_| | |_| | | (_) | (_| | (_| | *
+//* |___/_| |_|\__,_|_|  \___|\__,_| | .__/ \__,_|\__, |_|\___/ \__,_|\__,_| *
+//*                                  |_|          |___/                      *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file shared_payload.cpp
+/// \brief Content-addressed and compressed storage for section payloads.
+
+#include "pstore/mcrepo/shared_payload.hpp"
+
+#include <cstring>
+
+#include "pstore/core/hamt_map.hpp"
+#include "pstore/support/fnv.hpp"
+#include "pstore/support/lz4.hpp"
+
+namespace {
+
+    /// Adds an unshared copy of the bytes [\p first, \p last) to the store.
+    pstore::extent<std::uint8_t> append_payload (pstore::transaction_base & transaction,
+                                                 std::uint8_t const * const first,
+                                                 std::uint8_t const * const last) {
+        auto const size = static_cast<std::size_t> (last - first);
+        std::pair<std::shared_ptr<void>, pstore::address> const storage =
+            transaction.alloc_rw (size, 1U);
+        std::memcpy (storage.first.get (), first, size);
+        return {pstore::typed_address<std::uint8_t> (storage.second), std::uint64_t{size}};
+    }
+
+    /// Returns true if sections of the given kind are instances of generic_section.
+    bool is_generic_section (pstore::repo::section_kind const kind) noexcept {
+        using pstore::repo::section_kind;
+#define X(a)                                                                                       \
+    case section_kind::a:                                                                          \
+        return std::is_same<pstore::repo::enum_to_section_t<section_kind::a>,                      \
+                            pstore::repo::generic_section>::value;
+        switch (kind) {
+            PSTORE_MCREPO_SECTION_KINDS
+        case section_kind::last: break;
+        }
+#undef X
+        return false;
+    }
+
+    void set_shared_payload (pstore::repo::section_creation_dispatcher & d,
+                             pstore::extent<std::uint8_t> const & payload, bool const compressed) {
+        using namespace pstore::repo;
+        if (d.kind () == section_kind::debug_line) {
+            static_cast<debug_line_section_creation_dispatcher &> (d).set_shared_payload (
+                payload, compressed);
+        } else {
+            PSTORE_ASSERT (is_generic_section (d.kind ()));
+            static_cast<generic_section_creation_dispatcher &> (d).set_shared_payload (payload,
+                                                                                       compressed);
+        }
+    }
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace repo {
+
+        // default compressed kinds
+        // ~~~~~~~~~~~~~~~~~~~~~~~~
+        std::bitset<num_section_kinds> default_compressed_kinds () noexcept {
+            std::bitset<num_section_kinds> result;
+            for (section_kind const kind : {section_kind::debug_line, section_kind::debug_loc,
+                                            section_kind::debug_string,
+                                            section_kind::debug_ranges}) {
+                result.set (static_cast<std::size_t> (kind));
+            }
+            return result;
+        }
+
+        // payload digest
+        // ~~~~~~~~~~~~~~
+        index::digest payload_digest (std::uint8_t const * const first,
+                                      std::uint8_t const * const last) noexcept {
+            PSTORE_ASSERT (last >= first);
+            // The index is keyed on the high half of the digest so that holds the hash. The
+            // low half is the payload size which cheaply distinguishes some collisions. Since
+            // intern_payload() always compares the bytes, a collision can never cause one payload
+            // to be substituted for another.
+            auto const size = static_cast<std::size_t> (last - first);
+            return {fnv_64a_buf (gsl::make_span (first, size)), std::uint64_t{size}};
+        }
+
+        // intern payload
+        // ~~~~~~~~~~~~~~
+        extent<std::uint8_t> intern_payload (transaction_base & transaction,
+                                             std::uint8_t const * const first,
+                                             std::uint8_t const * const last) {
+            PSTORE_ASSERT (last >= first);
+            auto const size = static_cast<std::size_t> (last - first);
+            database & db = transaction.db ();
+            auto const payloads = index::get_index<trailer::indices::payload> (db);
+            index::digest const key = payload_digest (first, last);
+
+            auto const pos = payloads->find (db, key);
+            if (pos != payloads->end (db)) {
+                extent<std::uint8_t> const & existing = pos->second;
+                if (existing.size == size &&
+                    std::memcmp (db.getro (existing).get (), first, size) == 0) {
+                    return existing;
+                }
+                // A hash collision: the caller must use an inline copy of the payload.
+                return {};
+            }
+
+            extent<std::uint8_t> const result = append_payload (transaction, first, last);
+            payloads->insert (transaction, std::make_pair (key, result));
+            return result;
+        }
+
+        // payload content
+        // ~~~~~~~~~~~~~~~
+        section_content const * payload_content (section_creation_dispatcher const & d) noexcept {
+            section_kind const kind = d.kind ();
+            if (kind == section_kind::debug_line) {
+                return static_cast<debug_line_section_creation_dispatcher const &> (d).content ();
+            }
+            if (is_generic_section (kind)) {
+                return static_cast<generic_section_creation_dispatcher const &> (d).content ();
+            }
+            return nullptr;
+        }
+
+        // compress payload
+        // ~~~~~~~~~~~~~~~~
+        packed_payload compress_payload (section_creation_dispatcher const & d,
+                                         payload_options const & options) {
+            section_content const * const content = payload_content (d);
+            if (content == nullptr || !options.compress (d.kind (), content->data.size ())) {
+                return {};
+            }
+            std::size_t const size = content->data.size ();
+            packed_payload packed (lz4::compress_bound (size));
+            packed.resize (lz4::compress (content->data.data (), size, packed.data ()));
+            // Only keep the compressed form if it saves at least an eighth of the space: the
+            // saving would not be worth the cost of decoding it.
+            if (packed.size () > size - size / 8U) {
+                return {};
+            }
+            packed.shrink_to_fit ();
+            return packed;
+        }
+
+        // store payload
+        // ~~~~~~~~~~~~~
+        void store_payload (transaction_base & transaction, section_creation_dispatcher & d,
+                            packed_payload const & packed, payload_options const & options) {
+            section_content const * const content = payload_content (d);
+            if (content == nullptr) {
+                return;
+            }
+            std::size_t const size = content->data.size ();
+            if (!packed.empty ()) {
+                std::uint8_t const * const first = packed.data ();
+                std::uint8_t const * const last = first + packed.size ();
+                extent<std::uint8_t> payload;
+                if (options.share (size)) {
+                    payload = intern_payload (transaction, first, last);
+                }
+                if (payload.addr == typed_address<std::uint8_t>::null ()) {
+                    payload = append_payload (transaction, first, last);
+                }
+                set_shared_payload (d, payload, true);
+                return;
+            }
+            if (options.share (size)) {
+                std::uint8_t const * const first = content->data.data ();
+                extent<std::uint8_t> const payload =
+                    intern_payload (transaction, first, first + size);
+                if (payload.addr != typed_address<std::uint8_t>::null ()) {
+                    set_shared_payload (d, payload, false);
+                }
+            }
+        }
+
+        //*                  _              _              _         *
+        //*  _ __  __ _ _  _| |___  __ _ __| |  __ __ _ __| |_  ___  *
+        //* | '_ \/ _` | || | / _ \/ _` / _` | / _/ _` / _| ' \/ -_) *
+        //* | .__/\__,_|\_, |_\___/\__,_\__,_| \__\__,_\__|_||_\___| *
+        //* |_|         |__/                                         *
+        // find
+        // ~~~~
+        std::shared_ptr<std::uint8_t const> payload_cache::find (address const addr) {
+            std::lock_guard<std::mutex> const lock{mut_};
+            auto const pos = map_.find (addr);
+            if (pos == map_.end ()) {
+                return nullptr;
+            }
+            // Move the entry to the front of the list.
+            lru_.splice (lru_.begin (), lru_, pos->second);
+            return pos->second->data;
+        }
+
+        // insert
+        // ~~~~~~
+        void payload_cache::insert (address const addr,
+                                    std::shared_ptr<std::uint8_t const> const & data,
+                                    std::size_t const size) {
+            if (size > capacity_) {
+                return;
+            }
+            std::lock_guard<std::mutex> const lock{mut_};
+            if (map_.find (addr) != map_.end ()) {
+                return;
+            }
+            while (size_ + size > capacity_) {
+                PSTORE_ASSERT (!lru_.empty ());
+                entry const & back = lru_.back ();
+                size_ -= back.size;
+                map_.erase (back.addr);
+                lru_.pop_back ();
+            }
+            lru_.push_front (entry{addr, data, size});
+            map_[addr] = lru_.begin ();
+            size_ += size;
+        }
+
+        // load payload
+        // ~~~~~~~~~~~~
+        container<std::uint8_t> load_payload (database const & db, generic_section const & s,
+                                              std::shared_ptr<std::uint8_t const> * const owner,
+                                              payload_cache * const cache) {
+            if (!s.has_shared_payload ()) {
+                return s.inline_payload ();
+            }
+            extent<std::uint8_t> const & ex = s.shared_payload ();
+            if (!s.has_compressed_payload ()) {
+                *owner = db.getro (ex);
+                std::uint8_t const * const ptr = owner->get ();
+                return {ptr, ptr + ex.size};
+            }
+
+            auto const size = static_cast<std::size_t> (s.size ());
+            if (cache != nullptr) {
+                if ((*owner = cache->find (ex.addr.to_address ()))) {
+                    return {owner->get (), owner->get () + size};
+                }
+            }
+            std::shared_ptr<std::uint8_t> const buffer{new std::uint8_t[size],
+                                                       std::default_delete<std::uint8_t[]> ()};
+            std::shared_ptr<std::uint8_t const> const packed = db.getro (ex);
+            if (!lz4::decompress (packed.get (), static_cast<std::size_t> (ex.size),
+                                  buffer.get (), size)) {
+                raise (error_code::bad_compressed_payload);
+            }
+            *owner = buffer;
+            if (cache != nullptr) {
+                cache->insert (ex.addr.to_address (), buffer, size);
+            }
+            return {buffer.get (), buffer.get () + size};
+        }
+
+    } // end namespace repo
+} // end namespace pstore
@@ -0,0 +1,319 @@
+//===- lib/os/async_log.cpp -----------------------------------------------===//
+//*                               _              *
+//*   __ _ ___ _   _ _ __   ___  | | ___   __ _  *
+//*  / _` / __| | | | '_ \ / __| | |/ _ \ / _` | *
+//* | (_| \__ \ |_| | | | | (__  | | (_) | (_| | *
+//*  \__,_|___/\__, |_| |_|\___| |_|\___/ \__, | *
+//*            |___/                      |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/os/async_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include "pstore/support/portab.hpp"
+
+namespace {
+
+    using pstore::logger;
+
+    /// A message waiting to be written.
+    struct record {
+        logger * sink = nullptr;
+        logger::priority priority = logger::priority::debug;
+        std::time_t time = 0;
+        std::string message;
+    };
+
+    std::atomic<std::uint64_t> total_dropped{0U};
+
+    //*  _   _                    _   _          __  __          *
+    //* | |_| |_  _ _ ___ __ _ __| | | |__ _  _ / _|/ _|___ _ _  *
+    //* |  _| ' \| '_/ -_) _` / _` | | '_ \ || |  _|  _/ -_) '_| *
+    //*  \__|_||_|_| \___\__,_\__,_| |_.__/\_,_|_| |_| \___|_|   *
+    //*                                                          *
+    /// The messages logged by a single thread. The owning thread is the only producer; the writer
+    /// (or a thread flushing the log) is the only consumer.
+    class thread_buffer {
+    public:
+        explicit thread_buffer (std::string thread_name)
+                : thread_name_{std::move (thread_name)} {}
+
+        /// Adds a record to the ring. Returns false (and counts the record as dropped) if the
+        /// ring is full.
+        bool push (record && r) noexcept;
+
+        /// Passes each of the waiting records to \p f and removes it from the ring.
+        template <typename Function>
+        void drain (Function f);
+
+        bool empty () const noexcept {
+            return head_.load (std::memory_order_acquire) ==
+                   tail_.load (std::memory_order_relaxed);
+        }
+
+        /// Called when the owning thread exits. The buffer can be discarded once it is empty.
+        void orphan () noexcept { orphaned_.store (true, std::memory_order_release); }
+        bool orphaned () const noexcept { return orphaned_.load (std::memory_order_acquire); }
+
+    private:
+        std::string const thread_name_;
+        std::array<record, pstore::async_log_ring_size> records_;
+        /// The number of records added by the producer.
+        std::atomic<std::size_t> head_{0U};
+        /// The number of records removed by the consumer.
+        std::atomic<std::size_t> tail_{0U};
+        /// The number of records dropped since the consumer last looked.
+        std::atomic<std::uint64_t> dropped_{0U};
+        std::atomic<bool> orphaned_{false};
+    };
+
+    // push
+    // ~~~~
+    bool thread_buffer::push (record && r) noexcept {
+        std::size_t const head = head_.load (std::memory_order_relaxed);
+        if (head - tail_.load (std::memory_order_acquire) == records_.size ()) {
+            dropped_.fetch_add (1U, std::memory_order_relaxed);
+            total_dropped.fetch_add (1U, std::memory_order_relaxed);
+            return false;
+        }
+        records_[head % records_.size ()] = std::move (r);
+        head_.store (head + 1U, std::memory_order_release);
+        return true;
+    }
+
+    // drain
+    // ~~~~~
+    template <typename Function>
+    void thread_buffer::drain (Function f) {
+        std::size_t tail = tail_.load (std::memory_order_relaxed);
+        std::size_t const head = head_.load (std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            record & r = records_[tail % records_.size ()];
+            if (std::uint64_t const dropped = dropped_.exchange (0U, std::memory_order_relaxed)) {
+                f (record{r.sink, logger::priority::warning, r.time,
+                          std::to_string (dropped) + " log messages were dropped"},
+                   thread_name_);
+            }
+            f (r, thread_name_);
+            r.message.clear ();
+            tail_.store (tail + 1U, std::memory_order_release);
+        }
+    }
+
+    //*             _ _            *
+    //* __ __ ___ _(_) |_ ___ _ _  *
+    //* \ V  V / '_| |  _/ -_) '_| *
+    //*  \_/\_/|_| |_|\__\___|_|   *
+    //*                            *
+    /// Owns the thread which drains the rings of all of the threads which have logged to an
+    /// async_logger.
+    class writer {
+    public:
+        writer ();
+        writer (writer const &) = delete;
+        writer (writer &&) = delete;
+        ~writer () noexcept;
+
+        writer & operator= (writer const &) = delete;
+        writer & operator= (writer &&) = delete;
+
+        static writer & get ();
+
+        /// Returns the calling thread's ring.
+        thread_buffer & local ();
+        /// Wakes the writer thread if it is waiting.
+        void notify () noexcept {
+            if (sleeping_.load (std::memory_order_acquire)) {
+                cv_.notify_one ();
+            }
+        }
+        /// Writes all of the waiting records.
+        void drain_all ();
+
+    private:
+        /// The longest time that a message may wait if the writer misses a notification.
+        static constexpr auto max_wait = std::chrono::milliseconds{20};
+
+        void run ();
+        bool pending ();
+
+        std::mutex buffers_mut_;
+        std::vector<std::shared_ptr<thread_buffer>> buffers_;
+
+        /// Ensures that there is only one consumer at a time.
+        std::mutex drain_mut_;
+
+        std::mutex wait_mut_;
+        std::condition_variable cv_;
+        std::atomic<bool> sleeping_{false};
+        bool done_ = false;
+
+        std::thread thread_;
+    };
+
+    constexpr std::chrono::milliseconds writer::max_wait;
+
+    /// Lets the writer know when a thread which owns a ring exits.
+    class buffer_owner {
+    public:
+        explicit buffer_owner (std::shared_ptr<thread_buffer> b) noexcept
+                : buffer_{std::move (b)} {}
+        buffer_owner (buffer_owner const &) = delete;
+        buffer_owner (buffer_owner &&) = delete;
+        ~buffer_owner () noexcept { buffer_->orphan (); }
+
+        buffer_owner & operator= (buffer_owner const &) = delete;
+        buffer_owner & operator= (buffer_owner &&) = delete;
+
+        thread_buffer & get () const noexcept { return *buffer_; }
+
+    private:
+        std::shared_ptr<thread_buffer> buffer_;
+    };
+
+    // (ctor)
+    // ~~~~~~
+    writer::writer ()
+            : thread_{[this] { this->run (); }} {}
+
+    // (dtor)
+    // ~~~~~~
+    writer::~writer () noexcept {
+        {
+            std::lock_guard<std::mutex> const lock{wait_mut_};
+            done_ = true;
+        }
+        cv_.notify_one ();
+        thread_.join ();
+    }
+
+    // get
+    // ~~~
+    writer & writer::get () {
+        static writer w;
+        return w;
+    }
+
+    // local
+    // ~~~~~
+    thread_buffer & writer::local () {
+        thread_local buffer_owner const owner{[this] () {
+            auto b =
+                std::make_shared<thread_buffer> (pstore::basic_logger::get_current_thread_name ());
+            std::lock_guard<std::mutex> const lock{buffers_mut_};
+            buffers_.push_back (b);
+            return b;
+        }()};
+        return owner.get ();
+    }
+
+    // pending
+    // ~~~~~~~
+    bool writer::pending () {
+        std::lock_guard<std::mutex> const lock{buffers_mut_};
+        return std::any_of (std::begin (buffers_), std::end (buffers_),
+                            [] (std::shared_ptr<thread_buffer> const & b) { return !b->empty (); });
+    }
+
+    // drain all
+    // ~~~~~~~~~
+    void writer::drain_all () {
+        std::lock_guard<std::mutex> const drain_lock{drain_mut_};
+        std::vector<std::shared_ptr<thread_buffer>> buffers;
+        {
+            std::lock_guard<std::mutex> const lock{buffers_mut_};
+            // Discard the rings of threads which have exited once they are empty.
+            buffers_.erase (std::remove_if (std::begin (buffers_), std::end (buffers_),
+                                            [] (std::shared_ptr<thread_buffer> const & b) {
+                                                return b->orphaned () && b->empty ();
+                                            }),
+                            std::end (buffers_));
+            buffers = buffers_;
+        }
+        for (std::shared_ptr<thread_buffer> const & b : buffers) {
+            b->drain ([] (record const & r, std::string const & thread_name) {
+                PSTORE_TRY { r.sink->log_deferred (r.priority, r.time, thread_name, r.message); }
+                // There's nowhere to report a failure to log.
+                PSTORE_CATCH (..., {})
+            });
+        }
+    }
+
+    // run
+    // ~~~
+    void writer::run () {
+        for (;;) {
+            this->drain_all ();
+            std::unique_lock<std::mutex> lock{wait_mut_};
+            if (done_) {
+                break;
+            }
+            sleeping_.store (true, std::memory_order_seq_cst);
+            // A producer may have added a record after we drained but before it could see that
+            // we're sleeping. Check again before waiting; the timeout covers any that remain.
+            if (!this->pending ()) {
+                cv_.wait_for (lock, max_wait);
+            }
+            sleeping_.store (false, std::memory_order_relaxed);
+        }
+        this->drain_all ();
+    }
+
+} // end anonymous namespace
+
+namespace pstore {
+
+    //*                         _                         *
+    //*  __ _ ____  _ _ _  __  | |___  __ _ __ _ ___ _ _  *
+    //* / _` (_-< || | ' \/ _| | / _ \/ _` / _` / -_) '_| *
+    //* \__,_/__/\_, |_||_\__| |_\___/\__, \__, \___|_|   *
+    //*          |__/                 |___/|___/          *
+    // (ctor)
+    // ~~~~~~
+    async_logger::async_logger (std::unique_ptr<logger> sink)
+            : sink_{std::move (sink)} {
+        // Ensure that the writer is constructed (and therefore destroyed) before any logger
+        // that it might use.
+        writer::get ();
+    }
+
+    // (dtor)
+    // ~~~~~~
+    async_logger::~async_logger () noexcept {
+        PSTORE_TRY { flush_async_log (); }
+        PSTORE_CATCH (..., {})
+    }
+
+    // log
+    // ~~~
+    void async_logger::log (priority const p, std::string const & message) {
+        writer & w = writer::get ();
+        if (w.local ().push (record{sink_.get (), p, std::time (nullptr), message})) {
+            w.notify ();
+        }
+    }
+
+    // flush async log
+    // ~~~~~~~~~~~~~~~
+    void flush_async_log () { writer::get ().drain_all (); }
+
+    // async log dropped
+    // ~~~~~~~~~~~~~~~~~
+    std::uint64_t async_log_dropped () noexcept {
+        return total_dropped.load (std::memory_order_relaxed);
+    }
+
+} // end namespace pstore
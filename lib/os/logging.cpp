@@ -28,6 +28,7 @@
 
 // pstore includes
 #include "pstore/config/config.hpp"
+#include "pstore/os/async_log.hpp"
 #include "pstore/os/rotating_log.hpp"
 #include "pstore/os/time.hpp"
 #include "pstore/support/error.hpp"
@@ -78,6 +79,16 @@ namespace pstore {
             this->log (p, std::string{part1} + '"' + static_cast<gsl::czstring> (part2) + '"');
         }
 
+        // log deferred
+        // ~~~~~~~~~~~~
+        void logger::log_deferred (priority const p, std::time_t const /*time*/,
+                                   std::string const & /*thread_name*/,
+                                   std::string const & message) {
+            // A logger which doesn't record the time or thread of a message (such as syslog)
+            // simply logs it now.
+            this->log (p, message);
+        }
+
         //*  _             _      _                         *
         //* | |__  __ _ __(_)__  | |___  __ _ __ _ ___ _ _  *
         //* | '_ \/ _` (_-< / _| | / _ \/ _` / _` / -_) '_| *
@@ -291,6 +302,22 @@ namespace pstore {
 
         } // end namespace details
 
+        namespace {
+
+            std::atomic<bool> async_enabled{false};
+
+        } // end anonymous namespace
+
+        // set async logging
+        // ~~~~~~~~~~~~~~~~~
+        void set_async_logging (bool const enabled) noexcept {
+            async_enabled.store (enabled, std::memory_order_relaxed);
+        }
+
+        // async logging
+        // ~~~~~~~~~~~~~
+        bool async_logging () noexcept { return async_enabled.load (std::memory_order_relaxed); }
+
 
         // TODO: allow user control over where the log ends up.
         void create_log_stream (std::string const & ident) {
@@ -332,6 +359,12 @@ namespace pstore {
                 loggers->emplace_back (new stderr_logger);
             }
 
+            if (async_logging ()) {
+                for (std::unique_ptr<logger> & l : *loggers) {
+                    l = std::make_unique<async_logger> (std::move (l));
+                }
+            }
+
             using details::log_destinations;
             delete log_destinations;
             log_destinations = loggers.release ();
@@ -348,13 +381,28 @@ namespace pstore {
         // log
         // ~~~
         void basic_logger::log (priority const p, std::string const & message) {
+            this->write (p, std::time (nullptr), thread_name_, message);
+        }
+
+        // log deferred
+        // ~~~~~~~~~~~~
+        void basic_logger::log_deferred (priority const p, std::time_t const time,
+                                         std::string const & thread_name,
+                                         std::string const & message) {
+            this->write (p, time, thread_name, message);
+        }
+
+        // write
+        // ~~~~~
+        void basic_logger::write (priority const p, std::time_t const time,
+                                  std::string const & thread_name, std::string const & message) {
             std::array<char, time_buffer_size> time_buffer;
-            std::size_t const r = time_string (std::time (nullptr), ::gsl::make_span (time_buffer));
+            std::size_t const r = time_string (time, ::gsl::make_span (time_buffer));
             (void) r;
             PSTORE_ASSERT (r == sizeof (time_buffer) - 1);
             gsl::czstring const time_str = time_buffer.data ();
             std::ostringstream str;
-            str << time_str << " - " << thread_name_ << " - " << priority_string (p) << " - "
+            str << time_str << " - " << thread_name << " - " << priority_string (p) << " - "
                 << message << '\n';
 
             std::lock_guard<std::mutex> const lock (mutex_);
@@ -0,0 +1,185 @@
+//===- lib/os/trace.cpp ---------------------------------------------------===//
+//*  _                       *
+//* | |_ _ __ __ _  ___ ___  *
+//* | __| '__/ _` |/ __/ _ \ *
+//* | |_| | | (_| | (_|  __/ *
+//*  \__|_|  \__,_|\___\___| *
+//*                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/os/trace.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#include "pstore/support/portab.hpp"
+
+#ifdef _WIN32
+#    define NOMINMAX
+#    define WIN32_LEAN_AND_MEAN
+#    include <Windows.h>
+#else
+#    include <unistd.h>
+#endif
+
+namespace {
+
+    using pstore::trace::clock;
+
+    unsigned long process_id () {
+#ifdef _WIN32
+        return static_cast<unsigned long> (::GetCurrentProcessId ());
+#else
+        return static_cast<unsigned long> (::getpid ());
+#endif
+    }
+
+    /// Returns a small integer which identifies the calling thread.
+    std::uint32_t thread_id () noexcept {
+        static std::atomic<std::uint32_t> next{1U};
+        thread_local std::uint32_t const id = next.fetch_add (1U, std::memory_order_relaxed);
+        return id;
+    }
+
+    //*      _            *
+    //*  _ _(_)_ _  __ _  *
+    //* | '_| | ' \/ _` | *
+    //* |_| |_|_||_\__, | *
+    //*            |___/  *
+    struct event {
+        pstore::gsl::czstring name;
+        std::uint32_t tid;
+        /// The start time measured from the clock's epoch rather than from a per-process origin so
+        /// that the events recorded by different processes share a time line.
+        clock::duration start;
+        clock::duration duration;
+    };
+
+    // Both of these are constant-initialized so that events can be recorded during static
+    // initialization.
+    std::array<event, pstore::trace::ring_size> ring;
+    /// The total number of events recorded. The next event is written to ring[next % ring_size].
+    std::atomic<std::uint64_t> next{0U};
+
+    static_assert ((pstore::trace::ring_size & (pstore::trace::ring_size - 1U)) == 0U,
+                   "ring_size must be a power of 2");
+
+    /// Enables tracing if the PSTORE_TRACE environment variable is set. The trace is written to
+    /// the named file when the process exits.
+    class environment {
+    public:
+        environment ();
+        environment (environment const &) = delete;
+        environment (environment &&) = delete;
+        ~environment () noexcept;
+
+        environment & operator= (environment const &) = delete;
+        environment & operator= (environment &&) = delete;
+
+    private:
+        std::string path_;
+    };
+
+    // (ctor)
+    // ~~~~~~
+    environment::environment () {
+        // NOLINTNEXTLINE(concurrency-mt-unsafe)
+        char const * const path = std::getenv ("PSTORE_TRACE");
+        if (path == nullptr || path[0] == '\0') {
+            return;
+        }
+        path_ = path;
+        auto const pos = path_.find ("%p");
+        if (pos != std::string::npos) {
+            path_.replace (pos, 2U, std::to_string (process_id ()));
+        }
+        pstore::trace::enable (true);
+    }
+
+    // (dtor)
+    // ~~~~~~
+    environment::~environment () noexcept {
+        if (path_.empty ()) {
+            return;
+        }
+        PSTORE_TRY {
+            pstore::trace::enable (false);
+            std::ofstream os{path_};
+            pstore::trace::write_json (os);
+        }
+        PSTORE_CATCH (..., {})
+    }
+
+    environment const env;
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace trace {
+
+        std::atomic<bool> details::is_enabled{false};
+
+        // enable
+        // ~~~~~~
+        void enable (bool const on) noexcept {
+            details::is_enabled.store (on, std::memory_order_relaxed);
+        }
+
+        // record
+        // ~~~~~~
+        void record (gsl::czstring const name, clock::time_point const start,
+                     clock::time_point const end) noexcept {
+            std::uint64_t const n = next.fetch_add (1U, std::memory_order_relaxed);
+            event & e = ring[n & (ring_size - 1U)];
+            e.name = name;
+            e.tid = thread_id ();
+            e.start = start.time_since_epoch ();
+            e.duration = end - start;
+        }
+
+        // clear
+        // ~~~~~
+        void clear () noexcept { next.store (0U, std::memory_order_relaxed); }
+
+        // write json
+        // ~~~~~~~~~~
+        void write_json (std::ostream & os) {
+            using microseconds = std::chrono::duration<double, std::micro>;
+            std::uint64_t const last = next.load (std::memory_order_relaxed);
+            std::uint64_t const first = last > ring_size ? last - ring_size : 0U;
+            unsigned long const pid = process_id ();
+
+            // The timestamps are large (they are measured from the clock's epoch) so print them in
+            // fixed-point notation to keep their nanosecond resolution.
+            std::ios_base::fmtflags const flags = os.flags ();
+            std::streamsize const precision = os.precision ();
+            os << std::fixed << std::setprecision (3);
+
+            os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            auto const * sep = "\n";
+            for (auto n = first; n < last; ++n) {
+                event const & e = ring[n & (ring_size - 1U)];
+                os << sep << R"({"name":")" << e.name << R"(","cat":"pstore","ph":"X","ts":)"
+                   << microseconds{e.start}.count ()
+                   << ",\"dur\":" << microseconds{e.duration}.count () << ",\"pid\":" << pid
+                   << ",\"tid\":" << e.tid << '}';
+                sep = ",\n";
+            }
+            os << "\n]}\n";
+
+            os.flags (flags);
+            os.precision (precision);
+        }
+
+    } // end namespace trace
+} // end namespace pstore
@@ -0,0 +1,158 @@
+//===- lib/support/counters.cpp -------------------------------------------===//
+//*                        _                 *
+//*   ___ ___  _   _ _ __ | |_ ___ _ __ ___  *
+//*  / __/ _ \| | | | '_ \| __/ _ \ '__/ __| *
+//* | (_| (_) | |_| | | | | ||  __/ |  \__ \ *
+//*  \___\___/ \__,_|_| |_|\__\___|_|  |___/ *
+//*                                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/support/counters.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+    using namespace pstore::counters;
+
+    /// The set of threads whose counters are live together with the totals of those which have
+    /// exited.
+    class registry {
+    public:
+        void add (details::thread_counters * const tc) {
+            std::lock_guard<std::mutex> const lock{mut_};
+            live_.push_back (tc);
+        }
+        void remove (details::thread_counters * const tc) {
+            std::lock_guard<std::mutex> const lock{mut_};
+            accumulate (&retired_, *tc);
+            live_.erase (std::remove (std::begin (live_), std::end (live_), tc), std::end (live_));
+        }
+        snapshot read () {
+            std::lock_guard<std::mutex> const lock{mut_};
+            snapshot result = retired_;
+            for (details::thread_counters const * const tc : live_) {
+                accumulate (&result, *tc);
+            }
+            return result;
+        }
+
+    private:
+        static void accumulate (snapshot * const s, details::thread_counters const & tc) {
+            for (auto c = std::size_t{0}; c < num_counters; ++c) {
+                s->counters[c] += tc.counters[c].load (std::memory_order_relaxed);
+            }
+            for (auto h = std::size_t{0}; h < num_histograms; ++h) {
+                for (auto b = std::size_t{0}; b < histogram_buckets; ++b) {
+                    s->histograms[h][b] += tc.histograms[h][b].load (std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::mutex mut_;
+        std::vector<details::thread_counters *> live_;
+        snapshot retired_;
+    };
+
+    registry & get_registry () {
+        // The registry is deliberately leaked so that it outlives any thread_local instances
+        // destroyed during process exit.
+        static registry * const r = new registry;
+        return *r;
+    }
+
+    /// Registers a thread's counters for the lifetime of the thread.
+    class registration {
+    public:
+        registration () { get_registry ().add (&counters_); }
+        registration (registration const &) = delete;
+        registration (registration &&) = delete;
+        ~registration () noexcept { get_registry ().remove (&counters_); }
+
+        registration & operator= (registration const &) = delete;
+        registration & operator= (registration &&) = delete;
+
+        details::thread_counters & get () noexcept { return counters_; }
+
+    private:
+        details::thread_counters counters_;
+    };
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace counters {
+
+        // name
+        // ~~~~
+        char const * name (counter const c) noexcept {
+#define X(a)                                                                                       \
+    case counter::a: return #a;
+            switch (c) {
+                PSTORE_COUNTERS
+            case counter::last: break;
+            }
+#undef X
+            return "";
+        }
+
+        char const * name (histogram const h) noexcept {
+#define X(a)                                                                                       \
+    case histogram::a: return #a;
+            switch (h) {
+                PSTORE_HISTOGRAMS
+            case histogram::last: break;
+            }
+#undef X
+            return "";
+        }
+
+        // local
+        // ~~~~~
+        details::thread_counters & details::local () {
+            thread_local registration r;
+            return r.get ();
+        }
+
+        // read
+        // ~~~~
+        snapshot read () { return get_registry ().read (); }
+
+        // to json
+        // ~~~~~~~
+        std::string to_json (snapshot const & s) {
+            std::ostringstream os;
+            os << '{';
+            auto const * sep = "";
+            for (auto c = std::size_t{0}; c < num_counters; ++c) {
+                os << sep << '"' << name (static_cast<counter> (c)) << "\":" << s.counters[c];
+                sep = ",";
+            }
+            for (auto h = std::size_t{0}; h < num_histograms; ++h) {
+                os << sep << '"' << name (static_cast<histogram> (h)) << "\":{";
+                auto const * bsep = "";
+                for (auto b = std::size_t{0}; b < histogram_buckets; ++b) {
+                    if (std::uint64_t const count = s.histograms[h][b]) {
+                        std::uint64_t const lower = b == 0U ? 0U : std::uint64_t{1} << (b - 1U);
+                        os << bsep << '"' << lower << "\":" << count;
+                        bsep = ",";
+                    }
+                }
+                os << '}';
+                sep = ",";
+            }
+            os << '}';
+            return os.str ();
+        }
+
+    } // end namespace counters
+} // end namespace pstore
@@ -0,0 +1,229 @@
+//===- lib/support/lz4.cpp ------------------------------------------------===//
+//*  _     _  _    *
+//* | |___| || |   *
+//* | |_  / || |_  *
+//* | |/ /|__   _| *
+//* |_/___|  |_|   *
+//*                *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file lz4.cpp
+/// \brief A compressor and decompressor for the LZ4 block format.
+
+#include "pstore/support/lz4.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+    constexpr std::size_t min_match = 4U;
+    /// The final bytes of the input are always emitted as literals.
+    constexpr std::size_t last_literals = 5U;
+    /// A match may not start within this number of bytes of the end of the input.
+    constexpr std::size_t match_limit = 12U;
+    constexpr std::size_t max_offset = 65535U;
+    constexpr unsigned hash_log = 12U;
+
+    constexpr unsigned run_mask = 0x0FU;
+
+    inline std::uint32_t read32 (std::uint8_t const * const p) noexcept {
+        std::uint32_t v;
+        std::memcpy (&v, p, sizeof (v));
+        return v;
+    }
+
+    inline std::uint32_t hash (std::uint32_t const v) noexcept {
+        return (v * 2654435761U) >> (32U - hash_log);
+    }
+
+    /// Writes the extra bytes of a length whose value (after subtracting the token's share) is
+    /// \p len.
+    inline std::uint8_t * write_length (std::size_t len, std::uint8_t * out) noexcept {
+        for (; len >= 255U; len -= 255U) {
+            *(out++) = 255U;
+        }
+        *(out++) = static_cast<std::uint8_t> (len);
+        return out;
+    }
+
+    /// Writes a sequence made up of the \p num_literals bytes at \p literals and, if
+    /// \p match_length is non-zero, a match.
+    std::uint8_t * write_sequence (std::uint8_t const * const literals,
+                                   std::size_t const num_literals, std::size_t const offset,
+                                   std::size_t const match_length, std::uint8_t * out) noexcept {
+        std::uint8_t * const token = out++;
+        unsigned t = 0;
+        if (num_literals >= run_mask) {
+            t = run_mask << 4U;
+            out = write_length (num_literals - run_mask, out);
+        } else {
+            t = static_cast<unsigned> (num_literals) << 4U;
+        }
+        std::memcpy (out, literals, num_literals);
+        out += num_literals;
+
+        if (match_length > 0U) {
+            *(out++) = static_cast<std::uint8_t> (offset & 0xFFU);
+            *(out++) = static_cast<std::uint8_t> (offset >> 8U);
+            std::size_t const ml = match_length - min_match;
+            if (ml >= run_mask) {
+                t |= run_mask;
+                out = write_length (ml - run_mask, out);
+            } else {
+                t |= static_cast<unsigned> (ml);
+            }
+        }
+        *token = static_cast<std::uint8_t> (t);
+        return out;
+    }
+
+    /// Reads the extra bytes of a length from [*ip, iend) and adds them to *len.
+    /// \returns False if the input ended before the length was complete.
+    inline bool read_length (std::uint8_t const ** const ip, std::uint8_t const * const iend,
+                             std::size_t * const len) noexcept {
+        std::uint8_t const * p = *ip;
+        for (;;) {
+            if (p == iend) {
+                return false;
+            }
+            std::uint8_t const b = *(p++);
+            *len += b;
+            if (b != 255U) {
+                break;
+            }
+        }
+        *ip = p;
+        return true;
+    }
+
+} // end anonymous namespace
+
+namespace pstore {
+    namespace lz4 {
+
+        // compress
+        // ~~~~~~~~
+        std::size_t compress (std::uint8_t const * const src, std::size_t const size,
+                              std::uint8_t * const dst) noexcept {
+            std::uint8_t * out = dst;
+            std::size_t anchor = 0U;
+            if (size > match_limit) {
+                // Entries hold the position of the most recent occurrence of a 4-byte sequence
+                // with the corresponding hash. A stale or colliding entry is harmless because
+                // the bytes are always compared.
+                std::array<std::uint32_t, std::size_t{1} << hash_log> table{};
+                std::size_t const last_match_start = size - match_limit;
+                std::size_t const match_end_limit = size - last_literals;
+                std::size_t pos = 0U;
+                while (pos < last_match_start) {
+                    std::uint32_t const v = read32 (src + pos);
+                    std::uint32_t & entry = table[hash (v)];
+                    std::size_t const candidate = entry;
+                    entry = static_cast<std::uint32_t> (pos);
+                    if (candidate >= pos || pos - candidate > max_offset ||
+                        read32 (src + candidate) != v) {
+                        // Step faster through data which is not compressing.
+                        pos += 1U + ((pos - anchor) >> 6U);
+                        continue;
+                    }
+                    std::size_t length = min_match;
+                    while (pos + length < match_end_limit &&
+                           src[candidate + length] == src[pos + length]) {
+                        ++length;
+                    }
+                    out = write_sequence (src + anchor, pos - anchor, pos - candidate, length,
+                                          out);
+                    pos += length;
+                    anchor = pos;
+                    if (pos < last_match_start) {
+                        // Record a position from within the match to improve the chance that
+                        // the following data finds one.
+                        table[hash (read32 (src + pos - 2U))] =
+                            static_cast<std::uint32_t> (pos - 2U);
+                    }
+                }
+            }
+            return static_cast<std::size_t> (
+                write_sequence (src + anchor, size - anchor, 0U, 0U, out) - dst);
+        }
+
+        // decompress
+        // ~~~~~~~~~~
+        bool decompress (std::uint8_t const * const src, std::size_t const src_size,
+                         std::uint8_t * const dst, std::size_t const dst_size) noexcept {
+            std::uint8_t const * ip = src;
+            std::uint8_t const * const iend = src + src_size;
+            std::uint8_t * op = dst;
+            std::uint8_t * const oend = dst + dst_size;
+
+            for (;;) {
+                if (ip == iend) {
+                    return false;
+                }
+                unsigned const token = *(ip++);
+
+                std::size_t num_literals = token >> 4U;
+                if (num_literals == run_mask && !read_length (&ip, iend, &num_literals)) {
+                    return false;
+                }
+                if (num_literals > static_cast<std::size_t> (iend - ip) ||
+                    num_literals > static_cast<std::size_t> (oend - op)) {
+                    return false;
+                }
+                std::memcpy (op, ip, num_literals);
+                op += num_literals;
+                ip += num_literals;
+                if (ip == iend) {
+                    // The final sequence has no match.
+                    return op == oend;
+                }
+
+                if (iend - ip < 2) {
+                    return false;
+                }
+                auto const offset = static_cast<std::size_t> (ip[0] | (ip[1] << 8U));
+                ip += 2;
+                if (offset == 0U || offset > static_cast<std::size_t> (op - dst)) {
+                    return false;
+                }
+                std::size_t length = token & run_mask;
+                if (length == run_mask && !read_length (&ip, iend, &length)) {
+                    return false;
+                }
+                length += min_match;
+                if (length > static_cast<std::size_t> (oend - op)) {
+                    return false;
+                }
+
+                std::uint8_t const * match = op - offset;
+                if (offset >= length) {
+                    std::memcpy (op, match, length);
+                    op += length;
+                } else if (offset >= 8U) {
+                    // The regions overlap but each 8-byte block is copied from bytes which have
+                    // already been written.
+                    std::uint8_t * const end = op + length;
+                    for (; end - op >= 8; op += 8, match += 8) {
+                        std::memcpy (op, match, 8U);
+                    }
+                    while (op < end) {
+                        *(op++) = *(match++);
+                    }
+                } else {
+                    // A short repeating pattern (such as a run of a single byte).
+                    for (std::uint8_t * const end = op + length; op < end;) {
+                        *(op++) = *(match++);
+                    }
+                }
+            }
+        }
+
+    } // end namespace lz4
+} // end namespace pstore
@@ -0,0 +1,130 @@
+//===- lib/support/thread_pool.cpp ----------------------------------------===//
+//*  _   _                        _                     _  *
+//* | |_| |__  _ __ ___  __ _  __| |  _ __   ___   ___ | | *
+//* | __| '_ \| '__/ _ \/ _` |/ _` | | '_ \ / _ \ / _ \| | *
+//* | |_| | | | | |  __/ (_| | (_| | | |_) | (_) | (_) | | *
+//*  \__|_| |_|_|  \___|\__,_|\__,_| | .__/ \___/ \___/|_| *
+//*                                  |_|                   *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/support/thread_pool.hpp"
+
+#include <algorithm>
+
+#include "pstore/support/assert.hpp"
+
+namespace {
+
+    /// The pool to which the current thread belongs (or nullptr) and its index in that pool.
+    thread_local pstore::thread_pool const * current_pool = nullptr;
+    thread_local std::size_t current_index = 0;
+
+} // end anonymous namespace
+
+namespace pstore {
+
+    // (ctor)
+    // ~~~~~~
+    thread_pool::thread_pool (unsigned const workers) {
+        PSTORE_ASSERT (workers > 0U);
+        queues_.reserve (workers);
+        std::generate_n (std::back_inserter (queues_), workers,
+                         [] { return std::make_unique<queue> (); });
+        threads_.reserve (workers);
+        for (auto ctr = std::size_t{0}; ctr < workers; ++ctr) {
+            threads_.emplace_back ([this, ctr] { this->worker (ctr); });
+        }
+    }
+
+    // (dtor)
+    // ~~~~~~
+    thread_pool::~thread_pool () noexcept {
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            done_ = true;
+        }
+        cv_.notify_all ();
+        for (std::thread & t : threads_) {
+            t.join ();
+        }
+    }
+
+    // global [static]
+    // ~~~~~~~~~~~~~~~
+    thread_pool & thread_pool::global () {
+        static thread_pool pool{std::max (std::thread::hardware_concurrency (), 2U) - 1U};
+        return pool;
+    }
+
+    // submit
+    // ~~~~~~
+    void thread_pool::submit (task && t) {
+        std::size_t const index = current_pool == this
+                                      ? current_index
+                                      : next_queue_.fetch_add (1U) % queues_.size ();
+        {
+            queue & q = *queues_[index];
+            std::lock_guard<std::mutex> const lock{q.mut};
+            q.tasks.emplace_back (std::move (t));
+        }
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            ++queued_;
+        }
+        cv_.notify_one ();
+    }
+
+    // pop
+    // ~~~
+    bool thread_pool::pop (std::size_t const self, task * const out) {
+        {
+            queue & q = *queues_[self];
+            std::lock_guard<std::mutex> const lock{q.mut};
+            if (!q.tasks.empty ()) {
+                *out = std::move (q.tasks.back ());
+                q.tasks.pop_back ();
+                --queued_;
+                return true;
+            }
+        }
+        auto const size = queues_.size ();
+        for (auto ctr = std::size_t{1}; ctr < size; ++ctr) {
+            queue & victim = *queues_[(self + ctr) % size];
+            std::lock_guard<std::mutex> const lock{victim.mut};
+            if (!victim.tasks.empty ()) {
+                *out = std::move (victim.tasks.front ());
+                victim.tasks.pop_front ();
+                --queued_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // worker
+    // ~~~~~~
+    void thread_pool::worker (std::size_t const self) {
+        current_pool = this;
+        current_index = self;
+        task t;
+        for (;;) {
+            if (this->pop (self, &t)) {
+                t ();
+                t = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{mut_};
+            cv_.wait (lock, [this] { return done_ || queued_.load () > 0; });
+            if (done_ && queued_.load () <= 0) {
+                return;
+            }
+        }
+    }
+
+} // end namespace pstore
@@ -77,6 +77,45 @@ namespace {
 
 namespace vacuum {
 
+    // copy live
+    // ~~~~~~~~~
+    copy_result copy_live (pstore::database const & source, std::string const & destination_path,
+                           copy_progress const & progress) {
+        std::shared_ptr<pstore::index::write_index const> const source_names =
+            pstore::index::get_index<pstore::trailer::indices::write> (source);
+        if (source_names == nullptr) {
+            return copy_result::no_index;
+        }
+
+        pstore::database destination{destination_path, pstore::database::access_mode::writable};
+        // We don't want our pristine new store to be vacuumed; it doesn't need it.
+        destination.set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+
+        std::shared_ptr<pstore::index::write_index> const destination_names =
+            pstore::index::get_index<pstore::trailer::indices::write> (destination);
+
+        auto transaction = pstore::begin (destination);
+        for (auto const & kvp : source_names->make_range (source)) {
+            std::string const & key = kvp.first;
+            pstore::extent<char> const & extent = kvp.second;
+
+            pstore::address const addr = transaction.allocate (extent.size, 1 /*align*/);
+            // Copy from the source file to the data store.
+            std::memcpy (transaction.getrw (addr, extent.size).get (),
+                         source.getro (extent).get (), extent.size);
+
+            destination_names->insert_or_assign (
+                transaction, key, make_extent (pstore::typed_address<char> (addr), extent.size));
+
+            if (progress (extent.size)) {
+                transaction.rollback ();
+                return copy_result::abandoned;
+            }
+        }
+        transaction.commit ();
+        return copy_result::complete;
+    }
+
     void copy (std::shared_ptr<pstore::database> source, status * const st,
                user_options const & opt) {
         pstore::threads::set_name ("copy");
@@ -100,59 +139,27 @@ namespace vacuum {
                 // Tell the "watch" thread to start monitoring the store for changes.
                 start_watching (source, st);
 
-                bool copy_aborted = false;
                 // TODO: a new constructor to make a uniquely named file in the same directory as
                 // 'from'
-                auto destination = std::make_unique<pstore::database> (
-                    source->path () + ".gc", pstore::database::access_mode::writable);
-
-                // We don't want our pristine new store to be vacuumed; it doesn't need it.
-                destination->set_vacuum_mode (pstore::database::vacuum_mode::disabled);
-
-                std::shared_ptr<pstore::index::write_index const> const source_names =
-                    pstore::index::get_index<pstore::trailer::indices::write> (*source);
-                if (source_names == nullptr) {
-                    log (priority::error, "Names index was not found in source store");
-                    stop (st);
-                    return;
-                }
-
-                std::shared_ptr<pstore::index::write_index> const destination_names =
-                    pstore::index::get_index<pstore::trailer::indices::write> (*destination);
-
-                if (!st->done) {
-                    auto transaction = pstore::begin (*destination);
-
-                    for (auto const & kvp : source_names->make_range (*source)) {
-                        std::string const & key = kvp.first;
-                        pstore::extent<char> const & extent = kvp.second;
-
-                        pstore::address const addr =
-                            transaction.allocate (extent.size, 1 /*align*/);
-                        // Copy from the source file to the data store.
-                        std::memcpy (transaction.getrw (addr, extent.size).get (),
-                                     source->getro (extent).get (), extent.size);
-
-                        destination_names->insert_or_assign (
-                            transaction, key,
-                            make_extent (pstore::typed_address<char> (addr), extent.size));
-
+                std::string const destination_path = source->path () + ".gc";
+                copy_result const result =
+                    copy_live (*source, destination_path, [st] (std::uint64_t) {
+                        if (st->done) {
+                            return true;
+                        }
                         // Has the watch thread asked us to abort the copy?
                         if (st->modified) {
-                            copy_aborted = true;
                             log (priority::notice, "Store was modified during vacuuming: aborted.");
-                            break;
+                            return true;
                         }
-                    }
-
-                    if (copy_aborted) {
-                        transaction.rollback ();
-                    } else {
-                        transaction.commit ();
-                    }
-
-                    destination->close ();
+                        return false;
+                    });
+                if (result == copy_result::no_index) {
+                    log (priority::error, "Names index was not found in source store");
+                    stop (st);
+                    return;
                 }
+                bool const copy_aborted = result == copy_result::abandoned;
 
                 if (!copy_aborted) {
                     log (priority::notice, "Vacuuming complete");
@@ -163,9 +170,8 @@ namespace vacuum {
 
                     // TODO: wait for the watch thread to close its connection to the source store.
 
-                    pstore::file::file_handle destination_file{destination->path ()};
+                    pstore::file::file_handle destination_file{destination_path};
                     std::string const source_path = source->path ();
-                    destination.reset (); // Close the target data store
                     // assert that there's a single reference to the source pointer.
                     source.reset ();
 
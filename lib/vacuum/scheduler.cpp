@@ -0,0 +1,462 @@
+//===- lib/vacuum/scheduler.cpp -------------------------------------------===//
+//*           _              _       _            *
+//*  ___  ___| |__   ___  __| |_   _| | ___ _ __  *
+//* / __|/ __| '_ \ / _ \/ _` | | | | |/ _ \ '__| *
+//* \__ \ (__| | | |  __/ (_| | |_| | |  __/ |    *
+//* |___/\___|_| |_|\___|\__,_|\__,_|_|\___|_|    *
+//*                                               *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/vacuum/scheduler.hpp"
+
+#include <algorithm>
+#include <ctime>
+
+#include "pstore/core/database.hpp"
+#include "pstore/os/file.hpp"
+#include "pstore/os/logging.hpp"
+#include "pstore/os/thread.hpp"
+#include "pstore/support/portab.hpp"
+#include "pstore/vacuum/copy.hpp"
+
+namespace {
+
+    template <typename Lock>
+    bool can_lock (Lock & lock) {
+        if (lock.try_lock ()) {
+            lock.unlock ();
+            return true;
+        }
+        return false;
+    }
+
+    /// The number of entries copied between checks that the source store has not been touched.
+    constexpr unsigned check_interval = 64U;
+
+} // end anonymous namespace
+
+namespace vacuum {
+
+    //*  _   _            _   _   _      *
+    //* | |_| |_  _ _ ___| |_| |_| |___  *
+    //* |  _| ' \| '_/ _ \  _|  _| / -_) *
+    //*  \__|_||_|_| \___/\__|\__|_\___| *
+    //*                                  *
+    // set rate
+    // ~~~~~~~~
+    void throttle::set_rate (std::uint64_t const bytes_per_second) noexcept {
+        std::lock_guard<std::mutex> const lock{mut_};
+        rate_ = bytes_per_second;
+    }
+
+    // rate
+    // ~~~~
+    std::uint64_t throttle::rate () const noexcept {
+        std::lock_guard<std::mutex> const lock{mut_};
+        return rate_;
+    }
+
+    // consume
+    // ~~~~~~~
+    void throttle::consume (std::uint64_t const bytes) {
+        clock::time_point start;
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            if (rate_ == 0U) {
+                return;
+            }
+            // Each caller is given the next free slot. Its length is the time needed to transfer
+            // 'bytes' at the current rate.
+            start = std::max (next_, clock::now ());
+            next_ = start + std::chrono::duration_cast<clock::duration> (
+                                std::chrono::duration<double> (static_cast<double> (bytes) /
+                                                               static_cast<double> (rate_)));
+        }
+        std::this_thread::sleep_until (start);
+    }
+
+
+    // collect
+    // ~~~~~~~
+    collect_result collect (std::string const & path, throttle & limit,
+                            std::atomic<bool> const & cancel) {
+        using priority = pstore::logger::priority;
+        PSTORE_TRY {
+            if (!pstore::file::exists (path)) {
+                log (priority::notice, "Store not found: ", pstore::logger::quoted{path.c_str ()});
+                return collect_result::failed;
+            }
+            auto source = std::make_unique<pstore::database> (
+                path, pstore::database::access_mode::writable, false /*access tick enabled*/);
+            source->set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+
+            // If the exclusive lock can't be taken, the store is open in another process.
+            std::unique_lock<pstore::file::range_lock> * const file_lock =
+                source->upgrade_to_write_lock ();
+            if (file_lock == nullptr || !can_lock (*file_lock)) {
+                return collect_result::busy;
+            }
+
+            log (priority::notice, "Collecting ", pstore::logger::quoted{path.c_str ()});
+            std::time_t const start_time = source->latest_time ();
+            auto const touched = [&] () {
+                return source->latest_time () > start_time || !can_lock (*file_lock);
+            };
+
+            auto result = collect_result::complete;
+            auto count = 0U;
+            std::string const destination_path = path + ".gc";
+            copy_result const copied =
+                copy_live (*source, destination_path, [&] (std::uint64_t const bytes) {
+                    limit.consume (bytes);
+                    if (cancel) {
+                        result = collect_result::cancelled;
+                    } else if (++count % check_interval == 0U && touched ()) {
+                        result = collect_result::modified;
+                    }
+                    return result != collect_result::complete;
+                });
+            if (copied == copy_result::no_index) {
+                log (priority::error, "Names index was not found in ",
+                     pstore::logger::quoted{path.c_str ()});
+                pstore::file::unlink (destination_path, true /*allow_noent*/);
+                return collect_result::failed;
+            }
+            if (result == collect_result::complete && touched ()) {
+                result = collect_result::modified;
+            }
+            if (result != collect_result::complete) {
+                pstore::file::unlink (destination_path, true /*allow_noent*/);
+                return result;
+            }
+
+            pstore::file::file_handle destination_file{destination_path};
+#ifdef _WIN32
+            // Windows won't remove a file that is open so the source must be closed (and its
+            // lock released) first.
+            source.reset ();
+#endif
+            // file_handle::rename() won't replace an existing file so the source is removed
+            // first. The source remains open and exclusively locked until the copy has taken its
+            // place so that no other process can start to write to it. If another process
+            // manages to create a new store in the meantime, the copy is discarded.
+            pstore::file::unlink (path, true /*allow_noent*/);
+            bool const renamed = destination_file.rename (path);
+            source.reset ();
+            if (!renamed) {
+                pstore::file::unlink (destination_path, true /*allow_noent*/);
+                return collect_result::modified;
+            }
+            log (priority::notice, "Vacuumed ", pstore::logger::quoted{path.c_str ()});
+            return collect_result::complete;
+        }
+        // clang-format off
+        PSTORE_CATCH (std::exception const & ex, { // clang-format on
+            log (priority::error, "An error occurred: ", ex.what ());
+        })
+        // clang-format off
+        PSTORE_CATCH (..., { // clang-format on
+            log (priority::error, "Unknown error");
+        })
+        return collect_result::failed;
+    }
+
+    // estimate space
+    // ~~~~~~~~~~~~~~
+    space_usage estimate_space (std::string const & path) {
+        space_usage result;
+        PSTORE_TRY {
+            if (pstore::file::exists (path)) {
+                pstore::database db{path, pstore::database::access_mode::read_only,
+                                    false /*access tick enabled*/};
+                result.size = db.size ();
+                result.garbage = db.garbage ();
+            }
+        }
+        PSTORE_CATCH (..., {})
+        return result;
+    }
+
+
+    //*          _           _      _          *
+    //*  ___ __| |_  ___ __| |_  _| |___ _ _  *
+    //* (_-</ _| ' \/ -_) _` | || | / -_) '_| *
+    //* /__/\__|_||_\___\__,_|\_,_|_\___|_|   *
+    //*                                       *
+    // (ctor)
+    // ~~~~~~
+    scheduler::scheduler (options const & opt, collector collect, estimator estimate)
+            : collect_{std::move (collect)}
+            , estimate_{std::move (estimate)}
+            , throttle_{opt.bandwidth}
+            , workers_{0U}
+            , quiet_period_{opt.quiet_period}
+            , min_garbage_ratio_{opt.min_garbage_ratio} {
+        this->set_workers (opt.workers);
+    }
+
+    // (dtor)
+    // ~~~~~~
+    scheduler::~scheduler () noexcept {
+        PSTORE_TRY { this->stop (); }
+        PSTORE_CATCH (..., {})
+    }
+
+    // request
+    // ~~~~~~~
+    bool scheduler::request (std::string const & path) {
+        space_usage const usage = estimate_ (path);
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            auto const now = clock::now ();
+            auto pos = entries_.find (path);
+            if (usage.ratio () < min_garbage_ratio_) {
+                if (pos != entries_.end ()) {
+                    pos->second.usage = usage;
+                }
+                return false;
+            }
+            if (pos == entries_.end ()) {
+                pos = entries_.emplace (path, entry{}).first;
+                pos->second.last_vacuum = now;
+            }
+            entry & e = pos->second;
+            e.last_request = now;
+            e.usage = usage;
+            e.pending = true;
+        }
+        cv_.notify_all ();
+        return true;
+    }
+
+    // cancel
+    // ~~~~~~
+    bool scheduler::cancel (std::string const & path) {
+        std::lock_guard<std::mutex> const lock{mut_};
+        auto const pos = entries_.find (path);
+        if (pos == entries_.end ()) {
+            return false;
+        }
+        if (pos->second.running) {
+            // The worker removes the entry once it sees that the collection was cancelled.
+            *pos->second.cancel = true;
+            pos->second.pending = false;
+        } else {
+            entries_.erase (pos);
+        }
+        return true;
+    }
+
+    // set workers
+    // ~~~~~~~~~~~
+    void scheduler::set_workers (unsigned const workers) {
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            if (done_) {
+                return;
+            }
+            workers_ = std::max (workers, 1U);
+            // Threads are never destroyed: those whose index is not less than workers_ sit idle.
+            while (threads_.size () < workers_) {
+                auto const index = static_cast<unsigned> (threads_.size ());
+                threads_.emplace_back ([this, index] { this->worker (index); });
+            }
+        }
+        cv_.notify_all ();
+    }
+
+    // set quiet period
+    // ~~~~~~~~~~~~~~~~
+    void scheduler::set_quiet_period (std::chrono::seconds const period) {
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            quiet_period_ = period;
+        }
+        cv_.notify_all ();
+    }
+
+    // set min garbage ratio
+    // ~~~~~~~~~~~~~~~~~~~~~
+    void scheduler::set_min_garbage_ratio (double const ratio) {
+        std::lock_guard<std::mutex> const lock{mut_};
+        min_garbage_ratio_ = ratio;
+    }
+
+    // set observer
+    // ~~~~~~~~~~~~
+    void scheduler::set_observer (observer obs) {
+        std::lock_guard<std::mutex> const lock{mut_};
+        observer_ = std::move (obs);
+    }
+
+    // get options
+    // ~~~~~~~~~~~
+    auto scheduler::get_options () const -> options {
+        options result;
+        result.bandwidth = throttle_.rate ();
+        std::lock_guard<std::mutex> const lock{mut_};
+        result.workers = workers_;
+        result.quiet_period = quiet_period_;
+        result.min_garbage_ratio = min_garbage_ratio_;
+        return result;
+    }
+
+    // stop
+    // ~~~~
+    void scheduler::stop () {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            done_ = true;
+            for (auto & kvp : entries_) {
+                if (kvp.second.running) {
+                    *kvp.second.cancel = true;
+                }
+            }
+            threads = std::move (threads_);
+        }
+        cv_.notify_all ();
+        for (std::thread & t : threads) {
+            t.join ();
+        }
+    }
+
+    // status
+    // ~~~~~~
+    auto scheduler::status () const -> std::vector<store_status> {
+        std::vector<store_status> result;
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            auto const now = clock::now ();
+            result.reserve (entries_.size ());
+            for (auto const & kvp : entries_) {
+                entry const & e = kvp.second;
+                result.push_back (store_status{kvp.first, e.usage, priority (e, now), e.pending,
+                                               e.running, e.vacuums});
+            }
+        }
+        std::stable_sort (std::begin (result), std::end (result),
+                          [] (store_status const & a, store_status const & b) {
+                              return a.priority > b.priority;
+                          });
+        return result;
+    }
+
+    // priority [static]
+    // ~~~~~~~~~~~~~~~~~
+    double scheduler::priority (entry const & e, clock::time_point const now) {
+        // Weight the reclaimable space by the number of hours since the store was last vacuumed.
+        // A store with little garbage is therefore not starved forever.
+        auto const hours = std::chrono::duration<double, std::ratio<3600>> (now - e.last_vacuum);
+        return static_cast<double> (e.usage.garbage + 1U) * (1.0 + hours.count ());
+    }
+
+    // choose
+    // ~~~~~~
+    auto scheduler::choose (clock::time_point const now, clock::time_point * const wake)
+        -> entry_map::iterator {
+        auto best = entries_.end ();
+        auto best_priority = 0.0;
+        *wake = clock::time_point::max ();
+        for (auto it = entries_.begin (), end = entries_.end (); it != end; ++it) {
+            entry const & e = it->second;
+            if (e.running || !e.pending) {
+                continue;
+            }
+            auto const ready = e.last_request + quiet_period_;
+            if (ready > now) {
+                *wake = std::min (*wake, ready);
+                continue;
+            }
+            auto const p = priority (e, now);
+            if (best == end || p > best_priority) {
+                best = it;
+                best_priority = p;
+            }
+        }
+        return best;
+    }
+
+    // worker
+    // ~~~~~~
+    void scheduler::worker (unsigned const index) {
+        pstore::threads::set_name (("vacuum" + std::to_string (index)).c_str ());
+        pstore::create_log_stream ("vacuum." + std::to_string (index));
+
+        std::unique_lock<std::mutex> lock{mut_};
+        while (!done_) {
+            auto wake = clock::time_point::max ();
+            auto const pos = index < workers_ ? this->choose (clock::now (), &wake)
+                                              : entries_.end ();
+            if (pos == entries_.end ()) {
+                if (wake == clock::time_point::max ()) {
+                    cv_.wait (lock);
+                } else {
+                    cv_.wait_until (lock, wake);
+                }
+                continue;
+            }
+
+            std::string const path = pos->first;
+            entry & e = pos->second;
+            e.running = true;
+            e.pending = false;
+            e.cancel = std::make_shared<std::atomic<bool>> (false);
+            std::shared_ptr<std::atomic<bool>> const cancel = e.cancel;
+
+            lock.unlock ();
+            auto const result = collect_ (path, throttle_, *cancel);
+            space_usage const usage =
+                result == collect_result::complete ? estimate_ (path) : space_usage{};
+            lock.lock ();
+
+            this->finished (path, result, usage);
+            // Other workers may have been waiting for this store.
+            cv_.notify_all ();
+            if (observer_) {
+                observer const obs = observer_;
+                lock.unlock ();
+                obs ();
+                lock.lock ();
+            }
+        }
+    }
+
+    // finished
+    // ~~~~~~~~
+    void scheduler::finished (std::string const & path, collect_result const result,
+                              space_usage const & usage) {
+        auto const pos = entries_.find (path);
+        PSTORE_ASSERT (pos != entries_.end ());
+        entry & e = pos->second;
+        e.running = false;
+        e.cancel.reset ();
+        auto const now = clock::now ();
+        switch (result) {
+        case collect_result::complete:
+            ++e.vacuums;
+            e.last_vacuum = now;
+            e.usage = usage;
+            break;
+        case collect_result::busy:
+        case collect_result::modified:
+            // Try again once the store has been quiet for a while.
+            e.pending = true;
+            e.last_request = now;
+            break;
+        case collect_result::cancelled:
+            if (!e.pending) {
+                entries_.erase (pos);
+            }
+            break;
+        case collect_result::failed: entries_.erase (pos); break;
+        }
+    }
+
+} // end namespace vacuum
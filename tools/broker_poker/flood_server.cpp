@@ -25,11 +25,15 @@
 
 #include "iota_generator.hpp"
 
-void flood_server (pstore::gsl::czstring pipe_path, std::chrono::milliseconds retry_timeout,
-                   unsigned long num) {
+std::chrono::nanoseconds flood_server (pstore::gsl::czstring pipe_path,
+                                       pstore::brokerface::transport const kind,
+                                       std::chrono::milliseconds retry_timeout,
+                                       unsigned long num) {
+    auto const start = std::chrono::steady_clock::now ();
     pstore::parallel_for_each (
-        iota_generator (), iota_generator (num), [pipe_path, retry_timeout] (unsigned long count) {
-            pstore::brokerface::fifo_path fifo (pipe_path, retry_timeout,
+        iota_generator (), iota_generator (num),
+        [pipe_path, kind, retry_timeout] (unsigned long count) {
+            pstore::brokerface::fifo_path fifo (pipe_path, kind, retry_timeout,
                                                 pstore::brokerface::fifo_path::infinite_retries);
             pstore::brokerface::writer wr (fifo, retry_timeout,
                                            pstore::brokerface::writer::infinite_retries);
@@ -43,4 +47,5 @@ void flood_server (pstore::gsl::czstring pipe_path, std::chrono::milliseconds re
             constexpr bool error_on_timeout = true;
             pstore::brokerface::send_message (wr, error_on_timeout, "ECHO", path.c_str ());
         });
+    return std::chrono::steady_clock::now () - start;
 }
@@ -18,9 +18,17 @@
 #define PSTORE_BROKER_POKER_FLOOD_SERVER_HPP
 
 #include <chrono>
+
+#include "pstore/brokerface/fifo_path.hpp"
 #include "pstore/support/gsl.hpp"
 
-void flood_server (pstore::gsl::czstring pipe_path, std::chrono::milliseconds retry_timeout,
-                   unsigned long num);
+/// Sends \p num ECHO messages to the broker from a pool of threads. Each message is sent on a new
+/// connection and has a longer payload than its predecessor.
+///
+/// \returns The time taken to send all of the messages.
+std::chrono::nanoseconds flood_server (pstore::gsl::czstring pipe_path,
+                                       pstore::brokerface::transport kind,
+                                       std::chrono::milliseconds retry_timeout,
+                                       unsigned long num);
 
 #endif // PSTORE_BROKER_POKER_FLOOD_SERVER_HPP
@@ -70,10 +70,14 @@ int main (int argc, char * argv[]) {
             opt.pipe_path.has_value () ? opt.pipe_path.value ().c_str () : nullptr;
 
         if (opt.flood > 0) {
-            flood_server (pipe_path, opt.retry_timeout, opt.flood);
+            auto const elapsed = std::chrono::duration_cast<std::chrono::duration<double>> (
+                flood_server (pipe_path, opt.transport, opt.retry_timeout, opt.flood));
+            std::cout << "Sent " << opt.flood << " messages in " << elapsed.count () << "s ("
+                      << static_cast<double> (opt.flood) / elapsed.count () << " messages/s)"
+                      << std::endl;
         }
 
-        pstore::brokerface::fifo_path fifo (pipe_path, opt.retry_timeout,
+        pstore::brokerface::fifo_path fifo (pipe_path, opt.transport, opt.retry_timeout,
                                             pstore::brokerface::fifo_path::infinite_retries);
         pstore::brokerface::writer wr (fifo, opt.retry_timeout,
                                        pstore::brokerface::writer::infinite_retries);
@@ -29,7 +29,17 @@ namespace {
                                 desc ("Overrides the FIFO path to which messages are written."),
                                 init (""));
 
-    opt<unsigned> flood ("flood", desc ("Flood the broker with a number of ECHO messages."),
+    using pstore::brokerface::transport;
+    opt<transport> transport_opt (
+        "transport", desc ("The means by which messages are sent to the broker."),
+        values (literal{"fifo", static_cast<int> (transport::fifo), "A named pipe (the default)"},
+                literal{"socket", static_cast<int> (transport::socket),
+                        "A Unix-domain socket. The parts of each message are sent together."}),
+        init (transport::fifo));
+
+    opt<unsigned> flood ("flood",
+                         desc ("Flood the broker with a number of ECHO messages and report the "
+                               "time taken."),
                          init (0U));
     alias flood2 ("m", desc ("Alias for --flood"), aliasopt (flood));
 
@@ -63,5 +73,6 @@ std::pair<switches, int> get_switches (int argc, tchar * argv[]) {
     result.flood = flood.get ();
     result.kill = kill.get ();
     result.pipe_path = path_option (pipe_path.get ());
+    result.transport = transport_opt.get ();
     return {result, EXIT_SUCCESS};
 }
@@ -21,6 +21,7 @@
 #include <string>
 #include <utility>
 
+#include "pstore/brokerface/fifo_path.hpp"
 #include "pstore/command_line/tchar.hpp"
 #include "pstore/config/config.hpp"
 #include "pstore/support/maybe.hpp"
@@ -31,6 +32,7 @@ struct switches {
     std::chrono::milliseconds retry_timeout = std::chrono::milliseconds (500);
 
     pstore::maybe<std::string> pipe_path;
+    pstore::brokerface::transport transport = pstore::brokerface::transport::fifo;
 
     unsigned flood = 0;
     bool kill = false;
@@ -45,9 +45,11 @@
 #include "pstore/os/logging.hpp"
 #include "pstore/os/thread.hpp"
 #include "pstore/os/wsa_startup.hpp"
+#include "pstore/support/counters.hpp"
 #include "pstore/support/utf.hpp"
 
 #include "switches.hpp"
+#include "vacuum_service.hpp"
 
 using namespace std::string_literals;
 using namespace pstore;
@@ -97,7 +99,16 @@ namespace {
                      http::channel_container_entry{&broker::commits_channel, &broker::commits_cv}},
                     {"uptime",
                      http::channel_container_entry{&broker::uptime_channel, &broker::uptime_cv}},
+                    {"vacuum",
+                     http::channel_container_entry{&broker::vacuum_channel, &broker::vacuum_cv}},
                 };
+                // The counters channel is published only if the instrumentation is enabled.
+                if /*constexpr*/ (
+                    counters::enabled ()) { //! OCLINT(PH - don't warn that this is a constant)
+                    channels.emplace ("counters",
+                                      http::channel_container_entry{&broker::counters_channel,
+                                                                    &broker::counters_cv});
+                }
 
                 http::server (fs, &status->value (), channels,
                               [announce_port] (in_port_t const port) {
@@ -167,6 +178,8 @@ int run_broker (switches const & opt) {
     using priority = logger::priority;
 
     threads::set_name ("main");
+    // The broker's threads log on their hot paths: keep file writes off them.
+    set_async_logging (true);
     create_log_stream ("broker.main");
     log (priority::notice, "broker starting");
 
@@ -184,10 +197,19 @@ int run_broker (switches const & opt) {
         record_file = std::make_shared<broker::recorder> (*opt.record_path);
     }
 
+    if (opt.vacuum_service) {
+        log (priority::notice, "starting vacuum service");
+        vacuum::scheduler::options service_options;
+        service_options.workers = opt.vacuum_workers;
+        service_options.bandwidth = opt.vacuum_bandwidth;
+        broker::set_vacuum_service (make_vacuum_service (service_options));
+    }
+
     // TODO: ensure that this is a singleton process?
     log (priority::notice, "opening pipe");
 
-    brokerface::fifo_path fifo{opt.pipe_path.has_value () ? opt.pipe_path->c_str () : nullptr};
+    brokerface::fifo_path fifo{opt.pipe_path.has_value () ? opt.pipe_path->c_str () : nullptr,
+                               opt.transport, brokerface::fifo_path::duration_type{0}, 0U};
 
     std::vector<std::future<void>> futures;
     std::thread quit;
@@ -235,6 +257,7 @@ int run_broker (switches const & opt) {
     log (priority::notice, "worker threads done: stopping quit thread");
     broker::notify_quit_thread ();
     quit.join ();
+    broker::set_vacuum_service (nullptr);
     log (priority::notice, "exiting");
     return broker::exit_code;
 }
@@ -36,6 +36,14 @@ namespace {
     opt<std::string> pipe_path{
         "pipe-path", desc{"Overrides the path of the FIFO from which commands will be read"}};
 
+    using pstore::brokerface::transport;
+    opt<transport> transport_opt{
+        "transport", desc{"The means by which commands are received"},
+        values (literal{"fifo", static_cast<int> (transport::fifo), "A named pipe (the default)"},
+                literal{"socket", static_cast<int> (transport::socket),
+                        "A Unix-domain socket. Clients may send batches of messages."}),
+        init (transport::fifo)};
+
     opt<unsigned> num_read_threads{"read-threads", desc{"The number of pipe reading threads"},
                                    init (2U)};
 
@@ -53,6 +61,19 @@ namespace {
                                      "queue before being removed by the scavenger"},
                                 init (4U * 60U * 60U)};
 
+    opt<bool> vacuum_service{
+        "vacuum-service",
+        desc{"Vacuum stores using a pool of threads in the broker rather than one process each"},
+        init (false)};
+    opt<unsigned> vacuum_workers{"vacuum-workers",
+                                 desc{"The maximum number of stores that are vacuumed at once"},
+                                 init (2U)};
+    opt<std::uint64_t> vacuum_bandwidth{
+        "vacuum-bandwidth",
+        desc{"The maximum rate in bytes per second at which data is copied by the vacuum service "
+             "(0 is unlimited)"},
+        init (std::uint64_t{0})};
+
     pstore::maybe<std::string> path_option (opt<std::string> const & path) {
         if (path.get_num_occurrences () == 0U) {
             return pstore::nothing<std::string> ();
@@ -70,10 +91,14 @@ std::pair<switches, int> get_switches (int const argc, tchar * argv[]) {
     result.playback_path = path_option (playback_path);
     result.record_path = path_option (record_path);
     result.pipe_path = path_option (pipe_path);
+    result.transport = transport_opt.get ();
     result.num_read_threads = num_read_threads.get ();
     result.announce_http_port = announce_http_port.get ();
     result.http_port =
         disable_http ? pstore::nothing<in_port_t> () : pstore::just (http_port.get ());
     result.scavenge_time = std::chrono::seconds{scavenge_time.get ()};
+    result.vacuum_service = vacuum_service.get ();
+    result.vacuum_workers = vacuum_workers.get ();
+    result.vacuum_bandwidth = vacuum_bandwidth.get ();
     return {std::move (result), EXIT_SUCCESS};
 }
@@ -17,10 +17,12 @@
 #define SWITCHES_HPP
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <tuple>
 
+#include "pstore/brokerface/fifo_path.hpp"
 #include "pstore/command_line/tchar.hpp"
 #include "pstore/os/descriptor.hpp" // for in_port_t
 #include "pstore/support/maybe.hpp"
@@ -29,10 +31,16 @@ struct switches {
     pstore::maybe<std::string> playback_path;
     pstore::maybe<std::string> record_path;
     pstore::maybe<std::string> pipe_path;
+    pstore::brokerface::transport transport = pstore::brokerface::transport::fifo;
     unsigned num_read_threads = 2U;
     bool announce_http_port = false;
     pstore::maybe<in_port_t> http_port;
     std::chrono::seconds scavenge_time;
+    /// If true, stores are vacuumed by threads in the broker process rather than by spawning an
+    /// instance of the vacuum tool for each.
+    bool vacuum_service = false;
+    unsigned vacuum_workers = 2U;
+    std::uint64_t vacuum_bandwidth = 0U;
 };
 
 std::pair<switches, int> get_switches (int argc, pstore::command_line::tchar * argv[]);
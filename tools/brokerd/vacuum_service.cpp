@@ -0,0 +1,102 @@
+//===- tools/brokerd/vacuum_service.cpp -----------------------------------===//
+//*         _           _      _                           _         *
+//*  ___ __| |_  ___ __| |_  _| |___ _ _   ___ ___ _ ___ _(_)__ ___  *
+//* (_-</ _| ' \/ -_) _` | || | / -_) '_| (_-</ -_) '_\ V / / _/ -_) *
+//* /__/\__|_||_\___\__,_|\_,_|_\___|_|   /__/\___|_|  \_/|_\__\___| *
+//*                                                                  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "vacuum_service.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    class scheduler_service final : public pstore::broker::vacuum_service {
+    public:
+        explicit scheduler_service (vacuum::scheduler::options const & opt)
+                : scheduler_{opt} {
+            scheduler_.set_observer (pstore::broker::publish_vacuum_status);
+        }
+
+        void request (std::string const & path) override { scheduler_.request (path); }
+        bool cancel (std::string const & path) override { return scheduler_.cancel (path); }
+        bool configure (std::string const & key, std::string const & value) override;
+        std::string settings () const override;
+        std::vector<store> stores () const override;
+        void stop () override { scheduler_.stop (); }
+
+    private:
+        vacuum::scheduler scheduler_;
+    };
+
+    // configure
+    // ~~~~~~~~~
+    bool scheduler_service::configure (std::string const & key, std::string const & value) {
+        std::size_t pos = 0;
+        unsigned long long v = 0;
+        try {
+            if (key == "ratio") {
+                double const ratio = std::stod (value, &pos);
+                if (pos != value.length () || ratio < 0.0) {
+                    return false;
+                }
+                scheduler_.set_min_garbage_ratio (ratio);
+                return true;
+            }
+            v = std::stoull (value, &pos);
+        } catch (std::exception const &) {
+            return false;
+        }
+        if (pos != value.length ()) {
+            return false;
+        }
+        if (key == "workers") {
+            scheduler_.set_workers (static_cast<unsigned> (v));
+        } else if (key == "bandwidth") {
+            scheduler_.set_bandwidth (v);
+        } else if (key == "delay") {
+            scheduler_.set_quiet_period (std::chrono::seconds{v});
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // settings
+    // ~~~~~~~~
+    std::string scheduler_service::settings () const {
+        vacuum::scheduler::options const opt = scheduler_.get_options ();
+        std::ostringstream os;
+        os << "workers=" << opt.workers << " bandwidth=" << opt.bandwidth
+           << " delay=" << opt.quiet_period.count () << " ratio=" << opt.min_garbage_ratio;
+        return os.str ();
+    }
+
+    // stores
+    // ~~~~~~
+    auto scheduler_service::stores () const -> std::vector<store> {
+        std::vector<store> result;
+        for (vacuum::scheduler::store_status const & s : scheduler_.status ()) {
+            result.push_back (store{s.path, s.usage.size, s.usage.garbage, s.priority, s.pending,
+                                    s.running, s.vacuums});
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+// make vacuum service
+// ~~~~~~~~~~~~~~~~~~~
+std::shared_ptr<pstore::broker::vacuum_service>
+make_vacuum_service (vacuum::scheduler::options const & opt) {
+    return std::make_shared<scheduler_service> (opt);
+}
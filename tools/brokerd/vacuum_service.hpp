@@ -0,0 +1,28 @@
+//===- tools/brokerd/vacuum_service.hpp -------------------*- mode: C++ -*-===//
+//*                                                              _           *
+//* __   ____ _  ___ _   _ _   _ _ __ ___    ___  ___ _ ____   _(_) ___ ___  *
+//* \ \ / / _` |/ __| | | | | | | '_ ` _ \  / __|/ _ \ '__\ \ / / |/ __/ _ \ *
+//*  \ V / (_| | (__| |_| | |_| | | | | | | \__ \  __/ |   \ V /| | (_|  __/ *
+//*   \_/ \__,_|\___|\__,_|\__,_|_| |_| |_| |___/\___|_|    \_/ |_|\___\___| *
+//*                                                                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#ifndef VACUUM_SERVICE_HPP
+#define VACUUM_SERVICE_HPP
+
+#include <memory>
+
+#include "pstore/broker/gc.hpp"
+#include "pstore/vacuum/scheduler.hpp"
+
+/// Creates a vacuum service which collects stores on a pool of threads in the broker process.
+std::shared_ptr<pstore::broker::vacuum_service>
+make_vacuum_service (vacuum::scheduler::options const & opt);
+
+#endif // VACUUM_SERVICE_HPP
@@ -207,6 +207,7 @@ namespace {
             auto revision = std::make_shared<object> (object::container{
                 {"number", make_value (footer->a.generation.load ())},
                 {"size", make_number (footer->a.size.load ())},
+                {"garbage", make_number (footer->a.garbage.load ())},
                 {"time", make_time (footer->a.time, parm.no_times)},
             });
             revision->compact (true);
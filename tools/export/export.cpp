@@ -16,7 +16,18 @@
 
 #include <iostream>
 
+#ifdef _WIN32
+#    define NOMINMAX
+#    define WIN32_LEAN_AND_MEAN
+#    include <Windows.h>
+#    ifdef _MSC_VER
+#        include <fcntl.h>
+#        include <io.h>
+#    endif
+#endif
+
 #include "pstore/exchange/export.hpp"
+#include "pstore/exchange/export_binary.hpp"
 #include "pstore/core/database.hpp"
 #include "pstore/command_line/command_line.hpp"
 
@@ -24,6 +35,8 @@ using namespace pstore::command_line;
 
 namespace {
 
+    enum class format { json, binary };
+
     opt<std::string> db_path{positional, usage{"repository"},
                              desc{"Path of the pstore repository to be exported."}, required};
 
@@ -32,6 +45,32 @@ namespace {
         desc{"Disable embedded comments. (Required for output to be ECMA-404 compliant.)"},
         init (false)};
 
+    opt<unsigned> jobs{"jobs",
+                       desc{"The number of worker threads used to render transactions. (Default "
+                            "is 1: the export is performed on a single thread.)"},
+                       init (1U)};
+    alias jobs2{"j", desc{"Alias for --jobs"}, aliasopt{jobs}};
+
+    opt<format> format_opt{
+        "format", desc{"The format of the exported data"},
+        values (literal{"json", static_cast<int> (format::json), "JSON (the default)"},
+                literal{"binary", static_cast<int> (format::binary),
+                        "A compact binary format. (--jobs and --no-comments are ignored.)"}),
+        init (format::json)};
+
+    void set_output_stream_to_binary (pstore::gsl::not_null<FILE *> const file) {
+#ifdef _MSC_VER
+        // In Visual Studio, stream I/O routines operate on a file that is open in text mode and
+        // where line-feed characters are translated into CR-LF combinations on output. Here,
+        // the stream is placed in binary mode, in which the translation is suppressed.
+        if (_setmode (_fileno (file), O_BINARY) == -1) {
+            throw std::runtime_error ("Cannot set stream to binary mode");
+        }
+#else
+        (void) file; // Avoid an unused argument warning.
+#endif
+    }
+
 } // end anonymous namespace.
 
 #ifdef _WIN32
@@ -43,9 +82,17 @@ int main (int argc, char * argv[]) {
     PSTORE_TRY {
         parse_command_line_options (argc, argv, "pstore export utility\n");
 
+        if (format_opt.get () == format::binary) {
+            set_output_stream_to_binary (stdout);
+        }
         pstore::exchange::export_ns::ostream os{stdout};
         pstore::database db{db_path.get (), pstore::database::access_mode::read_only};
-        pstore::exchange::export_ns::emit_database (db, os, !no_comments);
+        switch (format_opt.get ()) {
+        case format::json:
+            pstore::exchange::export_ns::emit_database (db, os, !no_comments, jobs.get ());
+            break;
+        case format::binary: pstore::exchange::export_ns::emit_binary_database (db, os); break;
+        }
         os.flush ();
     }
     // clang-format off
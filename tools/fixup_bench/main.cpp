@@ -0,0 +1,299 @@
+//===- tools/fixup_bench/main.cpp -----------------------------------------===//
+//*                  _        *
+//*  _ __ ___   __ _(_)_ __   *
+//* | '_ ` _ \ / _` | | '_ \  *
+//* | | | | | | (_| | | | | | *
+//* |_| |_| |_|\__,_|_|_| |_| *
+//*                           *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file main.cpp
+/// \brief Measures the rate at which a linker could read section fixups.
+///
+/// A set of sections, each with a payload and a number of internal and external fixups, is built
+/// twice: once in the packed form written by generic_section and once as flat arrays of
+/// internal_fixup and external_fixup records (the form used by earlier versions of the file
+/// format). The sections are then visited in a random order and every field of every fixup is
+/// read.
+///
+/// The "hot" figures are for a small set of sections which stays in cache. The "cold" figures are
+/// for a set which is larger than the cache and are measured after the cache has been flushed, so
+/// they include the cost of bringing the records in from memory.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "pstore/command_line/command_line.hpp"
+#include "pstore/command_line/tchar.hpp"
+#include "pstore/mcrepo/generic_section.hpp"
+#include "pstore/support/portab.hpp"
+
+using namespace pstore::command_line;
+using pstore::repo::external_fixup;
+using pstore::repo::generic_section;
+using pstore::repo::internal_fixup;
+using pstore::repo::section_content;
+using pstore::repo::section_kind;
+
+namespace {
+
+    opt<unsigned> sections{"sections", desc{"The number of sections in the cold set"},
+                           init (200000U)};
+    opt<unsigned> hot_sections{"hot-sections", desc{"The number of sections in the hot set"},
+                               init (64U)};
+    opt<unsigned> ifixups{"ifixups", desc{"The number of internal fixups in each section"},
+                          init (16U)};
+    opt<unsigned> xfixups{"xfixups", desc{"The number of external fixups in each section"},
+                          init (8U)};
+    opt<unsigned> payload{"payload", desc{"The number of payload bytes in each section"},
+                          init (64U)};
+    opt<unsigned> flush_mb{"flush", desc{"The number of MiB written to flush the cache"},
+                           init (256U)};
+
+    /// Generates the content of a section. Fixup offsets increase through the payload and
+    /// external fixups refer to names chosen from a pool of strings spread across the store.
+    section_content make_content (std::mt19937_64 & rng) {
+        section_content content{section_kind::text, std::uint8_t{16}};
+        content.data.resize (payload.get ());
+        std::uniform_int_distribution<unsigned> byte{0U, 255U};
+        std::generate (std::begin (content.data), std::end (content.data),
+                       [&] () { return static_cast<std::uint8_t> (byte (rng)); });
+
+        std::uniform_int_distribution<std::uint64_t> step{1U, 16U};
+        std::uniform_int_distribution<int> addend{-8, 8};
+        std::uniform_int_distribution<std::uint64_t> name{0U, 100000U};
+        auto offset = std::uint64_t{0};
+        for (auto ctr = 0U; ctr < ifixups.get (); ++ctr) {
+            offset += step (rng);
+            content.ifixups.emplace_back (section_kind::data, pstore::repo::relocation_type{1},
+                                          offset, ctr % 4U == 0U ? addend (rng) : 0);
+        }
+        offset = 0U;
+        for (auto ctr = 0U; ctr < xfixups.get (); ++ctr) {
+            offset += step (rng);
+            content.xfixups.emplace_back (
+                pstore::typed_address<pstore::indirect_string>::make (0x10000U + name (rng) * 16U),
+                pstore::repo::relocation_type{2}, pstore::repo::binding::strong, offset, -4);
+        }
+        return content;
+    }
+
+    //*   __ _      _                _   _           *
+    //*  / _| |__ _| |_   ___ ___ __| |_(_)___ _ _   *
+    //* |  _| / _` |  _| (_-</ -_) _|  _| / _ \ ' \  *
+    //* |_| |_\__,_|\__| /__/\___\__|\__|_\___/_||_| *
+    //*                                              *
+    /// A section whose payload is followed by unpacked arrays of fixups.
+    struct flat_section {
+        std::uint32_t num_ifixups;
+        std::uint32_t num_xfixups;
+        std::uint64_t data_size;
+
+        internal_fixup const * ifixups () const noexcept {
+            return reinterpret_cast<internal_fixup const *> (
+                reinterpret_cast<std::uint8_t const *> (this + 1) + round (data_size));
+        }
+        external_fixup const * xfixups () const noexcept {
+            return reinterpret_cast<external_fixup const *> (this->ifixups () + num_ifixups);
+        }
+
+        static std::size_t size_bytes (section_content const & content) noexcept {
+            return sizeof (flat_section) + round (content.data.size ()) +
+                   content.ifixups.size () * sizeof (internal_fixup) +
+                   content.xfixups.size () * sizeof (external_fixup);
+        }
+        static void write (section_content const & content, std::uint8_t * const out) {
+            auto * const s = reinterpret_cast<flat_section *> (out);
+            s->num_ifixups = static_cast<std::uint32_t> (content.ifixups.size ());
+            s->num_xfixups = static_cast<std::uint32_t> (content.xfixups.size ());
+            s->data_size = content.data.size ();
+            std::copy (std::begin (content.data), std::end (content.data), out + sizeof (*s));
+            std::copy (std::begin (content.ifixups), std::end (content.ifixups),
+                       const_cast<internal_fixup *> (s->ifixups ()));
+            std::copy (std::begin (content.xfixups), std::end (content.xfixups),
+                       const_cast<external_fixup *> (s->xfixups ()));
+        }
+
+        static std::size_t round (std::size_t const v) noexcept { return (v + 7U) & ~7U; }
+    };
+
+    //*                          *
+    //*  __ _ _ _ ___ _ _  __ _  *
+    //* / _` | '_/ -_) ' \/ _` | *
+    //* \__,_|_| \___|_||_\__,_| *
+    //*                          *
+    /// Holds a collection of sections of type T laid out one after another.
+    template <typename T>
+    class arena {
+    public:
+        explicit arena (std::vector<section_content> const & contents);
+
+        std::size_t size () const noexcept { return offsets_.size (); }
+        std::size_t size_bytes () const noexcept { return memory_.size () * sizeof (memory_[0]); }
+        T const & operator[] (std::size_t const index) const noexcept {
+            return *reinterpret_cast<T const *> (
+                reinterpret_cast<std::uint8_t const *> (memory_.data ()) + offsets_[index]);
+        }
+
+    private:
+        static std::size_t size_bytes (section_content const & content) {
+            return generic_section::size_bytes (content.make_sources ());
+        }
+        static void write (section_content const & content, std::uint8_t * const out) {
+            new (out) generic_section (content.make_sources (), content.align);
+        }
+
+        std::vector<std::uint64_t> memory_;
+        std::vector<std::size_t> offsets_;
+    };
+
+    template <>
+    std::size_t arena<flat_section>::size_bytes (section_content const & content) {
+        return flat_section::size_bytes (content);
+    }
+    template <>
+    void arena<flat_section>::write (section_content const & content, std::uint8_t * const out) {
+        flat_section::write (content, out);
+    }
+
+    template <typename T>
+    arena<T>::arena (std::vector<section_content> const & contents) {
+        offsets_.reserve (contents.size ());
+        auto total = std::size_t{0};
+        for (section_content const & c : contents) {
+            offsets_.push_back (total);
+            total += flat_section::round (size_bytes (c));
+        }
+        memory_.resize (total / sizeof (memory_[0]));
+        auto * const base = reinterpret_cast<std::uint8_t *> (memory_.data ());
+        for (auto ctr = std::size_t{0}; ctr < contents.size (); ++ctr) {
+            write (contents[ctr], base + offsets_[ctr]);
+        }
+    }
+
+    template <typename Fixup>
+    std::uint64_t visit (Fixup const & f) noexcept;
+    template <>
+    std::uint64_t visit (internal_fixup const & f) noexcept {
+        return static_cast<std::uint64_t> (f.section) + f.type + f.offset +
+               static_cast<std::uint64_t> (f.addend);
+    }
+    template <>
+    std::uint64_t visit (external_fixup const & f) noexcept {
+        return f.name.absolute () + f.type + static_cast<std::uint64_t> (f.strength ()) + f.offset +
+               static_cast<std::uint64_t> (f.addend);
+    }
+
+    std::uint64_t read_fixups (generic_section const & s) noexcept {
+        auto result = std::uint64_t{0};
+        for (internal_fixup const & f : s.ifixups ()) {
+            result += visit (f);
+        }
+        for (external_fixup const & f : s.xfixups ()) {
+            result += visit (f);
+        }
+        return result;
+    }
+    std::uint64_t read_fixups (flat_section const & s) noexcept {
+        auto result = std::uint64_t{0};
+        std::for_each (s.ifixups (), s.ifixups () + s.num_ifixups,
+                       [&result] (internal_fixup const & f) { result += visit (f); });
+        std::for_each (s.xfixups (), s.xfixups () + s.num_xfixups,
+                       [&result] (external_fixup const & f) { result += visit (f); });
+        return result;
+    }
+
+    std::uint64_t sink = 0;
+
+    /// Writes to a buffer which is larger than the cache so that none of the sections remain in
+    /// it.
+    void flush_cache () {
+        static std::vector<std::uint64_t> scratch;
+        scratch.resize (std::size_t{flush_mb.get ()} * 1024U * 1024U / sizeof (std::uint64_t));
+        std::iota (std::begin (scratch), std::end (scratch), sink);
+        sink += scratch[scratch.size () / 2U];
+    }
+
+    /// Reads all of the fixups of the sections in \p a in the order given by \p order, \p passes
+    /// times, and returns the mean time taken per fixup in nanoseconds.
+    template <typename T>
+    double run (arena<T> const & a, std::vector<std::size_t> const & order, unsigned const passes,
+                bool const cold) {
+        std::chrono::duration<double, std::nano> elapsed{0};
+        for (auto pass = 0U; pass < passes; ++pass) {
+            if (cold) {
+                flush_cache ();
+            }
+            auto const start = std::chrono::steady_clock::now ();
+            for (std::size_t const index : order) {
+                sink += read_fixups (a[index]);
+            }
+            elapsed += std::chrono::steady_clock::now () - start;
+        }
+        auto const fixups = static_cast<double> (passes) * static_cast<double> (order.size ()) *
+                            (ifixups.get () + xfixups.get ());
+        return elapsed.count () / fixups;
+    }
+
+    void report (char const * const name, unsigned const num_sections, unsigned const passes,
+                 bool const cold) {
+        std::mt19937_64 rng{42U};
+        std::vector<section_content> contents;
+        contents.reserve (num_sections);
+        for (auto ctr = 0U; ctr < num_sections; ++ctr) {
+            contents.push_back (make_content (rng));
+        }
+        arena<generic_section> const packed{contents};
+        arena<flat_section> const flat{contents};
+        contents.clear ();
+
+        std::vector<std::size_t> order (num_sections);
+        std::iota (std::begin (order), std::end (order), std::size_t{0});
+        std::shuffle (std::begin (order), std::end (order), rng);
+
+        std::cout << name << " (" << num_sections << " sections, packed " << packed.size_bytes ()
+                  << " bytes, flat " << flat.size_bytes () << " bytes):\n"
+                  << "  packed: " << run (packed, order, passes, cold) << " ns/fixup\n"
+                  << "  flat:   " << run (flat, order, passes, cold) << " ns/fixup\n";
+    }
+
+} // end anonymous namespace
+
+#if defined(_WIN32)
+int _tmain (int argc, TCHAR * argv[]) {
+#else
+int main (int argc, char * argv[]) {
+#endif
+    int exit_code = EXIT_SUCCESS;
+    PSTORE_TRY {
+        parse_command_line_options (argc, argv, "Benchmarks the reading of section fixups");
+        unsigned const hot = std::max (hot_sections.get (), 1U);
+        report ("hot", hot, std::max (2000000U / hot, 1U), false);
+        report ("cold", std::max (sections.get (), 1U), 3U, true);
+        if (sink == 0U) {
+            std::cout << '\n';
+        }
+    }
+    // clang-format off
+    PSTORE_CATCH (std::exception const & ex, { // clang-format on
+        std::cerr << "Error: " << ex.what () << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    // clang-format off
+    PSTORE_CATCH (..., { // clang-format on
+        std::cerr << "Unknown error." << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    return exit_code;
+}
@@ -16,8 +16,11 @@
 /// \file main.cpp
 /// \brief A small utility which can be used to check the HAMT index.
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <future>
+#include <iterator>
 #include <vector>
 
 #include "pstore/command_line/command_line.hpp"
@@ -117,13 +120,16 @@ namespace {
     }
 
     /// Insert all keys of the maps into the database and update the mapped value to the expected
-    /// database address.
+    /// database address. The mean time taken per insertion (including the commit) is reported.
     ///
     /// \param index A database index.
     /// \param maps It is an input and output parameter. The mapped values are updated once the
     ///        values are saved into the database. It stores the actual map in the database.
+    /// \param test_name  A test name which is used to label the timing information.
     template <typename Map>
-    void insert (pstore::database & db, pstore::index::fragment_index & index, Map & maps) {
+    void insert (pstore::database & db, pstore::index::fragment_index & index, Map & maps,
+                 std::string const & test_name) {
+        auto const start = std::chrono::steady_clock::now ();
         // Start a transaction...
         auto transaction = pstore::begin (db);
 
@@ -151,10 +157,18 @@ namespace {
         }
 
         transaction.commit ();
+
+        auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now () - start);
+        if (!maps.empty ()) {
+            print_cout (test_name, ": ",
+                        static_cast<double> (elapsed.count ()) / static_cast<double> (maps.size ()),
+                        " ns per insert");
+        }
     }
 
     /// Find all keys of the map (expected_results) in the database. Return true if all keys are in
-    /// the database. Otherwise, return false.
+    /// the database. Otherwise, return false. The mean time taken per lookup is reported.
     ///
     /// \param index  A database index.
     /// \param expected_results  A expected index which is saved in the database.
@@ -175,11 +189,106 @@ namespace {
                 is_found = false;
             }
         };
+        auto const start = std::chrono::steady_clock::now ();
         pstore::parallel_for_each (std::begin (expected_results), std::end (expected_results),
                                    check_key);
+        auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now () - start);
+        if (!expected_results.empty ()) {
+            // The lookups are spread across threads so this is a measure of throughput rather
+            // than of the latency of a single lookup.
+            print_cout (test_name, ": ",
+                        static_cast<double> (elapsed.count ()) /
+                            static_cast<double> (expected_results.size ()),
+                        " ns per lookup");
+        }
         return is_found.load ();
     }
 
+    /// Compares the time taken to look up each of the keys of \p keys by calling find() with that
+    /// taken by find_many(). The keys are presented in batches of sizes from 16 to 4096 and both
+    /// functions run on a single thread so that the figures are a measure of latency. The results
+    /// of both are checked against the expected addresses.
+    ///
+    /// \param index  A database index.
+    /// \param keys  The keys to be found together with their expected addresses.
+    /// \returns True if every key was found by both functions, false otherwise.
+    bool find_many (pstore::database const & db, pstore::index::fragment_index const & index,
+                    random_list const & keys) {
+        using const_iterator = pstore::index::fragment_index::const_iterator;
+        auto const end = index.cend (db);
+        auto const is_correct = [&end] (const_iterator const & it,
+                                        random_list::value_type const & kv) {
+            return it != end && it->second.addr.to_address () == kv.second;
+        };
+
+        std::vector<pstore::index::digest> digests;
+        digests.reserve (keys.size ());
+        std::transform (std::begin (keys), std::end (keys), std::back_inserter (digests),
+                        [] (random_list::value_type const & kv) { return kv.first; });
+
+        // Check that find_many() produces the expected results. This pass also builds the
+        // index's top-levels cache so that it is not counted against either timed loop.
+        std::vector<const_iterator> results;
+        results.reserve (digests.size ());
+        index.find_many (db, digests, std::back_inserter (results));
+        bool ok = true;
+        for (auto ctr = std::size_t{0}; ctr < keys.size (); ++ctr) {
+            if (!is_correct (results[ctr], keys[ctr])) {
+                print_cerr ("find_many Error: ", keys[ctr].first, ": not found");
+                ok = false;
+            }
+        }
+        results.clear ();
+
+        using clock = std::chrono::steady_clock;
+        auto const ns_per_key = [&keys] (clock::duration const d) {
+            return static_cast<double> (
+                       std::chrono::duration_cast<std::chrono::nanoseconds> (d).count ()) /
+                   static_cast<double> (keys.size ());
+        };
+        for (auto batch_size = std::size_t{16}; batch_size <= 4096U; batch_size *= 4U) {
+            auto found = std::size_t{0};
+            auto const count_correct = [&] (std::size_t const base) {
+                for (auto ctr = std::size_t{0}; ctr < results.size (); ++ctr) {
+                    found += is_correct (results[ctr], keys[base + ctr]);
+                }
+                results.clear ();
+            };
+
+            auto start = clock::now ();
+            for (auto base = std::size_t{0}; base < digests.size (); base += batch_size) {
+                auto const last = std::min (base + batch_size, digests.size ());
+                for (auto ctr = base; ctr < last; ++ctr) {
+                    results.push_back (index.find (db, digests[ctr]));
+                }
+                count_correct (base);
+            }
+            auto const find_time = clock::now () - start;
+
+            start = clock::now ();
+            for (auto base = std::size_t{0}; base < digests.size (); base += batch_size) {
+                auto const first = std::begin (digests) + static_cast<std::ptrdiff_t> (base);
+                index.find_many (db, first,
+                                 first + static_cast<std::ptrdiff_t> (
+                                             std::min (batch_size, digests.size () - base)),
+                                 std::back_inserter (results));
+                count_correct (base);
+            }
+            auto const find_many_time = clock::now () - start;
+
+            if (found != keys.size () * 2U) {
+                print_cerr ("find_many Error: batch size ", batch_size, ": ",
+                            keys.size () * 2U - found, " keys not found");
+                ok = false;
+            }
+            print_cout ("batch size ", batch_size, ": find ", ns_per_key (find_time),
+                        " ns per lookup, find_many ", ns_per_key (find_many_time),
+                        " ns per lookup");
+        }
+        return ok;
+    }
+
 } // end anonymous namespace
 
 #ifdef _WIN32
@@ -205,7 +314,7 @@ int main (int argc, char * argv[]) {
         // Case 1a: generate the map with random keys.
         random_list map1 = generate_random_keys_map (num_keys);
         // Case 1b: insert the random keys.
-        insert<random_list> (database, *index, map1);
+        insert<random_list> (database, *index, map1, "random key tests");
         // Case 1c: find the random keys.
         if (!find<random_list> (database, *index, map1, "random key tests")) {
             exit_code = EXIT_FAILURE;
@@ -214,7 +323,7 @@ int main (int argc, char * argv[]) {
         // Case 2a: generate the map with increasing keys.
         less_map map2 = generate_ordered_map<less_map> (num_keys, value_step);
         // Case 2b: insert the increasing key.
-        insert<less_map> (database, *index, map2);
+        insert<less_map> (database, *index, map2, "increasing key tests");
         // Case 2c: find the increasing key.
         if (!find<less_map> (database, *index, map2, "increasing key tests")) {
             exit_code = EXIT_FAILURE;
@@ -223,12 +332,17 @@ int main (int argc, char * argv[]) {
         // Case 3a: generate the map with decreasing keys .
         greater_map map3 = generate_ordered_map<greater_map> (num_keys, value_step);
         // Case 3b: insert the decreasing key.
-        insert<greater_map> (database, *index, map3);
+        insert<greater_map> (database, *index, map3, "decreasing key tests");
         // Case 3c: find the decreasing key.
         if (!find<greater_map> (database, *index, map3, "decreasing key tests")) {
             exit_code = EXIT_FAILURE;
         }
 
+        // Case 4: compare find() with find_many() for the random keys.
+        if (!find_many (database, *index, map1)) {
+            exit_code = EXIT_FAILURE;
+        }
+
         // TODO: test the following keys {0, num_keys*value_step, value_step-1,
         // num_keys*value_step-num_keys, 2*value_step-2...}
 
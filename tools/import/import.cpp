@@ -14,12 +14,25 @@
 //
 //===----------------------------------------------------------------------===//
 #include <bitset>
+#include <unordered_map>
+
+#ifdef _WIN32
+#    define NOMINMAX
+#    define WIN32_LEAN_AND_MEAN
+#    include <Windows.h>
+#    ifdef _MSC_VER
+#        include <fcntl.h>
+#        include <io.h>
+#    endif
+#endif
 
 #include "pstore/command_line/command_line.hpp"
 #include "pstore/command_line/revision_opt.hpp"
 #include "pstore/command_line/str_to_revision.hpp"
 #include "pstore/core/database.hpp"
+#include "pstore/exchange/import_binary.hpp"
 #include "pstore/exchange/import_root.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
 
 using namespace pstore::command_line;
 using namespace std::string_literals;
@@ -31,14 +44,178 @@ namespace {
     opt<std::string> json_source (positional, usage ("[input]"),
                                   desc ("The export file to be read (stdin if not specified)."));
 
+
+    opt<unsigned> jobs{"jobs",
+                       desc{"The number of worker threads used to prepare fragments. (Default is "
+                            "1: the import is performed on a single thread.)"},
+                       init (1U)};
+    alias jobs2{"j", desc{"Alias for --jobs"}, aliasopt{jobs}};
+
+    opt<unsigned> dedup_threshold{
+        "dedup-threshold",
+        desc{"Section payloads of at least this number of bytes are stored once and shared "
+             "between fragments. (Default is 0: payloads are never shared.)"},
+        init (0U)};
+
+    opt<unsigned> compress_threshold{
+        "compress-threshold",
+        desc{"Section payloads of at least this number of bytes are compressed if their section "
+             "kind is selected by --compress-sections. (Default is 0: payloads are never "
+             "compressed.)"},
+        init (0U)};
+    list<std::string> compress_sections{
+        "compress-sections",
+        desc{"The kinds of section whose payloads may be compressed. (Default is "
+             "debug_line,debug_loc,debug_string,debug_ranges.)"},
+        comma_separated};
+
+    enum class format { json, binary };
+    opt<format> format_opt{
+        "format", desc{"The format of the import data"},
+        values (literal{"json", static_cast<int> (format::json), "JSON (the default)"},
+                literal{"binary", static_cast<int> (format::binary),
+                        "A compact binary format. (--jobs is ignored.)"}),
+        init (format::json)};
+
     bool is_file_input () { return json_source.get_num_occurrences () > 0; }
 
+    void set_input_stream_to_binary (pstore::gsl::not_null<FILE *> const file) {
+#ifdef _MSC_VER
+        // Place the stream in binary mode to suppress the translation of CR-LF combinations.
+        if (_setmode (_fileno (file), O_BINARY) == -1) {
+            throw std::runtime_error ("Cannot set stream to binary mode");
+        }
+#else
+        (void) file; // Avoid an unused argument warning.
+#endif
+    }
+
     FILE * open_input () {
-        return is_file_input () ? std::fopen (json_source.get ().c_str (), "r") : stdin;
+        bool const binary = format_opt.get () == format::binary;
+        if (is_file_input ()) {
+            return std::fopen (json_source.get ().c_str (), binary ? "rb" : "r");
+        }
+        if (binary) {
+            set_input_stream_to_binary (stdin);
+        }
+        return stdin;
     }
 
     std::string input_name () { return is_file_input () ? json_source.get () : "stdin"s; }
 
+    /// Reads the input file in chunks, passing each of them to \p consume. Stops at the end of
+    /// the file or when \p consume returns false.
+    ///
+    /// \returns True if the entire file was read and consumed successfully.
+    template <typename Function>
+    bool read_input (FILE * const infile, Function consume) {
+        std::vector<std::uint8_t> buffer;
+        buffer.resize (65535);
+
+        for (;;) {
+            std::uint8_t * const ptr = buffer.data ();
+            std::size_t const nread =
+                std::fread (ptr, sizeof (std::uint8_t), buffer.size (), infile);
+            if (nread < buffer.size ()) {
+                if (std::ferror (infile)) {
+                    error_stream << PSTORE_NATIVE_TEXT ("error: there was an error reading input")
+                                 << std::endl;
+                    return false;
+                }
+            }
+            if (!consume (ptr, ptr + nread)) {
+                return false;
+            }
+            // Stop if we've reached the end of the file.
+            if (std::feof (infile)) {
+                return true;
+            }
+        }
+    }
+
+    /// Builds the payload storage options from the command-line switches.
+    /// \returns False if --compress-sections names an unknown section kind.
+    bool make_payload_options (pstore::repo::payload_options * const options) {
+        using pstore::repo::section_kind;
+
+        options->share_threshold = dedup_threshold.get ();
+        options->compress_threshold = compress_threshold.get ();
+        if (compress_sections.empty ()) {
+            return true;
+        }
+#define X(a) {#a, section_kind::a},
+        static std::unordered_map<std::string, section_kind> const map{
+            PSTORE_MCREPO_SECTION_KINDS};
+#undef X
+        options->compress_kinds.reset ();
+        for (std::string const & name : compress_sections) {
+            auto const pos = map.find (name);
+            if (pos == map.end ()) {
+                error_stream << PSTORE_NATIVE_TEXT (R"(error: unknown section kind ")")
+                             << pstore::utf::to_native_string (name) << PSTORE_NATIVE_TEXT ("\"")
+                             << std::endl;
+                return false;
+            }
+            options->compress_kinds.set (static_cast<std::size_t> (pos->second));
+        }
+        return true;
+    }
+
+    int import_json (pstore::database & db, FILE * const infile,
+                     pstore::repo::payload_options const & payloads) {
+        auto parser = pstore::exchange::import_ns::create_parser (db, jobs.get (), payloads);
+        bool const ok =
+            read_input (infile, [&parser] (std::uint8_t const * const first,
+                                           std::uint8_t const * const last) {
+                parser.input (reinterpret_cast<char const *> (first),
+                              reinterpret_cast<char const *> (last));
+                if (parser.has_error ()) {
+                    auto const coord = parser.coordinate ();
+                    error_stream << pstore::utf::to_native_string (input_name ())
+                                 << PSTORE_NATIVE_TEXT (":") << coord.row
+                                 << PSTORE_NATIVE_TEXT (":") << coord.column
+                                 << PSTORE_NATIVE_TEXT (": error: ")
+                                 << pstore::utf::to_native_string (parser.last_error ().message ())
+                                 << std::endl;
+                    return false;
+                }
+                return true;
+            });
+        if (!ok) {
+            return EXIT_FAILURE;
+        }
+        parser.eof ();
+        return EXIT_SUCCESS;
+    }
+
+    int import_binary (pstore::database & db, FILE * const infile,
+                       pstore::repo::payload_options const & payloads) {
+        pstore::exchange::import_ns::binary_importer importer{&db, payloads};
+        auto const report = [&importer] () {
+            error_stream << pstore::utf::to_native_string (input_name ())
+                         << PSTORE_NATIVE_TEXT (":") << importer.offset ()
+                         << PSTORE_NATIVE_TEXT (": error: ")
+                         << pstore::utf::to_native_string (importer.last_error ().message ())
+                         << std::endl;
+        };
+        bool const ok = read_input (
+            infile, [&] (std::uint8_t const * const first, std::uint8_t const * const last) {
+                if (importer.input (first, last)) {
+                    report ();
+                    return false;
+                }
+                return true;
+            });
+        if (!ok) {
+            return EXIT_FAILURE;
+        }
+        if (importer.eof ()) {
+            report ();
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
 } // end anonymous namespace
 
 #ifdef _WIN32
@@ -49,6 +226,10 @@ int main (int argc, char * argv[]) {
     int exit_code = EXIT_SUCCESS;
     PSTORE_TRY {
         parse_command_line_options (argc, argv, "pstore import utility\n");
+        pstore::repo::payload_options payloads;
+        if (!make_payload_options (&payloads)) {
+            return EXIT_FAILURE;
+        }
 
         if (pstore::file::exists (db_path.get ())) {
             error_stream << PSTORE_NATIVE_TEXT (
@@ -73,42 +254,9 @@ int main (int argc, char * argv[]) {
             return EXIT_FAILURE;
         }
 
-        auto parser = pstore::exchange::import_ns::create_parser (db);
-
-        std::vector<std::uint8_t> buffer;
-        buffer.resize (65535);
-
-        for (;;) {
-            auto * const ptr = reinterpret_cast<char *> (buffer.data ());
-            std::size_t const nread =
-                std::fread (ptr, sizeof (std::uint8_t), buffer.size (), infile.get ());
-            if (nread < buffer.size ()) {
-                if (std::ferror (infile.get ())) {
-                    error_stream << PSTORE_NATIVE_TEXT ("error: there was an error reading input")
-                                 << std::endl;
-                    exit_code = EXIT_FAILURE;
-                    break;
-                }
-            }
-
-            parser.input (ptr, ptr + nread);
-            if (parser.has_error ()) {
-                auto const coord = parser.coordinate ();
-                error_stream << pstore::utf::to_native_string (input_name ())
-                             << PSTORE_NATIVE_TEXT (":") << coord.row << PSTORE_NATIVE_TEXT (":")
-                             << coord.column << PSTORE_NATIVE_TEXT (": error: ")
-                             << pstore::utf::to_native_string (parser.last_error ().message ())
-                             << std::endl;
-                exit_code = EXIT_FAILURE;
-                break;
-            }
-
-            // Stop if we've reached the end of the file.
-            if (std::feof (infile.get ())) {
-                parser.eof ();
-                break;
-            }
-        }
+        exit_code = format_opt.get () == format::binary
+                        ? import_binary (db, infile.get (), payloads)
+                        : import_json (db, infile.get (), payloads);
     }
     // clang-format off
     PSTORE_CATCH (std::exception const & ex, { // clang-format on
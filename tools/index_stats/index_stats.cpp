@@ -14,27 +14,50 @@
 //
 //===----------------------------------------------------------------------===//
 /// \file main.cpp
+/// \brief Dumps statistics describing the shape of each of the indices in a pstore database.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include "pstore/command_line/command_line.hpp"
 #include "pstore/command_line/modifiers.hpp"
 #include "pstore/command_line/revision_opt.hpp"
 #include "pstore/command_line/tchar.hpp"
+#include "pstore/core/btree_set.hpp"
 #include "pstore/core/database.hpp"
 #include "pstore/core/file_header.hpp"
+#include "pstore/core/generation_iterator.hpp"
 #include "pstore/core/hamt_map.hpp"
 #include "pstore/core/hamt_map_types.hpp"
 #include "pstore/core/hamt_set.hpp"
 #include "pstore/core/index_types.hpp"
+#include "pstore/support/parallel_for_each.hpp"
 
 using namespace pstore;
 
 namespace {
 
+    enum class output_format { csv, json };
+
     command_line::opt<command_line::revision_opt, command_line::parser<std::string>> revision{
         "revision", command_line::desc ("The starting revision number (or 'HEAD')")};
     command_line::alias revision2{"r", command_line::desc ("Alias for --revision"),
                                   command_line::aliasopt (revision)};
 
+    command_line::opt<output_format> format{
+        "format", command_line::desc ("The output format"),
+        command_line::values (
+            command_line::literal{"csv", static_cast<int> (output_format::csv),
+                                  "Comma-separated values (the default)"},
+            command_line::literal{"json", static_cast<int> (output_format::json), "JSON"}),
+        command_line::init (output_format::csv)};
+    command_line::alias format2{"f", command_line::desc ("Alias for --format"),
+                                command_line::aliasopt (format)};
+
     command_line::opt<std::string> db_path{command_line::positional, command_line::required,
                                            command_line::usage ("repository"),
                                            command_line::desc ("Database path")};
@@ -46,22 +69,67 @@ namespace {
     using index_pointer = index::details::index_pointer;
     using internal_node = index::details::internal_node;
     using linear_node = index::details::linear_node;
+    using btree_node = index::btree_details::node;
+    using btree_node_ref = index::btree_details::node_ref;
     constexpr auto max_internal_depth = index::details::max_internal_depth;
 
-    struct stats {
+    /// Maps a store address to the generation which wrote it.
+    class generation_map {
+    public:
+        explicit generation_map (database const & db);
+        unsigned operator() (address addr) const;
+
+    private:
+        /// The address of each generation's trailer and the generation number, in ascending
+        /// order of address.
+        std::vector<std::pair<address, unsigned>> footers_;
+    };
+
+    generation_map::generation_map (database const & db) {
+        for (typed_address<trailer> const pos : generation_container{db}) {
+            footers_.emplace_back (pos.to_address (), db.getro (pos)->a.generation.load ());
+        }
+        std::reverse (std::begin (footers_), std::end (footers_));
+    }
+
+    unsigned generation_map::operator() (address const addr) const {
+        // Data belongs to the first generation whose trailer follows it.
+        auto const pos = std::upper_bound (
+            std::begin (footers_), std::end (footers_), addr,
+            [] (address const a, std::pair<address, unsigned> const & f) { return a < f.first; });
+        return pos == std::end (footers_) ? 0U : pos->second;
+    }
+
+    template <typename Key>
+    using histogram = std::map<Key, std::uint64_t>;
+
+    class stats {
     public:
-        explicit stats (database const & db) noexcept;
+        stats (database const & db, generation_map const & generations) noexcept;
 
         template <typename Key, typename Hash, typename KeyEqual>
         void traverse (index::hamt_set<Key, Hash, KeyEqual> const & index) {
-            traverse (index.root ());
+            this->traverse_root (index.root ());
         }
 
         template <typename Key, typename Value, typename Hash, typename KeyEqual>
         void traverse (index::hamt_map<Key, Value, Hash, KeyEqual> const & index) {
-            traverse (index.root ());
+            this->traverse_root (index.root ());
+        }
+
+        template <typename Key, typename Compare>
+        void traverse (index::btree_set<Key, Compare> const & index) {
+            this->traverse_root (index.root ());
+        }
+
+        template <typename Key, typename Value, typename Compare>
+        void traverse (index::btree_map<Key, Value, Compare> const & index) {
+            this->traverse_root (index.root ());
         }
 
+        /// Adds the statistics gathered by \p other to this object.
+        stats & operator+= (stats const & other);
+
         double branching_factor () const noexcept {
             return internal_visited_ == 0 ? 0.0
                                           : static_cast<double> (internal_out_edges_) /
@@ -72,87 +140,387 @@ namespace {
                        ? 0.0
                        : static_cast<double> (leaf_depth_) / static_cast<double> (leaves_visited_);
         }
-        unsigned max_depth () const noexcept { return max_depth_; }
+        unsigned max_depth () const noexcept {
+            return static_cast<unsigned> (leaves_per_depth_.size ());
+        }
+        /// Returns the number of bytes occupied by the index nodes (excluding the leaves).
+        std::uint64_t node_bytes () const noexcept { return node_bytes_; }
+        /// Returns the number of bytes occupied by the index nodes (excluding the leaves) per
+        /// key.
+        double bytes_per_key (std::size_t const size) const noexcept {
+            return size == 0U ? 0.0
+                              : static_cast<double> (node_bytes_) / static_cast<double> (size);
+        }
+        /// Returns the number of nodes whose storage spans more than one memory-mapped region.
+        /// Each read of such a node must copy it.
+        std::uint64_t spanning_reads () const noexcept { return spanning_reads_; }
+
+        /// The number of internal (or linear) nodes at each depth. Element 0 is depth 1.
+        std::vector<std::uint64_t> const & nodes_per_depth () const noexcept {
+            return nodes_per_depth_;
+        }
+        /// The number of leaves at each depth. Element 0 is depth 1.
+        std::vector<std::uint64_t> const & leaves_per_depth () const noexcept {
+            return leaves_per_depth_;
+        }
+        /// The number of internal nodes with each number of children.
+        histogram<std::size_t> const & children () const noexcept { return children_; }
+        /// The number of linear nodes with each number of children.
+        histogram<std::size_t> const & linear_sizes () const noexcept { return linear_sizes_; }
+        /// The number of node bytes written by each generation.
+        histogram<unsigned> const & generation_bytes () const noexcept {
+            return generation_bytes_;
+        }
 
     private:
         database const & db_;
+        generation_map const & generations_;
 
         std::uint64_t internal_out_edges_ = 0;
-        std::size_t internal_visited_ = 0;
+        std::uint64_t internal_visited_ = 0;
         std::uint64_t leaf_depth_ = 0;
-        std::size_t leaves_visited_ = 0;
-        unsigned max_depth_ = 0;
+        std::uint64_t leaves_visited_ = 0;
+        std::uint64_t node_bytes_ = 0;
+        std::uint64_t spanning_reads_ = 0;
+        std::vector<std::uint64_t> nodes_per_depth_;
+        std::vector<std::uint64_t> leaves_per_depth_;
+        histogram<std::size_t> children_;
+        histogram<std::size_t> linear_sizes_;
+        histogram<unsigned> generation_bytes_;
+
+        void traverse_root (index_pointer root);
+        void traverse_root (btree_node_ref root);
+        /// Visits each of the subtries in \p subtries (whose roots are at \p depth) in parallel.
+        template <typename Node>
+        void traverse_parallel (std::vector<Node> const & subtries, unsigned depth);
 
-        void traverse (index_pointer root);
         void traverse (index_pointer node, unsigned depth);
-        void visit_linear (linear_node const & linear);
+        void traverse (btree_node_ref node, unsigned depth);
+        void visit_node (address addr, std::size_t size_bytes, std::size_t children,
+                         unsigned depth);
         void visit_leaf_node (unsigned depth);
-        void visit_internal (internal_node const & internal, unsigned depth);
+
+        static void bump (std::vector<std::uint64_t> & v, unsigned depth);
     };
 
-    stats::stats (database const & db) noexcept
-            : db_{db} {}
+    // (ctor)
+    // ~~~~~~
+    stats::stats (database const & db, generation_map const & generations) noexcept
+            : db_{db}
+            , generations_{generations} {}
 
-    void stats::traverse (index_pointer root) {
+    // operator+=
+    // ~~~~~~~~~~
+    stats & stats::operator+= (stats const & other) {
+        auto const add_vector = [] (std::vector<std::uint64_t> & lhs,
+                                    std::vector<std::uint64_t> const & rhs) {
+            lhs.resize (std::max (lhs.size (), rhs.size ()), 0U);
+            std::transform (std::begin (rhs), std::end (rhs), std::begin (lhs), std::begin (lhs),
+                            std::plus<std::uint64_t> ());
+        };
+        auto const add_histogram = [] (auto & lhs, auto const & rhs) {
+            for (auto const & kvp : rhs) {
+                lhs[kvp.first] += kvp.second;
+            }
+        };
+        internal_out_edges_ += other.internal_out_edges_;
+        internal_visited_ += other.internal_visited_;
+        leaf_depth_ += other.leaf_depth_;
+        leaves_visited_ += other.leaves_visited_;
+        node_bytes_ += other.node_bytes_;
+        spanning_reads_ += other.spanning_reads_;
+        add_vector (nodes_per_depth_, other.nodes_per_depth_);
+        add_vector (leaves_per_depth_, other.leaves_per_depth_);
+        add_histogram (children_, other.children_);
+        add_histogram (linear_sizes_, other.linear_sizes_);
+        add_histogram (generation_bytes_, other.generation_bytes_);
+        return *this;
+    }
+
+    // bump
+    // ~~~~
+    void stats::bump (std::vector<std::uint64_t> & v, unsigned const depth) {
+        PSTORE_ASSERT (depth > 0U);
+        if (v.size () < depth) {
+            v.resize (depth, 0U);
+        }
+        ++v[depth - 1U];
+    }
+
+    // traverse root
+    // ~~~~~~~~~~~~~
+    void stats::traverse_root (index_pointer const root) {
         if (!root) {
             return;
         }
-        traverse (root, 1U);
+        if (!root.is_internal ()) {
+            return this->traverse (root, 1U);
+        }
+        // Visit the root here and its children in parallel.
+        auto const internal = internal_node::get_node (db_, root);
+        this->visit_node (root.untag_address<internal_node> ().to_address (),
+                          internal_node::size_bytes (internal.second->size ()),
+                          internal.second->size (), 1U);
+        this->traverse_parallel (
+            std::vector<index_pointer> (internal.second->begin (), internal.second->end ()), 2U);
     }
 
-    void stats::traverse (index_pointer node, unsigned depth) {
-        max_depth_ = std::max (max_depth_, depth);
+    void stats::traverse_root (btree_node_ref const root) {
+        if (!root) {
+            return;
+        }
+        auto const n = btree_node::get_node (db_, root);
+        if (n.second->is_leaf ()) {
+            return this->traverse (root, 1U);
+        }
+        this->visit_node (root.to_address (), n.second->size_bytes (), n.second->size (), 1U);
+        std::vector<btree_node_ref> children;
+        children.reserve (n.second->size ());
+        for (auto ctr = std::size_t{0}; ctr < n.second->size (); ++ctr) {
+            children.push_back (n.second->child (ctr));
+        }
+        this->traverse_parallel (children, 2U);
+    }
+
+    // traverse parallel
+    // ~~~~~~~~~~~~~~~~~
+    template <typename Node>
+    void stats::traverse_parallel (std::vector<Node> const & subtries, unsigned const depth) {
+        std::mutex mut;
+        parallel_for_each (std::begin (subtries), std::end (subtries),
+                           [this, depth, &mut] (Node const & node) {
+                               stats s{db_, generations_};
+                               s.traverse (node, depth);
+                               std::lock_guard<std::mutex> const lock{mut};
+                               *this += s;
+                           });
+    }
+
+    // traverse
+    // ~~~~~~~~
+    void stats::traverse (index_pointer const node, unsigned const depth) {
         if (depth >= max_internal_depth && node.is_linear ()) {
             auto const linear = linear_node::get_node (db_, node);
-            return this->visit_linear (*linear.second);
+            auto const size = linear.second->size ();
+            this->visit_node (node.untag_address<linear_node> ().to_address (),
+                              linear.second->size_bytes (), size, depth);
+            ++linear_sizes_[size];
+            for (auto ctr = std::size_t{0}; ctr < size; ++ctr) {
+                this->visit_leaf_node (depth + 1U);
+            }
+            return;
         }
         if (node.is_internal ()) {
             auto const internal = internal_node::get_node (db_, node);
-            return this->visit_internal (*internal.second, depth);
+            this->visit_node (node.untag_address<internal_node> ().to_address (),
+                              internal_node::size_bytes (internal.second->size ()),
+                              internal.second->size (), depth);
+            for (index_pointer const child : *internal.second) {
+                this->traverse (child, depth + 1U);
+            }
+            return;
+        }
+        this->visit_leaf_node (depth);
+    }
+
+    void stats::traverse (btree_node_ref const node, unsigned const depth) {
+        if (!node) {
+            return;
+        }
+        // A B+-tree node is treated as an internal node whose children are either further nodes
+        // or, for a leaf node, the index records.
+        auto const n = btree_node::get_node (db_, node);
+        this->visit_node (node.to_address (), n.second->size_bytes (), n.second->size (), depth);
+        for (auto ctr = std::size_t{0}; ctr < n.second->size (); ++ctr) {
+            if (n.second->is_leaf ()) {
+                this->visit_leaf_node (depth + 1U);
+            } else {
+                this->traverse (n.second->child (ctr), depth + 1U);
+            }
         }
-        return this->visit_leaf_node (depth);
     }
 
-    void stats::visit_linear (linear_node const & linear) {
-        internal_out_edges_ += linear.size ();
+    // visit node
+    // ~~~~~~~~~~
+    void stats::visit_node (address const addr, std::size_t const size_bytes,
+                            std::size_t const children, unsigned const depth) {
+        node_bytes_ += size_bytes;
+        internal_out_edges_ += children;
         ++internal_visited_;
+        bump (nodes_per_depth_, depth);
+        ++children_[children];
+        generation_bytes_[generations_ (addr)] += size_bytes;
+        if (db_.storage ().request_spans_regions (addr, size_bytes)) {
+            ++spanning_reads_;
+        }
     }
 
-    void stats::visit_leaf_node (unsigned depth) {
+    // visit leaf node
+    // ~~~~~~~~~~~~~~~
+    void stats::visit_leaf_node (unsigned const depth) {
         leaf_depth_ += depth;
         ++leaves_visited_;
-    }
-
-    void stats::visit_internal (internal_node const & internal, unsigned depth) {
-        internal_out_edges_ += internal.size ();
-        ++internal_visited_;
-        for (index_pointer child : internal) {
-            this->traverse (child, depth + 1U);
-        }
+        bump (leaves_per_depth_, depth);
     }
 
     template <trailer::indices Index>
     struct index_name {};
 #define X(a)                                                                                       \
     template <>                                                                                    \
-    struct index_name<trailer::indices::a> {                                               \
+    struct index_name<trailer::indices::a> {                                                       \
         static constexpr auto name = #a;                                                           \
     };
     PSTORE_INDICES
 #undef X
 
+    template <typename Key>
+    Key const & key_of (Key const & key) noexcept {
+        return key;
+    }
+    template <typename Key, typename Value>
+    Key const & key_of (std::pair<Key const, Value> const & kvp) noexcept {
+        return kvp.first;
+    }
+
+    /// Returns the mean time (in nanoseconds) taken to find each of a sample of the keys in
+    /// \p index. The sample is taken from the start of the index: for a HAMT this is in hash order
+    /// and therefore spread across the whole trie.
+    template <typename IndexType>
+    double mean_lookup_ns (database const & db, IndexType const & index) {
+        constexpr auto max_sample = std::size_t{1} << 16U;
+        std::vector<typename IndexType::key_type> keys;
+        keys.reserve (std::min (index.size (), max_sample));
+        for (auto it = index.begin (db), end = index.end (db);
+             it != end && keys.size () < max_sample; ++it) {
+            keys.push_back (key_of (*it));
+        }
+        if (keys.empty ()) {
+            return 0.0;
+        }
+        auto found = std::size_t{0};
+        auto const start = std::chrono::steady_clock::now ();
+        for (auto const & key : keys) {
+            found += index.find (db, key) != index.cend (db);
+        }
+        auto const elapsed = std::chrono::steady_clock::now () - start;
+        PSTORE_ASSERT (found == keys.size ());
+        (void) found;
+        return static_cast<double> (
+                   std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()) /
+               static_cast<double> (keys.size ());
+    }
+
+    //*           _             _    *
+    //*  ___ _  _| |_ _ __ _  _| |_  *
+    //* / _ \ || |  _| '_ \ || |  _| *
+    //* \___/\_,_|\__| .__/\_,_|\__| *
+    //*              |_|             *
+
+    /// Writes the elements of \p v separated by \p separator.
+    template <typename OStream>
+    void write_list (OStream & os, std::vector<std::uint64_t> const & v,
+                     typename OStream::char_type const * const separator) {
+        auto const * sep = PSTORE_NATIVE_TEXT ("");
+        for (std::uint64_t const x : v) {
+            os << sep << x;
+            sep = separator;
+        }
+    }
+
+    /// Writes the members of \p h as key/value pairs.
+    template <typename OStream, typename Key>
+    void write_histogram (OStream & os, histogram<Key> const & h,
+                          typename OStream::char_type const * const separator,
+                          typename OStream::char_type const * const key_prefix,
+                          typename OStream::char_type const * const key_suffix) {
+        auto const * sep = PSTORE_NATIVE_TEXT ("");
+        for (auto const & kvp : h) {
+            os << sep << key_prefix << kvp.first << key_suffix << kvp.second;
+            sep = separator;
+        }
+    }
+
+    template <typename OStream>
+    void write_csv_header (OStream & os) {
+        os << PSTORE_NATIVE_TEXT ("name,branching-factor,mean-leaf-depth,max-depth,size,")
+           << PSTORE_NATIVE_TEXT ("bytes-per-key,mean-lookup-ns,node-bytes,spanning-reads,")
+           << PSTORE_NATIVE_TEXT ("nodes-per-depth,leaves-per-depth,children,linear-sizes,")
+           << PSTORE_NATIVE_TEXT ("bytes-per-generation\n");
+    }
+
+    /// Writes a CSV record. The lists and histograms are each written to a single field: list
+    /// members are separated by semicolons and histogram entries are written as key:value.
+    template <typename OStream>
+    void write_csv (OStream & os, char const * const name, std::size_t const size,
+                    stats const & s, double const lookup_ns) {
+        static constexpr auto comma = PSTORE_NATIVE_TEXT (",");
+        static constexpr auto semi = PSTORE_NATIVE_TEXT (";");
+        static constexpr auto colon = PSTORE_NATIVE_TEXT (":");
+        static constexpr auto empty = PSTORE_NATIVE_TEXT ("");
+        os << utf::to_native_string (name) << comma << s.branching_factor () << comma
+           << s.mean_leaf_depth () << comma << s.max_depth () << comma << size << comma
+           << s.bytes_per_key (size) << comma << lookup_ns << comma << s.node_bytes () << comma
+           << s.spanning_reads () << comma;
+        write_list (os, s.nodes_per_depth (), semi);
+        os << comma;
+        write_list (os, s.leaves_per_depth (), semi);
+        os << comma;
+        write_histogram (os, s.children (), semi, empty, colon);
+        os << comma;
+        write_histogram (os, s.linear_sizes (), semi, empty, colon);
+        os << comma;
+        write_histogram (os, s.generation_bytes (), semi, empty, colon);
+        os << PSTORE_NATIVE_TEXT ("\n");
+    }
+
+    /// Writes a JSON object. The caller is responsible for the enclosing array.
+    template <typename OStream>
+    void write_json (OStream & os, char const * const name, std::size_t const size,
+                     stats const & s, double const lookup_ns) {
+        static constexpr auto comma = PSTORE_NATIVE_TEXT (",");
+        static constexpr auto quote = PSTORE_NATIVE_TEXT ("\"");
+        static constexpr auto colon = PSTORE_NATIVE_TEXT ("\":");
+        os << PSTORE_NATIVE_TEXT ("{\"name\":\"") << utf::to_native_string (name)
+           << PSTORE_NATIVE_TEXT ("\",\"branching-factor\":") << s.branching_factor ()
+           << PSTORE_NATIVE_TEXT (",\"mean-leaf-depth\":") << s.mean_leaf_depth ()
+           << PSTORE_NATIVE_TEXT (",\"max-depth\":") << s.max_depth ()
+           << PSTORE_NATIVE_TEXT (",\"size\":") << size
+           << PSTORE_NATIVE_TEXT (",\"bytes-per-key\":") << s.bytes_per_key (size)
+           << PSTORE_NATIVE_TEXT (",\"mean-lookup-ns\":") << lookup_ns
+           << PSTORE_NATIVE_TEXT (",\"node-bytes\":") << s.node_bytes ()
+           << PSTORE_NATIVE_TEXT (",\"spanning-reads\":") << s.spanning_reads ()
+           << PSTORE_NATIVE_TEXT (",\"nodes-per-depth\":[");
+        write_list (os, s.nodes_per_depth (), comma);
+        os << PSTORE_NATIVE_TEXT ("],\"leaves-per-depth\":[");
+        write_list (os, s.leaves_per_depth (), comma);
+        os << PSTORE_NATIVE_TEXT ("],\"children\":{");
+        write_histogram (os, s.children (), comma, quote, colon);
+        os << PSTORE_NATIVE_TEXT ("},\"linear-sizes\":{");
+        write_histogram (os, s.linear_sizes (), comma, quote, colon);
+        os << PSTORE_NATIVE_TEXT ("},\"bytes-per-generation\":{");
+        write_histogram (os, s.generation_bytes (), comma, quote, colon);
+        os << PSTORE_NATIVE_TEXT ("}}");
+    }
+
     template <trailer::indices Index>
-    void dump_index_stats (database const & db) {
+    void dump_index_stats (database const & db, generation_map const & generations,
+                           bool & first) {
         if (auto index = index::get_index<Index> (db, false /*create*/)) {
-            stats s{db};
+            stats s{db, generations};
             s.traverse (*index);
+            double const lookup_ns = mean_lookup_ns (db, *index);
 
-            static constexpr auto newline = PSTORE_NATIVE_TEXT ("\n");
-            static constexpr auto comma = PSTORE_NATIVE_TEXT (",");
-            command_line::out_stream << utf::to_native_string (index_name<Index>::name) << comma
-                                     << s.branching_factor () << comma << s.mean_leaf_depth ()
-                                     << comma << s.max_depth () << comma << index->size ()
-                                     << newline;
+            auto & os = command_line::out_stream;
+            switch (format.get ()) {
+            case output_format::csv:
+                write_csv (os, index_name<Index>::name, index->size (), s, lookup_ns);
+                break;
+            case output_format::json:
+                os << (first ? PSTORE_NATIVE_TEXT ("\n") : PSTORE_NATIVE_TEXT (",\n"));
+                write_json (os, index_name<Index>::name, index->size (), s, lookup_ns);
+                break;
+            }
+            first = false;
         }
     }
 
@@ -171,12 +539,22 @@ int main (int argc, char * argv[]) {
 
         database db{db_path.get (), database::access_mode::read_only};
         db.sync (static_cast<unsigned> (revision.get ()));
+        generation_map const generations{db};
 
-        command_line::out_stream << PSTORE_NATIVE_TEXT (
-            "name,branching-factor,mean-leaf-depth,max-depth,size\n");
-#define X(a) dump_index_stats<trailer::indices::a> (db);
+        auto & os = command_line::out_stream;
+        bool const json = format.get () == output_format::json;
+        if (json) {
+            os << PSTORE_NATIVE_TEXT ("[");
+        } else {
+            write_csv_header (os);
+        }
+        bool first = true;
+#define X(a) dump_index_stats<trailer::indices::a> (db, generations, first);
         PSTORE_INDICES
 #undef X
+        if (json) {
+            os << PSTORE_NATIVE_TEXT ("\n]\n");
+        }
     }
     // clang-format off
     PSTORE_CATCH (std::exception const & ex, { // clang-format on
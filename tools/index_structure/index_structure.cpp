@@ -13,13 +13,16 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "pstore/config/config.hpp"
 #include "pstore/command_line/tchar.hpp"
+#include "pstore/core/btree_set.hpp"
 #include "pstore/core/database.hpp"
 #include "pstore/core/hamt_map.hpp"
 #include "pstore/core/hamt_map_types.hpp"
@@ -31,11 +34,14 @@
 #include "switches.hpp"
 
 using pstore::database;
+using pstore::index::btree_details::node_ref;
 // Note that using these internal "details" namespace is not, in general, good practice.
 // Here it is justified because the tool's purpose is to poke about inside the index
 // internals!
 using pstore::index::details::depth_is_internal_node;
 using pstore::index::details::hash_index_bits;
+using pstore::index::details::hash_size;
+using pstore::index::details::hash_type;
 using pstore::index::details::index_pointer;
 using pstore::index::details::internal_node;
 using pstore::index::details::linear_node;
@@ -104,6 +110,19 @@ namespace {
         return this_id;
     }
 
+    template <typename KeyType, typename Compare>
+    std::string dump_leaf (pstore::database const & db,
+                           pstore::index::btree_set<KeyType, Compare> const & index,
+                           std::ostream & os, pstore::address addr) {
+        auto const this_id = "leaf" + std::to_string (addr.absolute ());
+
+        std::ostringstream key_stream;
+        key_stream << index.load_leaf_node (db, addr);
+
+        os << this_id << " [shape=record label=\"" << escape (key_stream.str ()) << "\"]\n";
+        return this_id;
+    }
+
 
     template <typename IndexType>
     std::string dump (pstore::database const & db, IndexType const & index, std::ostream & os,
@@ -142,6 +161,29 @@ namespace {
                    : dump_intermediate<linear_node> (db, index, os, node, shifts);
     }
 
+    /// Dumps a B+-tree node and its descendents. The shifts argument is unused: it is present
+    /// only so that this function has the same signature as the hamt version.
+    template <typename IndexType>
+    std::string dump (pstore::database const & db, IndexType const & index, std::ostream & os,
+                      node_ref ref, unsigned /*shifts*/) {
+        using pstore::index::btree_details::node;
+        std::shared_ptr<node const> store_ptr;
+        node const * ptr = nullptr;
+        std::tie (store_ptr, ptr) = node::get_node (db, ref);
+        PSTORE_ASSERT (ptr != nullptr);
+
+        auto const this_id = (ptr->is_leaf () ? "leaf_node" : "branch") +
+                             std::to_string (ref.to_address ().absolute ());
+        os << this_id << " [label=\"" << (ptr->is_leaf () ? "leaf" : "branch") << "\"];\n";
+        for (auto ctr = std::size_t{0}; ctr < ptr->size (); ++ctr) {
+            auto const child_id = ptr->is_leaf ()
+                                      ? dump_leaf (db, index, os, ptr->key (ctr))
+                                      : dump (db, index, os, ptr->child (ctr), 0U);
+            os << this_id << " -> " << child_id << ";\n";
+        }
+        return this_id;
+    }
+
     template <typename IndexType>
     void dump_index (pstore::database const & db, IndexType const * const index,
                      char const * name) {
@@ -150,7 +192,7 @@ namespace {
             return;
         }
 
-        if (index_pointer const root = index->root ()) {
+        if (auto const root = index->root ()) {
             auto & os = std::cout;
             os << "digraph " << name << " {\ngraph [rankdir=LR];\n";
             auto label = dump (db, *index, os, root, 0U);
@@ -161,6 +203,150 @@ namespace {
         }
     }
 
+    //*              _  __       *
+    //* __ _____ _ _(_)/ _|_  _  *
+    //* \ V / -_) '_| |  _| || | *
+    //*  \_/\___|_| |_|_|  \_, | *
+    //*                    |__/  *
+
+    /// The number of nodes of each kind visited while verifying an index and the number of
+    /// problems found.
+    struct verify_stats {
+        std::size_t internals = 0U;
+        std::size_t linears = 0U;
+        std::size_t leaves = 0U;
+        std::size_t errors = 0U;
+    };
+
+    void report (verify_stats * const stats, char const * const name, pstore::address const addr,
+                 char const * const message) {
+        std::cerr << name << ": node at " << addr.absolute () << ": " << message << '\n';
+        ++stats->errors;
+    }
+
+    template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+    hash_type leaf_hash (pstore::database const & db,
+                         pstore::index::hamt_map<KeyType, ValueType, Hash, KeyEqual> const & index,
+                         pstore::address const addr) {
+        return static_cast<hash_type> (Hash{}(index.load_leaf_node (db, addr).first));
+    }
+
+    template <typename KeyType, typename Hash, typename KeyEqual>
+    hash_type leaf_hash (pstore::database const & db,
+                         pstore::index::hamt_set<KeyType, Hash, KeyEqual> const & index,
+                         pstore::address const addr) {
+        return static_cast<hash_type> (Hash{}(index.load_leaf_node (db, addr)));
+    }
+
+    /// Returns true if the addresses of the children of \p node are all different.
+    template <typename NodeType>
+    bool children_are_distinct (NodeType const & node) {
+        std::vector<pstore::address> addrs;
+        addrs.reserve (node.size ());
+        for (auto const & child : node) {
+            addrs.push_back (index_pointer{child}.to_address ());
+        }
+        std::sort (std::begin (addrs), std::end (addrs));
+        return std::adjacent_find (std::begin (addrs), std::end (addrs)) == std::end (addrs);
+    }
+
+    /// Verifies the trie below \p node. The node was reached by following the child positions
+    /// recorded in the low \p shifts bits of \p prefix so the key of every leaf below it must
+    /// hash to a value with that prefix. Internal nodes carry no signature: a reference to
+    /// something other than an internal node is caught by this check or by the structural
+    /// checks made when the node is loaded.
+    template <typename IndexType>
+    void verify (pstore::database const & db, IndexType const & index, char const * const name,
+                 index_pointer const node, unsigned const shifts, hash_type const prefix,
+                 verify_stats * const stats) {
+        if (node.is_leaf ()) {
+            ++stats->leaves;
+            auto const mask =
+                shifts >= hash_size ? ~hash_type{0} : (hash_type{1} << shifts) - hash_type{1};
+            if ((leaf_hash (db, index, node.to_address ()) & mask) != prefix) {
+                report (stats, name, node.to_address (), "key hash does not match its position");
+            }
+            return;
+        }
+        if (!depth_is_internal_node (shifts)) {
+            ++stats->linears;
+            std::shared_ptr<void const> store_ptr;
+            linear_node const * ptr = nullptr;
+            std::tie (store_ptr, ptr) = linear_node::get_node (db, node);
+            if (!children_are_distinct (*ptr)) {
+                report (stats, name, node.to_address (), "linear node children are not distinct");
+            }
+            for (auto const & child : *ptr) {
+                index_pointer const leaf{child};
+                if (!leaf.is_leaf ()) {
+                    report (stats, name, node.to_address (), "linear node child is not a leaf");
+                    continue;
+                }
+                verify (db, index, name, leaf, shifts, prefix, stats);
+            }
+            return;
+        }
+
+        ++stats->internals;
+        std::shared_ptr<void const> store_ptr;
+        internal_node const * ptr = nullptr;
+        std::tie (store_ptr, ptr) = internal_node::get_node (db, node);
+        if (!children_are_distinct (*ptr)) {
+            report (stats, name, node.to_address (), "internal node children are not distinct");
+        }
+        hash_type const bitmap = ptr->get_bitmap ();
+        auto index_pos = std::size_t{0};
+        for (auto bit = 0U; bit < hash_size; ++bit) {
+            if ((bitmap & (hash_type{1} << bit)) != 0U) {
+                verify (db, index, name, (*ptr)[index_pos], shifts + hash_index_bits,
+                        prefix | (hash_type{bit} << shifts), stats);
+                ++index_pos;
+            }
+        }
+    }
+
+    /// Verifies a B+-tree node and its descendents. The nodes check their own structure as they
+    /// are loaded. The shifts and prefix arguments are unused: they are present only so that this
+    /// function has the same signature as the hamt version.
+    template <typename IndexType>
+    void verify (pstore::database const & db, IndexType const & index, char const * const name,
+                 node_ref const ref, unsigned /*shifts*/, hash_type /*prefix*/,
+                 verify_stats * const stats) {
+        using pstore::index::btree_details::node;
+        std::shared_ptr<node const> store_ptr;
+        node const * ptr = nullptr;
+        std::tie (store_ptr, ptr) = node::get_node (db, ref);
+        PSTORE_ASSERT (ptr != nullptr);
+        if (ptr->is_leaf ()) {
+            stats->leaves += ptr->size ();
+            return;
+        }
+        ++stats->internals;
+        for (auto ctr = std::size_t{0}; ctr < ptr->size (); ++ctr) {
+            verify (db, index, name, ptr->child (ctr), 0U, hash_type{0}, stats);
+        }
+    }
+
+    /// Verifies the structure of an index. Returns true if no problems were found.
+    template <typename IndexType>
+    bool verify_index (pstore::database const & db, IndexType const * const index,
+                       char const * const name) {
+        verify_stats stats;
+        if (index != nullptr) {
+            if (auto const root = index->root ()) {
+                verify (db, *index, name, root, 0U, hash_type{0}, &stats);
+            }
+            if (stats.leaves != index->size ()) {
+                std::cerr << name << ": found " << stats.leaves << " leaves but the index size is "
+                          << index->size () << '\n';
+                ++stats.errors;
+            }
+        }
+        std::cout << name << ": " << stats.internals << " internal, " << stats.linears
+                  << " linear, " << stats.leaves << " leaves, " << stats.errors << " errors\n";
+        return stats.errors == 0U;
+    }
+
     template <pstore::trailer::indices Index>
     struct index_name {};
 #define X(a)                                                                                       \
@@ -179,6 +365,15 @@ namespace {
         }
     }
 
+    template <pstore::trailer::indices Index>
+    bool verify_if_selected (switches const & opt, pstore::database const & db) {
+        if (!opt.test (Index)) {
+            return true;
+        }
+        auto const index = pstore::index::get_index<Index> (db, false /*create*/);
+        return verify_index (db, index.get (), index_name<Index>::name);
+    }
+
 } // end anonymous namespace
 
 
@@ -199,9 +394,19 @@ int main (int argc, char * argv[]) {
         pstore::database db (opt.db_path, pstore::database::access_mode::read_only);
         db.sync (opt.revision);
 
+        if (opt.verify) {
+            bool ok = true;
+#define X(a) ok = verify_if_selected<pstore::trailer::indices::a> (opt, db) && ok;
+            PSTORE_INDICES
+#undef X
+            if (!ok) {
+                exit_code = EXIT_FAILURE;
+            }
+        } else {
 #define X(a) dump_if_selected<pstore::trailer::indices::a> (opt, db);
-        PSTORE_INDICES
+            PSTORE_INDICES
 #undef X
+        }
     }
     // clang-format off
     PSTORE_CATCH (std::exception const & ex, { // clang-format on
@@ -36,6 +36,9 @@ namespace {
         revision ("revision", desc ("The starting revision number (or 'HEAD')"));
     alias revision2 ("r", desc ("Alias for --revision"), aliasopt (revision));
 
+    opt<bool> verify ("verify",
+                      desc ("Check the structure of the indices rather than dumping them"));
+
     opt<std::string> db_path (positional, required, usage ("repository"), desc ("Database path"));
 
 #define X(a) literal (#a, static_cast<int> (pstore::trailer::indices::a), #a),
@@ -65,6 +68,7 @@ std::pair<switches, int> get_switches (int argc, tchar * argv[]) {
     switches sw;
     sw.revision = static_cast<unsigned> (revision.get ());
     sw.db_path = db_path.get ();
+    sw.verify = verify.get ();
     for (pstore::trailer::indices idx : index_names_opt) {
         sw.selected.set (static_cast<std::underlying_type<pstore::trailer::indices>::type> (idx));
     }
@@ -29,6 +29,8 @@ struct switches {
         selected;
     unsigned revision = pstore::head_revision;
     std::string db_path;
+    /// If true, the structure of the selected indices is checked rather than dumped.
+    bool verify = false;
 
     bool test (pstore::trailer::indices idx) const {
         auto const position =
@@ -0,0 +1,126 @@
+//===- tools/json_bench/main.cpp ------------------------------------------===//
+//*                  _        *
+//*  _ __ ___   __ _(_)_ __   *
+//* | '_ ` _ \ / _` | | '_ \  *
+//* | | | | | | (_| | | | | | *
+//* |_| |_| |_|\__,_|_|_| |_| *
+//*                           *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file main.cpp
+/// \brief Measures the rate at which the JSON parser consumes a file such as the output of
+/// pstore-export.
+///
+/// The file is read into memory and parsed a number of times with callbacks which discard the
+/// parsed values. The "bulk" figure is for input passed as a contiguous range of characters,
+/// which allows the parser to consume runs of whitespace and string characters with the
+/// scanner selected for the host CPU. The "per-character" figure is for the same text passed
+/// through an iterator which is not a pointer, so that every character goes through the
+/// parser's state machine.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "pstore/command_line/command_line.hpp"
+#include "pstore/command_line/tchar.hpp"
+#include "pstore/json/dom_types.hpp"
+#include "pstore/json/json.hpp"
+#include "pstore/json/scan.hpp"
+#include "pstore/support/portab.hpp"
+
+using namespace pstore::command_line;
+
+namespace {
+
+    opt<std::string> path (positional, usage ("input"),
+                           desc ("The JSON file to be parsed (for example, from pstore-export)"),
+                           required);
+    opt<unsigned> repeat{"repeat", desc{"The number of times that the file is parsed"},
+                         init (5U)};
+    alias repeat2{"r", desc{"Alias for --repeat"}, aliasopt{repeat}};
+
+    /// Returns the name of the best scanner instruction set supported by the host.
+    char const * scanner_name () noexcept {
+        using pstore::json::details::scan_isa;
+        using pstore::json::details::scan_isa_available;
+        if (scan_isa_available (scan_isa::avx2)) {
+            return "avx2";
+        }
+        if (scan_isa_available (scan_isa::sse2)) {
+            return "sse2";
+        }
+        return "portable";
+    }
+
+    /// Parses [first, last) repeat times and returns the best rate in MB/s.
+    template <typename Iterator>
+    double run (Iterator const first, Iterator const last) {
+        auto const bytes = static_cast<double> (std::distance (first, last));
+        double best = 0.0;
+        for (auto ctr = 0U; ctr < std::max (repeat.get (), 1U); ++ctr) {
+            auto const start = std::chrono::steady_clock::now ();
+            // Enable the extensions used by pstore-import: the export file includes comments.
+            auto parser = pstore::json::make_parser (pstore::json::null_output{},
+                                                     pstore::json::extensions::all);
+            parser.input (first, last).eof ();
+            std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now () - start;
+            if (parser.has_error ()) {
+                pstore::json::coord const pos = parser.coordinate ();
+                std::cerr << "Parse error: " << parser.last_error ().message () << " (Line "
+                          << pos.row << ", column " << pos.column << ")\n";
+                std::exit (EXIT_FAILURE);
+            }
+            best = std::max (best, bytes / elapsed.count () / 1.0e6);
+        }
+        return best;
+    }
+
+} // end anonymous namespace
+
+#if defined(_WIN32)
+int _tmain (int argc, TCHAR * argv[]) {
+#else
+int main (int argc, char * argv[]) {
+#endif
+    int exit_code = EXIT_SUCCESS;
+    PSTORE_TRY {
+        parse_command_line_options (argc, argv, "Benchmarks the pstore JSON parser");
+
+        std::ifstream in{path.get (), std::ios::binary};
+        std::vector<char> const text{std::istreambuf_iterator<char>{in},
+                                     std::istreambuf_iterator<char>{}};
+        if (!in.is_open () || in.bad ()) {
+            std::cerr << "Could not read " << path.get () << '\n';
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "input: " << text.size () << " bytes\n";
+        char const * const data = text.data ();
+        std::cout << "bulk (" << scanner_name () << "): " << run (data, data + text.size ())
+                  << " MB/s\n";
+        std::cout << "per-character: " << run (text.begin (), text.end ()) << " MB/s\n";
+    }
+    // clang-format off
+    PSTORE_CATCH (std::exception const & ex, { // clang-format on
+        std::cerr << "Error: " << ex.what () << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    // clang-format off
+    PSTORE_CATCH (..., { // clang-format on
+        std::cerr << "Unknown error." << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    return exit_code;
+}
@@ -0,0 +1,117 @@
+//===- tools/log_bench/main.cpp -------------------------------------------===//
+//*                  _        *
+//*  _ __ ___   __ _(_)_ __   *
+//* | '_ ` _ \ / _` | | '_ \  *
+//* | | | | | | (_| | | | | | *
+//* |_| |_| |_|\__,_|_|_| |_| *
+//*                           *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file main.cpp
+/// \brief Measures the rate at which threads can log messages, with and without async_logger.
+///
+/// Each of a number of threads logs a fixed number of messages to a logger which discards them.
+/// The "sync" figure is for a basic_logger, which serializes all of the threads on a single
+/// mutex; the "async" figure is for the same logger wrapped in an async_logger. The async rate
+/// counts only the time spent by the logging threads: messages which did not fit in a thread's
+/// ring are reported as dropped.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pstore/command_line/command_line.hpp"
+#include "pstore/command_line/tchar.hpp"
+#include "pstore/os/async_log.hpp"
+#include "pstore/support/portab.hpp"
+
+using namespace pstore::command_line;
+
+namespace {
+
+    opt<unsigned> threads{"threads", desc{"The number of logging threads"}, init (4U)};
+    alias threads2{"t", desc{"Alias for --threads"}, aliasopt{threads}};
+    opt<unsigned> messages{"messages", desc{"The number of messages logged by each thread"},
+                           init (100000U)};
+    alias messages2{"m", desc{"Alias for --messages"}, aliasopt{messages}};
+
+    //*           _ _   _                         *
+    //*  _ _ _  _| | | | |___  __ _ __ _ ___ _ _  *
+    //* | ' \ || | | | | / _ \/ _` / _` / -_) '_| *
+    //* |_||_\_,_|_|_| |_\___/\__, \__, \___|_|   *
+    //*                       |___/|___/          *
+    /// A logger which formats its messages and then discards them.
+    class null_logger final : public pstore::basic_logger {
+    private:
+        void log_impl (std::string const & message) override { bytes_ += message.size (); }
+        std::size_t bytes_ = 0;
+    };
+
+    /// Logs messages to \p l from each of \p num_threads threads and returns the number of log
+    /// calls per second.
+    double run (pstore::logger & l, unsigned const num_threads) {
+        auto const start = std::chrono::steady_clock::now ();
+        std::vector<std::thread> workers;
+        workers.reserve (num_threads);
+        for (auto t = 0U; t < num_threads; ++t) {
+            workers.emplace_back ([&l] () {
+                for (auto m = 0U; m < messages.get (); ++m) {
+                    l.log (pstore::logger::priority::info, "message number ", m);
+                }
+            });
+        }
+        for (std::thread & t : workers) {
+            t.join ();
+        }
+        std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now () - start;
+        return static_cast<double> (num_threads) * static_cast<double> (messages.get ()) /
+               elapsed.count ();
+    }
+
+} // end anonymous namespace
+
+#if defined(_WIN32)
+int _tmain (int argc, TCHAR * argv[]) {
+#else
+int main (int argc, char * argv[]) {
+#endif
+    int exit_code = EXIT_SUCCESS;
+    PSTORE_TRY {
+        parse_command_line_options (argc, argv, "Benchmarks the pstore loggers");
+        unsigned const num_threads = std::max (threads.get (), 1U);
+
+        {
+            null_logger sync;
+            std::cout << "sync: " << run (sync, num_threads) << " calls/s\n";
+        }
+        {
+            pstore::async_logger async{std::make_unique<null_logger> ()};
+            auto const dropped_before = pstore::async_log_dropped ();
+            double const rate = run (async, num_threads);
+            pstore::flush_async_log ();
+            std::cout << "async: " << rate << " calls/s ("
+                      << pstore::async_log_dropped () - dropped_before << " dropped)\n";
+        }
+    }
+    // clang-format off
+    PSTORE_CATCH (std::exception const & ex, { // clang-format on
+        std::cerr << "Error: " << ex.what () << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    // clang-format off
+    PSTORE_CATCH (..., { // clang-format on
+        std::cerr << "Unknown error." << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    return exit_code;
+}
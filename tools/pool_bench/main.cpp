@@ -0,0 +1,152 @@
+//===- tools/pool_bench/main.cpp ------------------------------------------===//
+//*                  _        *
+//*  _ __ ___   __ _(_)_ __   *
+//* | '_ ` _ \ / _` | | '_ \  *
+//* | | | | | | (_| | | | | | *
+//* |_| |_| |_|\__,_|_|_| |_| *
+//*                           *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file main.cpp
+/// \brief Measures parallel_for_each() on uniform and skewed workloads.
+///
+/// Each element of the range stands for a unit of work lasting a given number of microseconds.
+/// In the skewed workload the first few elements cost many times more than the rest. The
+/// "even split" figure is for the range being divided into one equal slice per thread, each
+/// processed by a fresh std::async thread (which is how parallel_for_each() used to work); the
+/// "pool" figure is for parallel_for_each() running on a thread_pool. By default the work is a
+/// sleep so that the results are meaningful on a machine with fewer cores than threads; --spin
+/// makes it a busy-wait instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "pstore/command_line/command_line.hpp"
+#include "pstore/command_line/tchar.hpp"
+#include "pstore/support/parallel_for_each.hpp"
+#include "pstore/support/portab.hpp"
+#include "pstore/support/thread_pool.hpp"
+
+using namespace pstore::command_line;
+
+namespace {
+
+    opt<unsigned> threads{"threads", desc{"The number of threads which share the work"},
+                          init (4U)};
+    alias threads2{"t", desc{"Alias for --threads"}, aliasopt{threads}};
+    opt<unsigned> items{"items", desc{"The number of elements in the range"}, init (2000U)};
+    alias items2{"n", desc{"Alias for --items"}, aliasopt{items}};
+    opt<unsigned> heavy{"heavy", desc{"The number of expensive elements at the start of the range"},
+                        init (40U)};
+    opt<unsigned> skew{"skew", desc{"The cost of an expensive element relative to the others"},
+                       init (100U)};
+    opt<unsigned> work{"work", desc{"The cost of an ordinary element in microseconds"},
+                       init (200U)};
+    opt<bool> spin{"spin", desc{"Busy-wait rather than sleep for the cost of each element"}};
+
+    /// Occupies the calling thread for \p cost.
+    void do_work (std::chrono::microseconds const cost) {
+        if (!spin.get ()) {
+            std::this_thread::sleep_for (cost);
+            return;
+        }
+        auto const end = std::chrono::steady_clock::now () + cost;
+        while (std::chrono::steady_clock::now () < end) {
+        }
+    }
+
+    /// Calls \p fn for each element of [\p first, \p last) by dividing the range into
+    /// \p num_threads equal slices, each of which is processed by its own std::async thread.
+    template <typename InputIt, typename UnaryFunction>
+    void even_split_for_each (unsigned const num_threads, InputIt first, InputIt last,
+                              UnaryFunction fn) {
+        auto const size = static_cast<std::size_t> (std::distance (first, last));
+        auto const slice = (size + num_threads - 1U) / num_threads;
+        std::vector<std::future<void>> futures;
+        futures.reserve (num_threads);
+        for (auto base = std::size_t{0}; base < size; base += slice) {
+            auto const begin = first + static_cast<std::ptrdiff_t> (base);
+            auto const end = first + static_cast<std::ptrdiff_t> (std::min (base + slice, size));
+            futures.emplace_back (std::async (std::launch::async, [begin, end, &fn] () {
+                std::for_each (begin, end, fn);
+            }));
+        }
+        for (std::future<void> & f : futures) {
+            f.get ();
+        }
+    }
+
+    /// Returns the time in milliseconds taken by \p f.
+    template <typename Function>
+    double time_ms (Function f) {
+        auto const start = std::chrono::steady_clock::now ();
+        f ();
+        return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start)
+            .count ();
+    }
+
+    /// Reports the time taken by each strategy to process elements with the costs given by
+    /// \p costs.
+    void run (char const * const name, std::vector<std::chrono::microseconds> const & costs,
+              unsigned const num_threads, pstore::thread_pool & pool) {
+        auto const total =
+            std::accumulate (std::begin (costs), std::end (costs), std::chrono::microseconds{0});
+        auto const ideal = std::chrono::duration<double, std::milli> (total).count () /
+                           static_cast<double> (num_threads);
+        double const even = time_ms ([&] () {
+            even_split_for_each (num_threads, std::begin (costs), std::end (costs), do_work);
+        });
+        double const pooled = time_ms ([&] () {
+            pstore::parallel_for_each (pool, std::begin (costs), std::end (costs), do_work);
+        });
+        std::cout << name << ": even split " << even << " ms, pool " << pooled << " ms (ideal "
+                  << ideal << " ms)\n";
+    }
+
+} // end anonymous namespace
+
+#if defined(_WIN32)
+int _tmain (int argc, TCHAR * argv[]) {
+#else
+int main (int argc, char * argv[]) {
+#endif
+    int exit_code = EXIT_SUCCESS;
+    PSTORE_TRY {
+        parse_command_line_options (argc, argv,
+                                    "Benchmarks parallel_for_each on uniform and skewed work");
+        unsigned const num_threads = std::max (threads.get (), 1U);
+        // The calling thread takes part in parallel_for_each() alongside the pool's workers.
+        pstore::thread_pool pool{std::max (num_threads, 2U) - 1U};
+
+        std::chrono::microseconds const cost{work.get ()};
+        std::vector<std::chrono::microseconds> costs (items.get (), cost);
+        run ("uniform", costs, num_threads, pool);
+
+        std::fill_n (std::begin (costs), std::min (heavy.get (), items.get ()),
+                     cost * skew.get ());
+        run ("skewed", costs, num_threads, pool);
+    }
+    // clang-format off
+    PSTORE_CATCH (std::exception const & ex, { // clang-format on
+        std::cerr << "Error: " << ex.what () << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    // clang-format off
+    PSTORE_CATCH (..., { // clang-format on
+        std::cerr << "Unknown error." << std::endl;
+        exit_code = EXIT_FAILURE;
+    })
+    return exit_code;
+}
@@ -77,6 +77,7 @@ int main (int argc, char * argv[]) {
     using priority = pstore::logger::priority;
     PSTORE_TRY {
         pstore::threads::set_name ("main");
+        pstore::set_async_logging (true);
         pstore::create_log_stream ("vacuumd");
 
         vacuum::user_options user_opt;
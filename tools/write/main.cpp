@@ -128,6 +128,8 @@ int main (int argc, char * argv[]) {
             // Read the write and name indexes.
             std::shared_ptr<pstore::index::name_index> const name =
                 pstore::index::get_index<pstore::trailer::indices::name> (database);
+            std::shared_ptr<pstore::index::ordered_name_index> const ordered_name =
+                pstore::index::get_index<pstore::trailer::indices::ordered_name> (database);
             std::shared_ptr<pstore::index::write_index> const write =
                 pstore::index::get_index<pstore::trailer::indices::write> (database);
 
@@ -154,7 +156,7 @@ int main (int argc, char * argv[]) {
             for (std::string const & str : opt.strings) {
                 strings.emplace_back (pstore::make_sstring_view (str));
                 auto & s = strings.back ();
-                adder.add (transaction, name, &s);
+                adder.add (transaction, name, ordered_name, &s);
             }
             adder.flush (transaction);
 
@@ -0,0 +1,117 @@
+//===- unittests/brokerface/test_writer.cpp -------------------------------===//
+//*                _ _             *
+//* __      ___ __(_) |_ ___ _ __  *
+//* \ \ /\ / / '__| | __/ _ \ '__| *
+//*  \ V  V /| |  | | ||  __/ |    *
+//*   \_/\_/ |_|  |_|\__\___|_|    *
+//*                                *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/brokerface/writer.hpp"
+
+#ifndef _WIN32
+
+#    include <string>
+#    include <vector>
+
+#    include <sys/socket.h>
+#    include <unistd.h>
+
+#    include <gtest/gtest.h>
+
+#    include "pstore/brokerface/message_type.hpp"
+#    include "pstore/brokerface/send_message.hpp"
+#    include "pstore/os/file.hpp"
+
+using pstore::brokerface::fifo_path;
+using pstore::brokerface::message_type;
+using pstore::brokerface::transport;
+using pstore::brokerface::writer;
+
+namespace {
+
+    class BrokerSocketWriter : public ::testing::Test {
+    public:
+        BrokerSocketWriter ()
+                : path_{pstore::file::file_handle::get_temporary_directory () +
+                        "/pstore-writer-test-" + std::to_string (::getpid ()) + ".sock"}
+                , fifo_{path_.c_str (), transport::socket, fifo_path::duration_type{10}, 10U} {}
+
+    protected:
+        /// Accepts the connection made by a writer and returns the records that it sent.
+        std::vector<std::vector<message_type>> receive (fifo_path::server_pipe const & listener,
+                                                        std::size_t num_records);
+
+        std::string const path_;
+        fifo_path fifo_;
+    };
+
+    auto BrokerSocketWriter::receive (fifo_path::server_pipe const & listener,
+                                      std::size_t const num_records)
+        -> std::vector<std::vector<message_type>> {
+        pstore::socket_descriptor const conn{
+            ::accept (listener.native_handle (), nullptr, nullptr)};
+        EXPECT_TRUE (conn.valid ());
+
+        std::vector<std::vector<message_type>> result;
+        std::vector<std::uint8_t> buffer ((writer::max_batch + 1U) * sizeof (message_type));
+        for (auto ctr = std::size_t{0}; ctr < num_records; ++ctr) {
+            ssize_t const size = ::recv (conn.native_handle (), buffer.data (), buffer.size (), 0);
+            EXPECT_GT (size, 0);
+            EXPECT_EQ (static_cast<std::size_t> (size) % sizeof (message_type), 0U);
+            auto const * const first = reinterpret_cast<message_type const *> (buffer.data ());
+            auto const count = static_cast<std::size_t> (size) / sizeof (message_type);
+            result.emplace_back (first, first + count);
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+TEST_F (BrokerSocketWriter, PartsOfAMessageArriveTogether) {
+    auto const listener = fifo_.open_server_pipe ();
+    writer wr{fifo_};
+
+    // A payload which needs three message parts.
+    std::string const path (message_type::payload_chars * 2U, 'p');
+    auto const mid = pstore::brokerface::next_message_id ();
+    pstore::brokerface::send_message (wr, true /*error on timeout*/, "ECHO", path.c_str ());
+
+    auto const records = this->receive (listener, 1U);
+    ASSERT_EQ (records.size (), 1U);
+    std::vector<message_type> const & parts = records.front ();
+    ASSERT_EQ (parts.size (), 3U);
+    for (auto part = std::uint16_t{0}; part < 3U; ++part) {
+        EXPECT_EQ (parts[part].message_id, mid);
+        EXPECT_EQ (parts[part].part_no, part);
+        EXPECT_EQ (parts[part].num_parts, 3U);
+    }
+}
+
+TEST_F (BrokerSocketWriter, LargeBatchIsSplit) {
+    auto const listener = fifo_.open_server_pipe ();
+    writer wr{fifo_};
+
+    constexpr auto num_messages = writer::max_batch + 3U;
+    std::vector<message_type> messages;
+    messages.reserve (num_messages);
+    for (auto ctr = std::uint32_t{0}; ctr < num_messages; ++ctr) {
+        messages.emplace_back (ctr, 0, 1, std::to_string (ctr));
+    }
+    wr.write (pstore::gsl::make_span (messages), true /*error on timeout*/);
+
+    auto const records = this->receive (listener, 2U);
+    ASSERT_EQ (records.size (), 2U);
+    EXPECT_EQ (records[0].size (), writer::max_batch);
+    EXPECT_EQ (records[1].size (), 3U);
+    EXPECT_EQ (records[0].front (), messages.front ());
+    EXPECT_EQ (records[1].back (), messages.back ());
+}
+
+#endif // _WIN32
@@ -0,0 +1,246 @@
+//===- unittests/core/test_btree_map.cpp ----------------------------------===//
+//*  _     _                                          *
+//* | |__ | |_ _ __ ___  ___   _ __ ___   __ _ _ __   *
+//* | '_ \| __| '__/ _ \/ _ \ | '_ ` _ \ / _` | '_ \  *
+//* | |_) | |_| | |  __/  __/ | | | | | | (_| | |_) | *
+//* |_.__/ \__|_|  \___|\___| |_| |_| |_|\__,_| .__/  *
+//*                                           |_|     *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/core/btree_map.hpp"
+
+// Standard library includes
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+// pstore includes
+#include "pstore/core/btree_set.hpp"
+#include "pstore/core/index_types.hpp"
+#include "pstore/core/transaction.hpp"
+
+// local includes
+#include "empty_store.hpp"
+
+namespace {
+
+    class BTreeMapFixture : public testing::Test {
+    public:
+        BTreeMapFixture ()
+                : db_{store_.file ()} {}
+
+        using lock_guard = std::unique_lock<mock_mutex>;
+        using transaction_type = pstore::transaction<lock_guard>;
+        using map = pstore::index::btree_map<std::string, int>;
+
+    protected:
+        /// Returns a key for value \p v such that the keys sort in the same order as the values.
+        static std::string key (int v) {
+            std::ostringstream os;
+            os << "key" << std::setw (5) << std::setfill ('0') << v;
+            return os.str ();
+        }
+
+        /// Inserts \p count values into \p m in an order which is neither ascending nor
+        /// descending so that nodes are split at a variety of positions.
+        void insert_many (transaction_type & t, map & m, int count) {
+            for (auto ctr = 0; ctr < count; ++ctr) {
+                int const v = (ctr * 7919) % count;
+                m.insert (t, std::make_pair (key (v), v));
+            }
+        }
+
+        static std::vector<int> values (pstore::database const & db, map const & m) {
+            std::vector<int> result;
+            for (auto const & kvp : m.make_range (db)) {
+                result.push_back (kvp.second);
+            }
+            return result;
+        }
+
+        static std::vector<int> iota (int first, int last) {
+            std::vector<int> result;
+            for (; first < last; ++first) {
+                result.push_back (first);
+            }
+            return result;
+        }
+
+        mock_mutex mutex_;
+        in_memory_store store_;
+        pstore::database db_;
+    };
+
+} // end anonymous namespace
+
+TEST_F (BTreeMapFixture, Empty) {
+    map m{db_};
+    EXPECT_TRUE (m.empty ());
+    EXPECT_EQ (m.size (), 0U);
+    EXPECT_EQ (m.begin (db_), m.end (db_));
+    EXPECT_EQ (m.find (db_, key (1)), m.end (db_));
+    EXPECT_EQ (m.lower_bound (db_, key (1)), m.end (db_));
+}
+
+TEST_F (BTreeMapFixture, InsertAndFind) {
+    constexpr auto count = 1000;
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    map m{db_};
+    this->insert_many (t1, m, count);
+    EXPECT_EQ (m.size (), std::size_t{count});
+
+    auto const res = m.insert (t1, std::make_pair (key (3), 42));
+    EXPECT_FALSE (res.second);
+    EXPECT_EQ (res.first->second, 3);
+    EXPECT_EQ (m.size (), std::size_t{count});
+
+    for (auto ctr = 0; ctr < count; ++ctr) {
+        auto const pos = m.find (db_, key (ctr));
+        ASSERT_NE (pos, m.end (db_));
+        EXPECT_EQ (pos->first, key (ctr));
+        EXPECT_EQ (pos->second, ctr);
+    }
+    EXPECT_EQ (m.find (db_, std::string{"key"}), m.end (db_));
+    EXPECT_EQ (m.find (db_, std::string{"kez"}), m.end (db_));
+}
+
+TEST_F (BTreeMapFixture, IterationIsOrdered) {
+    constexpr auto count = 1000;
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    map m{db_};
+    this->insert_many (t1, m, count);
+    EXPECT_THAT (values (db_, m), ::testing::ContainerEq (iota (0, count)));
+}
+
+TEST_F (BTreeMapFixture, LowerAndUpperBound) {
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    map m{db_};
+    for (auto ctr = 0; ctr < 500; ++ctr) {
+        m.insert (t1, std::make_pair (key (ctr * 2), ctr * 2));
+    }
+
+    EXPECT_EQ (m.lower_bound (db_, key (10))->second, 10);
+    EXPECT_EQ (m.lower_bound (db_, key (11))->second, 12);
+    EXPECT_EQ (m.upper_bound (db_, key (10))->second, 12);
+    EXPECT_EQ (m.upper_bound (db_, key (11))->second, 12);
+    EXPECT_EQ (m.lower_bound (db_, std::string{"a"})->second, 0);
+    EXPECT_EQ (m.lower_bound (db_, key (998))->second, 998);
+    EXPECT_EQ (m.lower_bound (db_, key (999)), m.end (db_));
+    EXPECT_EQ (m.upper_bound (db_, key (998)), m.end (db_));
+}
+
+TEST_F (BTreeMapFixture, PrefixRange) {
+    constexpr auto count = 1000;
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    map m{db_};
+    this->insert_many (t1, m, count);
+
+    // Visit all of the keys which start with "key004".
+    std::string const prefix = "key004";
+    std::vector<int> actual;
+    for (auto it = m.lower_bound (db_, prefix), end = m.end (db_);
+         it != end && it->first.compare (0, prefix.length (), prefix) == 0; ++it) {
+        actual.push_back (it->second);
+    }
+    EXPECT_THAT (actual, ::testing::ContainerEq (iota (400, 500)));
+}
+
+TEST_F (BTreeMapFixture, FlushAndReload) {
+    constexpr auto count = 1000;
+    pstore::typed_address<pstore::index::header_block> header;
+    {
+        transaction_type t1 = begin (db_, lock_guard{mutex_});
+        map m{db_};
+        this->insert_many (t1, m, count / 2);
+        header = m.flush (t1, db_.get_current_revision ());
+        EXPECT_TRUE (m.root ().is_address ());
+        t1.commit ();
+    }
+    {
+        // Extend the index loaded from the store.
+        transaction_type t2 = begin (db_, lock_guard{mutex_});
+        map m{db_, header};
+        EXPECT_EQ (m.size (), std::size_t{count / 2});
+        for (auto ctr = count / 2; ctr < count; ++ctr) {
+            m.insert (t2, std::make_pair (key (ctr), ctr));
+        }
+        header = m.flush (t2, db_.get_current_revision ());
+        t2.commit ();
+    }
+    map const m{db_, header};
+    EXPECT_EQ (m.size (), std::size_t{count});
+    EXPECT_THAT (values (db_, m), ::testing::ContainerEq (iota (0, count)));
+    EXPECT_EQ (m.lower_bound (db_, key (500))->second, 500);
+}
+
+TEST_F (BTreeMapFixture, InsertOrAssign) {
+    constexpr auto count = 300;
+    pstore::typed_address<pstore::index::header_block> header;
+    {
+        transaction_type t1 = begin (db_, lock_guard{mutex_});
+        map m{db_};
+        this->insert_many (t1, m, count);
+        header = m.flush (t1, db_.get_current_revision ());
+        t1.commit ();
+    }
+    transaction_type t2 = begin (db_, lock_guard{mutex_});
+    map m{db_, header};
+    // Replacing the first element changes the address of the smallest record in each node on
+    // the left edge of the tree.
+    for (auto const v : {0, 150, count - 1}) {
+        auto const res = m.insert_or_assign (t2, key (v), v + 1000);
+        EXPECT_FALSE (res.second);
+        EXPECT_EQ (res.first->second, v + 1000);
+    }
+    EXPECT_EQ (m.size (), std::size_t{count});
+    EXPECT_EQ (m.begin (db_)->second, 1000);
+    EXPECT_EQ (m.find (db_, key (150))->second, 1150);
+    EXPECT_EQ (m.find (db_, key (1))->second, 1);
+    EXPECT_EQ (m.lower_bound (db_, key (0))->second, 1000);
+}
+
+TEST_F (BTreeMapFixture, OrderedNameIndex) {
+    std::vector<std::string> const names{"pear", "apple", "banana", "apricot", "cherry", "avocado"};
+    {
+        transaction_type t1 = begin (db_, lock_guard{mutex_});
+        auto const index =
+            pstore::index::get_index<pstore::trailer::indices::ordered_name> (db_, true);
+        std::vector<pstore::raw_sstring_view> views;
+        views.reserve (names.size ());
+        pstore::indirect_string_adder adder;
+        for (std::string const & n : names) {
+            views.emplace_back (pstore::make_sstring_view (n));
+            adder.add (t1, index, &views.back ());
+        }
+        adder.flush (t1);
+        t1.commit ();
+    }
+
+    auto const index =
+        pstore::index::get_index<pstore::trailer::indices::ordered_name> (db_, false);
+    ASSERT_NE (index, nullptr);
+    EXPECT_EQ (index->size (), names.size ());
+
+    // Find the names which start with "a".
+    auto const prefix = pstore::make_sstring_view ("a");
+    std::vector<std::string> actual;
+    for (auto it = index->lower_bound (db_, pstore::indirect_string{db_, &prefix}),
+              end = index->end (db_);
+         it != end; ++it) {
+        std::string const s = it->to_string ();
+        if (s.compare (0, 1, "a") != 0) {
+            break;
+        }
+        actual.push_back (s);
+    }
+    EXPECT_THAT (actual, ::testing::ElementsAre ("apple", "apricot", "avocado"));
+}
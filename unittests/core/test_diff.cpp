@@ -25,6 +25,7 @@
 
 // pstore includes
 #include "pstore/core/index_types.hpp"
+#include "pstore/core/snapshot.hpp"
 
 // Local includes
 #include "empty_store.hpp"
@@ -194,3 +195,61 @@ TEST_F (Diff, UncomittedTransaction) {
 
     t2.commit ();
 }
+
+TEST_F (Diff, Removed) {
+    using ::testing::UnorderedElementsAreArray;
+
+    constexpr auto num_keys = 100U;
+    auto const key = [] (unsigned const ctr) { return "key" + std::to_string (ctr); };
+    {
+        transaction_type t1 = begin (db_, lock_guard{mutex_});
+        for (auto ctr = 0U; ctr < num_keys; ++ctr) {
+            this->add (t1, key (ctr), "first value");
+        }
+        t1.commit ();
+    }
+
+    std::vector<std::string> expected;
+    {
+        // Erase some keys, replace the values of others, and add some new ones.
+        transaction_type t2 = begin (db_, lock_guard{mutex_});
+        auto const index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+        for (auto ctr = 0U; ctr < num_keys; ctr += 7U) {
+            expected.push_back (key (ctr));
+            ASSERT_EQ (index->erase (t2, expected.back ()), 1U);
+        }
+        for (auto ctr = 1U; ctr < num_keys; ctr += 9U) {
+            if (ctr % 7U != 0U) {
+                this->add (t2, key (ctr), "second value");
+            }
+        }
+        for (auto ctr = num_keys; ctr < num_keys + 10U; ++ctr) {
+            this->add (t2, key (ctr), "second value");
+        }
+        t2.commit ();
+    }
+    ASSERT_EQ (2U, db_.get_current_revision ());
+
+    auto const index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+    pstore::snapshot const r1{db_, 1U};
+    auto const old_index = pstore::index::get_index<pstore::trailer::indices::write> (r1);
+    ASSERT_NE (old_index, nullptr);
+
+    std::vector<pstore::address> actual;
+    pstore::diff_removed (db_, *index, *old_index, std::back_inserter (actual));
+    std::vector<std::string> actual_keys;
+    for (auto const & kvp :
+         addresses_to_values (db_, *old_index, std::begin (actual), std::end (actual))) {
+        actual_keys.push_back (kvp.first);
+    }
+    EXPECT_THAT (actual_keys, UnorderedElementsAreArray (expected));
+
+    // Nothing was removed between r0 and r1 or between a revision and itself.
+    actual.clear ();
+    pstore::diff_removed (db_, *old_index, *old_index, std::back_inserter (actual));
+    pstore::diff_removed (db_, *old_index,
+                          *pstore::index::get_index<pstore::trailer::indices::write> (
+                              pstore::snapshot{db_, 0U}),
+                          std::back_inserter (actual));
+    EXPECT_EQ (actual.size (), 0U);
+}
@@ -16,8 +16,11 @@
 #include "pstore/core/hamt_map.hpp"
 
 // Standard library includes
-#include <random>
+#include <functional>
 #include <list>
+#include <mutex>
+#include <random>
+#include <vector>
 
 // 3rd party includes
 #include <gtest/gtest.h>
@@ -73,9 +76,37 @@ TEST_F (IndexFixture, InitAddress) {
 
 // Test initial pointer index pointer.
 TEST_F (IndexFixture, InternalSizeBytes) {
-    EXPECT_EQ (24U, internal_node::size_bytes (1));
-    EXPECT_EQ (32U, internal_node::size_bytes (2));
-    EXPECT_EQ (528U, internal_node::size_bytes (64));
+    EXPECT_EQ (16U, internal_node::size_bytes (1));
+    EXPECT_EQ (24U, internal_node::size_bytes (2));
+    EXPECT_EQ (64U, internal_node::size_bytes (7));
+    EXPECT_EQ (520U, internal_node::size_bytes (64));
+}
+
+// Test the arena from which in-heap linear nodes are allocated.
+TEST (NodeArena, Allocate) {
+    using pstore::index::details::node_arena;
+    node_arena arena;
+    EXPECT_EQ (arena.chunks (), 0U);
+
+    auto * const a = static_cast<std::uint8_t *> (arena.allocate (3U, 1U));
+    auto * const b = static_cast<std::uint8_t *> (arena.allocate (16U, 8U));
+    EXPECT_EQ (reinterpret_cast<std::uintptr_t> (b) % 8U, 0U);
+    EXPECT_EQ (b, a + 8) << "Successive allocations should come from the same chunk";
+    EXPECT_EQ (arena.chunks (), 1U);
+
+    // A large request is given a chunk of its own and does not disturb the current chunk.
+    arena.allocate (node_arena::chunk_size, 8U);
+    EXPECT_EQ (arena.chunks (), 2U);
+    EXPECT_EQ (static_cast<std::uint8_t *> (arena.allocate (8U, 8U)), b + 16);
+
+    // Exhaust the current chunk.
+    for (auto ctr = std::size_t{0}; ctr < node_arena::chunk_size / 16U; ++ctr) {
+        arena.allocate (16U, 8U);
+    }
+    EXPECT_EQ (arena.chunks (), 3U);
+
+    arena.clear ();
+    EXPECT_EQ (arena.chunks (), 0U);
 }
 
 namespace {
@@ -279,6 +310,232 @@ namespace {
 
 } // end anonymous namespace
 
+// test find_many: the results match those of find() for keys both present and absent, for both
+// heap and store nodes.
+TEST_F (DefaultIndexFixture, FindMany) {
+    constexpr auto num_keys = 200U;
+    std::vector<std::string> keys;
+    for (auto ctr = 0U; ctr < num_keys * 3U / 2U; ++ctr) {
+        keys.emplace_back ("key " + std::to_string (ctr));
+    }
+    std::shuffle (std::begin (keys), std::end (keys), std::mt19937{});
+
+    auto const check = [this, &keys] () {
+        std::vector<default_index::const_iterator> actual;
+        index_->find_many (db_, keys, std::back_inserter (actual));
+        ASSERT_EQ (actual.size (), keys.size ());
+        auto const end = index_->cend (db_);
+        for (auto ctr = std::size_t{0}; ctr < keys.size (); ++ctr) {
+            auto const expected = index_->find (db_, keys[ctr]);
+            ASSERT_EQ (actual[ctr] == end, expected == end) << "key: " << keys[ctr];
+            if (expected != end) {
+                EXPECT_EQ (actual[ctr]->first, keys[ctr]);
+                EXPECT_EQ (actual[ctr]->second, expected->second);
+            }
+        }
+    };
+
+    // An empty index.
+    check ();
+
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    for (auto ctr = 0U; ctr < num_keys; ++ctr) {
+        index_->insert (t1, std::make_pair ("key " + std::to_string (ctr), std::to_string (ctr)));
+    }
+    check ();
+    index_->flush (t1, db_.get_current_revision ());
+    check ();
+}
+
+// test partition: the ranges are disjoint and, in order, cover the whole index.
+TEST_F (DefaultIndexFixture, Partition) {
+    EXPECT_TRUE (index_->partition (db_, 4U).empty ());
+
+    auto const check = [this] () {
+        std::vector<std::string> expected;
+        for (auto const & kvp : index_->make_range (db_)) {
+            expected.push_back (kvp.first);
+        }
+        for (auto const max_parts : {std::size_t{1}, std::size_t{2}, std::size_t{7},
+                                     std::size_t{64}, std::size_t{1000}}) {
+            auto const parts = index_->partition (db_, max_parts);
+            EXPECT_GE (parts.size (), std::size_t{1});
+            EXPECT_LE (parts.size (), max_parts);
+            std::vector<std::string> actual;
+            for (auto const & part : parts) {
+                EXPECT_NE (part.begin (), part.end ());
+                for (auto const & kvp : part) {
+                    actual.push_back (kvp.first);
+                }
+            }
+            EXPECT_EQ (actual, expected) << "max_parts: " << max_parts;
+        }
+    };
+
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    index_->insert (t1, std::make_pair ("key"s, "value"s));
+    check ();
+    for (auto ctr = 0U; ctr < 500U; ++ctr) {
+        index_->insert (t1, std::make_pair ("key " + std::to_string (ctr), std::to_string (ctr)));
+    }
+    check ();
+    index_->flush (t1, db_.get_current_revision ());
+    check ();
+}
+
+// test parallel_for_each: visits every element exactly once.
+TEST_F (DefaultIndexFixture, ParallelForEach) {
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    std::vector<std::string> expected;
+    for (auto ctr = 0U; ctr < 300U; ++ctr) {
+        expected.push_back ("key " + std::to_string (ctr));
+        index_->insert (t1, std::make_pair (expected.back (), std::to_string (ctr)));
+    }
+    index_->flush (t1, db_.get_current_revision ());
+
+    std::mutex mut;
+    std::vector<std::string> actual;
+    pstore::index::parallel_for_each (db_, *index_,
+                                      [&mut, &actual] (default_index::value_type const & kvp) {
+                                          std::lock_guard<std::mutex> const lock{mut};
+                                          actual.push_back (kvp.first);
+                                      });
+    std::sort (std::begin (expected), std::end (expected));
+    std::sort (std::begin (actual), std::end (actual));
+    EXPECT_EQ (actual, expected);
+}
+
+// test flush: an in-store internal node spans no more cache lines than its size requires.
+TEST_F (DefaultIndexFixture, InternalNodesAreCacheLineAware) {
+    using pstore::index::details::cache_line_size;
+    using pstore::index::details::index_pointer;
+
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    for (auto ctr = 0U; ctr < 300U; ++ctr) {
+        // Interleave the allocations of the index leaves with data of an awkward size so that
+        // the nodes do not naturally fall on cache line boundaries.
+        t1.allocate (ctr % 13U * 8U + 8U, 8U);
+        index_->insert (t1, std::make_pair ("key " + std::to_string (ctr), "value"s));
+    }
+    index_->flush (t1, db_.get_current_revision ());
+
+    auto const lines = [] (std::uint64_t first, std::size_t size) {
+        return (first % cache_line_size + size + cache_line_size - 1U) / cache_line_size;
+    };
+    auto num_internal = 0U;
+    std::function<void (index_pointer)> check = [&] (index_pointer const node) {
+        if (!node.is_internal ()) {
+            return;
+        }
+        ++num_internal;
+        auto const internal = internal_node::get_node (db_, node);
+        std::size_t const size = internal_node::size_bytes (internal.second->size ());
+        EXPECT_EQ (lines (node.untag_address<internal_node> ().absolute (), size),
+                   lines (0U, size));
+        for (index_pointer const child : *internal.second) {
+            check (child);
+        }
+    };
+    check (index_->root ());
+    EXPECT_GT (num_internal, 1U);
+}
+
+// test find: lookups in a large in-store index start from the cached top levels of the trie.
+TEST_F (DefaultIndexFixture, FindWithTopLevels) {
+    auto const key = [] (unsigned const ctr) { return "key " + std::to_string (ctr); };
+    constexpr auto num_keys = 6000U;
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    for (auto ctr = 0U; ctr < num_keys; ++ctr) {
+        index_->insert (t1, std::make_pair (key (ctr), std::to_string (ctr)));
+    }
+    index_->flush (t1, db_.get_current_revision ());
+
+    // The iterator returned by find() must be positioned exactly as one reached by iteration.
+    std::vector<std::string> keys;
+    for (auto it = index_->cbegin (db_), end = index_->cend (db_); it != end; ++it) {
+        keys.push_back (it->first);
+        EXPECT_EQ (index_->find (db_, it->first), it);
+    }
+    ASSERT_EQ (keys.size (), num_keys);
+    for (auto ctr = std::size_t{0}; ctr + 1U < keys.size (); ctr += 97U) {
+        auto it = index_->find (db_, keys[ctr]);
+        ++it;
+        ASSERT_NE (it, index_->cend (db_));
+        EXPECT_EQ (it->first, keys[ctr + 1U]);
+    }
+    EXPECT_EQ (index_->find (db_, "missing"s), index_->cend (db_));
+
+    std::vector<std::string> const lookup{key (1U), "missing"s, key (num_keys - 1U)};
+    std::vector<default_index::const_iterator> found;
+    index_->find_many (db_, lookup, std::back_inserter (found));
+    ASSERT_EQ (found.size (), lookup.size ());
+    EXPECT_EQ (found[0], index_->find (db_, lookup[0]));
+    EXPECT_EQ (found[1], index_->cend (db_));
+    EXPECT_EQ (found[2], index_->find (db_, lookup[2]));
+
+    // Modify the index: the cache must not be used for the new root.
+    index_->insert (t1, std::make_pair ("new key"s, "value"s));
+    EXPECT_NE (index_->find (db_, "new key"s), index_->cend (db_));
+    index_->flush (t1, db_.get_current_revision ());
+    EXPECT_NE (index_->find (db_, "new key"s), index_->cend (db_));
+    EXPECT_NE (index_->find (db_, key (42U)), index_->cend (db_));
+}
+
+// test erase: keys are removed from both heap and store nodes; the remaining keys are
+// unaffected.
+TEST_F (DefaultIndexFixture, Erase) {
+    constexpr auto num_keys = 200U;
+    auto const key = [] (unsigned const ctr) { return "key " + std::to_string (ctr); };
+
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    EXPECT_EQ (index_->erase (t1, key (0U)), 0U);
+    for (auto ctr = 0U; ctr < num_keys; ++ctr) {
+        index_->insert (t1, std::make_pair (key (ctr), std::to_string (ctr)));
+    }
+    // Erase some keys from the heap-resident trie.
+    for (auto ctr = 0U; ctr < num_keys; ctr += 4U) {
+        EXPECT_EQ (index_->erase (t1, key (ctr)), 1U);
+    }
+    index_->flush (t1, db_.get_current_revision ());
+
+    // Now erase more keys, this time from the store.
+    auto const superseded = t1.superseded ();
+    for (auto ctr = 2U; ctr < num_keys; ctr += 4U) {
+        EXPECT_EQ (index_->erase (t1, key (ctr)), 1U);
+    }
+    EXPECT_GT (t1.superseded (), superseded);
+    EXPECT_EQ (index_->erase (t1, key (0U)), 0U);
+    EXPECT_EQ (index_->erase (t1, "missing"s), 0U);
+    EXPECT_EQ (index_->size (), num_keys / 2U);
+
+    auto const check = [&] () {
+        std::vector<std::string> actual;
+        for (auto const & kvp : index_->make_range (db_)) {
+            actual.push_back (kvp.first);
+        }
+        EXPECT_EQ (actual.size (), index_->size ());
+        for (auto ctr = 0U; ctr < num_keys; ++ctr) {
+            auto const pos = index_->find (db_, key (ctr));
+            if (ctr % 2U == 0U) {
+                EXPECT_EQ (pos, index_->cend (db_)) << "key: " << key (ctr);
+            } else {
+                ASSERT_NE (pos, index_->cend (db_)) << "key: " << key (ctr);
+                EXPECT_EQ (pos->second, std::to_string (ctr));
+            }
+        }
+    };
+    check ();
+    index_->flush (t1, db_.get_current_revision ());
+    check ();
+
+    for (auto ctr = 1U; ctr < num_keys; ctr += 2U) {
+        EXPECT_EQ (index_->erase (t1, key (ctr)), 1U);
+    }
+    EXPECT_TRUE (index_->empty ());
+    EXPECT_EQ (index_->root (), index_pointer{});
+    EXPECT_EQ (index_->begin (db_), index_->end (db_));
+}
+
 // *******************************************
 // *                                         *
 // *          GenericIndexFixture            *
@@ -1364,6 +1621,72 @@ TEST_F (TwoValuesWithHashCollision, LeafLevelLinearInsertIterator) {
     std::string const & v = (*itp.first).second;
     EXPECT_EQ ("value g", v);
 }
+TEST_F (TwoValuesWithHashCollision, FindMany) {
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    for (auto const & key : {"a"s, "b"s, "e"s, "f"s, "g"s, "h"s}) {
+        index_->insert (t1, std::make_pair (key, "value " + key));
+    }
+    index_->flush (t1, db_.get_current_revision ());
+
+    std::array<std::string, 8> const keys{{"a", "b", "c", "e", "f", "g", "h", "i"}};
+    std::vector<test_trie::const_iterator> actual;
+    index_->find_many (db_, keys, std::back_inserter (actual));
+    ASSERT_EQ (actual.size (), keys.size ());
+    auto const end = index_->cend (db_);
+    for (auto ctr = std::size_t{0}; ctr < keys.size (); ++ctr) {
+        if (keys[ctr] == "c" || keys[ctr] == "i") {
+            EXPECT_EQ (actual[ctr], end) << "key: " << keys[ctr];
+        } else {
+            ASSERT_NE (actual[ctr], end) << "key: " << keys[ctr];
+            EXPECT_EQ (actual[ctr]->second, "value " + keys[ctr]);
+        }
+    }
+}
+
+TEST_F (TwoValuesWithHashCollision, EraseCollapsesInternalNodes) {
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    this->insert_or_assign (*index_, t1, "a");
+    this->insert_or_assign (*index_, t1, "b");
+    index_->flush (t1, db_.get_current_revision ());
+    this->check_is_store_internal_node (index_->root ());
+
+    // Removing "b" leaves an internal node at level 1 with "a" as its only child, and a root
+    // with only that node as its child. Both are replaced by the leaf.
+    EXPECT_EQ (index_->erase (t1, "b"s), 1U);
+    EXPECT_EQ (index_->size (), 1U);
+    this->check_is_leaf_node (index_->root ());
+    EXPECT_TRUE (this->is_found (*index_, "a")) << "key \"a\" should be present in the index";
+    EXPECT_FALSE (this->is_found (*index_, "b")) << "key \"b\" should have been erased";
+
+    // The trie can grow again from the collapsed state.
+    this->insert_or_assign (*index_, t1, "c");
+    EXPECT_TRUE (this->is_found (*index_, "a")) << "key \"a\" should be present in the index";
+    EXPECT_TRUE (this->is_found (*index_, "c")) << "key \"c\" should be present in the index";
+}
+
+TEST_F (TwoValuesWithHashCollision, EraseFromLinearNode) {
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    for (auto const & key : {"g"s, "h"s, "i"s}) {
+        this->insert_or_assign (*index_, t1, key);
+    }
+    index_->flush (t1, db_.get_current_revision ());
+
+    // Remove a member of the in-store linear node.
+    EXPECT_EQ (index_->erase (t1, "h"s), 1U);
+    EXPECT_EQ (index_->erase (t1, "h"s), 0U);
+    this->check_is_heap_internal_node (index_->root ());
+    EXPECT_TRUE (this->is_found (*index_, "g")) << "key \"g\" should be present in the index";
+    EXPECT_FALSE (this->is_found (*index_, "h")) << "key \"h\" should have been erased";
+    EXPECT_TRUE (this->is_found (*index_, "i")) << "key \"i\" should be present in the index";
+
+    // Removing a second member leaves the linear node with a single member so the whole chain
+    // of internal nodes collapses.
+    EXPECT_EQ (index_->erase (t1, "g"s), 1U);
+    EXPECT_EQ (index_->size (), 1U);
+    this->check_is_leaf_node (index_->root ());
+    EXPECT_TRUE (this->is_found (*index_, "i")) << "key \"i\" should be present in the index";
+}
+
 // *******************************************
 // *                                         *
 // *         FourNodesOnTwoLevels            *
@@ -1809,3 +2132,71 @@ TEST_F (InvalidIndex, InsertIntoIndexAtWrongRevision) {
             pstore::error_code::index_not_latest_revision);
     }
 }
+
+// *******************************************
+// *                                         *
+// *               IndexGarbage              *
+// *                                         *
+// *******************************************
+
+namespace {
+
+    class IndexGarbage : public IndexFixture {
+    protected:
+        /// Commits a transaction which assigns a new block of \p size bytes to \p key in the write
+        /// index. Returns the increase in the store's garbage estimate.
+        std::uint64_t assign (std::string const & key, std::uint64_t size);
+    };
+
+    std::uint64_t IndexGarbage::assign (std::string const & key, std::uint64_t const size) {
+        std::uint64_t const before = db_.garbage ();
+        transaction_type t = begin (db_, lock_guard{mutex_});
+        auto const addr = pstore::typed_address<char> (t.allocate (size, 1U));
+        auto index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+        index->insert_or_assign (t, key, pstore::make_extent (addr, size));
+        t.commit ();
+        return db_.garbage () - before;
+    }
+
+} // end anonymous namespace
+
+TEST_F (IndexGarbage, NewKeys) {
+    // The first commit supersedes only the initial trailer.
+    EXPECT_EQ (this->assign ("key1", 16U), sizeof (pstore::trailer));
+    // Adding a key creates a new internal node which references the existing leaf, so the only
+    // additional garbage is the index's previous header block.
+    EXPECT_EQ (this->assign ("key2", 16U),
+               sizeof (pstore::trailer) + sizeof (pstore::index::header_block));
+}
+
+TEST_F (IndexGarbage, ReplacedValue) {
+    this->assign ("key", 16U);
+    std::uint64_t const replaced = this->assign ("key", 32U);
+    // The garbage includes the 16 bytes of data referenced by the old value together with the
+    // leaf node which held it.
+    EXPECT_GT (replaced, sizeof (pstore::trailer) + sizeof (pstore::index::header_block) + 16U);
+    EXPECT_LT (db_.garbage (), db_.size ());
+}
+
+TEST_F (IndexGarbage, ErasedValue) {
+    this->assign ("key1", 16U);
+    this->assign ("key2", 16U);
+
+    std::uint64_t const before = db_.garbage ();
+    {
+        transaction_type t = begin (db_, lock_guard{mutex_});
+        auto index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+        EXPECT_EQ (index->erase (t, "key1"s), 1U);
+        t.commit ();
+    }
+    // The garbage includes the 16 bytes of data referenced by the erased value, the leaf node
+    // which held it, and the internal node which referenced the leaf.
+    EXPECT_GT (db_.garbage () - before, sizeof (pstore::trailer) +
+                                            sizeof (pstore::index::header_block) + 16U +
+                                            internal_node::size_bytes (2U));
+
+    auto index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+    EXPECT_EQ (index->size (), 1U);
+    EXPECT_EQ (index->find (db_, "key1"s), index->cend (db_));
+    EXPECT_NE (index->find (db_, "key2"s), index->cend (db_));
+}
@@ -17,6 +17,7 @@
 
 // Standard library includes
 #include <random>
+#include <vector>
 
 // 3rd party includes
 #include <gtest/gtest.h>
@@ -206,3 +207,25 @@ TEST_F (SetFixture, FindInternal) {
     EXPECT_EQ (*it, ini);
     EXPECT_EQ (it->size (), 14U); // Check operator ->
 }
+
+TEST_F (SetFixture, Partition) {
+    transaction_type t1 = begin (db_, lock_guard{mutex_});
+    for (auto ctr = 0U; ctr < 100U; ++ctr) {
+        index_.insert (t1, "string " + std::to_string (ctr));
+    }
+    index_.flush (t1, db_.get_current_revision ());
+
+    std::vector<std::string> expected;
+    for (std::string const & str : index_.make_range (db_)) {
+        expected.push_back (str);
+    }
+    auto const parts = index_.partition (db_, 5U);
+    EXPECT_EQ (parts.size (), 5U);
+    std::vector<std::string> actual;
+    for (auto const & part : parts) {
+        for (std::string const & str : part) {
+            actual.push_back (str);
+        }
+    }
+    EXPECT_EQ (actual, expected);
+}
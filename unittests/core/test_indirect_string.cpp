@@ -16,6 +16,12 @@
 
 #include "pstore/core/indirect_string.hpp"
 
+// Standard library includes
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <vector>
+
 // 3rd party includes
 #include <gtest/gtest.h>
 
@@ -242,3 +248,42 @@ TEST_F (IndirectStringAdder, NewString) {
         EXPECT_EQ (pos->as_string_view (&owner), pstore::make_sstring_view (str));
     }
 }
+
+TEST_F (IndirectStringAdder, ManyStrings) {
+    std::array<pstore::gsl::czstring, 4> const strings{{"a", "bb", "ccc", "dddd"}};
+    {
+        mock_mutex mutex;
+        auto transaction = begin (db_, std::unique_lock<mock_mutex>{mutex});
+        {
+            auto const name_index = pstore::index::get_index<pstore::trailer::indices::name> (db_);
+            std::vector<pstore::raw_sstring_view> views;
+            views.reserve (strings.size ());
+            std::transform (std::begin (strings), std::end (strings), std::back_inserter (views),
+                            [] (pstore::gsl::czstring const s) {
+                                return pstore::make_sstring_view (s);
+                            });
+
+            pstore::indirect_string_adder adder{views.size ()};
+            for (auto const & view : views) {
+                EXPECT_TRUE (adder.add (transaction, name_index, &view).second);
+            }
+            auto const size_before_flush = transaction.size ();
+            adder.flush (transaction);
+            // The bodies are written contiguously: each is 2-byte aligned and has a 2 byte length
+            // prefix. Padding is only needed after the odd-length strings other than the last.
+            EXPECT_EQ (transaction.size () - size_before_flush, (2U + 1U + 1U) + (2U + 2U) +
+                                                                    (2U + 3U + 1U) + (2U + 4U));
+        }
+        transaction.commit ();
+    }
+
+    auto const name_index = pstore::index::get_index<pstore::trailer::indices::name> (db_);
+    for (auto const * const str : strings) {
+        auto const sstring = pstore::make_sstring_view (str);
+        auto const pos = name_index->find (db_, pstore::indirect_string{db_, &sstring});
+        ASSERT_NE (pos, name_index->cend (db_));
+
+        pstore::shared_sstring_view owner;
+        EXPECT_EQ (pos->as_db_string_view (&owner), sstring);
+    }
+}
@@ -0,0 +1,181 @@
+//===- unittests/core/test_sharded_hamt_map.cpp ---------------------------===//
+//*      _                   _          _   _                     _                            *
+//*  ___| |__   __ _ _ __ __| | ___  __| | | |__   __ _ _ __ ___ | |_   _ __ ___   __ _ _ __   *
+//* / __| '_ \ / _` | '__/ _` |/ _ \/ _` | | '_ \ / _` | '_ ` _ \| __| | '_ ` _ \ / _` | '_ \  *
+//* \__ \ | | | (_| | | | (_| |  __/ (_| | | | | | (_| | | | | | | |_  | | | | | | (_| | |_) | *
+//* |___/_| |_|\__,_|_|  \__,_|\___|\__,_| |_| |_|\__,_|_| |_| |_|\__| |_| |_| |_|\__,_| .__/  *
+//*                                                                                    |_|     *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/core/sharded_hamt_map.hpp"
+
+// Standard library includes
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 3rd party includes
+#include <gtest/gtest.h>
+
+// pstore includes
+#include "pstore/core/transaction.hpp"
+
+// local includes
+#include "check_for_error.hpp"
+#include "empty_store.hpp"
+
+namespace {
+
+    class ShardedMapFixture : public testing::Test {
+    public:
+        ShardedMapFixture ()
+                : db_{store_.file ()} {
+            db_.set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+        }
+
+        using lock_guard = std::unique_lock<mock_mutex>;
+        using transaction_type = pstore::transaction<lock_guard>;
+        using map = pstore::index::sharded_hamt_map<std::string, int>;
+
+    protected:
+        static std::string key (int const v) { return "key " + std::to_string (v); }
+
+        static std::set<int> values (pstore::database const & db, map const & m) {
+            std::set<int> result;
+            for (auto const & kvp : m.make_range (db)) {
+                result.insert (kvp.second);
+            }
+            return result;
+        }
+
+        static std::set<int> iota (int const count) {
+            std::set<int> result;
+            for (auto ctr = 0; ctr < count; ++ctr) {
+                result.insert (ctr);
+            }
+            return result;
+        }
+
+        mock_mutex mutex_;
+        in_memory_store store_;
+        pstore::database db_;
+    };
+
+} // end anonymous namespace
+
+TEST_F (ShardedMapFixture, Empty) {
+    map m{db_};
+    EXPECT_TRUE (m.empty ());
+    EXPECT_EQ (m.size (), 0U);
+    EXPECT_EQ (m.begin (db_), m.end (db_));
+    EXPECT_EQ (m.find (db_, key (1)), m.end (db_));
+
+    transaction_type t = begin (db_, lock_guard{mutex_});
+    EXPECT_EQ (m.flush (t, db_.get_current_revision ()),
+               pstore::typed_address<pstore::index::header_block>::null ());
+}
+
+TEST_F (ShardedMapFixture, InsertFindAndIterate) {
+    constexpr auto count = 500;
+    map m{db_};
+    transaction_type t = begin (db_, lock_guard{mutex_});
+    for (auto ctr = 0; ctr < count; ++ctr) {
+        auto const res = m.insert (t, std::make_pair (key (ctr), ctr));
+        EXPECT_TRUE (res.second);
+        EXPECT_EQ (res.first->second, ctr);
+    }
+    EXPECT_FALSE (m.insert (t, std::make_pair (key (7), 0)).second);
+    EXPECT_TRUE (m.insert_or_assign (t, key (7), 1000).first != m.end (db_));
+
+    EXPECT_EQ (m.size (), std::size_t{count});
+    for (auto ctr = 0; ctr < count; ++ctr) {
+        auto const pos = m.find (db_, key (ctr));
+        ASSERT_NE (pos, m.end (db_));
+        EXPECT_EQ (pos->second, ctr == 7 ? 1000 : ctr);
+    }
+    EXPECT_FALSE (m.contains (db_, key (count)));
+
+    std::set<int> expected = iota (count);
+    expected.erase (7);
+    expected.insert (1000);
+    EXPECT_EQ (values (db_, m), expected);
+
+    EXPECT_EQ (m.erase (t, key (count)), 0U);
+    EXPECT_EQ (m.erase (t, key (7)), 1U);
+    EXPECT_EQ (m.size (), std::size_t{count - 1});
+}
+
+TEST_F (ShardedMapFixture, ConcurrentInsertsAndReload) {
+    constexpr auto num_threads = 4;
+    constexpr auto per_thread = 300;
+    auto addr = pstore::typed_address<pstore::index::header_block>::null ();
+    {
+        map m{db_};
+        transaction_type t = begin (db_, lock_guard{mutex_});
+        std::vector<std::thread> threads;
+        for (auto th = 0; th < num_threads; ++th) {
+            threads.emplace_back ([&m, &t, th] () {
+                for (auto ctr = th * per_thread; ctr < (th + 1) * per_thread; ++ctr) {
+                    m.insert (t, std::make_pair (key (ctr), ctr));
+                }
+            });
+        }
+        for (std::thread & th : threads) {
+            th.join ();
+        }
+        addr = m.flush (t, db_.get_current_revision ());
+        t.commit ();
+    }
+    ASSERT_NE (addr, pstore::typed_address<pstore::index::header_block>::null ());
+
+    map const reloaded{db_, addr};
+    EXPECT_EQ (reloaded.size (), std::size_t{num_threads * per_thread});
+    EXPECT_EQ (values (db_, reloaded), iota (num_threads * per_thread));
+    EXPECT_NE (reloaded.find (db_, key (42)), reloaded.end (db_));
+}
+
+TEST_F (ShardedMapFixture, ShardCountIsPartOfTheSignature) {
+    auto addr = pstore::typed_address<pstore::index::header_block>::null ();
+    {
+        map m{db_};
+        transaction_type t = begin (db_, lock_guard{mutex_});
+        m.insert (t, std::make_pair (key (1), 1));
+        addr = m.flush (t, db_.get_current_revision ());
+        t.commit ();
+    }
+    using other_map = pstore::index::sharded_hamt_map<std::string, int, std::hash<std::string>,
+                                                      std::equal_to<std::string>, 2U>;
+#if PSTORE_SIGNATURE_CHECKS_ENABLED
+    check_for_error ([this, addr] () { other_map{db_, addr}; },
+                     pstore::error_code::index_corrupt);
+#endif
+}
+
+TEST_F (ShardedMapFixture, ModifiersAddToTheParentTransaction) {
+    auto addr = pstore::typed_address<pstore::index::header_block>::null ();
+    {
+        map m{db_};
+        transaction_type t = begin (db_, lock_guard{mutex_});
+        m.insert (t, std::make_pair (key (1), 1));
+        m.insert (t, std::make_pair (key (2), 2));
+        EXPECT_TRUE (t.is_open ());
+        EXPECT_GT (t.size (), 0U);
+        addr = m.flush (t, db_.get_current_revision ());
+        t.commit ();
+    }
+    map m{db_, addr};
+    transaction_type t = begin (db_, lock_guard{mutex_});
+    EXPECT_EQ (t.superseded (), 0U);
+    m.insert_or_assign (t, key (1), 3);
+    m.erase (t, key (2));
+    // Replacing and erasing stored leaves makes them unreachable.
+    EXPECT_GT (t.superseded (), 0U);
+    EXPECT_TRUE (t.is_open ());
+}
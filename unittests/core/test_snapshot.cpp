@@ -0,0 +1,212 @@
+//===- unittests/core/test_snapshot.cpp -----------------------------------===//
+//*                            _           _    *
+//*  ___ _ __   __ _ _ __  ___| |__   ___ | |_  *
+//* / __| '_ \ / _` | '_ \/ __| '_ \ / _ \| __| *
+//* \__ \ | | | (_| | |_) \__ \ | | | (_) | |_  *
+//* |___/_| |_|\__,_| .__/|___/_| |_|\___/ \__| *
+//*                 |_|                         *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/core/snapshot.hpp"
+
+// Standard library includes
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+// pstore
+#include "pstore/core/hamt_map.hpp"
+#include "pstore/core/transaction.hpp"
+
+// local includes
+#include "check_for_error.hpp"
+#include "empty_store.hpp"
+
+namespace {
+
+    class Snapshot : public testing::Test {
+    public:
+        Snapshot ()
+                : db_{store_.file ()} {
+            db_.set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+        }
+
+        using lock_guard = std::unique_lock<mock_mutex>;
+        using transaction_type = pstore::transaction<lock_guard>;
+
+        /// Commits a transaction which sets each of the given keys to the associated value.
+        void commit (std::vector<std::pair<std::string, std::string>> const & kvps);
+
+        /// Returns the value associated with \p key in the snapshot \p snap or "<missing>".
+        static std::string read (pstore::snapshot const & snap, std::string const & key);
+
+    protected:
+        mock_mutex mutex_;
+        in_memory_store store_;
+        pstore::database db_;
+    };
+
+    // commit
+    // ~~~~~~
+    void Snapshot::commit (std::vector<std::pair<std::string, std::string>> const & kvps) {
+        transaction_type t = begin (db_, lock_guard{mutex_});
+        auto const index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+        for (auto const & kvp : kvps) {
+            std::string const & value = kvp.second;
+            std::shared_ptr<char> ptr;
+            auto where = pstore::typed_address<char>::null ();
+            std::tie (ptr, where) = t.alloc_rw<char> (value.length ());
+            std::copy (std::begin (value), std::end (value), ptr.get ());
+            index->insert_or_assign (t, kvp.first, make_extent (where, value.length ()));
+        }
+        t.commit ();
+    }
+
+    // read
+    // ~~~~
+    std::string Snapshot::read (pstore::snapshot const & snap, std::string const & key) {
+        auto const index = pstore::index::get_index<pstore::trailer::indices::write> (snap);
+        auto const it = index->find (snap.db (), key);
+        if (it == index->cend (snap.db ())) {
+            return "<missing>";
+        }
+        pstore::extent<char> const & r = it->second;
+        std::shared_ptr<char const> const value = snap.db ().getro (r);
+        return {value.get (), r.size};
+    }
+
+} // end anonymous namespace
+
+TEST_F (Snapshot, Head) {
+    this->commit ({{"a", "first"}});
+    this->commit ({{"a", "second"}});
+
+    pstore::snapshot const snap{db_};
+    EXPECT_EQ (snap.revision (), 2U);
+    EXPECT_EQ (snap.footer_pos (), db_.footer_pos ());
+    EXPECT_EQ (snap.time (), db_.get_footer ()->a.time.load ());
+    EXPECT_EQ (read (snap, "a"), "second");
+}
+
+TEST_F (Snapshot, OlderRevisions) {
+    this->commit ({{"a", "first"}, {"b", "unchanged"}});
+    this->commit ({{"a", "second"}, {"c", "new"}});
+
+    pstore::snapshot const r0{db_, 0U};
+    pstore::snapshot const r1{db_, 1U};
+    pstore::snapshot const r2{db_, pstore::head_revision};
+    EXPECT_EQ (r0.revision (), 0U);
+    EXPECT_EQ (r1.revision (), 1U);
+    EXPECT_EQ (r2.revision (), 2U);
+
+    EXPECT_EQ (read (r0, "a"), "<missing>");
+    EXPECT_EQ (read (r1, "a"), "first");
+    EXPECT_EQ (read (r1, "b"), "unchanged");
+    EXPECT_EQ (read (r1, "c"), "<missing>");
+    EXPECT_EQ (read (r2, "a"), "second");
+    EXPECT_EQ (read (r2, "b"), "unchanged");
+    EXPECT_EQ (read (r2, "c"), "new");
+
+    // The parent database is unaffected by its snapshots.
+    EXPECT_EQ (db_.get_current_revision (), 2U);
+    auto const index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+    EXPECT_EQ (index->size (), 3U);
+}
+
+TEST_F (Snapshot, FromFooterPos) {
+    this->commit ({{"a", "first"}});
+    pstore::typed_address<pstore::trailer> const first = db_.footer_pos ();
+    this->commit ({{"a", "second"}});
+
+    pstore::snapshot const snap{db_, first};
+    EXPECT_EQ (snap.revision (), 1U);
+    EXPECT_EQ (read (snap, "a"), "first");
+}
+
+TEST_F (Snapshot, EmptyIndex) {
+    pstore::snapshot const snap{db_};
+    EXPECT_EQ (snap.index_location (pstore::trailer::indices::write),
+               pstore::typed_address<pstore::index::header_block>::null ());
+    EXPECT_EQ (pstore::index::get_index<pstore::trailer::indices::write> (snap, false), nullptr);
+    auto const index = pstore::index::get_index<pstore::trailer::indices::write> (snap);
+    ASSERT_NE (index, nullptr);
+    EXPECT_TRUE (index->empty ());
+}
+
+TEST_F (Snapshot, BadRevision) {
+    this->commit ({{"a", "first"}});
+    check_for_error ([this] () { pstore::snapshot{db_, 2U}; },
+                     pstore::error_code::unknown_revision);
+}
+
+TEST_F (Snapshot, BadFooterPos) {
+    this->commit ({{"a", "first"}});
+    pstore::typed_address<pstore::trailer> const first = db_.footer_pos ();
+    this->commit ({{"a", "second"}});
+    db_.sync (1U);
+    // Revision 2 is not visible to a database synced to revision 1.
+    check_for_error ([this] () { pstore::snapshot{db_, db_.footer_pos () + 1U}; },
+                     pstore::error_code::footer_corrupt);
+    check_for_error (
+        [this, first] () {
+            pstore::snapshot{
+                db_, pstore::typed_address<pstore::trailer>::make (first.to_address () - 8U)};
+        },
+        pstore::error_code::footer_corrupt);
+}
+
+TEST_F (Snapshot, ConcurrentReaders) {
+    constexpr auto revisions = 8U;
+    for (auto r = 1U; r <= revisions; ++r) {
+        this->commit ({{"key", std::to_string (r)}});
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::string> results (revisions + 1U);
+    for (auto r = 0U; r <= revisions; ++r) {
+        threads.emplace_back ([this, r, &results] {
+            pstore::snapshot const snap{db_, r};
+            results[r] = read (snap, "key");
+        });
+    }
+    for (std::thread & t : threads) {
+        t.join ();
+    }
+
+    EXPECT_EQ (results[0], "<missing>");
+    for (auto r = 1U; r <= revisions; ++r) {
+        EXPECT_EQ (results[r], std::to_string (r));
+    }
+}
+
+TEST_F (Snapshot, RevisionsCommittedAfterALookup) {
+    this->commit ({{"a", "first"}});
+    pstore::snapshot const r1{db_, 1U};
+    EXPECT_EQ (r1.footer_pos (), db_.footer_pos ());
+
+    // Revision 2 becomes visible to db_ when it's committed. Looking it up must not rely on a
+    // table of footers built before then.
+    this->commit ({{"a", "second"}});
+    pstore::snapshot const r2{db_, 2U};
+    EXPECT_EQ (r2.footer_pos (), db_.footer_pos ());
+    EXPECT_EQ (read (r2, "a"), "second");
+    EXPECT_EQ (pstore::snapshot (db_, 1U).footer_pos (), r1.footer_pos ());
+
+    // Syncing to an older revision and back.
+    db_.sync (1U);
+    EXPECT_EQ (pstore::snapshot (db_, 1U).footer_pos (), r1.footer_pos ());
+    check_for_error ([this] () { pstore::snapshot{db_, 2U}; },
+                     pstore::error_code::unknown_revision);
+    db_.sync ();
+    EXPECT_EQ (pstore::snapshot (db_, 2U).footer_pos (), r2.footer_pos ());
+}
@@ -484,3 +484,32 @@ TEST_F (Transaction, GetRwUInt64) {
     }
     EXPECT_EQ (expected, *db_.getro (extent));
 }
+
+TEST_F (Transaction, NextAddressDoesNotAllocate) {
+    mock_mutex mutex;
+    auto transaction = begin (db_, std::unique_lock<mock_mutex>{mutex});
+    std::uint64_t const size = db_.size ();
+    EXPECT_EQ (transaction.next_address (), pstore::address{size});
+    EXPECT_EQ (db_.size (), size);
+    EXPECT_FALSE (transaction.is_open ());
+
+    pstore::address const addr = transaction.allocate (sizeof (std::uint64_t), 1U);
+    EXPECT_EQ (addr, pstore::address{size});
+    EXPECT_EQ (transaction.next_address (), addr + sizeof (std::uint64_t));
+    transaction.rollback ();
+}
+
+TEST_F (Transaction, CommitAfterOpenWritesARevision) {
+    pstore::header const * const header = this->get_header ();
+    auto const footer0 = header->footer_pos.load ();
+    {
+        mock_mutex mutex;
+        auto transaction = begin (db_, std::unique_lock<mock_mutex>{mutex});
+        transaction.open ();
+        EXPECT_TRUE (transaction.is_open ());
+        EXPECT_EQ (transaction.size (), 0U);
+        transaction.commit ();
+    }
+    EXPECT_NE (header->footer_pos.load (), footer0);
+    EXPECT_EQ (db_.get_current_revision (), 1U);
+}
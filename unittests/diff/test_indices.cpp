@@ -262,3 +262,33 @@ TEST_F (DiffFixture, MakeIndexDiffNew1Old1) {
     addr->write (out);
     check (out, "write");
 }
+
+TEST_F (DiffFixture, MakeIndexDiffRemoved) {
+    using ::testing::ElementsAre;
+
+    {
+        transaction_type t1 = begin (db_, lock_guard{mutex_});
+        this->add (t1, "key1", "first value");
+        this->add (t1, "key2", "second value");
+        t1.commit ();
+    }
+    {
+        transaction_type t2 = begin (db_, lock_guard{mutex_});
+        auto index = pstore::index::get_index<pstore::trailer::indices::write> (db_);
+        ASSERT_EQ (index->erase (t2, std::string{"key1"}), 1U);
+        t2.commit ();
+    }
+
+    std::ostringstream out;
+    pstore::diff_dump::make_index_diff<pstore::index::write_index> (
+        "write", db_, 2U, 1U, pstore::index::get_index<pstore::trailer::indices::write>)
+        ->write (out);
+
+    auto const lines = split_lines (out.str ());
+    ASSERT_EQ (4U, lines.size ());
+    auto line = 0U;
+    EXPECT_THAT (split_tokens (lines.at (line++)), ElementsAre ("name", ":", "write"));
+    EXPECT_THAT (split_tokens (lines.at (line++)), ElementsAre ("members", ":", "[", "]"));
+    EXPECT_THAT (split_tokens (lines.at (line++)), ElementsAre ("removed", ":"));
+    EXPECT_THAT (split_tokens (lines.at (line++)), ElementsAre ("-", "key1"));
+}
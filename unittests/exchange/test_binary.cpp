@@ -0,0 +1,214 @@
+//===- unittests/exchange/test_binary.cpp ---------------------------------===//
+//*  _     _                         *
+//* | |__ (_)_ __   __ _ _ __ _   _  *
+//* | '_ \| | '_ \ / _` | '__| | | | *
+//* | |_) | | | | | (_| | |  | |_| | *
+//* |_.__/|_|_| |_|\__,_|_|   \__, | *
+//*                           |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/exchange/export_binary.hpp"
+#include "pstore/exchange/import_binary.hpp"
+
+// Standard library
+#include <array>
+#include <unordered_map>
+
+// 3rd party includes
+#include <gtest/gtest.h>
+
+// pstore includes
+#include "pstore/mcrepo/compilation.hpp"
+#include "pstore/mcrepo/fragment.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
+
+// local includes
+#include "add_export_strings.hpp"
+
+namespace {
+
+    using transaction_lock = std::unique_lock<mock_mutex>;
+    using string_address = pstore::typed_address<pstore::indirect_string>;
+
+    class ExchangeBinary : public testing::Test {
+    public:
+        ExchangeBinary ()
+                : export_db_{export_store_.file ()}
+                , import_db_{import_store_.file ()} {
+            export_db_.set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+            import_db_.set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+        }
+
+    protected:
+        static constexpr pstore::index::digest fragment_digest{0x11111111, 0x22222222};
+        static constexpr pstore::index::digest compilation_digest{0x33333333, 0x44444444};
+
+        /// Builds a database containing a single compilation whose definition references a
+        /// fragment with text, data, and bss sections.
+        void build_export_db ();
+        std::string export_binary ();
+
+        std::string load_string (string_address const addr) const {
+            return pstore::indirect_string::read (import_db_, addr).to_string ();
+        }
+
+        in_memory_store export_store_;
+        pstore::database export_db_;
+
+        in_memory_store import_store_;
+        pstore::database import_db_;
+    };
+
+    constexpr pstore::index::digest ExchangeBinary::fragment_digest;
+    constexpr pstore::index::digest ExchangeBinary::compilation_digest;
+
+    void ExchangeBinary::build_export_db () {
+        using pstore::repo::section_kind;
+
+        std::array<pstore::gsl::czstring, 2> names{{"triple", "name"}};
+        std::unordered_map<std::string, string_address> indir_strings;
+        add_export_strings<pstore::trailer::indices::name> (
+            export_db_, std::begin (names), std::end (names),
+            std::inserter (indir_strings, std::end (indir_strings)));
+
+        mock_mutex mutex;
+        auto transaction = begin (export_db_, transaction_lock{mutex});
+
+        pstore::repo::section_content text{section_kind::text, std::uint8_t{16}};
+        text.data.assign ({0x01, 0x02, 0x03, 0x04});
+        text.ifixups.emplace_back (section_kind::data, pstore::repo::relocation_type{3},
+                                   std::uint64_t{2}, std::int64_t{-7});
+        text.xfixups.emplace_back (indir_strings["name"], pstore::repo::relocation_type{5},
+                                   pstore::repo::binding::weak, std::uint64_t{1},
+                                   std::int64_t{-1});
+        pstore::repo::section_content data{section_kind::data, std::uint8_t{8}};
+        data.data.assign ({0xFF, 0xFE});
+        pstore::repo::section_content bss{section_kind::bss, std::uint8_t{4}};
+        bss.data.resize (128U);
+
+        std::vector<std::unique_ptr<pstore::repo::section_creation_dispatcher>> dispatchers;
+        dispatchers.emplace_back (
+            std::make_unique<pstore::repo::generic_section_creation_dispatcher> (
+                section_kind::text, &text));
+        dispatchers.emplace_back (
+            std::make_unique<pstore::repo::generic_section_creation_dispatcher> (
+                section_kind::data, &data));
+        dispatchers.emplace_back (
+            std::make_unique<pstore::repo::bss_section_creation_dispatcher> (&bss));
+        pstore::extent<pstore::repo::fragment> const fext = pstore::repo::fragment::alloc (
+            transaction, pstore::make_pointee_adaptor (dispatchers.begin ()),
+            pstore::make_pointee_adaptor (dispatchers.end ()));
+        pstore::index::get_index<pstore::trailer::indices::fragment> (export_db_)
+            ->insert (transaction, std::make_pair (fragment_digest, fext));
+
+        std::array<pstore::repo::definition, 1> definitions{
+            {{fragment_digest, fext, indir_strings["name"], pstore::repo::linkage::external,
+              pstore::repo::visibility::protected_vis}}};
+        pstore::extent<pstore::repo::compilation> const cext =
+            pstore::repo::compilation::alloc (transaction, indir_strings["triple"],
+                                              std::begin (definitions), std::end (definitions));
+        pstore::index::get_index<pstore::trailer::indices::compilation> (export_db_)
+            ->insert (transaction, std::make_pair (compilation_digest, cext));
+        transaction.commit ();
+    }
+
+    std::string ExchangeBinary::export_binary () {
+        pstore::exchange::export_ns::ostringstream os;
+        pstore::exchange::export_ns::emit_binary_database (export_db_, os);
+        return os.str ();
+    }
+
+    std::uint8_t const * as_bytes (std::string const & str) {
+        return reinterpret_cast<std::uint8_t const *> (str.data ());
+    }
+
+} // end anonymous namespace
+
+TEST_F (ExchangeBinary, RoundTrip) {
+    using pstore::repo::section_kind;
+
+    this->build_export_db ();
+    std::string const exported = this->export_binary ();
+
+    // Feed the importer a byte at a time to exercise the handling of partial records.
+    pstore::exchange::import_ns::binary_importer importer{&import_db_};
+    auto const * const first = as_bytes (exported);
+    for (auto it = first, last = first + exported.size (); it != last; ++it) {
+        ASSERT_FALSE (importer.input (it, it + 1)) << "Error at offset " << importer.offset ();
+    }
+    ASSERT_FALSE (importer.eof ()) << importer.last_error ().message ();
+
+    EXPECT_EQ (import_db_.get_header ().id (), export_db_.get_header ().id ())
+        << "The file UUID was not preserved by import";
+    EXPECT_EQ (import_db_.get_current_revision (), export_db_.get_current_revision ());
+
+    // Check the compilation.
+    auto const compilations =
+        pstore::index::get_index<pstore::trailer::indices::compilation> (import_db_);
+    auto const cpos = compilations->find (import_db_, compilation_digest);
+    ASSERT_NE (cpos, compilations->end (import_db_));
+    auto const compilation = import_db_.getro (cpos->second);
+    EXPECT_EQ (load_string (compilation->triple ()), "triple");
+    ASSERT_EQ (compilation->size (), 1U);
+    pstore::repo::definition const & def = (*compilation)[0];
+    EXPECT_EQ (def.digest, fragment_digest);
+    EXPECT_EQ (load_string (def.name), "name");
+    EXPECT_EQ (def.linkage (), pstore::repo::linkage::external);
+    EXPECT_EQ (def.visibility (), pstore::repo::visibility::protected_vis);
+
+    // Check the fragment.
+    auto const fragments =
+        pstore::index::get_index<pstore::trailer::indices::fragment> (import_db_);
+    auto const fpos = fragments->find (import_db_, fragment_digest);
+    ASSERT_NE (fpos, fragments->end (import_db_));
+    auto const fragment = pstore::repo::fragment::load (import_db_, fpos->second);
+    EXPECT_EQ (fragment->size (), 3U);
+
+    ASSERT_TRUE (fragment->has_section (section_kind::text));
+    auto const & text = fragment->at<section_kind::text> ();
+    EXPECT_EQ (text.align (), 16U);
+    std::shared_ptr<std::uint8_t const> owner;
+    EXPECT_EQ (pstore::repo::load_payload (import_db_, text, &owner).size (), 4U);
+    ASSERT_EQ (text.ifixups ().size (), 1U);
+    EXPECT_EQ (*text.ifixups ().begin (),
+               (pstore::repo::internal_fixup{section_kind::data, pstore::repo::relocation_type{3},
+                                             std::uint64_t{2}, std::int64_t{-7}}));
+    ASSERT_EQ (text.xfixups ().size (), 1U);
+    pstore::repo::external_fixup const & xfx = *text.xfixups ().begin ();
+    EXPECT_EQ (load_string (xfx.name), "name");
+    EXPECT_EQ (xfx.type, pstore::repo::relocation_type{5});
+    EXPECT_TRUE (xfx.is_weak);
+    EXPECT_EQ (xfx.offset, 1U);
+    EXPECT_EQ (xfx.addend, -1);
+
+    ASSERT_TRUE (fragment->has_section (section_kind::bss));
+    EXPECT_EQ (fragment->at<section_kind::bss> ().align (), 4U);
+    EXPECT_EQ (fragment->at<section_kind::bss> ().size (), 128U);
+}
+
+TEST_F (ExchangeBinary, BadSignature) {
+    std::string const input = R"({"version":1})";
+    pstore::exchange::import_ns::binary_importer importer{&import_db_};
+    auto const * const first = as_bytes (input);
+    EXPECT_EQ (importer.input (first, first + input.size ()),
+               make_error_code (pstore::exchange::import_ns::error::bad_binary_signature));
+}
+
+TEST_F (ExchangeBinary, Truncated) {
+    this->build_export_db ();
+    std::string const exported = this->export_binary ();
+
+    // Drop the final (end) record.
+    pstore::exchange::import_ns::binary_importer importer{&import_db_};
+    auto const * const first = as_bytes (exported);
+    EXPECT_FALSE (importer.input (first, first + exported.size () - 1U));
+    EXPECT_EQ (importer.eof (),
+               make_error_code (
+                   pstore::exchange::import_ns::error::unexpected_end_of_binary_input));
+}
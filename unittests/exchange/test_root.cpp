@@ -15,13 +15,26 @@
 //===----------------------------------------------------------------------===//
 #include "pstore/exchange/import_root.hpp"
 
+// Standard library includes
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
 // 3rd party includes
 #include <gtest/gtest.h>
 
 // pstore includes
+#include "pstore/config/config.hpp"
 #include "pstore/core/database.hpp"
+#include "pstore/core/hamt_map.hpp"
+#include "pstore/core/index_types.hpp"
+#include "pstore/exchange/export.hpp"
+#include "pstore/exchange/import_error.hpp"
 #include "pstore/json/json.hpp"
 #include "pstore/exchange/import_root.hpp"
+#include "pstore/mcrepo/fragment.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
 
 // Local includes
 #include "empty_store.hpp"
@@ -58,3 +71,166 @@ TEST_F (ExchangeRoot, ImportId) {
         << "The file UUID was not preserved by import";
     EXPECT_TRUE (import_db_.get_header ().is_valid ()) << "The file header was not valid";
 }
+
+namespace {
+
+    constexpr auto two_transactions = R"({
+  "version":1,
+  "id":"2dedee5a-6992-49d5-b98b-9f6fa95418f3",
+  "transactions":[
+    {
+      "names":[ "triple", "f", "g" ],
+      "fragments":{
+        "11111111111111111111111111111111":{
+          "text":{ "align":16, "data":"AQIDBA==",
+                   "xfixups":[ { "name":2, "type":4, "offset":1, "addend":-4 } ] },
+          "data":{ "align":8, "data":"/w==",
+                   "ifixups":[ { "section":"text", "type":1, "offset":0, "addend":0 } ] }
+        },
+        "22222222222222222222222222222222":{
+          "text":{ "data":"BQYH" }
+        }
+      },
+      "compilations":{
+        "33333333333333333333333333333333":{
+          "triple":0,
+          "definitions":[
+            { "digest":"11111111111111111111111111111111", "name":1, "linkage":"external" },
+            { "digest":"22222222222222222222222222222222", "name":2, "linkage":"internal" }
+          ]
+        }
+      }
+    },
+    {
+      "names":[ "h" ],
+      "fragments":{
+        "44444444444444444444444444444444":{
+          "text":{ "data":"CAkK" }
+        }
+      }
+    }
+  ]
+})";
+
+} // end anonymous namespace
+
+TEST_F (ExchangeRoot, ImportWithWorkers) {
+    using namespace pstore::exchange;
+    using pstore::repo::section_kind;
+
+    pstore::json::parser<import_ns::callbacks> parser =
+        import_ns::create_parser (import_db_, 3U /*jobs*/);
+    parser.input (two_transactions).eof ();
+    ASSERT_FALSE (parser.has_error ()) << "JSON error was: " << parser.last_error ().message ()
+                                       << ' ' << parser.coordinate ();
+    EXPECT_EQ (import_db_.get_current_revision (), 2U);
+
+    auto const fragments =
+        pstore::index::get_index<pstore::trailer::indices::fragment> (import_db_);
+    ASSERT_NE (fragments, nullptr);
+    EXPECT_EQ (fragments->size (), 3U);
+
+    // Returns the payload of the text section of the fragment with the given digest.
+    auto const text = [this, &fragments] (std::uint64_t const d) {
+        auto const pos = fragments->find (import_db_, pstore::index::digest{d, d});
+        EXPECT_NE (pos, fragments->end (import_db_));
+        auto const fragment = pstore::repo::fragment::load (import_db_, pos->second);
+        std::shared_ptr<std::uint8_t const> owner;
+        auto const payload =
+            pstore::repo::load_payload (import_db_, fragment->at<section_kind::text> (), &owner);
+        return std::vector<std::uint8_t> (payload.begin (), payload.end ());
+    };
+    EXPECT_EQ (text (0x1111111111111111), (std::vector<std::uint8_t>{1, 2, 3, 4}));
+    EXPECT_EQ (text (0x2222222222222222), (std::vector<std::uint8_t>{5, 6, 7}));
+    EXPECT_EQ (text (0x4444444444444444), (std::vector<std::uint8_t>{8, 9, 10}));
+}
+
+TEST_F (ExchangeRoot, ImportPopulatesOrderedNames) {
+    using namespace pstore::exchange;
+
+    static constexpr auto json = R"({
+  "version":1,
+  "id":"2dedee5a-6992-49d5-b98b-9f6fa95418f3",
+  "transactions":[
+    { "names":[ "pear", "apple", "banana", "apricot", "cherry", "avocado" ] },
+    { "names":[ "plum", "aardvark" ] }
+  ]
+})";
+    pstore::json::parser<import_ns::callbacks> parser = import_ns::create_parser (import_db_);
+    parser.input (json).eof ();
+    ASSERT_FALSE (parser.has_error ()) << "JSON error was: " << parser.last_error ().message ()
+                                       << ' ' << parser.coordinate ();
+
+    auto const names = pstore::index::get_index<pstore::trailer::indices::name> (import_db_);
+    auto const ordered =
+        pstore::index::get_index<pstore::trailer::indices::ordered_name> (import_db_, false);
+    ASSERT_NE (names, nullptr);
+    ASSERT_NE (ordered, nullptr);
+    EXPECT_EQ (ordered->size (), names->size ());
+
+    // Find the names which start with "a".
+    auto const prefix = pstore::make_sstring_view ("a");
+    std::vector<std::string> actual;
+    for (auto it = ordered->lower_bound (import_db_, pstore::indirect_string{import_db_, &prefix}),
+              end = ordered->end (import_db_);
+         it != end; ++it) {
+        std::string const s = it->to_string ();
+        if (s.compare (0, 1, "a") != 0) {
+            break;
+        }
+        actual.push_back (s);
+
+        // The two indices share the string's body.
+        auto const pos = names->find (import_db_, *it);
+        ASSERT_NE (pos, names->end (import_db_));
+        EXPECT_EQ (pos->in_store_address (), it->in_store_address ());
+    }
+    EXPECT_EQ (actual, (std::vector<std::string>{"aardvark", "apple", "apricot", "avocado"}));
+}
+
+#ifdef PSTORE_EXCEPTIONS
+TEST_F (ExchangeRoot, ExportStopsWhenAWorkerFails) {
+    using namespace pstore::exchange;
+
+    pstore::json::parser<import_ns::callbacks> parser = import_ns::create_parser (import_db_);
+    parser.input (two_transactions).eof ();
+    ASSERT_FALSE (parser.has_error ()) << "JSON error was: " << parser.last_error ().message ()
+                                       << ' ' << parser.coordinate ();
+
+    // Each worker opens the store by its path. That is impossible for an in-memory store so the
+    // workers fail.
+    std::unique_ptr<std::FILE, decltype (&std::fclose)> file{std::tmpfile (), &std::fclose};
+    ASSERT_NE (file, nullptr);
+    {
+        export_ns::ostream os{file.get ()};
+        EXPECT_THROW (export_ns::emit_database (import_db_, os, false, 2U), std::system_error);
+    }
+
+    std::string output;
+    std::rewind (file.get ());
+    for (int c; (c = std::fgetc (file.get ())) != EOF;) {
+        output += static_cast<char> (c);
+    }
+    // The output stops at the start of the transactions array: no empty elements were written
+    // and the document was not closed.
+    EXPECT_NE (output.find (R"("transactions":)"), std::string::npos);
+    EXPECT_EQ (output.find (']'), std::string::npos);
+    EXPECT_EQ (output.find ('}'), std::string::npos);
+}
+#endif // PSTORE_EXCEPTIONS
+
+TEST_F (ExchangeRoot, ImportWithWorkersBadBase64) {
+    using namespace pstore::exchange;
+
+    static constexpr auto json = R"({
+  "version":1,
+  "id":"2dedee5a-6992-49d5-b98b-9f6fa95418f3",
+  "transactions":[
+    { "names":[], "fragments":{ "11111111111111111111111111111111":{ "text":{ "data":"*" } } } }
+  ]
+})";
+    pstore::json::parser<import_ns::callbacks> parser =
+        import_ns::create_parser (import_db_, 2U /*jobs*/);
+    parser.input (json).eof ();
+    EXPECT_EQ (parser.last_error (), make_error_code (import_ns::error::bad_base64_data));
+}
@@ -0,0 +1,155 @@
+//===- unittests/json/test_scan.cpp ---------------------------------------===//
+//*                       *
+//*  ___  ___ __ _ _ __   *
+//* / __|/ __/ _` | '_ \  *
+//* \__ \ (_| (_| | | | | *
+//* |___/\___\__,_|_| |_| *
+//*                       *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/json/scan.hpp"
+
+// Standard library
+#include <string>
+
+// 3rd party includes
+#include <gtest/gtest.h>
+
+// pstore includes
+#include "pstore/json/json.hpp"
+
+#include "callbacks.hpp"
+
+using pstore::json::details::scan_isa;
+
+namespace {
+
+    class JsonScan : public testing::TestWithParam<scan_isa> {
+    protected:
+        pstore::json::details::scanner const & scanner () const {
+            return pstore::json::details::get_scanner (GetParam ());
+        }
+
+        /// Returns the offset of the result of \p fn when applied to \p str.
+        template <typename Function>
+        static std::size_t offset (Function fn, std::string const & str) {
+            char const * const first = str.data ();
+            return static_cast<std::size_t> (fn (first, first + str.size ()) - first);
+        }
+    };
+
+} // end anonymous namespace
+
+TEST_P (JsonScan, BlanksEmpty) {
+    std::string const empty;
+    EXPECT_EQ (offset (scanner ().blanks, empty), 0U);
+}
+
+TEST_P (JsonScan, BlanksStopAtEveryPosition) {
+    // Lengths either side of the 16- and 32-byte vector widths exercise both the vector loops and
+    // the scalar tails.
+    for (auto length = std::size_t{0}; length < 80U; ++length) {
+        std::string str (length, ' ');
+        for (auto ctr = std::size_t{0}; ctr < length; ctr += 3U) {
+            str[ctr] = '\t';
+        }
+        EXPECT_EQ (offset (scanner ().blanks, str), length);
+        for (char const stop : {'\n', '\r', 'x', '"', '\0', '\x80'}) {
+            for (auto pos = std::size_t{0}; pos < length; ++pos) {
+                std::string copy = str;
+                copy[pos] = stop;
+                EXPECT_EQ (offset (scanner ().blanks, copy), pos)
+                    << "length=" << length << " pos=" << pos;
+            }
+        }
+    }
+}
+
+TEST_P (JsonScan, StringBodyStopAtEveryPosition) {
+    for (auto length = std::size_t{0}; length < 80U; ++length) {
+        std::string str;
+        for (auto ctr = std::size_t{0}; ctr < length; ++ctr) {
+            // Cycle through the printable ASCII characters other than quote and backslash.
+            auto c = static_cast<char> (' ' + ctr % 95U);
+            if (c == '"' || c == '\\') {
+                c = 'a';
+            }
+            str += c;
+        }
+        EXPECT_EQ (offset (scanner ().string_body, str), length);
+        for (char const stop : {'"', '\\', '\0', '\t', '\x1F', '\x80', '\xC3', '\xFF'}) {
+            for (auto pos = std::size_t{0}; pos < length; ++pos) {
+                std::string copy = str;
+                copy[pos] = stop;
+                EXPECT_EQ (offset (scanner ().string_body, copy), pos)
+                    << "length=" << length << " pos=" << pos;
+            }
+        }
+    }
+}
+
+TEST_P (JsonScan, StringBodyAcceptsDelete) {
+    std::string const str (40U, '\x7F');
+    EXPECT_EQ (offset (scanner ().string_body, str), str.size ());
+}
+
+#ifdef PSTORE_IS_INSIDE_LLVM
+INSTANTIATE_TEST_CASE_P (JsonScan, JsonScan,
+                         testing::Values (scan_isa::portable, scan_isa::sse2, scan_isa::avx2), );
+#else
+INSTANTIATE_TEST_SUITE_P (JsonScan, JsonScan,
+                          testing::Values (scan_isa::portable, scan_isa::sse2, scan_isa::avx2));
+#endif
+
+namespace {
+
+    /// Parses \p src twice: once as contiguous memory (which uses the bulk scanning fast paths)
+    /// and once a character at a time through a non-pointer iterator (which does not). Both the
+    /// results and the final coordinates must match.
+    void check_fast_path (std::string const & src) {
+        pstore::json::parser<json_out_callbacks> fast;
+        std::string const fast_result = fast.input (src).eof ();
+
+        pstore::json::parser<json_out_callbacks> slow;
+        for (auto it = std::begin (src), end = std::end (src); it != end; ++it) {
+            slow.input (it, it + 1);
+        }
+        std::string const slow_result = slow.eof ();
+
+        EXPECT_EQ (fast.last_error (), slow.last_error ()) << src;
+        EXPECT_EQ (fast_result, slow_result) << src;
+        EXPECT_EQ (fast.coordinate (), slow.coordinate ()) << src;
+    }
+
+} // end anonymous namespace
+
+TEST (JsonScanParser, MatchesCharacterAtATime) {
+    std::string const long_text (100U, 'x');
+    std::string const indent (40U, ' ');
+    check_fast_path ("\"" + long_text + "\"");
+    check_fast_path ("[\n" + indent + "\"" + long_text + "\",\n" + indent + "\t\"a\\nb\"\n]");
+    check_fast_path ("{\r\n" + indent + "\"key\" :\r\n" + indent + "\"" + long_text + "\"}\r\n");
+    check_fast_path ("\"" + long_text + "\xC3\xA9" + long_text + "\"");
+    check_fast_path ("\"" + long_text + "\\uD834\\uDD1E" + long_text + "\"");
+    check_fast_path ("\"" + long_text + "\\uD834" + long_text + "\"");
+    check_fast_path ("\"" + long_text + "\t" + long_text + "\"");
+    check_fast_path ("\"" + long_text);
+    check_fast_path (indent + "\n\n" + indent + "null" + indent + "\n");
+}
+
+TEST (JsonScanParser, Coordinates) {
+    std::string const indent (50U, ' ');
+    pstore::json::parser<json_out_callbacks> p;
+    std::string const res =
+        p.input ("[\n" + indent + "\"" + std::string (70U, 'y') + "\",\n" + indent + "1\n]")
+            .eof ();
+    EXPECT_FALSE (p.has_error ());
+    EXPECT_EQ (res, "[ \"" + std::string (70U, 'y') + "\" 1 ]");
+    EXPECT_EQ (p.coordinate (), (pstore::json::coord{2U, 4U}));
+}
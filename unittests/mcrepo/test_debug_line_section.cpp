@@ -22,6 +22,7 @@
 #include "pstore/mcrepo/debug_line_section.hpp"
 
 // System includes
+#include <algorithm>
 #include <vector>
 #include <memory>
 
@@ -31,6 +32,7 @@
 // pstore includes
 #include "pstore/support/pointee_adaptor.hpp"
 #include "pstore/mcrepo/fragment.hpp"
+#include "pstore/mcrepo/shared_payload.hpp"
 
 // Local includes
 #include "empty_store.hpp"
@@ -84,5 +86,50 @@ TEST_F (DebugLineSection, RoundTrip) {
     EXPECT_EQ (dls->align (), alignment);
     EXPECT_EQ (dls->header_digest (), header_digest);
     EXPECT_EQ (dls->header_extent (), header_extent);
-    EXPECT_THAT (dls->payload (), testing::ElementsAre (std::uint8_t{11}, std::uint8_t{13}));
+    EXPECT_THAT (dls->generic ().inline_payload (),
+                 testing::ElementsAre (std::uint8_t{11}, std::uint8_t{13}));
+}
+
+TEST_F (DebugLineSection, CompressedRoundTrip) {
+    using pstore::repo::debug_line_section_creation_dispatcher;
+
+    constexpr auto section_type = pstore::repo::section_kind::debug_line;
+    constexpr auto header_digest = pstore::index::digest{0x01234567U, 0x89ABCDEF};
+    constexpr auto header_extent =
+        pstore::make_extent (pstore::typed_address<std::uint8_t>::make (5), 7);
+
+    pstore::repo::section_content content{section_type, std::uint8_t{1}};
+    for (auto ctr = 0U; ctr < 512U; ++ctr) {
+        content.data.emplace_back (static_cast<std::uint8_t> (ctr % 8U));
+    }
+
+    std::vector<std::unique_ptr<pstore::repo::section_creation_dispatcher>> dispatchers;
+    dispatchers.emplace_back (
+        new debug_line_section_creation_dispatcher (header_digest, header_extent, &content));
+    auto const first = pstore::make_pointee_adaptor (dispatchers.begin ());
+    auto const last = pstore::make_pointee_adaptor (dispatchers.end ());
+
+    pstore::repo::payload_options options;
+    options.compress_threshold = 64U;
+
+    transaction_type transaction = begin (db_, lock_guard{mutex_});
+    pstore::repo::store_payloads (transaction, first, last, options);
+    auto fragment = pstore::repo::fragment::load (
+        db_, pstore::repo::fragment::alloc (transaction, first, last));
+    transaction.commit ();
+
+    auto const * const dls = fragment->atp<section_type> ();
+    ASSERT_NE (dls, nullptr);
+    ASSERT_TRUE (dls->generic ().has_compressed_payload ());
+    EXPECT_EQ (dls->size (), content.data.size ());
+    EXPECT_EQ (dls->header_extent (), header_extent);
+
+    pstore::repo::payload_cache cache{4096U};
+    std::shared_ptr<std::uint8_t const> owner1;
+    auto const p1 = dls->payload (db_, &owner1, &cache);
+    EXPECT_TRUE (std::equal (p1.begin (), p1.end (), content.data.begin (), content.data.end ()));
+    // The dispatcher decompresses the payload in the same way.
+    std::shared_ptr<std::uint8_t const> owner2;
+    auto const p2 = pstore::repo::section_value (db_, *fragment, section_type, &owner2, &cache);
+    EXPECT_TRUE (std::equal (p2.begin (), p2.end (), content.data.begin (), content.data.end ()));
 }
@@ -118,8 +118,8 @@ TEST_F (FragmentTest, MakeReadOnlySection) {
     EXPECT_EQ (4U, section_alignment (s));
     EXPECT_EQ (6U, section_size (s));
 
-    auto data_begin = std::begin (s.payload ());
-    auto data_end = std::end (s.payload ());
+    auto data_begin = std::begin (s.inline_payload ());
+    auto data_end = std::end (s.inline_payload ());
     auto rodata_begin = std::begin (rodata.data);
     auto rodata_end = std::end (rodata.data);
     ASSERT_EQ (std::distance (data_begin, data_end), std::distance (rodata_begin, rodata_end));
@@ -175,12 +175,12 @@ TEST_F (FragmentTest, MakeTextSectionWithFixups) {
     EXPECT_EQ (4U, section_size (s));
 
     EXPECT_EQ (16U, s.align ());
-    EXPECT_EQ (4U, s.payload ().size ());
+    EXPECT_EQ (4U, s.inline_payload ().size ());
     EXPECT_EQ (4U, s.size ());
     EXPECT_EQ (2U, s.ifixups ().size ());
     EXPECT_EQ (3U, s.xfixups ().size ());
 
-    EXPECT_THAT (s.payload (), ElementsAreArray (original));
+    EXPECT_THAT (s.inline_payload (), ElementsAreArray (original));
     EXPECT_THAT (s.ifixups (), ElementsAre (internal_fixup{section_kind::text, 1, 1, 1},
                                             internal_fixup{section_kind::data, 2, 2, 2}));
     EXPECT_THAT (s.xfixups (),
@@ -274,7 +274,7 @@ TEST_F (FragmentTest, TwoSections) {
 
     generic_section const & rodata = f->at<section_kind::read_only> ();
     generic_section const & tls = f->at<section_kind::thread_data> ();
-    EXPECT_LT (rodata.payload ().begin (), tls.payload ().begin ());
+    EXPECT_LT (rodata.inline_payload ().begin (), tls.inline_payload ().begin ());
 }
 
 TEST_F (FragmentTest, Iterator) {
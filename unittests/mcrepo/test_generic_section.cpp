@@ -0,0 +1,123 @@
+//===- unittests/mcrepo/test_generic_section.cpp --------------------------===//
+//*                             _                      _   _              *
+//*   __ _  ___ _ __   ___ _ __(_) ___   ___  ___  ___| |_(_) ___  _ __   *
+//*  / _` |/ _ \ '_ \ / _ \ '__| |/ __| / __|/ _ \/ __| __| |/ _ \| '_ \  *
+//* | (_| |  __/ | | |  __/ |  | | (__  \__ \  __/ (__| |_| | (_) | | | | *
+//*  \__, |\___|_| |_|\___|_|  |_|\___| |___/\___|\___|\__|_|\___/|_| |_| *
+//*  |___/                                                                *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/mcrepo/generic_section.hpp"
+
+// System includes
+#include <limits>
+#include <vector>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+using pstore::repo::binding;
+using pstore::repo::external_fixup;
+using pstore::repo::generic_section;
+using pstore::repo::internal_fixup;
+using pstore::repo::relocation_type;
+using pstore::repo::section_content;
+using pstore::repo::section_kind;
+
+namespace {
+
+    class GenericSection : public testing::Test {
+    protected:
+        /// Builds a generic section from \p content in the buffer_ member.
+        generic_section const & build (section_content const & content);
+
+    private:
+        std::vector<std::uint64_t> buffer_;
+    };
+
+    generic_section const & GenericSection::build (section_content const & content) {
+        pstore::repo::generic_section_creation_dispatcher const dispatcher{content.kind,
+                                                                           &content};
+        std::size_t const size = dispatcher.size_bytes ();
+        buffer_.assign (size / sizeof (std::uint64_t) + 1U, std::uint64_t{0});
+        auto * const out = reinterpret_cast<std::uint8_t *> (buffer_.data ());
+        std::uint8_t const * const end = dispatcher.write (out);
+        EXPECT_EQ (static_cast<std::size_t> (end - out), size);
+        auto const & section = *reinterpret_cast<generic_section const *> (out);
+        EXPECT_EQ (section.size_bytes (), size);
+        return section;
+    }
+
+    pstore::typed_address<pstore::indirect_string> name (std::uint64_t const a) {
+        return pstore::typed_address<pstore::indirect_string>::make (a);
+    }
+
+} // end anonymous namespace
+
+TEST_F (GenericSection, NoFixups) {
+    section_content content{section_kind::data, std::uint8_t{8}};
+    content.data.assign ({1, 2, 3});
+    generic_section const & s = this->build (content);
+    EXPECT_EQ (s.align (), 8U);
+    EXPECT_THAT (s.inline_payload (), testing::ElementsAre (1, 2, 3));
+    EXPECT_TRUE (s.ifixups ().empty ());
+    EXPECT_TRUE (s.xfixups ().empty ());
+    EXPECT_EQ (s.ifixups ().begin (), s.ifixups ().end ());
+    EXPECT_EQ (s.size_bytes (), sizeof (generic_section) + 3U);
+}
+
+TEST_F (GenericSection, ExtremeFixupValues) {
+    constexpr auto max_offset = std::numeric_limits<std::uint64_t>::max ();
+    constexpr auto min_addend = std::numeric_limits<std::int64_t>::min ();
+    constexpr auto max_addend = std::numeric_limits<std::int64_t>::max ();
+
+    section_content content{section_kind::text, std::uint8_t{16}};
+    content.data.assign ({0x90, 0x90});
+    // Offsets which go down as well as up, the largest possible deltas, and addends at the
+    // extremes of their range.
+    content.ifixups = {
+        internal_fixup{section_kind::data, relocation_type{1}, 8U, 0},
+        internal_fixup{section_kind::rel_ro, relocation_type{255}, 2U, -1},
+        internal_fixup{section_kind::linked_definitions, relocation_type{0}, max_offset,
+                       min_addend},
+        internal_fixup{section_kind::text, relocation_type{7}, 0U, max_addend},
+    };
+    content.xfixups = {
+        external_fixup{name (0x1000), relocation_type{2}, binding::strong, 4U, 0},
+        external_fixup{name (0x10), relocation_type{3}, binding::weak, 1U, -4},
+        external_fixup{name (max_offset), relocation_type{4}, binding::strong, max_offset,
+                       min_addend},
+        external_fixup{name (0), relocation_type{5}, binding::weak, 0U, max_addend},
+    };
+
+    generic_section const & s = this->build (content);
+    EXPECT_THAT (s.inline_payload (), testing::ElementsAre (0x90, 0x90));
+    EXPECT_EQ (s.ifixups ().size (), content.ifixups.size ());
+    EXPECT_THAT (s.ifixups (), testing::ElementsAreArray (content.ifixups));
+    EXPECT_EQ (s.xfixups ().size (), content.xfixups.size ());
+    EXPECT_THAT (s.xfixups (), testing::ElementsAreArray (content.xfixups));
+}
+
+TEST_F (GenericSection, TypicalFixupsArePacked) {
+    section_content content{section_kind::text, std::uint8_t{16}};
+    content.data.resize (256U);
+    for (auto offset = std::uint64_t{0}; offset < 256U; offset += 8U) {
+        content.ifixups.emplace_back (section_kind::data, relocation_type{2}, offset, 0);
+        content.xfixups.emplace_back (name (0x10 + offset * 4U), relocation_type{4},
+                                      binding::strong, offset + 4U, -4);
+    }
+    generic_section const & s = this->build (content);
+    EXPECT_THAT (s.ifixups (), testing::ElementsAreArray (content.ifixups));
+    EXPECT_THAT (s.xfixups (), testing::ElementsAreArray (content.xfixups));
+
+    // Each internal fixup should occupy three bytes and each external fixup five. The internal
+    // fixup array has a one byte length prefix and the external fixup array a two byte prefix.
+    std::size_t const fixup_bytes = s.size_bytes () - sizeof (generic_section) - 256U;
+    EXPECT_EQ (fixup_bytes, (1U + 32U * 3U) + (2U + 32U * 5U));
+}
@@ -0,0 +1,227 @@
+//===- unittests/mcrepo/test_shared_payload.cpp ---------------------------===//
+//*      _                        _                     _                 _  *
+//*  ___| |__   __ _ _ __ ___  __| |  _ __   __ _ _   _| | ___   __ _  __| | *
+//* / __| '_ \ / _` | '__/ _ \/ _` | | '_ \ / _` | | | | |/ _ \ / _` |/ _` | *
+//* \__ \ | | | (_| | | |  __/ (_| | | |_) | (_| | |_| | | (_) | (_| | (_| | *
+//* |___/_| |_|\__,_|_|  \___|\__,_| | .__/ \__,_|\__, |_|\___/ \__,_|\__,_| *
+//*                                  |_|          |___/                      *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/mcrepo/shared_payload.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "pstore/core/hamt_map.hpp"
+#include "pstore/support/pointee_adaptor.hpp"
+
+#include "empty_store.hpp"
+
+using pstore::repo::generic_section;
+using pstore::repo::section_content;
+using pstore::repo::section_kind;
+
+namespace {
+
+    using transaction_lock = std::unique_lock<mock_mutex>;
+
+    class SharedPayload : public testing::Test {
+    public:
+        SharedPayload ()
+                : db_{store_.file ()} {
+            db_.set_vacuum_mode (pstore::database::vacuum_mode::disabled);
+        }
+
+    protected:
+        /// Allocates a fragment containing \p contents whose payloads are stored according to
+        /// \p options.
+        pstore::extent<pstore::repo::fragment>
+        alloc (pstore::transaction_base & transaction, std::vector<section_content> & contents,
+               pstore::repo::payload_options const & options);
+
+        static pstore::repo::payload_options share_options (std::size_t const threshold) {
+            pstore::repo::payload_options options;
+            options.share_threshold = threshold;
+            return options;
+        }
+
+        std::size_t payload_index_size () {
+            return pstore::index::get_index<pstore::trailer::indices::payload> (db_)->size ();
+        }
+
+        in_memory_store store_;
+        pstore::database db_;
+    };
+
+    pstore::extent<pstore::repo::fragment>
+    SharedPayload::alloc (pstore::transaction_base & transaction,
+                          std::vector<section_content> & contents,
+                          pstore::repo::payload_options const & options) {
+        std::vector<std::unique_ptr<pstore::repo::section_creation_dispatcher>> dispatchers;
+        for (section_content const & c : contents) {
+            dispatchers.emplace_back (
+                new pstore::repo::generic_section_creation_dispatcher (c.kind, &c));
+        }
+        auto const first = pstore::make_pointee_adaptor (dispatchers.begin ());
+        auto const last = pstore::make_pointee_adaptor (dispatchers.end ());
+        pstore::repo::store_payloads (transaction, first, last, options);
+        return pstore::repo::fragment::alloc (transaction, first, last);
+    }
+
+    std::vector<std::uint8_t> payload_of (pstore::database const & db, generic_section const & s) {
+        std::shared_ptr<std::uint8_t const> owner;
+        pstore::repo::container<std::uint8_t> const payload =
+            pstore::repo::load_payload (db, s, &owner);
+        return {payload.begin (), payload.end ()};
+    }
+
+} // end anonymous namespace
+
+TEST_F (SharedPayload, InternReturnsTheSameExtentForEqualPayloads) {
+    mock_mutex mutex;
+    auto transaction = begin (db_, transaction_lock{mutex});
+    std::vector<std::uint8_t> const a (100U, std::uint8_t{0xAA});
+    std::vector<std::uint8_t> const b = a;
+    std::vector<std::uint8_t> const c (100U, std::uint8_t{0xCC});
+
+    auto const ea = pstore::repo::intern_payload (transaction, a.data (), a.data () + a.size ());
+    auto const eb = pstore::repo::intern_payload (transaction, b.data (), b.data () + b.size ());
+    auto const ec = pstore::repo::intern_payload (transaction, c.data (), c.data () + c.size ());
+    EXPECT_EQ (ea, eb);
+    EXPECT_NE (ea, ec);
+    EXPECT_EQ (ea.size, 100U);
+    EXPECT_EQ (this->payload_index_size (), 2U);
+    transaction.commit ();
+}
+
+TEST_F (SharedPayload, FragmentsShareLargePayloads) {
+    mock_mutex mutex;
+    auto transaction = begin (db_, transaction_lock{mutex});
+
+    std::vector<std::uint8_t> const text (64U, std::uint8_t{0x90});
+    std::vector<section_content> contents1;
+    contents1.emplace_back (section_kind::text, std::uint8_t{16});
+    contents1.back ().data.assign (text.begin (), text.end ());
+    contents1.back ().ifixups.emplace_back (section_kind::data, pstore::repo::relocation_type{1},
+                                            8U, 4);
+    contents1.emplace_back (section_kind::data, std::uint8_t{8});
+    contents1.back ().data.assign ({1, 2, 3});
+
+    // The second fragment has the same text payload but different fixups.
+    std::vector<section_content> contents2;
+    contents2.emplace_back (section_kind::text, std::uint8_t{16});
+    contents2.back ().data.assign (text.begin (), text.end ());
+
+    auto const f1 = pstore::repo::fragment::load (
+        db_, this->alloc (transaction, contents1, share_options (16U)));
+    auto const f2 = pstore::repo::fragment::load (
+        db_, this->alloc (transaction, contents2, share_options (16U)));
+    transaction.commit ();
+
+    generic_section const & text1 = f1->at<section_kind::text> ();
+    generic_section const & text2 = f2->at<section_kind::text> ();
+    generic_section const & data1 = f1->at<section_kind::data> ();
+    ASSERT_TRUE (text1.has_shared_payload ());
+    ASSERT_TRUE (text2.has_shared_payload ());
+    EXPECT_EQ (text1.shared_payload (), text2.shared_payload ());
+    // The data section's payload is smaller than the threshold so remains inline.
+    EXPECT_FALSE (data1.has_shared_payload ());
+    EXPECT_EQ (this->payload_index_size (), 1U);
+
+    EXPECT_EQ (text1.align (), 16U);
+    EXPECT_EQ (payload_of (db_, text1), text);
+    EXPECT_EQ (payload_of (db_, text2), text);
+    EXPECT_THAT (payload_of (db_, data1), testing::ElementsAre (1, 2, 3));
+    EXPECT_THAT (text1.ifixups (), testing::ElementsAreArray (contents1[0].ifixups));
+    EXPECT_TRUE (text2.ifixups ().empty ());
+    EXPECT_EQ (text1.size_bytes (),
+               sizeof (generic_section) + sizeof (pstore::extent<std::uint8_t>) + 1U + 4U);
+}
+
+TEST_F (SharedPayload, SectionValueLoadsSharedPayloads) {
+    mock_mutex mutex;
+    auto transaction = begin (db_, transaction_lock{mutex});
+    std::vector<std::uint8_t> const text (64U, std::uint8_t{0x90});
+    std::vector<section_content> contents;
+    contents.emplace_back (section_kind::text, std::uint8_t{16});
+    contents.back ().data.assign (text.begin (), text.end ());
+    contents.emplace_back (section_kind::data, std::uint8_t{8});
+    contents.back ().data.assign ({1, 2, 3});
+    // Store the same fragment twice so that the second copy refers to the first's text payload.
+    this->alloc (transaction, contents, share_options (16U));
+    auto const f = pstore::repo::fragment::load (
+        db_, this->alloc (transaction, contents, share_options (16U)));
+    transaction.commit ();
+    ASSERT_TRUE (f->at<section_kind::text> ().has_shared_payload ());
+    EXPECT_EQ (this->payload_index_size (), 1U);
+
+    std::shared_ptr<std::uint8_t const> owner;
+    pstore::repo::container<std::uint8_t> const value =
+        pstore::repo::section_value (db_, *f, section_kind::text, &owner);
+    EXPECT_TRUE (std::equal (value.begin (), value.end (), text.begin (), text.end ()));
+    EXPECT_NE (owner, nullptr);
+
+    std::shared_ptr<std::uint8_t const> data_owner;
+    EXPECT_THAT (pstore::repo::section_value (db_, *f, section_kind::data, &data_owner),
+                 testing::ElementsAre (1, 2, 3));
+}
+
+TEST_F (SharedPayload, DebugPayloadsAreCompressed) {
+    std::string const line = "DW_AT_name DW_AT_decl_file DW_AT_decl_line DW_AT_type ";
+    std::vector<std::uint8_t> debug;
+    for (auto ctr = 0; ctr < 40; ++ctr) {
+        debug.insert (debug.end (), line.begin (), line.end ());
+    }
+
+    pstore::repo::payload_options options;
+    options.compress_threshold = 64U;
+
+    mock_mutex mutex;
+    auto transaction = begin (db_, transaction_lock{mutex});
+    // A text section (which is not compressed by default), a debug section which is smaller than
+    // the threshold, and a debug section which is compressed.
+    std::vector<section_content> contents;
+    contents.emplace_back (section_kind::text, std::uint8_t{16});
+    contents.back ().data.assign (debug.begin (), debug.end ());
+    contents.emplace_back (section_kind::debug_loc, std::uint8_t{1});
+    contents.back ().data.assign ({1, 2, 3, 4});
+    contents.emplace_back (section_kind::debug_string, std::uint8_t{1});
+    contents.back ().data.assign (debug.begin (), debug.end ());
+    contents.back ().ifixups.emplace_back (section_kind::text, pstore::repo::relocation_type{1},
+                                           8U, 0);
+    auto const f =
+        pstore::repo::fragment::load (db_, this->alloc (transaction, contents, options));
+    transaction.commit ();
+
+    generic_section const & text = f->at<section_kind::text> ();
+    generic_section const & loc = f->at<section_kind::debug_loc> ();
+    generic_section const & str = f->at<section_kind::debug_string> ();
+    EXPECT_FALSE (text.has_shared_payload ());
+    EXPECT_FALSE (loc.has_shared_payload ());
+    ASSERT_TRUE (str.has_compressed_payload ());
+    EXPECT_EQ (str.size (), debug.size ());
+    EXPECT_LT (str.shared_payload ().size, debug.size () / 4U);
+    EXPECT_THAT (str.ifixups (), testing::ElementsAreArray (contents[2].ifixups));
+    // Compressed payloads are not shared unless that is also requested.
+    EXPECT_EQ (this->payload_index_size (), 0U);
+
+    EXPECT_EQ (payload_of (db_, str), debug);
+    EXPECT_EQ (payload_of (db_, text), debug);
+
+    // A second load through the cache returns the same decompressed copy.
+    pstore::repo::payload_cache cache{4096U};
+    std::shared_ptr<std::uint8_t const> owner1;
+    std::shared_ptr<std::uint8_t const> owner2;
+    auto const p1 = pstore::repo::load_payload (db_, str, &owner1, &cache);
+    auto const p2 = pstore::repo::load_payload (db_, str, &owner2, &cache);
+    EXPECT_EQ (p1.data (), p2.data ());
+    EXPECT_TRUE (std::equal (p1.begin (), p1.end (), debug.begin (), debug.end ()));
+}
@@ -0,0 +1,126 @@
+//===- unittests/os/test_async_log.cpp ------------------------------------===//
+//*                               _              *
+//*   __ _ ___ _   _ _ __   ___  | | ___   __ _  *
+//*  / _` / __| | | | '_ \ / __| | |/ _ \ / _` | *
+//* | (_| \__ \ |_| | | | | (__  | | (_) | (_| | *
+//*  \__,_|___/\__, |_| |_|\___| |_|\___/ \__, | *
+//*            |___/                      |___/  *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/os/async_log.hpp"
+
+// Standard library includes
+#include <future>
+#include <thread>
+#include <vector>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+namespace {
+
+    using message = std::pair<std::string, std::string>; // thread name and text.
+
+    /// The messages written to a recorder. This outlives the recorder (which is owned by the
+    /// async_logger under test).
+    class journal {
+    public:
+        void add (std::string const & thread_name, std::string const & text) {
+            std::lock_guard<std::mutex> const lock{mut_};
+            messages_.emplace_back (thread_name, text);
+        }
+        std::vector<message> messages () const {
+            std::lock_guard<std::mutex> const lock{mut_};
+            return messages_;
+        }
+
+    private:
+        mutable std::mutex mut_;
+        std::vector<message> messages_;
+    };
+
+    /// A logger which records the messages that it is asked to write.
+    class recorder final : public pstore::logger {
+    public:
+        explicit recorder (journal * const j, std::shared_future<void> gate = {})
+                : journal_{j}
+                , gate_{std::move (gate)} {}
+
+        void log (priority, std::string const & text) override { journal_->add ({}, text); }
+        void log_deferred (priority, std::time_t, std::string const & thread_name,
+                           std::string const & text) override {
+            if (gate_.valid ()) {
+                gate_.wait ();
+            }
+            journal_->add (thread_name, text);
+        }
+
+    private:
+        journal * const journal_;
+        std::shared_future<void> gate_;
+    };
+
+} // end anonymous namespace
+
+TEST (AsyncLog, MessagesFromEachThreadAreWrittenInOrder) {
+    using testing::ElementsAre;
+    using testing::Pair;
+
+    journal j;
+    pstore::async_logger logger{std::make_unique<recorder> (&j)};
+
+    auto const worker = [&logger] (char const * const name) {
+        pstore::threads::set_name (name);
+        logger.log (pstore::logger::priority::info, std::string{name} + " 1");
+        logger.log (pstore::logger::priority::info, std::string{name} + " 2");
+    };
+    std::thread t1{worker, "one"};
+    std::thread t2{worker, "two"};
+    t1.join ();
+    t2.join ();
+    pstore::flush_async_log ();
+
+    std::vector<message> one;
+    std::vector<message> two;
+    for (message const & m : j.messages ()) {
+        (m.first == "one" ? one : two).push_back (m);
+    }
+    EXPECT_THAT (one, ElementsAre (Pair ("one", "one 1"), Pair ("one", "one 2")));
+    EXPECT_THAT (two, ElementsAre (Pair ("two", "two 1"), Pair ("two", "two 2")));
+}
+
+TEST (AsyncLog, FullRingDropsMessages) {
+    std::promise<void> open;
+    journal j;
+    auto const dropped_before = pstore::async_log_dropped ();
+    {
+        pstore::async_logger logger{
+            std::make_unique<recorder> (&j, open.get_future ().share ())};
+        // The writer blocks on the first message so this thread's ring fills.
+        constexpr auto count = pstore::async_log_ring_size + 10U;
+        for (auto ctr = std::size_t{0}; ctr < count; ++ctr) {
+            logger.log (pstore::logger::priority::info, "message");
+        }
+        auto const dropped = pstore::async_log_dropped () - dropped_before;
+        EXPECT_GE (dropped, 10U);
+        open.set_value ();
+        pstore::flush_async_log ();
+        logger.log (pstore::logger::priority::info, "last");
+        // The destructor waits for the messages to be written.
+    }
+    // Once there was space in the ring, the number of dropped messages was reported.
+    std::vector<message> const messages = j.messages ();
+    ASSERT_FALSE (messages.empty ());
+    EXPECT_EQ (messages.back ().second, "last");
+    EXPECT_TRUE (std::any_of (std::begin (messages), std::end (messages),
+                              [] (message const & m) {
+                                  return m.second.find ("log messages were dropped") !=
+                                         std::string::npos;
+                              }));
+}
@@ -0,0 +1,83 @@
+//===- unittests/os/test_trace.cpp ----------------------------------------===//
+//*  _                       *
+//* | |_ _ __ __ _  ___ ___  *
+//* | __| '__/ _` |/ __/ _ \ *
+//* | |_| | | (_| | (_|  __/ *
+//*  \__|_|  \__,_|\___\___| *
+//*                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/os/trace.hpp"
+
+// Standard library includes
+#include <chrono>
+#include <sstream>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+namespace {
+
+    class Trace : public testing::Test {
+    protected:
+        Trace () { pstore::trace::clear (); }
+        ~Trace () override {
+            pstore::trace::enable (false);
+            pstore::trace::clear ();
+        }
+
+        static std::string json () {
+            std::ostringstream os;
+            pstore::trace::write_json (os);
+            return os.str ();
+        }
+    };
+
+} // end anonymous namespace
+
+TEST_F (Trace, DisabledRecordsNothing) {
+    pstore::trace::enable (false);
+    { pstore::trace::span const s{"disabled"}; }
+    EXPECT_EQ (json (), "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n");
+}
+
+TEST_F (Trace, SpanIsRecorded) {
+    using testing::HasSubstr;
+    pstore::trace::enable (true);
+    { pstore::trace::span const s{"first"}; }
+    { pstore::trace::span const s{"second"}; }
+    std::string const str = json ();
+    EXPECT_THAT (str, HasSubstr (R"({"name":"first","cat":"pstore","ph":"X","ts":)"));
+    EXPECT_THAT (str, HasSubstr (R"({"name":"second","cat":"pstore","ph":"X","ts":)"));
+    EXPECT_LT (str.find ("first"), str.find ("second"));
+}
+
+TEST_F (Trace, RingKeepsTheNewestEvents) {
+    pstore::trace::enable (true);
+    auto const now = pstore::trace::clock::now ();
+    pstore::trace::record ("oldest", now, now);
+    for (auto ctr = std::size_t{0}; ctr < pstore::trace::ring_size; ++ctr) {
+        pstore::trace::record ("newer", now, now);
+    }
+    std::string const str = json ();
+    EXPECT_EQ (str.find ("oldest"), std::string::npos);
+    EXPECT_NE (str.find ("newer"), std::string::npos);
+}
+
+TEST_F (Trace, TimestampsAreMeasuredFromTheClockEpoch) {
+    using testing::HasSubstr;
+    // A time well beyond the start of the process. Timestamps measured from the clock's epoch
+    // allow the traces written by different processes to be merged.
+    auto const start = pstore::trace::clock::time_point{std::chrono::duration_cast<
+        pstore::trace::clock::duration> (std::chrono::nanoseconds{1234567890123456})};
+    pstore::trace::enable (true);
+    pstore::trace::record ("epoch", start, start + std::chrono::microseconds{2});
+    std::string const str = json ();
+    EXPECT_THAT (str, HasSubstr (R"("ts":1234567890123.456,"dur":2.000,)"));
+}
@@ -0,0 +1,71 @@
+//===- unittests/support/test_counters.cpp --------------------------------===//
+//*                        _                 *
+//*   ___ ___  _   _ _ __ | |_ ___ _ __ ___  *
+//*  / __/ _ \| | | | '_ \| __/ _ \ '__/ __| *
+//* | (_| (_) | |_| | | | | ||  __/ |  \__ \ *
+//*  \___\___/ \__,_|_| |_|\__\___|_|  |___/ *
+//*                                          *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/support/counters.hpp"
+
+// Standard library includes
+#include <limits>
+#include <thread>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+using pstore::counters::counter;
+using pstore::counters::histogram;
+
+TEST (Counters, Bucket) {
+    using pstore::counters::bucket;
+    EXPECT_EQ (bucket (0U), 0U);
+    EXPECT_EQ (bucket (1U), 1U);
+    EXPECT_EQ (bucket (2U), 2U);
+    EXPECT_EQ (bucket (3U), 2U);
+    EXPECT_EQ (bucket (4U), 3U);
+    EXPECT_EQ (bucket (std::numeric_limits<std::uint64_t>::max ()), 64U);
+}
+
+TEST (Counters, AddIsVisibleToRead) {
+    auto const before = pstore::counters::read ();
+    pstore::counters::add (counter::hamt_find);
+    pstore::counters::add (counter::hamt_find, 2U);
+    auto const after = pstore::counters::read ();
+    // Other threads may also increment the counter, so we can't check for equality.
+    EXPECT_GE (after[counter::hamt_find] - before[counter::hamt_find], 3U);
+}
+
+TEST (Counters, ExitedThreadsAreRetained) {
+    auto const before = pstore::counters::read ();
+    std::thread t{[] {
+        pstore::counters::add (counter::storage_regions_mapped, 5U);
+        pstore::counters::record (histogram::transaction_commit_ns, 6U);
+    }};
+    t.join ();
+    auto const after = pstore::counters::read ();
+    EXPECT_GE (after[counter::storage_regions_mapped] - before[counter::storage_regions_mapped],
+               5U);
+    // 6 is in the bucket [4, 8).
+    EXPECT_GE (after[histogram::transaction_commit_ns][3] -
+                   before[histogram::transaction_commit_ns][3],
+               1U);
+}
+
+TEST (Counters, ToJson) {
+    pstore::counters::snapshot s;
+    s.counters[static_cast<std::size_t> (counter::database_get)] = 7U;
+    s.histograms[static_cast<std::size_t> (histogram::transaction_commit_ns)][0] = 1U;
+    s.histograms[static_cast<std::size_t> (histogram::transaction_commit_ns)][4] = 2U;
+    std::string const json = pstore::counters::to_json (s);
+    EXPECT_THAT (json, testing::StartsWith ("{\"database_get\":7,\"database_get_spanning\":0,"));
+    EXPECT_THAT (json, testing::EndsWith (",\"transaction_commit_ns\":{\"0\":1,\"8\":2}}"));
+}
@@ -0,0 +1,126 @@
+//===- unittests/support/test_lz4.cpp -------------------------------------===//
+//*  _     _  _    *
+//* | |___| || |   *
+//* | |_  / || |_  *
+//* | |/ /|__   _| *
+//* |_/___|  |_|   *
+//*                *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+/// \file test_lz4.cpp
+
+#include "pstore/support/lz4.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+namespace {
+
+    using bytes = std::vector<std::uint8_t>;
+
+    bytes compress (bytes const & in) {
+        bytes out (pstore::lz4::compress_bound (in.size ()));
+        out.resize (pstore::lz4::compress (in.data (), in.size (), out.data ()));
+        return out;
+    }
+
+    bool decompress (bytes const & in, bytes * const out) {
+        return pstore::lz4::decompress (in.data (), in.size (), out->data (), out->size ());
+    }
+
+    class Lz4 : public testing::Test {
+    protected:
+        /// Compresses and decompresses \p in. Returns the size of the compressed data.
+        std::size_t round_trip (bytes const & in) {
+            bytes const compressed = compress (in);
+            EXPECT_LE (compressed.size (), pstore::lz4::compress_bound (in.size ()));
+            bytes out (in.size ());
+            EXPECT_TRUE (decompress (compressed, &out));
+            EXPECT_EQ (out, in);
+            return compressed.size ();
+        }
+    };
+
+} // end anonymous namespace
+
+TEST_F (Lz4, Empty) {
+    bytes const compressed = compress (bytes{});
+    // A single empty literal run.
+    EXPECT_THAT (compressed, testing::ElementsAre (0x00));
+}
+
+TEST_F (Lz4, ShortInputIsLiteral) {
+    bytes const in{'a', 'b', 'c', 'a', 'b', 'c'};
+    EXPECT_EQ (this->round_trip (in), in.size () + 1U);
+}
+
+TEST_F (Lz4, RunOfOneByte) {
+    bytes const in (1000U, std::uint8_t{'x'});
+    EXPECT_LT (this->round_trip (in), 20U);
+}
+
+TEST_F (Lz4, RepeatedText) {
+    std::string const sentence = "The quick brown fox jumps over the lazy dog. ";
+    bytes in;
+    for (auto ctr = 0; ctr < 100; ++ctr) {
+        in.insert (in.end (), sentence.begin (), sentence.end ());
+    }
+    EXPECT_LT (this->round_trip (in), in.size () / 10U);
+}
+
+TEST_F (Lz4, RandomDataDoesNotExceedBound) {
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<unsigned> distribution{0U, 255U};
+    bytes in (70000U);
+    for (std::uint8_t & b : in) {
+        b = static_cast<std::uint8_t> (distribution (generator));
+    }
+    this->round_trip (in);
+}
+
+TEST_F (Lz4, LongLiteralAndMatchLengths) {
+    // 300 distinct bytes need a multi-byte literal length; the following copy of those bytes is
+    // a match whose length also needs extra bytes.
+    bytes in;
+    for (auto ctr = 0U; ctr < 300U; ++ctr) {
+        in.push_back (static_cast<std::uint8_t> (ctr * 7U + ctr / 256U));
+    }
+    bytes const first = in;
+    in.insert (in.end (), first.begin (), first.end ());
+    EXPECT_LT (this->round_trip (in), 320U);
+}
+
+TEST_F (Lz4, DecodeReferenceBlock) {
+    // One literal 'a' followed by a 14-byte match at offset 1 then five trailing literals.
+    bytes const block{0x1A, 'a', 0x01, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    bytes out (20U);
+    ASSERT_TRUE (decompress (block, &out));
+    EXPECT_EQ (out, bytes (20U, std::uint8_t{'a'}));
+}
+
+TEST_F (Lz4, RejectsMalformedInput) {
+    bytes out (20U);
+    // The offset refers to data before the start of the output.
+    EXPECT_FALSE (decompress (bytes{0x1A, 'a', 0x02, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'}, &out));
+    // A zero offset.
+    EXPECT_FALSE (decompress (bytes{0x1A, 'a', 0x00, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'}, &out));
+    // Truncated input.
+    EXPECT_FALSE (decompress (bytes{0x1A, 'a', 0x01}, &out));
+    EXPECT_FALSE (decompress (bytes{}, &out));
+    // The output would be too short.
+    EXPECT_FALSE (decompress (bytes{0x1A, 'a', 0x01, 0x00, 0x40, 'a', 'a', 'a', 'a'}, &out));
+    // The output would overflow.
+    bytes small (10U);
+    EXPECT_FALSE (decompress (bytes{0x1A, 'a', 0x01, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'}, &small));
+}
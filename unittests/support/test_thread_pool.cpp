@@ -0,0 +1,98 @@
+//===- unittests/support/test_thread_pool.cpp -----------------------------===//
+//*  _   _                        _                     _  *
+//* | |_| |__  _ __ ___  __ _  __| |  _ __   ___   ___ | | *
+//* | __| '_ \| '__/ _ \/ _` |/ _` | | '_ \ / _ \ / _ \| | *
+//* | |_| | | | | |  __/ (_| | (_| | | |_) | (_) | (_) | | *
+//*  \__|_| |_|_|  \___|\__,_|\__,_| | .__/ \___/ \___/|_| *
+//*                                  |_|                   *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/support/thread_pool.hpp"
+
+// Standard library includes
+#include <atomic>
+#include <forward_list>
+#include <numeric>
+
+// 3rd party includes
+#include <gmock/gmock.h>
+
+// pstore includes
+#include "pstore/support/parallel_for_each.hpp"
+
+TEST (ThreadPool, RunsAllTasks) {
+    std::atomic<unsigned> count{0U};
+    {
+        pstore::thread_pool pool{3U};
+        EXPECT_EQ (pool.size (), 3U);
+        for (auto ctr = 0U; ctr < 100U; ++ctr) {
+            pool.submit ([&count] { ++count; });
+        }
+        // The destructor waits for the queued tasks to complete.
+    }
+    EXPECT_EQ (count.load (), 100U);
+}
+
+TEST (ThreadPool, TasksSubmittedByWorkers) {
+    std::atomic<unsigned> count{0U};
+    {
+        pstore::thread_pool pool{2U};
+        for (auto ctr = 0U; ctr < 10U; ++ctr) {
+            pool.submit ([&pool, &count] {
+                for (auto inner = 0U; inner < 10U; ++inner) {
+                    pool.submit ([&count] { ++count; });
+                }
+            });
+        }
+    }
+    EXPECT_EQ (count.load (), 100U);
+}
+
+TEST (ThreadPool, ParallelForEachForwardIterator) {
+    pstore::thread_pool pool{2U};
+    std::forward_list<unsigned> src (1000U);
+    std::iota (std::begin (src), std::end (src), 1U);
+    std::atomic<unsigned> sum{0U};
+    pstore::parallel_for_each (pool, std::begin (src), std::end (src),
+                               [&sum] (unsigned const v) { sum += v; });
+    EXPECT_EQ (sum.load (), 1000U * 1001U / 2U);
+}
+
+TEST (ThreadPool, NestedParallelForEach) {
+    // Every worker may be occupied by the outer loop: the inner loops must still complete.
+    pstore::thread_pool pool{2U};
+    std::vector<unsigned> outer (16U);
+    std::iota (std::begin (outer), std::end (outer), 0U);
+    std::atomic<unsigned> count{0U};
+    pstore::parallel_for_each (pool, std::begin (outer), std::end (outer), [&] (unsigned) {
+        std::vector<unsigned> const inner (50U);
+        pstore::parallel_for_each (pool, std::begin (inner), std::end (inner),
+                                   [&count] (unsigned) { ++count; });
+    });
+    EXPECT_EQ (count.load (), 16U * 50U);
+}
+
+#ifdef PSTORE_EXCEPTIONS
+TEST (ThreadPool, ParallelForEachSkipsAfterException) {
+    class custom_exception : public std::exception {};
+    pstore::thread_pool pool{2U};
+    std::vector<unsigned> src (10000U);
+    std::iota (std::begin (src), std::end (src), 0U);
+    std::atomic<unsigned> count{0U};
+    EXPECT_THROW (pstore::parallel_for_each (pool, std::begin (src), std::end (src),
+                                             [&count] (unsigned const v) {
+                                                 if (v == 0U) {
+                                                     throw custom_exception{};
+                                                 }
+                                                 ++count;
+                                             }),
+                  custom_exception);
+    EXPECT_LT (count.load (), 10000U);
+}
+#endif // PSTORE_EXCEPTIONS
@@ -0,0 +1,251 @@
+//===- unittests/vacuum/test_scheduler.cpp --------------------------------===//
+//*           _              _       _            *
+//*  ___  ___| |__   ___  __| |_   _| | ___ _ __  *
+//* / __|/ __| '_ \ / _ \/ _` | | | | |/ _ \ '__| *
+//* \__ \ (__| | | |  __/ (_| | |_| | |  __/ |    *
+//* |___/\___|_| |_|\___|\__,_|\__,_|_|\___|_|    *
+//*                                               *
+//===----------------------------------------------------------------------===//
+//
+// Part of the pstore project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://github.com/SNSystems/pstore/blob/master/LICENSE.txt for license
+// information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "pstore/vacuum/scheduler.hpp"
+
+#include <algorithm>
+
+#include <gmock/gmock.h>
+
+namespace {
+
+    class VacuumScheduler : public testing::Test {
+    protected:
+        using collect_result = vacuum::collect_result;
+
+        static vacuum::scheduler::options make_options (unsigned workers) {
+            vacuum::scheduler::options opt;
+            opt.workers = workers;
+            opt.quiet_period = std::chrono::seconds{0};
+            return opt;
+        }
+
+        /// Returns the estimated size of a store. Unless a store's garbage was given explicitly,
+        /// it is assumed to be entirely garbage.
+        vacuum::space_usage estimate (std::string const & path) const {
+            std::lock_guard<std::mutex> const lock{mut_};
+            vacuum::space_usage result;
+            result.size = 1000U;
+            result.garbage = result.size;
+            auto const pos = garbage_.find (path);
+            if (pos != garbage_.end ()) {
+                result.garbage = pos->second;
+            }
+            return result;
+        }
+
+        /// Waits until the scheduler has no outstanding work.
+        static bool wait_idle (vacuum::scheduler const & s) {
+            auto const busy = [&s] () {
+                std::vector<vacuum::scheduler::store_status> const status = s.status ();
+                return std::any_of (std::begin (status), std::end (status),
+                                    [] (vacuum::scheduler::store_status const & st) {
+                                        return st.pending || st.running;
+                                    });
+            };
+            auto const timeout = std::chrono::steady_clock::now () + std::chrono::seconds{10};
+            while (busy ()) {
+                if (std::chrono::steady_clock::now () > timeout) {
+                    return false;
+                }
+                std::this_thread::sleep_for (std::chrono::milliseconds{1});
+            }
+            return true;
+        }
+
+        mutable std::mutex mut_;
+        std::condition_variable cv_;
+        std::map<std::string, std::uint64_t> garbage_;
+        std::vector<std::string> collected_;
+    };
+
+} // end anonymous namespace
+
+TEST_F (VacuumScheduler, HighestPriorityFirst) {
+    garbage_ = {{"gate", 900U}, {"small", 200U}, {"large", 800U}, {"medium", 500U}};
+    bool open = false;
+    auto collect = [this, &open] (std::string const & path, vacuum::throttle &,
+                                  std::atomic<bool> const &) {
+        std::unique_lock<std::mutex> lock{mut_};
+        collected_.push_back (path);
+        cv_.notify_all ();
+        // Hold the only worker until the other requests have been made.
+        cv_.wait (lock, [&open] { return open; });
+        return collect_result::complete;
+    };
+    vacuum::scheduler s{make_options (1U), collect,
+                        [this] (std::string const & path) { return this->estimate (path); }};
+
+    s.request ("gate");
+    {
+        std::unique_lock<std::mutex> lock{mut_};
+        cv_.wait_for (lock, std::chrono::seconds{10}, [this] { return !collected_.empty (); });
+    }
+    s.request ("small");
+    s.request ("large");
+    s.request ("medium");
+    {
+        std::lock_guard<std::mutex> const lock{mut_};
+        open = true;
+    }
+    cv_.notify_all ();
+    ASSERT_TRUE (wait_idle (s));
+    EXPECT_THAT (collected_, testing::ElementsAre ("gate", "large", "medium", "small"));
+}
+
+TEST_F (VacuumScheduler, BoundedWorkers) {
+    auto running = 0U;
+    auto max_running = 0U;
+    auto collect = [this, &running, &max_running] (std::string const & path, vacuum::throttle &,
+                                                   std::atomic<bool> const &) {
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            collected_.push_back (path);
+            max_running = std::max (max_running, ++running);
+        }
+        std::this_thread::sleep_for (std::chrono::milliseconds{5});
+        std::lock_guard<std::mutex> const lock{mut_};
+        --running;
+        return collect_result::complete;
+    };
+    vacuum::scheduler s{make_options (2U), collect,
+                        [this] (std::string const & path) { return this->estimate (path); }};
+    for (auto ctr = 0; ctr < 8; ++ctr) {
+        s.request ("store" + std::to_string (ctr));
+    }
+    ASSERT_TRUE (wait_idle (s));
+    EXPECT_EQ (collected_.size (), 8U);
+    EXPECT_LE (max_running, 2U);
+}
+
+TEST_F (VacuumScheduler, RetryWhenBusy) {
+    auto collect = [this] (std::string const & path, vacuum::throttle &,
+                           std::atomic<bool> const &) {
+        std::lock_guard<std::mutex> const lock{mut_};
+        collected_.push_back (path);
+        return collected_.size () == 1U ? collect_result::busy : collect_result::complete;
+    };
+    vacuum::scheduler s{make_options (1U), collect,
+                        [this] (std::string const & path) { return this->estimate (path); }};
+    s.request ("store");
+    ASSERT_TRUE (wait_idle (s));
+    EXPECT_THAT (collected_, testing::ElementsAre ("store", "store"));
+}
+
+TEST_F (VacuumScheduler, CancelRunning) {
+    bool started = false;
+    auto collect = [this, &started] (std::string const &, vacuum::throttle &,
+                                     std::atomic<bool> const & cancel) {
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            started = true;
+        }
+        cv_.notify_all ();
+        while (!cancel) {
+            std::this_thread::sleep_for (std::chrono::milliseconds{1});
+        }
+        return collect_result::cancelled;
+    };
+    vacuum::scheduler s{make_options (1U), collect,
+                        [this] (std::string const & path) { return this->estimate (path); }};
+    s.request ("store");
+    {
+        std::unique_lock<std::mutex> lock{mut_};
+        cv_.wait_for (lock, std::chrono::seconds{10}, [&started] { return started; });
+    }
+    EXPECT_TRUE (s.cancel ("store"));
+    ASSERT_TRUE (wait_idle (s));
+    EXPECT_FALSE (s.cancel ("store"));
+}
+
+TEST_F (VacuumScheduler, RememberCollectedStore) {
+    auto collect = [this] (std::string const & path, vacuum::throttle &,
+                           std::atomic<bool> const &) {
+        std::lock_guard<std::mutex> const lock{mut_};
+        collected_.push_back (path);
+        garbage_[path] = 0U;
+        return collect_result::complete;
+    };
+    vacuum::scheduler s{make_options (1U), collect,
+                        [this] (std::string const & path) { return this->estimate (path); }};
+    s.request ("store");
+    ASSERT_TRUE (wait_idle (s));
+    {
+        std::vector<vacuum::scheduler::store_status> const status = s.status ();
+        ASSERT_EQ (status.size (), 1U);
+        EXPECT_EQ (status[0].path, "store");
+        EXPECT_EQ (status[0].vacuums, 1U);
+        EXPECT_FALSE (status[0].pending);
+        EXPECT_EQ (status[0].usage.garbage, 0U);
+    }
+
+    // The store's history is kept for its next request.
+    s.set_quiet_period (std::chrono::hours{1});
+    {
+        std::lock_guard<std::mutex> const lock{mut_};
+        garbage_["store"] = 300U;
+    }
+    EXPECT_TRUE (s.request ("store"));
+    {
+        std::vector<vacuum::scheduler::store_status> const status = s.status ();
+        ASSERT_EQ (status.size (), 1U);
+        EXPECT_TRUE (status[0].pending);
+        EXPECT_EQ (status[0].usage.garbage, 300U);
+        EXPECT_EQ (status[0].vacuums, 1U);
+    }
+    EXPECT_TRUE (s.cancel ("store"));
+    EXPECT_TRUE (s.status ().empty ());
+}
+
+TEST_F (VacuumScheduler, IgnoreLowGarbageRatio) {
+    garbage_ = {{"clean", 50U}};
+    auto collect = [this] (std::string const & path, vacuum::throttle &,
+                           std::atomic<bool> const &) {
+        std::lock_guard<std::mutex> const lock{mut_};
+        collected_.push_back (path);
+        return collect_result::complete;
+    };
+    vacuum::scheduler::options opt = make_options (1U);
+    opt.min_garbage_ratio = 0.1;
+    vacuum::scheduler s{opt, collect,
+                        [this] (std::string const & path) { return this->estimate (path); }};
+    EXPECT_FALSE (s.request ("clean"));
+    EXPECT_TRUE (s.request ("dirty"));
+    ASSERT_TRUE (wait_idle (s));
+    EXPECT_THAT (collected_, testing::ElementsAre ("dirty"));
+
+    std::vector<vacuum::scheduler::store_status> const status = s.status ();
+    ASSERT_EQ (status.size (), 1U);
+    EXPECT_EQ (status[0].path, "dirty");
+    EXPECT_EQ (status[0].vacuums, 1U);
+}
+
+TEST (VacuumThrottle, Unlimited) {
+    vacuum::throttle t;
+    auto const start = std::chrono::steady_clock::now ();
+    t.consume (std::uint64_t{1} << 40U);
+    t.consume (std::uint64_t{1} << 40U);
+    EXPECT_LT (std::chrono::steady_clock::now () - start, std::chrono::seconds{1});
+}
+
+TEST (VacuumThrottle, Paced) {
+    // At 1MB/s, each 50KB slot lasts 50ms. The third call must wait for the first two slots.
+    vacuum::throttle t{1000000U};
+    auto const start = std::chrono::steady_clock::now ();
+    t.consume (50000U);
+    t.consume (50000U);
+    t.consume (50000U);
+    EXPECT_GE (std::chrono::steady_clock::now () - start, std::chrono::milliseconds{100});
+}